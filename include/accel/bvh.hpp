@@ -0,0 +1,247 @@
+#ifndef GPU_RAYTRACE_BVH_HPP
+#define GPU_RAYTRACE_BVH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "base/thread_pool.hpp"
+#include "gpu/gpu.hpp"
+#include "math/floats.hpp"
+#include "math/geometry/bounds.hpp"
+#include "math/geometry/ray.hpp"
+
+namespace accel
+{
+
+    /**
+     * node of a flattened bvh, sized and aligned to half a cache line.
+     * the nodes are laid out depth first: the first child of an interior node follows it, and offset holds the index
+     * of the second. a leaf holds count primitives starting at offset in the primitive index array.
+     */
+    struct alignas(32) bvh_node
+    {
+        float lower[3]; // minimum corner of the bounds
+        std::uint32_t offset; // first primitive of a leaf, second child of an interior node
+        float upper[3]; // maximum corner of the bounds
+        std::uint16_t count; // number of primitives of a leaf. zero for interior nodes
+        std::uint8_t axis; // axis an interior node was split along
+        std::uint8_t pad;
+
+        CPU_GPU bool is_leaf() const { return count > 0; }
+
+        CPU_GPU math::bounds3f get_bounds() const;
+
+        /**
+         * slab test of a ray against the bounds, with the far distances pushed out by a few ulp so that rounding never
+         * culls a grazing hit.
+         * @param origin origin of the ray
+         * @param inv_direction reciprocal of the direction of the ray
+         * @param dir_is_neg whether each component of the direction is negative
+         * @param tmax end of the interval searched along the ray, which starts at 0
+         * @return whether the ray overlaps the bounds within [0, tmax]
+         */
+        CPU_GPU bool intersect(const float origin[3], const float inv_direction[3], const int dir_is_neg[3], float tmax) const;
+    };
+
+    static_assert(sizeof(bvh_node) == 32, "bvh nodes must stay 32 bytes so that two fill a cache line");
+
+    /**
+     * how a bvh is built.
+     */
+    struct bvh_build_settings
+    {
+        std::uint32_t max_leaf_size = 4; // a node with more primitives is always split
+        std::uint32_t bins = 16; // candidate split planes per axis are the boundaries of this many bins, at most 32
+        float traversal_cost = 1; // cost of visiting a node, relative to intersection_cost
+        float intersection_cost = 1; // cost of intersecting a primitive
+    };
+
+    /**
+     * bounding volume hierarchy over a set of primitives known only by their bounds.
+     * it is built top down by splitting each node at the bin boundary of least surface area heuristic cost along any
+     * axis, running the two halves of large nodes and the binning of large ranges on the thread pool. the tree is then
+     * flattened into an array of bvh_nodes.
+     * traversal calls back for each primitive of the leaves it reaches, so the bvh serves any primitive type.
+     */
+    class bvh
+    {
+    private:
+        std::vector<bvh_node> _nodes;
+        std::vector<std::uint32_t> _indices;
+
+        friend class deformable_bvh;
+
+        /**
+         * fits the bounds of a leaf to its primitives, or those of an interior node to its children.
+         */
+        void fit_node(std::uint32_t node, std::span<const math::bounds3f> primitive_bounds);
+
+        /**
+         * refits the subtree of a node, which spans the nodes [node, end).
+         */
+        void refit(std::uint32_t node, std::uint32_t end, std::span<const math::bounds3f> primitive_bounds, base::thread_pool& pool);
+
+        template<bool AnyHit, typename Fn>
+        bool traverse(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const;
+    public:
+        /**
+         * deepest path traversal can follow. the SAH builder falls back to median splits by depth 32, and Morton code
+         * splits end after the bits of the codes and of the primitive index, at most 63 + 32.
+         */
+        static constexpr std::size_t max_depth = 128;
+
+        bvh() = default;
+
+        /**
+         * @param primitive_bounds bounds of each primitive
+         * @param settings how the tree is built
+         * @param pool pool running the build
+         * @throws std::invalid_argument if there are 2^32 primitives or more, or if a bounds is empty.
+         */
+        explicit bvh(std::span<const math::bounds3f> primitive_bounds, const bvh_build_settings& settings = {},
+                     base::thread_pool& pool = base::thread_pool::global());
+
+        /**
+         * adopts a tree flattened elsewhere, e.g. by build_lbvh.
+         * @param nodes nodes in the depth first layout described at bvh_node, at most max_depth deep
+         * @param primitive_indices the primitives in the order the leaves reference them
+         */
+        bvh(std::vector<bvh_node> nodes, std::vector<std::uint32_t> primitive_indices);
+
+        bool empty() const;
+        math::bounds3f get_bounds() const;
+
+        std::span<const bvh_node> nodes() const;
+
+        /**
+         * @return the primitives in the order the leaves reference them
+         */
+        std::span<const std::uint32_t> primitive_indices() const;
+
+        /**
+         * fits the bounds of every node to new bounds of the primitives, keeping the topology, e.g. after the vertices
+         * of a mesh moved. the children of large nodes are refitted in parallel. the quality of the tree degrades with
+         * the distance the primitives moved from where it was built. deformable_bvh refits only what moved.
+         * @param primitive_bounds bounds of each primitive
+         * @param pool pool running the refit
+         * @throws std::invalid_argument if primitive_bounds does not hold one bounds per primitive of the tree.
+         */
+        void refit(std::span<const math::bounds3f> primitive_bounds, base::thread_pool& pool = base::thread_pool::global());
+
+        /**
+         * finds the closest primitive hit by a ray, visiting children front to back.
+         * intersect(primitive, ray, tmax) tests a primitive against the ray and, on a hit closer than tmax, lowers
+         * tmax to it and returns true.
+         * @param r ray, or a tracked_ray
+         * @param tmax end of the interval searched along the ray. receives the distance of the closest hit
+         * @param intersect callable taking (std::uint32_t, const math::ray<float, 3>&, float&) and returning bool
+         * @return whether a primitive was hit
+         */
+        template<typename Fn>
+        bool closest_hit(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const;
+
+        /**
+         * finds whether a ray hits any primitive, e.g. for shadow rays, stopping at the first hit.
+         * @param r ray, or a tracked_ray
+         * @param tmax end of the interval searched along the ray
+         * @param intersect callable with the signature of the one of closest_hit
+         * @return whether a primitive was hit
+         */
+        template<typename Fn>
+        bool any_hit(const math::ray<float, 3>& r, float tmax, Fn&& intersect) const;
+    };
+
+    inline CPU_GPU math::bounds3f bvh_node::get_bounds() const
+    {
+        return { math::point<float, 3>{ lower[0], lower[1], lower[2] }, math::point<float, 3>{ upper[0], upper[1], upper[2] } };
+    }
+
+    inline CPU_GPU bool bvh_node::intersect(const float origin[3], const float inv_direction[3], const int dir_is_neg[3], float tmax) const
+    {
+        float t0 = 0, t1 = tmax;
+        for (int i = 0; i < 3; ++i)
+        {
+            float t_near = ((dir_is_neg[i] ? upper[i] : lower[i]) - origin[i]) * inv_direction[i];
+            float t_far = ((dir_is_neg[i] ? lower[i] : upper[i]) - origin[i]) * inv_direction[i] * math::slab_far_scale<float>;
+
+            // NaN is handled as in bounds::intersect
+            t0 = t_near > t0 ? t_near : t0;
+            t1 = t_far < t1 ? t_far : t1;
+        }
+        return t0 <= t1;
+    }
+
+    template<bool AnyHit, typename Fn>
+    bool bvh::traverse(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const
+    {
+        if (_nodes.empty()) return false;
+
+        float origin[3], inv_direction[3];
+        int dir_is_neg[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            origin[i] = r.get_origin()[i];
+            inv_direction[i] = 1 / r.get_direction()[i];
+            dir_is_neg[i] = inv_direction[i] < 0;
+        }
+
+        std::uint32_t stack[max_depth];
+        std::size_t top = 0;
+        std::uint32_t current = 0;
+        bool hit = false;
+        while (true)
+        {
+            const bvh_node& node = _nodes[current];
+            if (node.intersect(origin, inv_direction, dir_is_neg, tmax))
+            {
+                if (node.is_leaf())
+                {
+                    for (std::uint32_t i = node.offset; i < node.offset + node.count; ++i)
+                    {
+                        if constexpr (AnyHit)
+                        {
+                            float t = tmax;
+                            if (intersect(_indices[i], r, t)) return true;
+                        }
+                        else if (intersect(_indices[i], r, tmax)) hit = true;
+                    }
+                }
+                else
+                {
+                    // the near child first, so that its hits cull the far one
+                    if (dir_is_neg[node.axis])
+                    {
+                        stack[top++] = current + 1;
+                        current = node.offset;
+                    }
+                    else
+                    {
+                        stack[top++] = node.offset;
+                        current = current + 1;
+                    }
+                    continue;
+                }
+            }
+            if (top == 0) break;
+            current = stack[--top];
+        }
+        return hit;
+    }
+
+    template<typename Fn>
+    bool bvh::closest_hit(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const
+    {
+        return traverse<false>(r, tmax, intersect);
+    }
+
+    template<typename Fn>
+    bool bvh::any_hit(const math::ray<float, 3>& r, float tmax, Fn&& intersect) const
+    {
+        return traverse<true>(r, tmax, intersect);
+    }
+
+}
+
+#endif //GPU_RAYTRACE_BVH_HPP
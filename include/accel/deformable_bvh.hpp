@@ -0,0 +1,111 @@
+#ifndef GPU_RAYTRACE_DEFORMABLE_BVH_HPP
+#define GPU_RAYTRACE_DEFORMABLE_BVH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "accel/bvh.hpp"
+#include "base/thread_pool.hpp"
+#include "math/geometry/bounds.hpp"
+
+namespace accel
+{
+
+    /**
+     * how a deformable_bvh is refitted.
+     */
+    struct bvh_refit_settings
+    {
+        bool rotate = false; // restructure the refitted nodes with tree rotations where they lower the SAH cost
+    };
+
+    /**
+     * bvh over geometry that deforms from frame to frame, updated by refitting rather than rebuilding.
+     * primitives that moved are marked, which flags their leaves and all their ancestors dirty. a refit then visits
+     * only the dirty nodes, so its cost follows the number of primitives that moved rather than the size of the scene.
+     * optionally, each refitted interior node tries the rotations of Kopta et al. 2012, "Fast, Effective BVH Updates
+     * for Animated Scenes", which swap one of its children with a grandchild under the other or two grandchildren
+     * under different children, and keeps the one that shrinks the surface area of the regrouped children most. this recovers much of the SAH quality lost to
+     * large deformations. a rotation moves the nodes of the subtrees it regroups, so it is cheap low in the tree and
+     * rare high in it, where the bounds are large.
+     */
+    class deformable_bvh
+    {
+    private:
+        /**
+         * nodes [begin, end) of the depth first layout, which hold a whole subtree.
+         */
+        struct subtree
+        {
+            std::uint32_t begin;
+            std::uint32_t end;
+        };
+
+        /**
+         * child of a regrouped node: one subtree kept as it is, or two grouped under a new node.
+         */
+        struct side
+        {
+            subtree parts[2];
+            int count;
+        };
+
+        bvh _tree;
+        std::vector<std::uint32_t> _parents; // parent of every node. the root is its own parent
+        std::vector<std::uint32_t> _leaves; // leaf holding each primitive
+        std::vector<std::uint8_t> _heights; // nodes on the longest path down from each node, so rotations respect max_depth
+        std::vector<std::uint8_t> _dirty; // nodes above a moved primitive
+
+        void link(std::uint32_t begin, std::uint32_t end);
+        std::size_t refit(std::uint32_t node, std::uint32_t end, std::uint32_t depth, std::span<const math::bounds3f> primitive_bounds,
+                          const bvh_refit_settings& settings, base::thread_pool& pool);
+        void rotate(std::uint32_t node, std::uint32_t end, std::uint32_t depth);
+        void regroup(std::uint32_t node, const side& first, const side& second);
+    public:
+        deformable_bvh() = default;
+
+        /**
+         * @param tree tree to update, built by any builder
+         */
+        explicit deformable_bvh(bvh tree);
+
+        /**
+         * @return the tree, for traversal or to collapse into a wide bvh
+         */
+        const bvh& tree() const;
+
+        /**
+         * flags a primitive to be refitted by the next refit, along with every node above it. not thread safe.
+         * @param primitive index of a primitive of the tree
+         */
+        void mark_moved(std::uint32_t primitive);
+
+        /**
+         * flags primitives to be refitted by the next refit. not thread safe.
+         * @param primitives indices of primitives of the tree
+         */
+        void mark_moved(std::span<const std::uint32_t> primitives);
+
+        /**
+         * flags every primitive to be refitted by the next refit, e.g. when a whole mesh was skinned.
+         */
+        void mark_all_moved();
+
+        /**
+         * fits the dirty nodes to new bounds of the primitives and clears their flags. the children of large nodes
+         * are refitted in parallel.
+         * @param primitive_bounds bounds of each primitive. only those in dirty leaves are read
+         * @param settings how the tree is refitted
+         * @param pool pool running the refit
+         * @return number of nodes refitted
+         * @throws std::invalid_argument if primitive_bounds does not hold one bounds per primitive of the tree.
+         */
+        std::size_t refit(std::span<const math::bounds3f> primitive_bounds, const bvh_refit_settings& settings = {},
+                          base::thread_pool& pool = base::thread_pool::global());
+    };
+
+}
+
+#endif //GPU_RAYTRACE_DEFORMABLE_BVH_HPP
@@ -0,0 +1,111 @@
+#ifndef GPU_RAYTRACE_LBVH_INL
+#define GPU_RAYTRACE_LBVH_INL
+
+#include "accel/lbvh.hpp"
+
+#if !defined(__CUDA_ARCH__)
+#include <atomic>
+#include <bit>
+#endif
+
+namespace accel
+{
+
+    namespace impl
+    {
+        template<typename Code>
+        CPU_GPU int count_leading_zeros(Code v)
+        {
+#if defined(__CUDA_ARCH__)
+            if constexpr (sizeof(Code) == 8) return __clzll(static_cast<long long>(v));
+            else return __clz(static_cast<int>(v));
+#else
+            return std::countl_zero(v);
+#endif
+        }
+
+        CPU_GPU inline std::uint32_t atomic_increment(std::uint32_t* counter)
+        {
+#if defined(__CUDA_ARCH__)
+            __threadfence(); // publishes the bounds written before to whichever thread reads them after the increment
+            return atomicAdd(counter, 1u);
+#else
+            return std::atomic_ref<std::uint32_t>{ *counter }.fetch_add(1, std::memory_order_acq_rel);
+#endif
+        }
+
+        /**
+         * length of the common prefix of the codes of primitives i and j, or -1 when j is out of range. equal codes
+         * are told apart by the indices of the primitives, as if appended to the codes.
+         */
+        template<typename Code>
+        CPU_GPU int common_prefix(const Code* codes, std::int64_t n, int code_bits, std::int64_t i, std::int64_t j)
+        {
+            if (j < 0 || j >= n) return -1;
+            Code a = codes[i], b = codes[j];
+            if (a == b) return code_bits + count_leading_zeros(static_cast<std::uint32_t>(i ^ j));
+            return count_leading_zeros(static_cast<Code>(a ^ b)) - (8 * static_cast<int>(sizeof(Code)) - code_bits);
+        }
+    }
+
+    template<typename Code>
+    CPU_GPU void lbvh_emit_node(const Code* codes, std::uint32_t n, int code_bits, std::uint32_t i, lbvh_node* nodes, std::uint32_t* parents)
+    {
+        auto delta = [&](std::int64_t j) { return impl::common_prefix(codes, n, code_bits, i, j); };
+        const std::int64_t idx = i;
+
+        // the range of the node extends from i towards the neighbour sharing the longer prefix
+        int d = delta(idx + 1) > delta(idx - 1) ? 1 : -1;
+        int delta_min = delta(idx - d);
+
+        std::int64_t length_max = 2;
+        while (delta(idx + length_max * d) > delta_min) length_max *= 2;
+        std::int64_t length = 0;
+        for (std::int64_t t = length_max / 2; t >= 1; t /= 2)
+        {
+            if (delta(idx + (length + t) * d) > delta_min) length += t;
+        }
+        std::int64_t j = idx + length * d;
+
+        // the split is the last primitive sharing more than the prefix of the whole range with i
+        int delta_node = delta(j);
+        std::int64_t split = 0, t = length;
+        do
+        {
+            t = (t + 1) / 2;
+            if (delta(idx + (split + t) * d) > delta_node) split += t;
+        } while (t > 1);
+        std::int64_t gamma = idx + split * d + (d < 0 ? -1 : 0);
+
+        std::int64_t first = idx < j ? idx : j, last = idx < j ? j : idx;
+        auto leaf_base = static_cast<std::int64_t>(n) - 1;
+        auto left = static_cast<std::uint32_t>(first == gamma ? leaf_base + gamma : gamma);
+        auto right = static_cast<std::uint32_t>(last == gamma + 1 ? leaf_base + gamma + 1 : gamma + 1);
+
+        lbvh_node& node = nodes[i];
+        node.children[0] = left;
+        node.children[1] = right;
+        node.first = static_cast<std::uint32_t>(first);
+        node.last = static_cast<std::uint32_t>(last);
+        // x sits in the lowest bit of each triple of a code
+        node.axis = static_cast<std::uint8_t>(delta_node < code_bits ? (code_bits - 1 - delta_node) % 3 : 0);
+        parents[left] = i;
+        parents[right] = i;
+    }
+
+    CPU_GPU inline void lbvh_refit_from_leaf(std::uint32_t leaf, const lbvh_node* nodes, const std::uint32_t* parents,
+                                             math::bounds3f* bounds, std::uint32_t* visits)
+    {
+        std::uint32_t node = leaf;
+        while (node != 0)
+        {
+            std::uint32_t parent = parents[node];
+            if (impl::atomic_increment(&visits[parent]) == 0) return; // the other child is not done yet
+            bounds[parent] = math::merge(bounds[nodes[parent].children[0]], bounds[nodes[parent].children[1]]);
+            node = parent;
+        }
+    }
+
+}
+
+#endif //GPU_RAYTRACE_LBVH_INL
@@ -0,0 +1,109 @@
+#ifndef GPU_RAYTRACE_TWO_LEVEL_BVH_INL
+#define GPU_RAYTRACE_TWO_LEVEL_BVH_INL
+
+#include "accel/two_level_bvh.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+namespace accel
+{
+
+    template<typename Blas>
+    two_level_bvh<Blas>::two_level_bvh(std::span<const Blas> blases, std::vector<bvh_instance> instances,
+                                       const bvh_build_settings& settings, base::thread_pool& pool)
+        : _blases{ blases }, _instances{ std::move(instances) }, _settings{ settings }
+    {
+        for (const auto& instance : _instances)
+        {
+            if (instance.blas >= _blases.size()) throw std::invalid_argument{ "instance places a bvh out of range" };
+            if (_blases[instance.blas].empty()) throw std::invalid_argument{ "instance places an empty bvh" };
+        }
+        rebuild(pool);
+    }
+
+    template<typename Blas>
+    bool two_level_bvh<Blas>::empty() const
+    {
+        return _top.empty();
+    }
+
+    template<typename Blas>
+    math::bounds3f two_level_bvh<Blas>::get_bounds() const
+    {
+        return _top.get_bounds();
+    }
+
+    template<typename Blas>
+    std::span<const Blas> two_level_bvh<Blas>::blases() const
+    {
+        return _blases;
+    }
+
+    template<typename Blas>
+    std::span<const bvh_instance> two_level_bvh<Blas>::instances() const
+    {
+        return _instances;
+    }
+
+    template<typename Blas>
+    const bvh& two_level_bvh<Blas>::top() const
+    {
+        return _top;
+    }
+
+    template<typename Blas>
+    void two_level_bvh<Blas>::set_transform(std::uint32_t instance, const math::transformf& object_to_world)
+    {
+        _instances[instance].object_to_world = object_to_world;
+    }
+
+    template<typename Blas>
+    void two_level_bvh<Blas>::rebuild(base::thread_pool& pool)
+    {
+        std::vector<math::bounds3f> world_bounds(_instances.size());
+        for (std::size_t i = 0; i < _instances.size(); ++i)
+        {
+            world_bounds[i] = _instances[i].object_to_world(_blases[_instances[i].blas].get_bounds());
+        }
+        _top = bvh{ world_bounds, _settings, pool };
+    }
+
+    template<typename Blas>
+    template<bool AnyHit, typename Fn>
+    bool two_level_bvh<Blas>::traverse(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const
+    {
+        // the leaves of the top level are instances, entered by carrying the ray into their space
+        auto enter = [&](std::uint32_t instance, const math::ray<float, 3>& world_ray, float& t)
+        {
+            const bvh_instance& placed = _instances[instance];
+            math::ray<float, 3> object_ray = placed.object_to_world.inverse()(world_ray);
+            auto leaf = [&](std::uint32_t primitive, const math::ray<float, 3>& ray, float& t_leaf)
+            {
+                return intersect(instance, primitive, ray, t_leaf);
+            };
+            if constexpr (AnyHit) return _blases[placed.blas].any_hit(object_ray, t, leaf);
+            else return _blases[placed.blas].closest_hit(object_ray, t, leaf);
+        };
+
+        if constexpr (AnyHit) return _top.any_hit(r, tmax, enter);
+        else return _top.closest_hit(r, tmax, enter);
+    }
+
+    template<typename Blas>
+    template<typename Fn>
+    bool two_level_bvh<Blas>::closest_hit(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const
+    {
+        return traverse<false>(r, tmax, intersect);
+    }
+
+    template<typename Blas>
+    template<typename Fn>
+    bool two_level_bvh<Blas>::any_hit(const math::ray<float, 3>& r, float tmax, Fn&& intersect) const
+    {
+        return traverse<true>(r, tmax, intersect);
+    }
+
+}
+
+#endif //GPU_RAYTRACE_TWO_LEVEL_BVH_INL
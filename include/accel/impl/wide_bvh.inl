@@ -0,0 +1,232 @@
+#ifndef GPU_RAYTRACE_WIDE_BVH_INL
+#define GPU_RAYTRACE_WIDE_BVH_INL
+
+#include "accel/wide_bvh.hpp"
+
+#include <bit>
+
+namespace accel
+{
+
+    template<std::size_t W>
+    CPU_GPU wide_bvh_node<W>::wide_bvh_node()
+    {
+        for (std::size_t slot = 0; slot < W; ++slot)
+        {
+            set_bounds(slot, math::bounds3f{});
+            child[slot] = 0;
+            count[slot] = 0;
+        }
+    }
+
+    template<std::size_t W>
+    CPU_GPU math::bounds3f wide_bvh_node<W>::get_bounds(std::size_t slot) const
+    {
+        if (!is_used(slot)) return {};
+        return { math::point<float, 3>{ lower[0][slot], lower[1][slot], lower[2][slot] },
+                 math::point<float, 3>{ upper[0][slot], upper[1][slot], upper[2][slot] } };
+    }
+
+    template<std::size_t W>
+    CPU_GPU void wide_bvh_node<W>::set_bounds(std::size_t slot, const math::bounds3f& b)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            lower[i][slot] = b.get_min()[i];
+            upper[i][slot] = b.get_max()[i];
+        }
+    }
+
+    template<std::size_t W>
+    wide_bvh<W>::wide_bvh(const bvh& binary) : _indices(binary.primitive_indices().begin(), binary.primitive_indices().end()),
+                                                _bounds{ binary.get_bounds() }
+    {
+        if (binary.empty()) return;
+        _nodes.reserve(binary.nodes().size() / (W - 1) + 1);
+        collapse(binary, 0);
+    }
+
+    template<std::size_t W>
+    std::uint32_t wide_bvh<W>::collapse(const bvh& binary, std::uint32_t node)
+    {
+        auto nodes = binary.nodes();
+
+        // open the interior child of largest surface area until there are W children
+        std::uint32_t slots[W];
+        std::size_t used = 0;
+        if (nodes[node].is_leaf())
+        {
+            slots[used++] = node;
+        }
+        else
+        {
+            slots[used++] = node + 1;
+            slots[used++] = nodes[node].offset;
+        }
+        while (used < W)
+        {
+            int widest = -1;
+            float widest_area = -1;
+            for (std::size_t s = 0; s < used; ++s)
+            {
+                if (nodes[slots[s]].is_leaf()) continue;
+                float area = nodes[slots[s]].get_bounds().surface_area();
+                if (area > widest_area)
+                {
+                    widest = static_cast<int>(s);
+                    widest_area = area;
+                }
+            }
+            if (widest < 0) break;
+
+            std::uint32_t opened = slots[widest];
+            slots[widest] = opened + 1;
+            slots[used++] = nodes[opened].offset;
+        }
+
+        auto index = static_cast<std::uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+        for (std::size_t s = 0; s < used; ++s)
+        {
+            const bvh_node& child = nodes[slots[s]];
+            _nodes[index].set_bounds(s, child.get_bounds());
+            if (child.is_leaf())
+            {
+                _nodes[index].child[s] = child.offset;
+                _nodes[index].count[s] = child.count;
+            }
+            else
+            {
+                // collapsing may grow _nodes, so the node is indexed again rather than held by reference
+                std::uint32_t collapsed = collapse(binary, slots[s]);
+                _nodes[index].child[s] = collapsed;
+            }
+        }
+        return index;
+    }
+
+    template<std::size_t W>
+    bool wide_bvh<W>::empty() const
+    {
+        return _nodes.empty();
+    }
+
+    template<std::size_t W>
+    math::bounds3f wide_bvh<W>::get_bounds() const
+    {
+        return _bounds;
+    }
+
+    template<std::size_t W>
+    std::span<const typename wide_bvh<W>::node_type> wide_bvh<W>::nodes() const
+    {
+        return _nodes;
+    }
+
+    template<std::size_t W>
+    std::span<const std::uint32_t> wide_bvh<W>::primitive_indices() const
+    {
+        return _indices;
+    }
+
+    template<std::size_t W>
+    template<bool AnyHit, typename Fn>
+    bool wide_bvh<W>::traverse(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const
+    {
+        if (_nodes.empty()) return false;
+
+        lane_type origin[3], inv_direction[3];
+        int dir_is_neg[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            float inv = 1 / r.get_direction()[i];
+            origin[i] = r.get_origin()[i];
+            inv_direction[i] = inv;
+            dir_is_neg[i] = inv < 0;
+        }
+
+        struct entry
+        {
+            std::uint32_t child;
+            std::uint32_t count;
+            float t;
+        };
+        entry stack[stack_size];
+        std::size_t top = 0;
+        stack[top++] = { 0, 0, 0 };
+
+        bool hit = false;
+        while (top > 0)
+        {
+            entry e = stack[--top];
+            if (e.t > tmax) continue; // a closer hit was found since the entry was pushed
+
+            if (e.count > 0)
+            {
+                for (std::uint32_t i = e.child; i < e.child + e.count; ++i)
+                {
+                    if constexpr (AnyHit)
+                    {
+                        float t = tmax;
+                        if (intersect(_indices[i], r, t)) return true;
+                    }
+                    else
+                    {
+                        if (intersect(_indices[i], r, tmax)) hit = true;
+                    }
+                }
+                continue;
+            }
+
+            // slab test against every child at once. the NaN from 0 * infinity loses to the second argument of min
+            // and max, leaving the interval as it was
+            const node_type& node = _nodes[e.child];
+            lane_type t_near = 0, t_far = tmax;
+            for (int i = 0; i < 3; ++i)
+            {
+                lane_type lo = lane_type::load_aligned(node.lower[i]);
+                lane_type hi = lane_type::load_aligned(node.upper[i]);
+                lane_type near_bound = dir_is_neg[i] ? hi : lo;
+                lane_type far_bound = dir_is_neg[i] ? lo : hi;
+                t_near = max((near_bound - origin[i]) * inv_direction[i], t_near);
+                t_far = min((far_bound - origin[i]) * inv_direction[i] * math::slab_far_scale<float>, t_far);
+            }
+            std::uint32_t hits = (t_near <= t_far).bits();
+
+            // push the children far to near so that the nearest is popped first
+            std::size_t first = top;
+            while (hits)
+            {
+                int slot = std::countr_zero(hits);
+                hits &= hits - 1;
+
+                entry child{ node.child[slot], node.count[slot], t_near[slot] };
+                std::size_t pos = top++;
+                while (pos > first && stack[pos - 1].t < child.t)
+                {
+                    stack[pos] = stack[pos - 1];
+                    --pos;
+                }
+                stack[pos] = child;
+            }
+        }
+        return hit;
+    }
+
+    template<std::size_t W>
+    template<typename Fn>
+    bool wide_bvh<W>::closest_hit(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const
+    {
+        return traverse<false>(r, tmax, intersect);
+    }
+
+    template<std::size_t W>
+    template<typename Fn>
+    bool wide_bvh<W>::any_hit(const math::ray<float, 3>& r, float tmax, Fn&& intersect) const
+    {
+        return traverse<true>(r, tmax, intersect);
+    }
+
+}
+
+#endif //GPU_RAYTRACE_WIDE_BVH_INL
@@ -0,0 +1,81 @@
+#ifndef GPU_RAYTRACE_LBVH_HPP
+#define GPU_RAYTRACE_LBVH_HPP
+
+#include <cstdint>
+#include <span>
+
+#include "accel/bvh.hpp"
+#include "base/thread_pool.hpp"
+#include "gpu/gpu.hpp"
+#include "math/geometry/bounds.hpp"
+
+namespace accel
+{
+
+    /**
+     * how a linear bvh is built.
+     */
+    struct lbvh_build_settings
+    {
+        bool use_63_bit_codes = false; // 21 bits per axis instead of 10, for scenes whose detail 1024 cells cannot resolve
+        std::uint32_t max_leaf_size = 1; // subtrees with at most this many primitives become leaves
+    };
+
+    /**
+     * node of the hierarchy emitted from sorted Morton codes (Karras 2012, "Maximizing Parallelism in the Construction
+     * of BVHs, Octrees, and k-d Trees"). with n primitives, nodes 0 to n - 2 are interior and node n - 1 + i is the
+     * leaf of the i-th primitive in Morton order. the root is node 0.
+     */
+    struct lbvh_node
+    {
+        std::uint32_t children[2]; // the first covers the lower codes
+        std::uint32_t first; // first primitive of the range in Morton order
+        std::uint32_t last; // last primitive of the range, inclusive
+        std::uint8_t axis; // axis of the highest bit in which the codes of the two children differ
+    };
+
+    /**
+     * emits interior node i, independently of every other node, so that all n - 1 of them can run at once.
+     * @tparam Code std::uint32_t or std::uint64_t
+     * @param codes Morton codes of the primitives, sorted
+     * @param n number of primitives, at least 2
+     * @param code_bits number of low bits of the codes that may be set
+     * @param i interior node to emit
+     * @param nodes receives the node at nodes[i]
+     * @param parents receives the parent of both children of the node
+     */
+    template<typename Code>
+    CPU_GPU void lbvh_emit_node(const Code* codes, std::uint32_t n, int code_bits, std::uint32_t i, lbvh_node* nodes, std::uint32_t* parents);
+
+    /**
+     * fits the bounds of the ancestors of a leaf. every leaf runs at once: each climbs until it reaches a node whose
+     * other child is not done, so the last of the two to arrive carries on and every node is fitted exactly once.
+     * @param leaf leaf to start from, in [n - 1, 2n - 1) for n primitives
+     * @param nodes interior nodes
+     * @param parents parent of every node but the root
+     * @param bounds bounds of every node. those of the leaves must be set, those of the interior nodes are written
+     * @param visits one counter per interior node, zero before the first leaf runs
+     */
+    CPU_GPU void lbvh_refit_from_leaf(std::uint32_t leaf, const lbvh_node* nodes, const std::uint32_t* parents,
+                                      math::bounds3f* bounds, std::uint32_t* visits);
+
+    /**
+     * builds a bvh by sorting the primitives along a Morton curve through the bounds of their centroids and splitting
+     * every range at the highest bit in which its codes differ. much faster to build than the SAH bvh, for scenes
+     * rebuilt every frame, at the cost of some traversal speed.
+     * the codes, sort, emission and refit all run on the pool. the emission and refit are the CPU_GPU kernels above.
+     * @param primitive_bounds bounds of each primitive
+     * @param settings how the tree is built
+     * @param pool pool running the build
+     * @return the tree in the flattened layout of bvh, so that it is traversed and collapsed like any other
+     * @throws std::invalid_argument if there are 2^31 primitives or more, if a bounds is empty or if max_leaf_size does
+     * not fit a bvh_node.
+     */
+    bvh build_lbvh(std::span<const math::bounds3f> primitive_bounds, const lbvh_build_settings& settings = {},
+                   base::thread_pool& pool = base::thread_pool::global());
+
+}
+
+#include "impl/lbvh.inl"
+
+#endif //GPU_RAYTRACE_LBVH_HPP
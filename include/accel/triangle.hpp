@@ -0,0 +1,62 @@
+#ifndef GPU_RAYTRACE_TRIANGLE_HPP
+#define GPU_RAYTRACE_TRIANGLE_HPP
+
+#include "gpu/gpu.hpp"
+#include "math/geometry/bounds.hpp"
+#include "math/geometry/point.hpp"
+#include "math/geometry/ray.hpp"
+#include "math/geometry/vec.hpp"
+
+namespace accel
+{
+
+    /**
+     * triangle given by its three vertices, the primitive the bvh tests and benchmarks trace against.
+     */
+    struct triangle
+    {
+        math::point<float, 3> p0, p1, p2;
+
+        CPU_GPU math::bounds3f get_bounds() const
+        {
+            return math::merge(math::bounds3f{ p0, p1 }, p2);
+        }
+
+        /**
+         * Moller-Trumbore ray-triangle test.
+         * @param r ray
+         * @param tmax end of the interval searched along the ray, which starts at 0. lowered to the distance of the
+         * hit if there is one
+         * @param b1 if not null, receives the barycentric coordinate of the hit for p1
+         * @param b2 if not null, receives the barycentric coordinate of the hit for p2
+         * @return whether the ray hits the triangle in (0, tmax)
+         */
+        CPU_GPU bool intersect(const math::ray<float, 3>& r, float& tmax, float* b1 = nullptr, float* b2 = nullptr) const
+        {
+            math::vector<float, 3> e1 = p1 - p0, e2 = p2 - p0;
+            math::vector<float, 3> pvec = math::cross(r.get_direction(), e2);
+            float det = math::dot(e1, pvec);
+            if (det == 0) return false;
+
+            float inv_det = 1 / det;
+            math::vector<float, 3> tvec = r.get_origin() - p0;
+            float u = math::dot(tvec, pvec) * inv_det;
+            if (u < 0 || u > 1) return false;
+
+            math::vector<float, 3> qvec = math::cross(tvec, e1);
+            float v = math::dot(r.get_direction(), qvec) * inv_det;
+            if (v < 0 || u + v > 1) return false;
+
+            float t = math::dot(e2, qvec) * inv_det;
+            if (!(t > 0 && t < tmax)) return false;
+
+            tmax = t;
+            if (b1) *b1 = u;
+            if (b2) *b2 = v;
+            return true;
+        }
+    };
+
+}
+
+#endif //GPU_RAYTRACE_TRIANGLE_HPP
@@ -0,0 +1,112 @@
+#ifndef GPU_RAYTRACE_TWO_LEVEL_BVH_HPP
+#define GPU_RAYTRACE_TWO_LEVEL_BVH_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "accel/bvh.hpp"
+#include "base/thread_pool.hpp"
+#include "math/geometry/bounds.hpp"
+#include "math/geometry/ray.hpp"
+#include "math/geometry/transform.hpp"
+
+namespace accel
+{
+
+    /**
+     * placement of a bottom-level structure in the scene.
+     */
+    struct bvh_instance
+    {
+        std::uint32_t blas; // index of the bottom-level structure placed
+        math::transformf object_to_world; // maps the space of the structure into the scene
+    };
+
+    /**
+     * two-level acceleration structure: a top-level bvh (TLAS) over instances, each placing one of a set of
+     * bottom-level structures (BLAS) with an affine transform. any number of instances share a BLAS, which is stored
+     * once, and moving an instance only rebuilds the top level, whose primitives are the instances.
+     * traversal transforms the ray into the space of each instance it reaches. the direction is not renormalized, so
+     * distances along the ray and tmax carry over between the spaces unchanged. normals found in object space are
+     * brought to the scene by object_to_world, which transforms them correctly under any affine map.
+     * @tparam Blas type of the bottom-level structures: bvh, bvh4 or bvh8
+     */
+    template<typename Blas = bvh>
+    class two_level_bvh
+    {
+    private:
+        std::span<const Blas> _blases;
+        std::vector<bvh_instance> _instances;
+        bvh_build_settings _settings;
+        bvh _top;
+
+        template<bool AnyHit, typename Fn>
+        bool traverse(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const;
+    public:
+        two_level_bvh() = default;
+
+        /**
+         * @param blases bottom-level structures, which are not copied and must outlive the tree
+         * @param instances placements of the structures
+         * @param settings how the top level is built
+         * @param pool pool running the build
+         * @throws std::invalid_argument if an instance places a structure out of range or an empty one.
+         */
+        two_level_bvh(std::span<const Blas> blases, std::vector<bvh_instance> instances, const bvh_build_settings& settings = {},
+                      base::thread_pool& pool = base::thread_pool::global());
+
+        bool empty() const;
+        math::bounds3f get_bounds() const;
+
+        std::span<const Blas> blases() const;
+        std::span<const bvh_instance> instances() const;
+
+        /**
+         * @return the bvh over the instances, whose primitive indices are instance indices
+         */
+        const bvh& top() const;
+
+        /**
+         * moves an instance. the move only shows in traversal after the next rebuild, so that many instances can move
+         * for the cost of one.
+         * @param instance index of the instance
+         * @param object_to_world new placement
+         */
+        void set_transform(std::uint32_t instance, const math::transformf& object_to_world);
+
+        /**
+         * rebuilds the top level over the current placements of the instances. the BLASes are untouched.
+         * @param pool pool running the build
+         */
+        void rebuild(base::thread_pool& pool = base::thread_pool::global());
+
+        /**
+         * finds the closest primitive hit by a ray.
+         * intersect(instance, primitive, object_ray, tmax) tests a primitive of the BLAS of an instance against the
+         * ray in the space of that BLAS and, on a hit closer than tmax, lowers tmax to it and returns true.
+         * @param r ray in the space of the scene
+         * @param tmax end of the interval searched along the ray. receives the distance of the closest hit
+         * @param intersect callable taking (std::uint32_t, std::uint32_t, const math::ray<float, 3>&, float&) and
+         * returning bool
+         * @return whether a primitive was hit
+         */
+        template<typename Fn>
+        bool closest_hit(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const;
+
+        /**
+         * finds whether a ray hits any primitive, stopping at the first hit.
+         * @param r ray in the space of the scene
+         * @param tmax end of the interval searched along the ray
+         * @param intersect callable with the signature of the one of closest_hit
+         * @return whether a primitive was hit
+         */
+        template<typename Fn>
+        bool any_hit(const math::ray<float, 3>& r, float tmax, Fn&& intersect) const;
+    };
+
+}
+
+#include "impl/two_level_bvh.inl"
+
+#endif //GPU_RAYTRACE_TWO_LEVEL_BVH_HPP
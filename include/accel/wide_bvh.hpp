@@ -0,0 +1,115 @@
+#ifndef GPU_RAYTRACE_WIDE_BVH_HPP
+#define GPU_RAYTRACE_WIDE_BVH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "accel/bvh.hpp"
+#include "math/geometry/bounds.hpp"
+#include "math/geometry/ray.hpp"
+#include "math/simd/lane.hpp"
+
+namespace accel
+{
+
+    /**
+     * node of a wide bvh holding the bounds of up to W children as one array per component (structure of arrays), so
+     * that a ray is tested against all of them with one lane of each bound.
+     * a child is either an interior node, given by its index, or a leaf, given by its range in the primitive index
+     * array. the slots past the last child hold empty bounds, which no ray hits.
+     * @tparam W number of children
+     */
+    template<std::size_t W>
+    struct alignas(64) wide_bvh_node
+    {
+        float lower[3][W]; // minimum corners of the children, one array per axis
+        float upper[3][W]; // maximum corners of the children, one array per axis
+        std::uint32_t child[W]; // index of an interior child, first primitive of a leaf child
+        std::uint32_t count[W]; // number of primitives of a leaf child. zero for interior children and empty slots
+
+        CPU_GPU wide_bvh_node();
+
+        CPU_GPU bool is_leaf(std::size_t slot) const { return count[slot] > 0; }
+
+        /**
+         * @return whether the slot holds a child
+         */
+        CPU_GPU bool is_used(std::size_t slot) const { return lower[0][slot] <= upper[0][slot]; }
+
+        CPU_GPU math::bounds3f get_bounds(std::size_t slot) const;
+        CPU_GPU void set_bounds(std::size_t slot, const math::bounds3f& b);
+    };
+
+    /**
+     * bounding volume hierarchy with up to W children per node, collapsed from a binary bvh.
+     * each interior node of the binary tree absorbs the largest of its descendants until it has W children, which
+     * divides the depth by about log2(W) and lets traversal test all children of a node at once with lanes of W floats.
+     * children are visited in order of distance along the ray. the lanes use SSE for W = 4 and AVX for W = 8 when the
+     * target supports them and otherwise fall back to the portable, scalar lanes, with the same results.
+     * @tparam W number of children per node, 4 or 8
+     */
+    template<std::size_t W>
+    class wide_bvh
+    {
+        static_assert(W == 4 || W == 8, "wide bvhs have 4 or 8 children per node");
+    public:
+        using node_type = wide_bvh_node<W>;
+        using lane_type = math::lane<float, W>;
+
+        /**
+         * most entries the traversal stack can hold: each visit pops one entry and pushes at most W.
+         */
+        static constexpr std::size_t stack_size = bvh::max_depth * (W - 1) + 1;
+    private:
+        std::vector<node_type> _nodes;
+        std::vector<std::uint32_t> _indices;
+        math::bounds3f _bounds;
+
+        std::uint32_t collapse(const bvh& binary, std::uint32_t node);
+
+        template<bool AnyHit, typename Fn>
+        bool traverse(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const;
+    public:
+        wide_bvh() = default;
+
+        /**
+         * @param binary tree to collapse. its primitive order is reused, so the leaves hold the same primitives
+         */
+        explicit wide_bvh(const bvh& binary);
+
+        bool empty() const;
+        math::bounds3f get_bounds() const;
+        std::span<const node_type> nodes() const;
+        std::span<const std::uint32_t> primitive_indices() const;
+
+        /**
+         * finds the closest primitive hit by a ray. see bvh::closest_hit.
+         * @param r ray, or a tracked_ray
+         * @param tmax end of the interval searched along the ray. receives the distance of the closest hit
+         * @param intersect callable taking (std::uint32_t, const math::ray<float, 3>&, float&) and returning bool
+         * @return whether a primitive was hit
+         */
+        template<typename Fn>
+        bool closest_hit(const math::ray<float, 3>& r, float& tmax, Fn&& intersect) const;
+
+        /**
+         * finds whether a ray hits any primitive, stopping at the first hit. see bvh::any_hit.
+         * @param r ray, or a tracked_ray
+         * @param tmax end of the interval searched along the ray
+         * @param intersect callable with the signature of the one of closest_hit
+         * @return whether a primitive was hit
+         */
+        template<typename Fn>
+        bool any_hit(const math::ray<float, 3>& r, float tmax, Fn&& intersect) const;
+    };
+
+    using bvh4 = wide_bvh<4>;
+    using bvh8 = wide_bvh<8>;
+
+}
+
+#include "impl/wide_bvh.inl"
+
+#endif //GPU_RAYTRACE_WIDE_BVH_HPP
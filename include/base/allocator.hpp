@@ -0,0 +1,105 @@
+#ifndef GPU_RAYTRACE_ALLOCATOR_HPP
+#define GPU_RAYTRACE_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace base
+{
+
+    class pixel;
+
+    /**
+     * source of the pixel buffers owned by images. buffers are returned uninitialized and aligned to at least 64
+     * bytes, so that rows start on a cache line and aligned vector loads can be used on them.
+     */
+    class pixel_allocator
+    {
+    public:
+        static constexpr std::size_t alignment = 64;
+
+        virtual ~pixel_allocator() = default;
+
+        /**
+         * @param count number of pixels
+         * @return uninitialized buffer of count pixels.
+         * @throws std::bad_alloc if the memory cannot be allocated.
+         */
+        virtual pixel* allocate(std::size_t count) = 0;
+
+        /**
+         * @param buffer buffer returned by allocate
+         * @param count number of pixels it was allocated with
+         */
+        virtual void deallocate(pixel* buffer, std::size_t count) = 0;
+
+        /**
+         * shared heap allocator used by images unless told otherwise.
+         */
+        static pixel_allocator& heap();
+    };
+
+    /**
+     * allocates every buffer from the heap.
+     */
+    class heap_allocator : public pixel_allocator
+    {
+    private:
+        bool _huge_pages;
+    public:
+        /**
+         * @param huge_pages aligns buffers to 2 MiB and asks the kernel to back them with transparent huge pages,
+         * which saves TLB misses and page faults on large frames. small buffers waste most of a huge page.
+         */
+        explicit heap_allocator(bool huge_pages = false);
+
+        pixel* allocate(std::size_t count) override;
+        void deallocate(pixel* buffer, std::size_t count) override;
+    };
+
+    /**
+     * keeps released buffers around and hands them out again for images of the same size, so a render loop that
+     * creates and drops frames of a fixed size stops allocating after its first few frames.
+     * thread-safe. must outlive every image allocated from it.
+     */
+    class frame_pool : public pixel_allocator
+    {
+    private:
+        struct buffer
+        {
+            pixel* data;
+            std::size_t count;
+        };
+
+        pixel_allocator& _upstream;
+        std::size_t _max_cached;
+        std::vector<buffer> _cache;
+        std::mutex _mtx;
+    public:
+        /**
+         * @param upstream allocator serving requests the pool cannot serve from its cache
+         * @param max_cached number of released buffers kept. further buffers go back to the upstream allocator.
+         */
+        explicit frame_pool(pixel_allocator& upstream = pixel_allocator::heap(), std::size_t max_cached = 8);
+
+        frame_pool(const frame_pool&) = delete;
+        frame_pool& operator=(const frame_pool&) = delete;
+
+        /**
+         * returns the cached buffers to the upstream allocator.
+         */
+        ~frame_pool() override;
+
+        pixel* allocate(std::size_t count) override;
+        void deallocate(pixel* buffer, std::size_t count) override;
+
+        /**
+         * @return number of released buffers waiting to be reused.
+         */
+        std::size_t cached();
+    };
+
+}
+
+#endif //GPU_RAYTRACE_ALLOCATOR_HPP
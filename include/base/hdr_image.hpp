@@ -0,0 +1,105 @@
+#ifndef GPU_RAYTRACE_HDR_IMAGE_HPP
+#define GPU_RAYTRACE_HDR_IMAGE_HPP
+
+#include <cstdint>
+#include <memory>
+
+#include "base/image.hpp"
+#include "base/thread_pool.hpp"
+
+namespace base
+{
+
+    /**
+     * curve compressing linear radiance into [0, 1] before it is encoded.
+     */
+    enum class tone_map
+    {
+        clamp, // values above one are clipped
+        reinhard, // x / (1 + x)
+        aces // Narkowicz's fit of the ACES filmic curve
+    };
+
+    /**
+     * how an hdr_image is turned into displayable 8-bit pixels.
+     */
+    struct resolve_settings
+    {
+        float exposure = 0; // in stops. every stop doubles the radiance
+        tone_map curve = tone_map::aces;
+        bool srgb = true; // encodes with the sRGB transfer function. otherwise values are written linearly
+        bool dither = true; // adds up to half a step of noise before quantizing, which hides banding in gradients
+        uint32_t seed = 0; // varies the dither pattern, e.g. with the frame number
+    };
+
+    /**
+     * floating-point buffer accumulating radiance samples over many passes of a progressive renderer.
+     * each channel is stored in its own plane (structure of arrays) next to a plane of per-pixel sample counts, so
+     * that passes over the buffer run over contiguous floats. pixels are resolved to their average on demand.
+     */
+    class hdr_image
+    {
+    private:
+        int _width;
+        int _height;
+        // each plane is released by its own owner, so that a failed allocation of a later one frees the earlier
+        std::unique_ptr<float[]> _red;
+        std::unique_ptr<float[]> _green;
+        std::unique_ptr<float[]> _blue;
+        std::unique_ptr<uint32_t[]> _samples;
+
+        struct coordinate
+        {
+            int x;
+            int y;
+        };
+    public:
+        /**
+         * creates an empty buffer, with no samples in any pixel.
+         */
+        hdr_image(int width, int height);
+
+        hdr_image(const hdr_image& img);
+        hdr_image(hdr_image&& img);
+        hdr_image& operator=(const hdr_image& img);
+        hdr_image& operator=(hdr_image&& img);
+        ~hdr_image();
+
+        int width() const;
+        int height() const;
+
+        /**
+         * planes of summed radiance, row by row with no padding.
+         */
+        float* red() const;
+        float* green() const;
+        float* blue() const;
+
+        /**
+         * plane of the number of samples summed into each pixel.
+         */
+        uint32_t* samples() const;
+
+        /**
+         * adds a sample of linear radiance to a pixel.
+         */
+        void add_sample(coordinate coord, float r, float g, float b);
+
+        /**
+         * removes every sample, e.g. when the camera moves.
+         */
+        void clear();
+
+        /**
+         * averages, exposes, tone maps and encodes every pixel, converting rows in parallel.
+         * pixels without samples come out black.
+         * @param dst image receiving the pixels. may be a strided view, e.g. a frame lent by a video_builder.
+         * @param settings how the pixels are encoded
+         * @param pool threads converting the rows
+         */
+        void resolve(image& dst, const resolve_settings& settings = {}, thread_pool& pool = thread_pool::global()) const;
+    };
+
+}
+
+#endif //GPU_RAYTRACE_HDR_IMAGE_HPP
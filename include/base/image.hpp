@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <cstddef>
 
+#include "base/allocator.hpp"
+
 namespace base
 {
     class alignas(4) pixel
@@ -31,12 +33,21 @@ namespace base
                   offsetof(pixel, blue) == 2,
                   "pixel layout is not correct for compatibility with AV_PIX_FMT_RGB0");
 
+    /**
+     * two-dimensional buffer of pixels stored row by row.
+     * rows are `stride` pixels apart, which allows an image to view memory owned by someone else (e.g. a frame of
+     * a video encoder) whose rows are padded for alignment. images created from dimensions own a packed buffer,
+     * which comes from a pixel_allocator so that render loops can recycle frames instead of allocating them.
+     */
     class image
     {
     private:
         int _width;
         int _height;
+        int _stride;
         pixel *_buf;
+        bool _owner;
+        pixel_allocator *_allocator; // allocator of the owned buffer. null for views
 
         struct coordinate
         {
@@ -44,7 +55,28 @@ namespace base
             int y;
         };
     public:
-        image(int width, int height);
+        /**
+         * creates an image owning a packed buffer.
+         * @param width width in pixels
+         * @param height height in pixels
+         * @param allocator source of the buffer. must outlive the image and every copy of it.
+         * @param clear whether to set every pixel to black. images about to be overwritten entirely can skip it.
+         */
+        image(int width, int height, pixel_allocator& allocator = pixel_allocator::heap(), bool clear = true);
+
+        /**
+         * creates a non-owning view over an existing buffer. the buffer must outlive the view.
+         * @param buffer first pixel of the first row
+         * @param width width in pixels
+         * @param height height in pixels
+         * @param stride distance between the starts of two consecutive rows in pixels
+         */
+        image(pixel* buffer, int width, int height, int stride);
+
+        /**
+         * copies the pixels of another image into a packed buffer from the same allocator (the heap for views).
+         * assigning an image of the same dimensions reuses the buffer already owned.
+         */
         image(const image& img);
         image(image&& img);
         image& operator=(const image& img);
@@ -53,6 +85,9 @@ namespace base
 
         int width() const;
         int height() const;
+        int stride() const;
+        bool owns_buffer() const;
+        pixel_allocator* allocator() const;
         pixel* get_buffer() const;
 
         pixel& operator[](coordinate coord);
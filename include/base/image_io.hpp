@@ -0,0 +1,149 @@
+#ifndef GPU_RAYTRACE_IMAGE_IO_HPP
+#define GPU_RAYTRACE_IMAGE_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "base/hdr_image.hpp"
+#include "base/image.hpp"
+
+namespace base
+{
+
+    /**
+     * layout of the pixels in a raw image file.
+     */
+    enum class raw_pixel_format : uint32_t
+    {
+        rgb0 = 1 // base::pixel, i.e. AV_PIX_FMT_RGB0
+    };
+
+    /**
+     * header at the start of a raw image file, followed by the pixels at data_offset. every field is stored little
+     * endian, whatever the byte order of the host.
+     * the pixels are stored exactly as in memory, rows stride pixels apart, so a file can be mapped and viewed as an
+     * image without being parsed or copied.
+     */
+    struct raw_image_header
+    {
+        static constexpr char signature[8] = { 'R', 'T', 'I', 'M', 'A', 'G', 'E', '\0' };
+        static constexpr uint32_t current_version = 1;
+
+        char magic[8];
+        uint32_t version;
+        raw_pixel_format format;
+        int32_t width;
+        int32_t height;
+        int32_t stride; // in pixels
+        uint32_t reserved;
+        uint64_t data_offset; // in bytes from the start of the file. a multiple of 64
+        uint8_t padding[24];
+    };
+
+    static_assert(sizeof(raw_image_header) == 64, "raw_image_header must stay 64 bytes so that pixels start cache aligned");
+
+    /**
+     * image file mapped writable into memory. the pixels are viewed in place, so opening costs a page fault per page
+     * touched rather than a read of the whole file. writes through the view land in the file.
+     */
+    class mapped_image
+    {
+    private:
+        friend class read_only_mapped_image;
+
+        void *_map;
+        std::size_t _size;
+        image _view;
+
+        mapped_image(void* map, std::size_t size, image view);
+
+        /**
+         * maps an existing raw image file, checking that its header describes pixels inside the file.
+         */
+        static mapped_image map_file(const std::string& path, bool writable);
+    public:
+        /**
+         * maps an existing raw image file writable. files which must not be modified are opened through
+         * read_only_mapped_image instead.
+         * @param path file written by save_raw or mapped_image::create
+         * @throws std::system_error if the file cannot be opened or mapped.
+         * @throws std::runtime_error if the file is not a raw image file.
+         */
+        static mapped_image open(const std::string& path);
+
+        /**
+         * creates (or truncates) a raw image file of black pixels and maps it writable, e.g. to checkpoint a render
+         * in progress by rendering straight into the file.
+         * @throws std::system_error if the file cannot be created or mapped.
+         */
+        static mapped_image create(const std::string& path, int width, int height);
+
+        mapped_image(const mapped_image&) = delete;
+        mapped_image(mapped_image&& img);
+        mapped_image& operator=(const mapped_image&) = delete;
+        mapped_image& operator=(mapped_image&& img);
+
+        /**
+         * unmaps the file. modified pixels are written back by the kernel.
+         */
+        ~mapped_image();
+
+        /**
+         * @return view over the mapped pixels. valid while the mapping lives.
+         */
+        image& get();
+        const image& get() const;
+
+        /**
+         * blocks until modified pixels have been written to the file.
+         */
+        void sync();
+    };
+
+    /**
+     * image file mapped read-only into memory. the pixels can only be viewed as a const image, since a write to the
+     * mapping would crash rather than fail to compile.
+     */
+    class read_only_mapped_image
+    {
+    private:
+        mapped_image _mapped;
+
+        explicit read_only_mapped_image(mapped_image&& mapped);
+    public:
+        /**
+         * maps an existing raw image file.
+         * @param path file written by save_raw or mapped_image::create
+         * @throws std::system_error if the file cannot be opened or mapped.
+         * @throws std::runtime_error if the file is not a raw image file.
+         */
+        static read_only_mapped_image open(const std::string& path);
+
+        /**
+         * @return view over the mapped pixels. valid while the mapping lives.
+         */
+        const image& get() const;
+    };
+
+    /**
+     * writes an image as a raw image file, keeping its stride.
+     * @throws std::system_error if the file cannot be written.
+     */
+    void save_raw(const image& img, const std::string& path);
+
+    /**
+     * writes an image as a binary PPM (P6), e.g. to look at a frame while debugging.
+     * @throws std::system_error if the file cannot be written.
+     */
+    void save_ppm(const image& img, const std::string& path);
+
+    /**
+     * writes the average radiance of every pixel as a PFM in the byte order of the host, keeping the full dynamic range.
+     * @throws std::system_error if the file cannot be written.
+     */
+    void save_pfm(const hdr_image& img, const std::string& path);
+
+}
+
+#endif //GPU_RAYTRACE_IMAGE_IO_HPP
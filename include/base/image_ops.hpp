@@ -0,0 +1,101 @@
+#ifndef GPU_RAYTRACE_IMAGE_OPS_HPP
+#define GPU_RAYTRACE_IMAGE_OPS_HPP
+
+#include <cstddef>
+
+#include "base/image.hpp"
+#include "base/thread_pool.hpp"
+
+/**
+ * bulk operations over whole images. every operation splits the image into bands of rows run on a thread pool, and
+ * the arithmetic kernels use AVX2 or SSE2 when the compiler targets them, with a scalar fallback otherwise.
+ * images may be strided views; padding between rows is never touched.
+ */
+namespace base
+{
+
+    /**
+     * rectangle of pixels, in pixels.
+     */
+    struct rect
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+    };
+
+    /**
+     * @return number of rows per chunk so that a chunk covers enough pixels to be worth scheduling.
+     */
+    std::size_t row_grain(int width);
+
+    /**
+     * sets every pixel to the same value.
+     */
+    void fill(image& dst, pixel pix, thread_pool& pool = thread_pool::global());
+
+    /**
+     * copies a rectangle of one image into another. the rectangle must lie within both images.
+     * @param src image to copy from
+     * @param area rectangle of src to copy
+     * @param dst image to copy into. must not overlap src.
+     * @param dst_x column of dst receiving the left edge of the rectangle
+     * @param dst_y row of dst receiving the top edge of the rectangle
+     */
+    void blit(const image& src, rect area, image& dst, int dst_x, int dst_y, thread_pool& pool = thread_pool::global());
+
+    /**
+     * blends src over dst with a constant opacity: dst = (src * alpha + dst * (255 - alpha)) / 255, rounded.
+     * both images must have the same dimensions.
+     */
+    void alpha_blend(const image& src, image& dst, uint8_t alpha, thread_pool& pool = thread_pool::global());
+
+    /**
+     * raises every channel, as a value in [0, 1], to the power of gamma.
+     * @throws std::invalid_argument if gamma is not positive or is NaN.
+     */
+    void apply_gamma(image& img, float gamma, thread_pool& pool = thread_pool::global());
+
+    /**
+     * halves the dimensions of an image by averaging 2x2 blocks of pixels.
+     * @param src image to downsample. an odd last row or column is dropped.
+     * @param dst image of dimensions (src.width() / 2, src.height() / 2)
+     */
+    void downsample(const image& src, image& dst, thread_pool& pool = thread_pool::global());
+
+    /**
+     * replaces every pixel by fn(pixel).
+     * @param fn callable taking and returning a pixel. called concurrently.
+     */
+    template<typename F>
+    void map(image& img, F&& fn, thread_pool& pool = thread_pool::global())
+    {
+        pool.parallel_for(0, img.height(), row_grain(img.width()), [&](std::size_t begin, std::size_t end) {
+            for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
+            {
+                pixel* row = &img[{ 0, y }];
+                for (int x = 0; x < img.width(); ++x) row[x] = fn(row[x]);
+            }
+        });
+    }
+
+    /**
+     * sets every pixel to fn(x, y).
+     * @param fn callable taking the column and row of a pixel and returning its value. called concurrently.
+     */
+    template<typename F>
+    void generate(image& img, F&& fn, thread_pool& pool = thread_pool::global())
+    {
+        pool.parallel_for(0, img.height(), row_grain(img.width()), [&](std::size_t begin, std::size_t end) {
+            for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
+            {
+                pixel* row = &img[{ 0, y }];
+                for (int x = 0; x < img.width(); ++x) row[x] = fn(x, y);
+            }
+        });
+    }
+
+}
+
+#endif //GPU_RAYTRACE_IMAGE_OPS_HPP
@@ -0,0 +1,116 @@
+#ifndef GPU_RAYTRACE_RADIX_SORT_HPP
+#define GPU_RAYTRACE_RADIX_SORT_HPP
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "base/thread_pool.hpp"
+
+namespace base
+{
+
+    /**
+     * sorts keys in ascending order and applies the same permutation to values, e.g. Morton codes and the primitives
+     * they belong to. least significant digit radix sort over bytes: each pass counts the digits of every block of
+     * the input in parallel, prefix sums the counts in (digit, block) order and scatters each block to its offsets in
+     * parallel, which keeps the sort stable. passes over a byte which all keys share are skipped.
+     * @tparam K unsigned key type
+     * @tparam V value type
+     * @param keys keys to sort
+     * @param values values to permute along with keys
+     * @param bits number of low bits of the keys that may be set. fewer bits take fewer passes
+     * @param pool pool running the passes
+     * @throws std::invalid_argument if keys and values differ in size
+     */
+    template<std::unsigned_integral K, typename V>
+    void radix_sort(std::span<K> keys, std::span<V> values, int bits = 8 * sizeof(K), thread_pool& pool = thread_pool::global());
+
+    template<std::unsigned_integral K, typename V>
+    void radix_sort(std::span<K> keys, std::span<V> values, int bits, thread_pool& pool)
+    {
+        constexpr std::size_t RADIX = 256;
+        constexpr std::size_t MIN_BLOCK = 1 << 14; // smaller blocks cost more in counting than they gain in parallelism
+
+        if (keys.size() != values.size()) throw std::invalid_argument{ "radix_sort needs as many values as keys" };
+        const std::size_t n = keys.size();
+        if (n < 2) return;
+
+        const std::size_t blocks = std::max<std::size_t>(1, std::min(4 * pool.concurrency(), n / MIN_BLOCK));
+        const std::size_t block_size = (n + blocks - 1) / blocks;
+
+        std::vector<K> key_scratch(n);
+        std::vector<V> value_scratch(n);
+        std::span<K> key_in = keys, key_out = key_scratch;
+        std::span<V> value_in = values, value_out = value_scratch;
+
+        std::vector<std::size_t> offsets(blocks * RADIX);
+        for (int shift = 0; shift < bits && shift < static_cast<int>(8 * sizeof(K)); shift += 8)
+        {
+            auto digit = [shift](K key) { return static_cast<std::size_t>((key >> shift) & (RADIX - 1)); };
+
+            pool.parallel_for(0, blocks, 1, [&](std::size_t lo, std::size_t hi)
+            {
+                for (std::size_t b = lo; b < hi; ++b)
+                {
+                    std::size_t* counts = offsets.data() + b * RADIX;
+                    std::fill(counts, counts + RADIX, 0);
+                    for (std::size_t i = b * block_size; i < std::min(n, (b + 1) * block_size); ++i) ++counts[digit(key_in[i])];
+                }
+            });
+
+            // every key has the same digit, so the pass would not move anything
+            if (offsets[digit(key_in[0])] == std::min(n, block_size))
+            {
+                bool uniform = true;
+                for (std::size_t b = 1; b < blocks && uniform; ++b)
+                {
+                    std::size_t count = std::min(n, (b + 1) * block_size) - std::min(n, b * block_size);
+                    uniform = offsets[b * RADIX + digit(key_in[0])] == count;
+                }
+                if (uniform) continue;
+            }
+
+            std::size_t sum = 0;
+            for (std::size_t d = 0; d < RADIX; ++d)
+            {
+                for (std::size_t b = 0; b < blocks; ++b)
+                {
+                    std::size_t count = offsets[b * RADIX + d];
+                    offsets[b * RADIX + d] = sum;
+                    sum += count;
+                }
+            }
+
+            pool.parallel_for(0, blocks, 1, [&](std::size_t lo, std::size_t hi)
+            {
+                for (std::size_t b = lo; b < hi; ++b)
+                {
+                    std::size_t* next = offsets.data() + b * RADIX;
+                    for (std::size_t i = b * block_size; i < std::min(n, (b + 1) * block_size); ++i)
+                    {
+                        std::size_t out = next[digit(key_in[i])]++;
+                        key_out[out] = key_in[i];
+                        value_out[out] = value_in[i];
+                    }
+                }
+            });
+
+            std::swap(key_in, key_out);
+            std::swap(value_in, value_out);
+        }
+
+        if (key_in.data() != keys.data())
+        {
+            std::copy(key_in.begin(), key_in.end(), keys.begin());
+            std::copy(value_in.begin(), value_in.end(), values.begin());
+        }
+    }
+
+}
+
+#endif //GPU_RAYTRACE_RADIX_SORT_HPP
@@ -0,0 +1,121 @@
+#ifndef GPU_RAYTRACE_THREAD_POOL_HPP
+#define GPU_RAYTRACE_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace base
+{
+
+    /**
+     * fixed set of worker threads that run the chunks of parallel loops.
+     * a thread waiting on a loop helps run queued chunks instead of sleeping, so loops may be nested
+     * (e.g. a recursive builder issuing a parallel loop from inside another one) without deadlocking.
+     */
+    class thread_pool
+    {
+    private:
+        struct task_group
+        {
+            std::atomic<std::size_t> remaining;
+            std::exception_ptr error;
+            std::mutex error_mtx;
+        };
+
+        struct task
+        {
+            std::function<void()> fn;
+            task_group* group;
+        };
+
+        std::vector<std::thread> _workers;
+        std::deque<task> _tasks;
+        std::mutex _mtx;
+        std::condition_variable _cv;
+        bool _stopping;
+
+        void worker_loop();
+        bool run_one(std::unique_lock<std::mutex>& lock);
+        void run_group(task_group& group, std::vector<std::function<void()>>& fns);
+    public:
+        /**
+         * starts the worker threads.
+         * @param threads number of worker threads. the thread calling parallel_for also runs chunks, so zero workers
+         * simply runs every loop on the calling thread.
+         */
+        explicit thread_pool(std::size_t threads = std::thread::hardware_concurrency());
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool(thread_pool&&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+        thread_pool& operator=(thread_pool&&) = delete;
+
+        /**
+         * joins the worker threads. no loop may be running.
+         */
+        ~thread_pool();
+
+        /**
+         * @return number of threads that can run chunks at once, counting the calling thread.
+         */
+        std::size_t concurrency() const;
+
+        /**
+         * splits [begin, end) into contiguous chunks and calls fn(chunk_begin, chunk_end) for each of them in parallel.
+         * blocks until every chunk has run.
+         * @param begin first index
+         * @param end one past the last index
+         * @param grain minimum number of indices in a chunk. keeps chunks large enough to amortize scheduling.
+         * @param fn callable taking (std::size_t, std::size_t)
+         * @throws the first exception thrown by fn, once every chunk has finished.
+         */
+        template<typename F>
+        void parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F&& fn);
+
+        /**
+         * shared pool with one worker per hardware thread, created on first use.
+         */
+        static thread_pool& global();
+    };
+
+    template<typename F>
+    void thread_pool::parallel_for(std::size_t begin, std::size_t end, std::size_t grain, F&& fn)
+    {
+        if (begin >= end) return;
+        if (grain == 0) grain = 1;
+
+        const std::size_t count = end - begin;
+        std::size_t chunks = (count + grain - 1) / grain;
+        const std::size_t max_chunks = 4 * concurrency(); // a few chunks per thread evens out imbalanced work
+        if (chunks > max_chunks) chunks = max_chunks;
+
+        if (chunks <= 1 || _workers.empty())
+        {
+            fn(begin, end);
+            return;
+        }
+
+        std::vector<std::function<void()>> fns;
+        fns.reserve(chunks);
+        for (std::size_t i = 0; i < chunks; ++i)
+        {
+            std::size_t lo = begin + count * i / chunks;
+            std::size_t hi = begin + count * (i + 1) / chunks;
+            fns.emplace_back([&fn, lo, hi] { fn(lo, hi); });
+        }
+
+        task_group group{ fns.size(), nullptr, {} };
+        run_group(group, fns);
+        if (group.error) std::rethrow_exception(group.error);
+    }
+
+}
+
+#endif //GPU_RAYTRACE_THREAD_POOL_HPP
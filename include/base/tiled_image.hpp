@@ -0,0 +1,80 @@
+#ifndef GPU_RAYTRACE_TILED_IMAGE_HPP
+#define GPU_RAYTRACE_TILED_IMAGE_HPP
+
+#include "base/image.hpp"
+#include "base/thread_pool.hpp"
+
+namespace base
+{
+
+    /**
+     * two-dimensional buffer of pixels stored in square tiles rather than rows.
+     * the pixels of a tile are contiguous (row by row within the tile) and tiles are stored row by row, so a renderer
+     * working on screen-space tiles touches a handful of cache lines per tile instead of one per row.
+     * the buffer is padded up to a whole number of tiles; the padding is never exported.
+     */
+    class tiled_image
+    {
+    public:
+        static constexpr int tile_size = 8; // a tile of RGB0 pixels spans four 64-byte cache lines
+        static constexpr int tile_pixels = tile_size * tile_size;
+    private:
+        int _width;
+        int _height;
+        int _tiles_x;
+        int _tiles_y;
+        pixel *_buf;
+
+        struct coordinate
+        {
+            int x;
+            int y;
+        };
+    public:
+        tiled_image(int width, int height);
+
+        /**
+         * copies the pixels of a row-major image into tiles.
+         */
+        explicit tiled_image(const image& img);
+
+        tiled_image(const tiled_image& img);
+        tiled_image(tiled_image&& img);
+        tiled_image& operator=(const tiled_image& img);
+        tiled_image& operator=(tiled_image&& img);
+        ~tiled_image();
+
+        int width() const;
+        int height() const;
+        int tiles_x() const;
+        int tiles_y() const;
+        pixel* get_buffer() const;
+
+        /**
+         * @param tile_x column of the tile
+         * @param tile_y row of the tile
+         * @return first pixel of the tile. the tile's pixels follow row by row, tile_size to a row.
+         */
+        pixel* tile(int tile_x, int tile_y) const;
+
+        pixel& operator[](coordinate coord);
+        const pixel& operator[](coordinate coord) const;
+
+        void fill(pixel pix);
+
+        /**
+         * writes the pixels into a row-major image of the same dimensions, converting rows of tiles in parallel.
+         * @param dst image receiving the pixels. may be a strided view (e.g. over a frame of a video encoder).
+         * @param pool threads converting the rows of tiles
+         */
+        void untile(image& dst, thread_pool& pool = thread_pool::global()) const;
+
+        /**
+         * @return a newly allocated row-major copy of the pixels.
+         */
+        image to_image() const;
+    };
+
+}
+
+#endif //GPU_RAYTRACE_TILED_IMAGE_HPP
@@ -0,0 +1,271 @@
+#ifndef GPU_RAYTRACE_DISTRIBUTIONS_HPP
+#define GPU_RAYTRACE_DISTRIBUTIONS_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "gpu/gpu.hpp"
+#include "floats.hpp"
+#include "geometry/point.hpp"
+
+/**
+ * distributions that are built once from a set of weights and then sampled many times. each one is owned by a class
+ * holding its tables, which is built on the host, and is sampled through a view. the view is a pointer and a size per
+ * table, so it can be copied to the device once the tables have been.
+ */
+namespace math::sampling
+{
+
+    /**
+     * a slot of an alias table: an index is drawn uniformly, then kept with probability q or replaced by its alias.
+     * @tparam T floating point type
+     */
+    template<std::floating_point T>
+    struct alias_bin
+    {
+        T q; // probability of keeping the index of this bin
+        T p; // normalized probability of the index of this bin, for pmf queries
+        std::uint32_t alias; // index drawn instead with probability 1 - q
+    };
+
+    /**
+     * non-owning view of the bins of an alias_table.
+     * @tparam T floating point type
+     */
+    template<std::floating_point T>
+    class alias_table_view
+    {
+    private:
+        const alias_bin<T>* _bins;
+        std::size_t _size;
+    public:
+        constexpr CPU_GPU alias_table_view();
+        constexpr CPU_GPU alias_table_view(const alias_bin<T>* bins, std::size_t size);
+
+        constexpr CPU_GPU std::size_t size() const;
+
+        /**
+         * draws an index in O(1).
+         * @param u uniform random value in interval [0,1)
+         * @param pmf if not null, receives the probability of the returned index
+         * @param u_remapped if not null, receives a fresh uniform value in [0,1) recovered from u
+         * @return index of the weight sampled. -1 on an empty table.
+         */
+        constexpr CPU_GPU int sample(T u, T* pmf = nullptr, T* u_remapped = nullptr) const;
+
+        /**
+         * @param idx index below size()
+         * @return probability of sampling idx
+         */
+        constexpr CPU_GPU T pmf(std::size_t idx) const;
+    };
+
+    /**
+     * Vose's alias method: a discrete distribution over the indices of a set of weights that is built in O(n) and
+     * sampled in O(1), for light selection over many emitters and similar large PMFs. the weights do not need to be
+     * normalized. if they are all zero every index is equally likely.
+     * @tparam T floating point type
+     */
+    template<std::floating_point T>
+    class alias_table
+    {
+    private:
+        std::vector<alias_bin<T>> _bins;
+    public:
+        alias_table() = default;
+
+        /**
+         * @param weights weights that form the PMF
+         * @throws std::invalid_argument if a weight is negative or not finite, or if there are more than 2^31 - 1.
+         */
+        explicit alias_table(std::span<const T> weights);
+
+        std::size_t size() const;
+        std::span<const alias_bin<T>> bins() const;
+        alias_table_view<T> view() const;
+
+        int sample(T u, T* pmf = nullptr, T* u_remapped = nullptr) const;
+        T pmf(std::size_t idx) const;
+    };
+
+    /**
+     * non-owning view of a piecewise_constant_1d.
+     * @tparam T floating point type
+     */
+    template<std::floating_point T>
+    class piecewise_constant_1d_view
+    {
+    private:
+        const T* _func;
+        const T* _cdf;
+        std::size_t _size;
+        T _integral;
+        T _min;
+        T _max;
+
+        constexpr CPU_GPU std::size_t find_interval(T u) const;
+    public:
+        constexpr CPU_GPU piecewise_constant_1d_view();
+        constexpr CPU_GPU piecewise_constant_1d_view(const T* func, const T* cdf, std::size_t size, T integral, T min, T max);
+
+        constexpr CPU_GPU std::size_t size() const;
+
+        /**
+         * @return integral of the function over its domain
+         */
+        constexpr CPU_GPU T integral() const;
+
+        /**
+         * draws a point of the domain by inverting the CDF with a binary search, in O(log n).
+         * @param u uniform random value in interval [0,1)
+         * @param pdf if not null, receives the density of the returned point
+         * @param offset if not null, receives the index of the piece containing the returned point
+         * @return the sampled point in [min, max)
+         */
+        constexpr CPU_GPU T sample_continuous(T u, T* pdf = nullptr, std::size_t* offset = nullptr) const;
+
+        /**
+         * draws the index of a piece with probability proportional to its value, in O(log n).
+         * @param u uniform random value in interval [0,1)
+         * @param pmf if not null, receives the probability of the returned index
+         * @param u_remapped if not null, receives a fresh uniform value in [0,1) recovered from u
+         * @return index of the piece sampled
+         */
+        constexpr CPU_GPU std::size_t sample_discrete(T u, T* pmf = nullptr, T* u_remapped = nullptr) const;
+
+        /**
+         * @param x point of the domain. points outside are clamped to it
+         * @return density of sampling x with sample_continuous
+         */
+        constexpr CPU_GPU T pdf(T x) const;
+
+        /**
+         * @param idx index below size()
+         * @return probability of sampling idx with sample_discrete
+         */
+        constexpr CPU_GPU T pmf(std::size_t idx) const;
+    };
+
+    /**
+     * a piecewise-constant function over [min, max] split in n equal pieces, sampled proportionally to its absolute
+     * value through its CDF. if the function is zero everywhere it is sampled uniformly.
+     * @tparam T floating point type
+     */
+    template<std::floating_point T>
+    class piecewise_constant_1d
+    {
+    private:
+        std::vector<T> _func;
+        std::vector<T> _cdf;
+        T _integral;
+        T _min;
+        T _max;
+    public:
+        piecewise_constant_1d();
+
+        /**
+         * @param func values of the pieces
+         * @param min start of the domain
+         * @param max end of the domain
+         * @throws std::invalid_argument if func is empty or holds a value that is not finite, or if max <= min.
+         */
+        explicit piecewise_constant_1d(std::span<const T> func, T min = 0, T max = 1);
+
+        std::size_t size() const;
+        T integral() const;
+        piecewise_constant_1d_view<T> view() const;
+
+        T sample_continuous(T u, T* pdf = nullptr, std::size_t* offset = nullptr) const;
+        std::size_t sample_discrete(T u, T* pmf = nullptr, T* u_remapped = nullptr) const;
+        T pdf(T x) const;
+        T pmf(std::size_t idx) const;
+    };
+
+    /**
+     * non-owning view of a piecewise_constant_2d.
+     * @tparam T floating point type
+     */
+    template<std::floating_point T>
+    class piecewise_constant_2d_view
+    {
+    private:
+        const T* _conditional_func; // rows of the function, nu values each
+        const T* _conditional_cdf; // CDF of each row, nu + 1 values each
+        const T* _conditional_integral; // integral of each row, which is the marginal function
+        piecewise_constant_1d_view<T> _marginal;
+        std::size_t _nu;
+
+        constexpr CPU_GPU piecewise_constant_1d_view<T> row(std::size_t v) const;
+    public:
+        constexpr CPU_GPU piecewise_constant_2d_view();
+        constexpr CPU_GPU piecewise_constant_2d_view(const T* conditional_func, const T* conditional_cdf,
+                                                     const T* conditional_integral,
+                                                     piecewise_constant_1d_view<T> marginal, std::size_t nu);
+
+        constexpr CPU_GPU std::size_t width() const;
+        constexpr CPU_GPU std::size_t height() const;
+
+        /**
+         * @return integral of the function over the unit square
+         */
+        constexpr CPU_GPU T integral() const;
+
+        /**
+         * draws a point by sampling a row from the marginal distribution, then a column from that row, in
+         * O(log nu + log nv).
+         * @param u vector of two uniform random values in interval [0,1)
+         * @param pdf if not null, receives the density of the returned point
+         * @return the sampled point in [0,1)^2
+         */
+        constexpr CPU_GPU point<T, 2> sample(point<T, 2> u, T* pdf = nullptr) const;
+
+        /**
+         * @param p point of the unit square. points outside are clamped to it
+         * @return density of sampling p with sample
+         */
+        constexpr CPU_GPU T pdf(point<T, 2> p) const;
+    };
+
+    /**
+     * a piecewise-constant function over the unit square on a grid of nu by nv cells, e.g. the luminance of an
+     * environment map, sampled proportionally to its absolute value.
+     * @tparam T floating point type
+     */
+    template<std::floating_point T>
+    class piecewise_constant_2d
+    {
+    private:
+        std::vector<T> _conditional_func;
+        std::vector<T> _conditional_cdf;
+        std::vector<T> _conditional_integral;
+        piecewise_constant_1d<T> _marginal;
+        std::size_t _nu;
+    public:
+        piecewise_constant_2d();
+
+        /**
+         * @param func values of the cells in row-major order, nu values per row
+         * @param nu number of cells along u, the first dimension
+         * @param nv number of cells along v, the second dimension
+         * @throws std::invalid_argument if func does not hold nu * nv values, if either is zero, or if a value is not
+         * finite.
+         */
+        piecewise_constant_2d(std::span<const T> func, std::size_t nu, std::size_t nv);
+
+        std::size_t width() const;
+        std::size_t height() const;
+        T integral() const;
+        piecewise_constant_2d_view<T> view() const;
+
+        point<T, 2> sample(point<T, 2> u, T* pdf = nullptr) const;
+        T pdf(point<T, 2> p) const;
+    };
+
+}
+
+#include "impl/distributions.inl"
+
+#endif //GPU_RAYTRACE_DISTRIBUTIONS_HPP
@@ -0,0 +1,158 @@
+#ifndef GPU_RAYTRACE_FAST_FUNCTIONS_HPP
+#define GPU_RAYTRACE_FAST_FUNCTIONS_HPP
+
+#include <cstddef>
+#include <concepts>
+
+#include "functions.hpp"
+#include "math/simd/lane.hpp"
+
+/**
+ * approximations of the transcendental functions for shading and sampling, where the functions of math:: (which
+ * forward to std:: at runtime) are too slow and do not vectorize.
+ * every function reduces its argument to a small interval and evaluates a minimax polynomial there, using only
+ * multiplications, fmas, one division at most and selects instead of branches. so the same kernel serves scalars,
+ * device code and the SIMD lanes of math/simd/lane.hpp.
+ *
+ * the polynomials are fitted for float. double arguments are accepted and are as accurate relative to the value, but
+ * no more. the error bounds documented below are the largest errors for float measured against the correctly rounded
+ * result over the documented domain, in units in the last place (ulp). near their zeros the relative error of sine and
+ * cosine is unbounded, so theirs is absolute.
+ */
+namespace math::fast
+{
+
+    /**
+     * size of the polynomials evaluated by the fast functions.
+     * low keeps about 3 significant decimal digits, medium about 5 and high is within a few ulp of float.
+     */
+    enum class precision
+    {
+        low,
+        medium,
+        high
+    };
+
+    constexpr inline precision DEFAULT_PRECISION = precision::high;
+
+    /**
+     * sine. the bounds hold for |theta| <= 8192, beyond which the argument reduction loses bits.
+     * max absolute error: low 2^-11, medium 2^-19, high 2^-23.
+     * @tparam P precision of the polynomial
+     * @tparam T floating point type
+     * @param theta angle in radians
+     * @return approximation of sin(theta)
+     */
+    template<precision P = DEFAULT_PRECISION, std::floating_point T>
+    CPU_GPU T sin(T theta);
+
+    /**
+     * cosine. the bounds hold for |theta| <= 8192, beyond which the argument reduction loses bits.
+     * max absolute error: low 2^-11, medium 2^-19, high 2^-23.
+     * @tparam P precision of the polynomial
+     * @tparam T floating point type
+     * @param theta angle in radians
+     * @return approximation of cos(theta)
+     */
+    template<precision P = DEFAULT_PRECISION, std::floating_point T>
+    CPU_GPU T cos(T theta);
+
+    /**
+     * sine and cosine sharing one argument reduction. the errors are those of sin and cos.
+     * @tparam P precision of the polynomials
+     * @tparam T floating point type
+     * @param theta angle in radians
+     * @param s receives the approximation of sin(theta)
+     * @param c receives the approximation of cos(theta)
+     */
+    template<precision P = DEFAULT_PRECISION, std::floating_point T>
+    CPU_GPU void sincos(T theta, T& s, T& c);
+
+    /**
+     * natural logarithm of any positive value, subnormals included. zero returns -infinity and negative values NaN.
+     * max error: low 768 ulp, medium 6 ulp, high 2 ulp.
+     * @tparam P precision of the polynomial
+     * @tparam T floating point type
+     * @param x
+     * @return approximation of ln(x)
+     */
+    template<precision P = DEFAULT_PRECISION, std::floating_point T>
+    CPU_GPU T log(T x);
+
+    /**
+     * natural exponential. overflows to infinity and underflows through the subnormals to zero.
+     * max error: low 2500 ulp, medium 72 ulp, high 1 ulp.
+     * @tparam P precision of the polynomial
+     * @tparam T floating point type
+     * @param x
+     * @return approximation of e^x
+     */
+    template<precision P = DEFAULT_PRECISION, std::floating_point T>
+    CPU_GPU T exp(T x);
+
+    /**
+     * power, computed as exp(b * log(|a|)). negative bases are defined for integral exponents. the errors of log are
+     * scaled by |b * ln(a)|. while |b * ln(a)| <= 8 the max error is low 3072 ulp, medium 96 ulp, high 12 ulp.
+     * @tparam P precision of the polynomials
+     * @tparam T floating point type
+     * @param a base
+     * @param b exponent
+     * @return approximation of a^b
+     */
+    template<precision P = DEFAULT_PRECISION, std::floating_point T>
+    CPU_GPU T pow(T a, T b);
+
+    /**
+     * inverse cosine. values outside [-1, 1] return NaN.
+     * max error: low 800 ulp, medium 40 ulp, high 1 ulp.
+     * @tparam P precision of the polynomial
+     * @tparam T floating point type
+     * @param ratio
+     * @return approximation of arccos(ratio) in [0, pi]
+     */
+    template<precision P = DEFAULT_PRECISION, std::floating_point T>
+    CPU_GPU T arccos(T ratio);
+
+    /**
+     * angle of the point (x, y), with the quadrant taken from the signs of both.
+     * max error: low 400 ulp, medium 16 ulp, high 4 ulp.
+     * @tparam P precision of the polynomial
+     * @tparam T floating point type
+     * @param y
+     * @param x
+     * @return approximation of arctan(y / x) in [-pi, pi]
+     */
+    template<precision P = DEFAULT_PRECISION, std::floating_point T>
+    CPU_GPU T arctan2(T y, T x);
+
+    // the same functions over every lane of a SIMD lane, with the same errors
+
+    template<precision P = DEFAULT_PRECISION, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> sin(const lane<T, W>& theta);
+
+    template<precision P = DEFAULT_PRECISION, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> cos(const lane<T, W>& theta);
+
+    template<precision P = DEFAULT_PRECISION, std::floating_point T, std::size_t W>
+    CPU_GPU void sincos(const lane<T, W>& theta, lane<T, W>& s, lane<T, W>& c);
+
+    template<precision P = DEFAULT_PRECISION, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> log(const lane<T, W>& x);
+
+    template<precision P = DEFAULT_PRECISION, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> exp(const lane<T, W>& x);
+
+    template<precision P = DEFAULT_PRECISION, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> pow(const lane<T, W>& a, const lane<T, W>& b);
+
+    template<precision P = DEFAULT_PRECISION, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> arccos(const lane<T, W>& ratio);
+
+    template<precision P = DEFAULT_PRECISION, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> arctan2(const lane<T, W>& y, const lane<T, W>& x);
+
+}
+
+#include "impl/fast_functions.inl"
+
+#endif //GPU_RAYTRACE_FAST_FUNCTIONS_HPP
@@ -3,6 +3,7 @@
 
 #include <concepts>
 #include <cstdint>
+#include <limits>
 
 #include "gpu/gpu.hpp"
 
@@ -13,6 +14,13 @@ namespace math
     template<> constexpr CONSTANT inline float one_minus_epsilon<float> = 0x1.fffffep-1;
     template<> constexpr CONSTANT inline double one_minus_epsilon<double> = 0x1.fffffffffffffp-1;
 
+    /**
+     * factor by which the far distances of a ray slab test are pushed out, by a few ulp, so that rounding never culls
+     * a grazing hit. it is 1 + 2 gamma(3), gamma(n) bounding the relative error of n rounded operations.
+     */
+    template<std::floating_point T> constexpr CONSTANT inline T slab_far_scale =
+            1 + 2 * (3 * std::numeric_limits<T>::epsilon() / 2) / (1 - 3 * std::numeric_limits<T>::epsilon() / 2);
+
     /**
      * generic function to test if a floating point value is "not a number" (NaN)
      * @tparam T floating point type
@@ -0,0 +1,117 @@
+#ifndef GPU_RAYTRACE_ALIGNED_HPP
+#define GPU_RAYTRACE_ALIGNED_HPP
+
+#include "vec.hpp"
+#include "point.hpp"
+#include "normal.hpp"
+#include "math/simd/lane.hpp"
+
+namespace math
+{
+
+    /**
+     * float vector of dimension 3 padded to four floats and aligned to 16 bytes, so that it is loaded into a single
+     * SSE register. its operations use SSE4.1 when the target supports it.
+     * it is vector_like, so it mixes with vector, normal and swizzles in the generic vector functions, and converts
+     * to and from any of them explicitly.
+     */
+    class alignas(16) aligned_vector3f : public vector_base<aligned_vector3f>
+    {
+    public:
+        using value_type = float;
+        constexpr static std::size_t size = 3;
+
+        container<value_type, 4> data; // x, y, z and a zero pad
+
+        constexpr CPU_GPU aligned_vector3f() : data{} {}
+        constexpr CPU_GPU aligned_vector3f(float x, float y, float z) : data{ { x, y, z, 0 } } {}
+
+        template<vector_like Vector> requires (std::remove_cvref_t<Vector>::size == 3 && std::is_same_v<typename std::remove_cvref_t<Vector>::value_type, float>)
+        constexpr CPU_GPU explicit aligned_vector3f(const Vector& vec) : data{ { vec[0], vec[1], vec[2], 0 } } {}
+
+        constexpr CPU_GPU float& operator[](int idx) { return data.buffer[idx]; }
+        constexpr CPU_GPU float operator[](int idx) const { return data.buffer[idx]; }
+    };
+
+    /**
+     * float normal of dimension 3 with the layout of aligned_vector3f.
+     */
+    class alignas(16) aligned_normal3f : public vector_base<aligned_normal3f>
+    {
+    public:
+        using value_type = float;
+        constexpr static std::size_t size = 3;
+
+        container<value_type, 4> data; // x, y, z and a zero pad
+
+        constexpr CPU_GPU aligned_normal3f() : data{} {}
+        constexpr CPU_GPU aligned_normal3f(float x, float y, float z) : data{ { x, y, z, 0 } } {}
+
+        template<vector_like Vector> requires (std::remove_cvref_t<Vector>::size == 3 && std::is_same_v<typename std::remove_cvref_t<Vector>::value_type, float>)
+        constexpr CPU_GPU explicit aligned_normal3f(const Vector& vec) : data{ { vec[0], vec[1], vec[2], 0 } } {}
+
+        constexpr CPU_GPU float& operator[](int idx) { return data.buffer[idx]; }
+        constexpr CPU_GPU float operator[](int idx) const { return data.buffer[idx]; }
+    };
+
+    /**
+     * float point of dimension 3 with the layout of aligned_vector3f.
+     */
+    class alignas(16) aligned_point3f : public point_base<aligned_point3f>
+    {
+    public:
+        using value_type = float;
+        constexpr static std::size_t size = 3;
+
+        container<value_type, 4> data; // x, y, z and a zero pad
+
+        constexpr CPU_GPU aligned_point3f() : data{} {}
+        constexpr CPU_GPU aligned_point3f(float x, float y, float z) : data{ { x, y, z, 0 } } {}
+        constexpr CPU_GPU explicit aligned_point3f(const point<float, 3>& pt) : data{ { pt[0], pt[1], pt[2], 0 } } {}
+
+        constexpr CPU_GPU explicit operator point<float, 3>() const { return point<float, 3>{ data.buffer[0], data.buffer[1], data.buffer[2] }; }
+
+        constexpr CPU_GPU float& operator[](int idx) { return data.buffer[idx]; }
+        constexpr CPU_GPU float operator[](int idx) const { return data.buffer[idx]; }
+    };
+
+    using vec3fa = aligned_vector3f;
+    using normal3fa = aligned_normal3f;
+    using point3fa = aligned_point3f;
+
+    template<std::size_t... Swizzles> requires ((Swizzles < 3) && ...)
+    constexpr CPU_GPU auto swizzle(const aligned_vector3f& vec, swizzle_tag<Swizzles...>) -> swizzle_vector<float, 4, Swizzles...>;
+
+    inline CPU_GPU aligned_vector3f operator+(const aligned_vector3f& v0, const aligned_vector3f& v1);
+    inline CPU_GPU aligned_vector3f operator-(const aligned_vector3f& v0, const aligned_vector3f& v1);
+    inline CPU_GPU aligned_vector3f operator-(const aligned_vector3f& v);
+    inline CPU_GPU aligned_vector3f operator*(const aligned_vector3f& v, float s);
+    inline CPU_GPU aligned_vector3f operator*(float s, const aligned_vector3f& v);
+    inline CPU_GPU aligned_vector3f operator/(const aligned_vector3f& v, float s);
+
+    inline CPU_GPU float dot(const aligned_vector3f& v0, const aligned_vector3f& v1);
+    inline CPU_GPU aligned_vector3f cross(const aligned_vector3f& v0, const aligned_vector3f& v1);
+    inline CPU_GPU float magnitude(const aligned_vector3f& v);
+    inline CPU_GPU aligned_vector3f normalize(const aligned_vector3f& v);
+    inline CPU_GPU aligned_vector3f min(const aligned_vector3f& v0, const aligned_vector3f& v1);
+    inline CPU_GPU aligned_vector3f max(const aligned_vector3f& v0, const aligned_vector3f& v1);
+
+    inline CPU_GPU aligned_normal3f operator-(const aligned_normal3f& n);
+    inline CPU_GPU float dot(const aligned_normal3f& n0, const aligned_normal3f& n1);
+    inline CPU_GPU float dot(const aligned_normal3f& n, const aligned_vector3f& v);
+    inline CPU_GPU float dot(const aligned_vector3f& v, const aligned_normal3f& n);
+    inline CPU_GPU aligned_normal3f normalize(const aligned_normal3f& n);
+    inline CPU_GPU aligned_normal3f face_forward(const aligned_normal3f& n, const aligned_vector3f& v);
+
+    inline CPU_GPU aligned_point3f operator+(const aligned_point3f& pt, const aligned_vector3f& v);
+    inline CPU_GPU aligned_point3f operator-(const aligned_point3f& pt, const aligned_vector3f& v);
+    inline CPU_GPU aligned_vector3f operator-(const aligned_point3f& pt0, const aligned_point3f& pt1);
+    inline CPU_GPU float distance(const aligned_point3f& pt0, const aligned_point3f& pt1);
+    inline CPU_GPU aligned_point3f min(const aligned_point3f& pt0, const aligned_point3f& pt1);
+    inline CPU_GPU aligned_point3f max(const aligned_point3f& pt0, const aligned_point3f& pt1);
+
+}
+
+#include "impl/aligned.inl"
+
+#endif //GPU_RAYTRACE_ALIGNED_HPP
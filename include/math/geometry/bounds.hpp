@@ -0,0 +1,108 @@
+#ifndef GPU_RAYTRACE_BOUNDS_HPP
+#define GPU_RAYTRACE_BOUNDS_HPP
+
+#include <concepts>
+#include <limits>
+
+#include "point.hpp"
+#include "ray.hpp"
+
+namespace math
+{
+
+    /**
+     * axis-aligned box between two corners. the default box is empty: its minimum is +infinity and its maximum
+     * -infinity on every axis, so the union with anything is that thing.
+     * @tparam T value type
+     * @tparam N dimension
+     */
+    template<typename T, std::size_t N>
+    class bounds
+    {
+    private:
+        point<T, N> _min;
+        point<T, N> _max;
+    public:
+        constexpr CPU_GPU bounds();
+
+        /**
+         * @param p the single point inside the box
+         */
+        constexpr CPU_GPU explicit bounds(const point<T, N>& p);
+
+        /**
+         * @param p0 a corner
+         * @param p1 the opposite corner. the corners may come in any order
+         */
+        constexpr CPU_GPU bounds(const point<T, N>& p0, const point<T, N>& p1);
+
+        constexpr CPU_GPU const point<T, N>& get_min() const;
+        constexpr CPU_GPU const point<T, N>& get_max() const;
+
+        /**
+         * @param idx 0 for the minimum corner, 1 for the maximum
+         */
+        constexpr CPU_GPU const point<T, N>& operator[](int idx) const;
+
+        constexpr CPU_GPU bool is_empty() const;
+
+        /**
+         * @return the extent of the box along each axis
+         */
+        constexpr CPU_GPU vector<T, N> diagonal() const;
+
+        constexpr CPU_GPU point<T, N> centroid() const;
+
+        /**
+         * @return the axis along which the box is longest
+         */
+        constexpr CPU_GPU int max_extent() const;
+
+        /**
+         * @return area of the surface of the box. zero for an empty box
+         */
+        constexpr CPU_GPU T surface_area() const requires (N == 3);
+
+        /**
+         * @param p point
+         * @return position of p relative to the box, 0 at the minimum corner and 1 at the maximum on each axis
+         */
+        constexpr CPU_GPU vector<T, N> offset(const point<T, N>& p) const;
+
+        constexpr CPU_GPU bool contains(const point<T, N>& p) const;
+        constexpr CPU_GPU bool overlaps(const bounds& b) const;
+
+        constexpr CPU_GPU bounds& extend(const point<T, N>& p);
+        constexpr CPU_GPU bounds& extend(const bounds& b);
+
+        /**
+         * clips a ray against the box with the slab test.
+         * @param r ray
+         * @param tmax end of the interval searched along the ray, which starts at 0
+         * @param t0 if not null, receives where the ray enters the box
+         * @param t1 if not null, receives where the ray leaves the box
+         * @return whether the ray overlaps the box within [0, tmax]
+         */
+        constexpr CPU_GPU bool intersect(const ray<T, N>& r, T tmax, T* t0 = nullptr, T* t1 = nullptr) const requires std::floating_point<T>;
+    };
+
+    using bounds2f = bounds<float, 2>;
+    using bounds3f = bounds<float, 3>;
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N> merge(bounds<T, N> b, const point<T, N>& p);
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N> merge(bounds<T, N> b0, const bounds<T, N>& b1);
+
+    /**
+     * @return the overlap of two boxes, which is empty if they do not overlap
+     */
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N> intersection(const bounds<T, N>& b0, const bounds<T, N>& b1);
+
+}
+
+#include "impl/bounds.inl"
+
+#endif //GPU_RAYTRACE_BOUNDS_HPP
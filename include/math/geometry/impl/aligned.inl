@@ -0,0 +1,233 @@
+#ifndef GPU_RAYTRACE_ALIGNED_INL
+#define GPU_RAYTRACE_ALIGNED_INL
+
+#include "math/geometry/aligned.hpp"
+
+namespace math
+{
+
+#ifdef RAYTRACE_SIMD_SSE41
+    namespace impl
+    {
+        template<typename Aligned>
+        inline __m128 load(const Aligned& a)
+        {
+            return _mm_load_ps(a.data.buffer);
+        }
+
+        template<typename Aligned>
+        inline Aligned from_register(__m128 r)
+        {
+            Aligned a;
+            _mm_store_ps(a.data.buffer, r);
+            return a;
+        }
+
+        // the pad multiplies to zero, so it never leaks into the products
+        inline __m128 cross(__m128 a, __m128 b)
+        {
+            __m128 a_yzx = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 b_yzx = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+            __m128 c = _mm_sub_ps(_mm_mul_ps(a, b_yzx), _mm_mul_ps(a_yzx, b));
+            return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+        }
+
+        // dot product of x, y and z, in every lane. dpps is slower than shuffling on most cores.
+        // the pad is masked out rather than trusted to be zero: v / 0 or v * inf turn it into NaN
+        inline __m128 dot(__m128 a, __m128 b)
+        {
+            const __m128 xyz = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+            __m128 products = _mm_and_ps(_mm_mul_ps(a, b), xyz);
+            __m128 sums = _mm_add_ps(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 3, 0, 1)));
+            return _mm_add_ps(sums, _mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 0, 3, 2)));
+        }
+    }
+#endif
+
+    template<std::size_t... Swizzles> requires ((Swizzles < 3) && ...)
+    constexpr CPU_GPU auto swizzle(const aligned_vector3f& vec, swizzle_tag<Swizzles...>) -> swizzle_vector<float, 4, Swizzles...>
+    {
+        return swizzle_vector<float, 4, Swizzles...>{ vec.data };
+    }
+
+    // aligned_vector3f
+
+    inline CPU_GPU aligned_vector3f operator+(const aligned_vector3f& v0, const aligned_vector3f& v1)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        return impl::from_register<aligned_vector3f>(_mm_add_ps(impl::load(v0), impl::load(v1)));
+#else
+        return aligned_vector3f{ v0[0] + v1[0], v0[1] + v1[1], v0[2] + v1[2] };
+#endif
+    }
+
+    inline CPU_GPU aligned_vector3f operator-(const aligned_vector3f& v0, const aligned_vector3f& v1)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        return impl::from_register<aligned_vector3f>(_mm_sub_ps(impl::load(v0), impl::load(v1)));
+#else
+        return aligned_vector3f{ v0[0] - v1[0], v0[1] - v1[1], v0[2] - v1[2] };
+#endif
+    }
+
+    inline CPU_GPU aligned_vector3f operator-(const aligned_vector3f& v)
+    {
+        return aligned_vector3f{} - v;
+    }
+
+    inline CPU_GPU aligned_vector3f operator*(const aligned_vector3f& v, float s)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        return impl::from_register<aligned_vector3f>(_mm_mul_ps(impl::load(v), _mm_set1_ps(s)));
+#else
+        return aligned_vector3f{ v[0] * s, v[1] * s, v[2] * s };
+#endif
+    }
+
+    inline CPU_GPU aligned_vector3f operator*(float s, const aligned_vector3f& v)
+    {
+        return v * s;
+    }
+
+    inline CPU_GPU aligned_vector3f operator/(const aligned_vector3f& v, float s)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        return impl::from_register<aligned_vector3f>(_mm_div_ps(impl::load(v), _mm_set1_ps(s)));
+#else
+        return aligned_vector3f{ v[0] / s, v[1] / s, v[2] / s };
+#endif
+    }
+
+    inline CPU_GPU float dot(const aligned_vector3f& v0, const aligned_vector3f& v1)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        return _mm_cvtss_f32(impl::dot(impl::load(v0), impl::load(v1)));
+#else
+        return v0[0] * v1[0] + v0[1] * v1[1] + v0[2] * v1[2];
+#endif
+    }
+
+    inline CPU_GPU aligned_vector3f cross(const aligned_vector3f& v0, const aligned_vector3f& v1)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        return impl::from_register<aligned_vector3f>(impl::cross(impl::load(v0), impl::load(v1)));
+#else
+        return aligned_vector3f{
+            v0[1] * v1[2] - v0[2] * v1[1],
+            v0[2] * v1[0] - v0[0] * v1[2],
+            v0[0] * v1[1] - v0[1] * v1[0]
+        };
+#endif
+    }
+
+    inline CPU_GPU float magnitude(const aligned_vector3f& v)
+    {
+        return math::sqrt(dot(v, v));
+    }
+
+    inline CPU_GPU aligned_vector3f normalize(const aligned_vector3f& v)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        __m128 r = impl::load(v);
+        return impl::from_register<aligned_vector3f>(_mm_div_ps(r, _mm_sqrt_ps(impl::dot(r, r))));
+#else
+        return v / magnitude(v);
+#endif
+    }
+
+    inline CPU_GPU aligned_vector3f min(const aligned_vector3f& v0, const aligned_vector3f& v1)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        return impl::from_register<aligned_vector3f>(_mm_min_ps(impl::load(v0), impl::load(v1)));
+#else
+        return aligned_vector3f{ v0[0] < v1[0] ? v0[0] : v1[0], v0[1] < v1[1] ? v0[1] : v1[1], v0[2] < v1[2] ? v0[2] : v1[2] };
+#endif
+    }
+
+    inline CPU_GPU aligned_vector3f max(const aligned_vector3f& v0, const aligned_vector3f& v1)
+    {
+#ifdef RAYTRACE_SIMD_SSE41
+        return impl::from_register<aligned_vector3f>(_mm_max_ps(impl::load(v0), impl::load(v1)));
+#else
+        return aligned_vector3f{ v0[0] > v1[0] ? v0[0] : v1[0], v0[1] > v1[1] ? v0[1] : v1[1], v0[2] > v1[2] ? v0[2] : v1[2] };
+#endif
+    }
+
+    // aligned_normal3f. it shares the layout of aligned_vector3f, so the vector operations are reused
+
+    namespace impl
+    {
+        template<typename To, typename From>
+        constexpr CPU_GPU To relabel(const From& from)
+        {
+            To to;
+            to.data = from.data;
+            return to;
+        }
+    }
+
+    inline CPU_GPU aligned_normal3f operator-(const aligned_normal3f& n)
+    {
+        return impl::relabel<aligned_normal3f>(-impl::relabel<aligned_vector3f>(n));
+    }
+
+    inline CPU_GPU float dot(const aligned_normal3f& n0, const aligned_normal3f& n1)
+    {
+        return dot(impl::relabel<aligned_vector3f>(n0), impl::relabel<aligned_vector3f>(n1));
+    }
+
+    inline CPU_GPU float dot(const aligned_normal3f& n, const aligned_vector3f& v)
+    {
+        return dot(impl::relabel<aligned_vector3f>(n), v);
+    }
+
+    inline CPU_GPU float dot(const aligned_vector3f& v, const aligned_normal3f& n)
+    {
+        return dot(v, impl::relabel<aligned_vector3f>(n));
+    }
+
+    inline CPU_GPU aligned_normal3f normalize(const aligned_normal3f& n)
+    {
+        return impl::relabel<aligned_normal3f>(normalize(impl::relabel<aligned_vector3f>(n)));
+    }
+
+    inline CPU_GPU aligned_normal3f face_forward(const aligned_normal3f& n, const aligned_vector3f& v)
+    {
+        return dot(n, v) < 0.0f ? -n : n;
+    }
+
+    // aligned_point3f
+
+    inline CPU_GPU aligned_point3f operator+(const aligned_point3f& pt, const aligned_vector3f& v)
+    {
+        return impl::relabel<aligned_point3f>(impl::relabel<aligned_vector3f>(pt) + v);
+    }
+
+    inline CPU_GPU aligned_point3f operator-(const aligned_point3f& pt, const aligned_vector3f& v)
+    {
+        return impl::relabel<aligned_point3f>(impl::relabel<aligned_vector3f>(pt) - v);
+    }
+
+    inline CPU_GPU aligned_vector3f operator-(const aligned_point3f& pt0, const aligned_point3f& pt1)
+    {
+        return impl::relabel<aligned_vector3f>(pt0) - impl::relabel<aligned_vector3f>(pt1);
+    }
+
+    inline CPU_GPU float distance(const aligned_point3f& pt0, const aligned_point3f& pt1)
+    {
+        return magnitude(pt0 - pt1);
+    }
+
+    inline CPU_GPU aligned_point3f min(const aligned_point3f& pt0, const aligned_point3f& pt1)
+    {
+        return impl::relabel<aligned_point3f>(min(impl::relabel<aligned_vector3f>(pt0), impl::relabel<aligned_vector3f>(pt1)));
+    }
+
+    inline CPU_GPU aligned_point3f max(const aligned_point3f& pt0, const aligned_point3f& pt1)
+    {
+        return impl::relabel<aligned_point3f>(max(impl::relabel<aligned_vector3f>(pt0), impl::relabel<aligned_vector3f>(pt1)));
+    }
+
+}
+
+#endif //GPU_RAYTRACE_ALIGNED_INL
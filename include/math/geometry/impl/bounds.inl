@@ -0,0 +1,204 @@
+#ifndef GPU_RAYTRACE_BOUNDS_INL
+#define GPU_RAYTRACE_BOUNDS_INL
+
+#include "math/geometry/bounds.hpp"
+
+namespace math
+{
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N>::bounds()
+    {
+        using limits = std::numeric_limits<T>;
+        constexpr T highest = limits::has_infinity ? limits::infinity() : limits::max();
+        constexpr T lowest = limits::has_infinity ? -limits::infinity() : limits::lowest();
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            _min[i] = highest;
+            _max[i] = lowest;
+        }
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N>::bounds(const point<T, N>& p) : _min{ p }, _max{ p } {}
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N>::bounds(const point<T, N>& p0, const point<T, N>& p1)
+    {
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            _min[i] = p0[i] < p1[i] ? p0[i] : p1[i];
+            _max[i] = p0[i] < p1[i] ? p1[i] : p0[i];
+        }
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU const point<T, N>& bounds<T, N>::get_min() const
+    {
+        return _min;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU const point<T, N>& bounds<T, N>::get_max() const
+    {
+        return _max;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU const point<T, N>& bounds<T, N>::operator[](int idx) const
+    {
+        return idx == 0 ? _min : _max;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bool bounds<T, N>::is_empty() const
+    {
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            if (_min[i] > _max[i]) return true;
+        }
+        return false;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU vector<T, N> bounds<T, N>::diagonal() const
+    {
+        return _max - _min;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU point<T, N> bounds<T, N>::centroid() const
+    {
+        point<T, N> c;
+        for (int i = 0; i < static_cast<int>(N); ++i) c[i] = (_min[i] + _max[i]) / 2;
+        return c;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU int bounds<T, N>::max_extent() const
+    {
+        int axis = 0;
+        for (int i = 1; i < static_cast<int>(N); ++i)
+        {
+            if (_max[i] - _min[i] > _max[axis] - _min[axis]) axis = i;
+        }
+        return axis;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU T bounds<T, N>::surface_area() const requires (N == 3)
+    {
+        if (is_empty()) return 0;
+        T dx = _max[0] - _min[0], dy = _max[1] - _min[1], dz = _max[2] - _min[2];
+        return 2 * (dx * dy + dx * dz + dy * dz);
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU vector<T, N> bounds<T, N>::offset(const point<T, N>& p) const
+    {
+        vector<T, N> o = p - _min;
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            if (_max[i] > _min[i]) o[i] /= _max[i] - _min[i];
+        }
+        return o;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bool bounds<T, N>::contains(const point<T, N>& p) const
+    {
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            if (p[i] < _min[i] || p[i] > _max[i]) return false;
+        }
+        return true;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bool bounds<T, N>::overlaps(const bounds& b) const
+    {
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            if (_max[i] < b._min[i] || _min[i] > b._max[i]) return false;
+        }
+        return true;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N>& bounds<T, N>::extend(const point<T, N>& p)
+    {
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            if (p[i] < _min[i]) _min[i] = p[i];
+            if (p[i] > _max[i]) _max[i] = p[i];
+        }
+        return *this;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N>& bounds<T, N>::extend(const bounds& b)
+    {
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            if (b._min[i] < _min[i]) _min[i] = b._min[i];
+            if (b._max[i] > _max[i]) _max[i] = b._max[i];
+        }
+        return *this;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bool bounds<T, N>::intersect(const ray<T, N>& r, T tmax, T* t0, T* t1) const requires std::floating_point<T>
+    {
+        T near = 0, far = tmax;
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            T inv = 1 / r.get_direction()[i];
+            T t_near = (_min[i] - r.get_origin()[i]) * inv;
+            T t_far = (_max[i] - r.get_origin()[i]) * inv;
+            if (t_near > t_far)
+            {
+                T t = t_near;
+                t_near = t_far;
+                t_far = t;
+            }
+            t_far *= slab_far_scale<T>;
+
+            // written so that a NaN from 0 * infinity leaves the interval as it was
+            near = t_near > near ? t_near : near;
+            far = t_far < far ? t_far : far;
+            if (near > far) return false;
+        }
+
+        if (t0) *t0 = near;
+        if (t1) *t1 = far;
+        return true;
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N> merge(bounds<T, N> b, const point<T, N>& p)
+    {
+        return b.extend(p);
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N> merge(bounds<T, N> b0, const bounds<T, N>& b1)
+    {
+        return b0.extend(b1);
+    }
+
+    template<typename T, std::size_t N>
+    constexpr CPU_GPU bounds<T, N> intersection(const bounds<T, N>& b0, const bounds<T, N>& b1)
+    {
+        point<T, N> lo, hi;
+        for (int i = 0; i < static_cast<int>(N); ++i)
+        {
+            lo[i] = b0.get_min()[i] > b1.get_min()[i] ? b0.get_min()[i] : b1.get_min()[i];
+            hi[i] = b0.get_max()[i] < b1.get_max()[i] ? b0.get_max()[i] : b1.get_max()[i];
+            if (lo[i] > hi[i]) return {};
+        }
+        return { lo, hi };
+    }
+
+}
+
+#endif //GPU_RAYTRACE_BOUNDS_INL
@@ -0,0 +1,72 @@
+#ifndef GPU_RAYTRACE_MORTON_INL
+#define GPU_RAYTRACE_MORTON_INL
+
+#include "math/geometry/morton.hpp"
+
+namespace math
+{
+
+    namespace impl
+    {
+        // position of p in b on a grid of cells cells per axis, clamped to the grid
+        template<std::floating_point T>
+        constexpr CPU_GPU std::uint64_t quantize(const point<T, 3>& p, const bounds<T, 3>& b, int axis, std::uint64_t cells)
+        {
+            T extent = b.get_max()[axis] - b.get_min()[axis];
+            T offset = extent > 0 ? (p[axis] - b.get_min()[axis]) / extent : 0;
+            T cell = offset * static_cast<T>(cells);
+            if (!(cell > 0)) return 0;
+            if (cell >= static_cast<T>(cells - 1)) return cells - 1;
+            return static_cast<std::uint64_t>(cell);
+        }
+    }
+
+    constexpr CPU_GPU std::uint32_t spread_bits_10(std::uint32_t v)
+    {
+        v &= 0x3ffu;
+        v = (v | (v << 16)) & 0x030000ffu;
+        v = (v | (v << 8)) & 0x0300f00fu;
+        v = (v | (v << 4)) & 0x030c30c3u;
+        v = (v | (v << 2)) & 0x09249249u;
+        return v;
+    }
+
+    constexpr CPU_GPU std::uint64_t spread_bits_21(std::uint64_t v)
+    {
+        v &= 0x1fffffull;
+        v = (v | (v << 32)) & 0x001f00000000ffffull;
+        v = (v | (v << 16)) & 0x001f0000ff0000ffull;
+        v = (v | (v << 8)) & 0x100f00f00f00f00full;
+        v = (v | (v << 4)) & 0x10c30c30c30c30c3ull;
+        v = (v | (v << 2)) & 0x1249249249249249ull;
+        return v;
+    }
+
+    constexpr CPU_GPU std::uint32_t morton_encode_30(std::uint32_t x, std::uint32_t y, std::uint32_t z)
+    {
+        return spread_bits_10(x) | spread_bits_10(y) << 1 | spread_bits_10(z) << 2;
+    }
+
+    constexpr CPU_GPU std::uint64_t morton_encode_63(std::uint64_t x, std::uint64_t y, std::uint64_t z)
+    {
+        return spread_bits_21(x) | spread_bits_21(y) << 1 | spread_bits_21(z) << 2;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU std::uint32_t morton_code_30(const point<T, 3>& p, const bounds<T, 3>& b)
+    {
+        return morton_encode_30(static_cast<std::uint32_t>(impl::quantize(p, b, 0, 1u << 10)),
+                                static_cast<std::uint32_t>(impl::quantize(p, b, 1, 1u << 10)),
+                                static_cast<std::uint32_t>(impl::quantize(p, b, 2, 1u << 10)));
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU std::uint64_t morton_code_63(const point<T, 3>& p, const bounds<T, 3>& b)
+    {
+        return morton_encode_63(impl::quantize(p, b, 0, 1ull << 21), impl::quantize(p, b, 1, 1ull << 21),
+                                impl::quantize(p, b, 2, 1ull << 21));
+    }
+
+}
+
+#endif //GPU_RAYTRACE_MORTON_INL
@@ -18,12 +18,12 @@ namespace math
 
     template<typename T>
     constexpr CPU_GPU normal<T, 1>::normal(const normal& cpy) requires std::is_copy_constructible_v<value_type>
-            : _data{cpy.data}
+            : _data{cpy._data}
     {}
 
     template<typename T>
     constexpr CPU_GPU normal<T, 1>::normal(normal&& mv) requires std::is_move_constructible_v<value_type>
-            : _data{std::move(mv.data)}
+            : _data{std::move(mv._data)}
     {}
 
     template<typename T>
@@ -75,12 +75,12 @@ namespace math
 
     template<typename T>
     constexpr CPU_GPU normal<T, 2>::normal(const normal& cpy) requires std::is_copy_constructible_v<value_type>
-            : _data{cpy.data}
+            : _data{cpy._data}
     {}
 
     template<typename T>
     constexpr CPU_GPU normal<T, 2>::normal(normal&& mv) requires std::is_move_constructible_v<value_type>
-            : _data{std::move(mv.data)}
+            : _data{std::move(mv._data)}
     {}
 
     template<typename T>
@@ -126,12 +126,12 @@ namespace math
 
     template<typename T>
     constexpr CPU_GPU normal<T, 3>::normal(const normal& cpy) requires std::is_copy_constructible_v<value_type>
-            : _data{cpy.data}
+            : _data{cpy._data}
     {}
 
     template<typename T>
     constexpr CPU_GPU normal<T, 3>::normal(normal&& mv) requires std::is_move_constructible_v<value_type>
-            : _data{std::move(mv.data)}
+            : _data{std::move(mv._data)}
     {}
 
     template<typename T>
@@ -177,12 +177,12 @@ namespace math
 
     template<typename T>
     constexpr CPU_GPU normal<T, 4>::normal(const normal& cpy) requires std::is_copy_constructible_v<value_type>
-            : _data{cpy.data}
+            : _data{cpy._data}
     {}
 
     template<typename T>
     constexpr CPU_GPU normal<T, 4>::normal(normal&& mv) requires std::is_move_constructible_v<value_type>
-            : _data{std::move(mv)}
+            : _data{std::move(mv._data)}
     {}
 
     template<typename T>
@@ -14,7 +14,7 @@ namespace math
         {
             as_derived()[i] += vec[i];
         }
-        return *this;
+        return as_derived();
     }
 
     template<typename Derived>
@@ -25,7 +25,7 @@ namespace math
         {
             as_derived()[i] -= vec[i];
         }
-        return *this;
+        return as_derived();
     }
 
     template<typename Derived>
@@ -36,7 +36,7 @@ namespace math
         {
             as_derived()[i] *= vec[i];
         }
-        return *this;
+        return as_derived();
     }
 
     template<typename Derived>
@@ -47,7 +47,7 @@ namespace math
         {
             as_derived()[i] /= vec[i];
         }
-        return *this;
+        return as_derived();
     }
 
 }
@@ -27,7 +27,7 @@ namespace math
         }
 
         template<typename Point0, typename Point1>
-        using point_point_sub_t = point<decltype(std::declval<typename Point0::value_type>() + std::declval<typename Point1::value_type>()), Point0::size>;
+        using point_point_sub_t = vector<decltype(std::declval<typename Point0::value_type>() - std::declval<typename Point1::value_type>()), Point0::size>;
 
         template<typename Point0, typename Point1, std::size_t... Ns>
         constexpr CPU_GPU point_point_sub_t<Point0, Point1> point_point_sub(const Point0& p0, const Point1& p1, std::index_sequence<Ns...>)
@@ -64,7 +64,7 @@ namespace math
     template<typename T, std::size_t N0, typename U, std::size_t N1>
     constexpr CPU_GPU auto operator-(const point<T, N0>& pt0, const point<U, N1>& pt1) requires (N0 == N1) && requires(T a, U b) { a - b; }
     {
-        return impl::point_point_sub<point<T, N0>, point<T, N1>>(pt0, pt1, std::make_index_sequence<N0>{});
+        return impl::point_point_sub<point<T, N0>, point<U, N1>>(pt0, pt1, std::make_index_sequence<N0>{});
     }
 
     template<typename T, typename U, std::size_t N>
@@ -53,7 +53,7 @@ namespace math
     template<std::floating_point T, std::size_t N>
     constexpr CPU_GPU T tracked_ray<T, N>::get_time() const
     {
-        return time;
+        return _time;
     }
 
     template<std::floating_point T, std::size_t N>
@@ -0,0 +1,150 @@
+#ifndef GPU_RAYTRACE_RAY_PACKET_INL
+#define GPU_RAYTRACE_RAY_PACKET_INL
+
+#include "math/geometry/ray_packet.hpp"
+
+#include <cmath>
+
+namespace math
+{
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU ray_packet<T, W>::ray_packet(const vector_type& origin, const vector_type& direction, const lane_type& tmin, const lane_type& tmax, const mask_type& active)
+    : _origin{ origin }, _direction{ direction }, _tmin{ tmin }, _tmax{ tmax }, _active{ active }
+    {
+        for (int i = 0; i < 3; ++i) _inv_direction[i] = lane_type{ 1 } / _direction[i];
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU ray_packet<T, W> ray_packet<T, W>::load(std::span<const ray<T, 3>> rays, T tmin, T tmax)
+    {
+        // transpose through a buffer so that each lane is a single load
+        alignas(64) T components[6][W]{};
+        std::size_t count = rays.size() < W ? rays.size() : W;
+        for (std::size_t r = 0; r < count; ++r)
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                components[i][r] = rays[r].get_origin()[i];
+                components[3 + i][r] = rays[r].get_direction()[i];
+            }
+        }
+
+        vector_type origin, direction;
+        for (int i = 0; i < 3; ++i)
+        {
+            origin[i] = lane_type::load_aligned(components[i]);
+            direction[i] = lane_type::load_aligned(components[3 + i]);
+        }
+        return { origin, direction, lane_type{ tmin }, lane_type{ tmax }, mask_type::from_bits(count == 32 ? ~0u : (1u << count) - 1) };
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU ray<T, 3> ray_packet<T, W>::extract(std::size_t idx) const
+    {
+        return { point<T, 3>{ _origin[0][idx], _origin[1][idx], _origin[2][idx] }, _direction.extract(idx) };
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU void ray_packet<T, W>::insert(std::size_t idx, const ray<T, 3>& r, T tmin, T tmax)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            _origin[i].set(idx, r.get_origin()[i]);
+            _direction[i].set(idx, r.get_direction()[i]);
+            _inv_direction[i].set(idx, 1 / r.get_direction()[i]);
+        }
+        _tmin.set(idx, tmin);
+        _tmax.set(idx, tmax);
+        _active = mask_type::from_bits(_active.bits() | (1u << idx));
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU const typename ray_packet<T, W>::vector_type& ray_packet<T, W>::get_origin() const
+    {
+        return _origin;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU const typename ray_packet<T, W>::vector_type& ray_packet<T, W>::get_direction() const
+    {
+        return _direction;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU const typename ray_packet<T, W>::vector_type& ray_packet<T, W>::get_inv_direction() const
+    {
+        return _inv_direction;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU typename ray_packet<T, W>::lane_type& ray_packet<T, W>::get_tmin()
+    {
+        return _tmin;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU const typename ray_packet<T, W>::lane_type& ray_packet<T, W>::get_tmin() const
+    {
+        return _tmin;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU typename ray_packet<T, W>::lane_type& ray_packet<T, W>::get_tmax()
+    {
+        return _tmax;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU const typename ray_packet<T, W>::lane_type& ray_packet<T, W>::get_tmax() const
+    {
+        return _tmax;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU const typename ray_packet<T, W>::mask_type& ray_packet<T, W>::get_active() const
+    {
+        return _active;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU void ray_packet<T, W>::set_active(const mask_type& active)
+    {
+        _active = active;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU int ray_packet<T, W>::common_octant() const
+    {
+        // a lane is negative along an axis when its reciprocal is, which also catches negative zeros
+        lane_type zero{ 0 };
+        std::uint32_t negative[3];
+        for (int i = 0; i < 3; ++i) negative[i] = (_inv_direction[i] < zero).bits() & _active.bits();
+
+        std::uint32_t active = _active.bits();
+        int octant = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            if (negative[i] == active) octant |= 1 << i;
+            else if (negative[i] != 0) return -1;
+        }
+        return octant;
+    }
+
+    template<std::floating_point T, std::size_t W>
+    CPU_GPU typename ray_packet<T, W>::vector_type ray_packet<T, W>::at(const lane_type& t) const
+    {
+        return fma(_direction, vector_type{ t, t, t }, _origin);
+    }
+
+    template<std::floating_point T>
+    CPU_GPU std::uint32_t direction_octant(const vector<T, 3>& direction)
+    {
+        std::uint32_t octant = 0;
+        for (int i = 0; i < 3; ++i) octant |= static_cast<std::uint32_t>(std::signbit(direction[i])) << i;
+        return octant;
+    }
+
+}
+
+#endif //GPU_RAYTRACE_RAY_PACKET_INL
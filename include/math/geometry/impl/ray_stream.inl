@@ -0,0 +1,283 @@
+#ifndef GPU_RAYTRACE_RAY_STREAM_INL
+#define GPU_RAYTRACE_RAY_STREAM_INL
+
+#include "math/geometry/ray_stream.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+
+#include "base/radix_sort.hpp"
+
+namespace math
+{
+
+    template<std::floating_point T>
+    ray_stream<T>::ray_stream(std::size_t capacity)
+    {
+        reserve(capacity);
+    }
+
+    template<std::floating_point T>
+    std::size_t ray_stream<T>::size() const
+    {
+        return _ids.size();
+    }
+
+    template<std::floating_point T>
+    bool ray_stream<T>::empty() const
+    {
+        return _ids.empty();
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::reserve(std::size_t capacity)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            _origin[i].reserve(capacity);
+            _direction[i].reserve(capacity);
+        }
+        _tmin.reserve(capacity);
+        _tmax.reserve(capacity);
+        _ids.reserve(capacity);
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::clear()
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            _origin[i].clear();
+            _direction[i].clear();
+        }
+        _tmin.clear();
+        _tmax.clear();
+        _ids.clear();
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::push_back(const ray<T, 3>& r, T tmin, T tmax)
+    {
+        push_back(r, tmin, tmax, static_cast<std::uint32_t>(size()));
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::push_back(const ray<T, 3>& r, T tmin, T tmax, std::uint32_t id)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            _origin[i].push_back(r.get_origin()[i]);
+            _direction[i].push_back(r.get_direction()[i]);
+        }
+        _tmin.push_back(tmin);
+        _tmax.push_back(tmax);
+        _ids.push_back(id);
+    }
+
+    template<std::floating_point T>
+    ray<T, 3> ray_stream<T>::get_ray(std::size_t idx) const
+    {
+        return {
+            point<T, 3>{ _origin[0][idx], _origin[1][idx], _origin[2][idx] },
+            vector<T, 3>{ _direction[0][idx], _direction[1][idx], _direction[2][idx] }
+        };
+    }
+
+    template<std::floating_point T>
+    T ray_stream<T>::get_tmin(std::size_t idx) const
+    {
+        return _tmin[idx];
+    }
+
+    template<std::floating_point T>
+    T ray_stream<T>::get_tmax(std::size_t idx) const
+    {
+        return _tmax[idx];
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::set_tmax(std::size_t idx, T tmax)
+    {
+        _tmax[idx] = tmax;
+    }
+
+    template<std::floating_point T>
+    std::uint32_t ray_stream<T>::get_id(std::size_t idx) const
+    {
+        return _ids[idx];
+    }
+
+    template<std::floating_point T>
+    std::span<const T> ray_stream<T>::origins(int axis) const
+    {
+        return _origin[axis];
+    }
+
+    template<std::floating_point T>
+    std::span<const T> ray_stream<T>::directions(int axis) const
+    {
+        return _direction[axis];
+    }
+
+    template<std::floating_point T>
+    std::span<const T> ray_stream<T>::tmins() const
+    {
+        return _tmin;
+    }
+
+    template<std::floating_point T>
+    std::span<T> ray_stream<T>::tmaxs()
+    {
+        return _tmax;
+    }
+
+    template<std::floating_point T>
+    std::span<const T> ray_stream<T>::tmaxs() const
+    {
+        return _tmax;
+    }
+
+    template<std::floating_point T>
+    std::span<const std::uint32_t> ray_stream<T>::ids() const
+    {
+        return _ids;
+    }
+
+    template<std::floating_point T>
+    template<std::size_t W>
+    ray_packet<T, W> ray_stream<T>::packet(std::size_t first) const
+    {
+        using packet_type = ray_packet<T, W>;
+        using lane_type = typename packet_type::lane_type;
+
+        std::size_t count = first < size() ? std::min(W, size() - first) : 0;
+        if (count == W)
+        {
+            typename packet_type::vector_type origin, direction;
+            for (int i = 0; i < 3; ++i)
+            {
+                origin[i] = lane_type::load(_origin[i].data() + first);
+                direction[i] = lane_type::load(_direction[i].data() + first);
+            }
+            return { origin, direction, lane_type::load(_tmin.data() + first), lane_type::load(_tmax.data() + first),
+                     typename packet_type::mask_type{ true } };
+        }
+
+        packet_type p;
+        for (std::size_t r = 0; r < count; ++r) p.insert(r, get_ray(first + r), _tmin[first + r], _tmax[first + r]);
+        return p;
+    }
+
+    template<std::floating_point T>
+    template<std::size_t W>
+    void ray_stream<T>::store_tmax(std::size_t first, const ray_packet<T, W>& p)
+    {
+        for (std::size_t r = 0; r < W && first + r < size(); ++r)
+        {
+            if (p.get_active()[r]) _tmax[first + r] = p.get_tmax()[r];
+        }
+    }
+
+    template<std::floating_point T>
+    template<typename Pred>
+    std::size_t ray_stream<T>::compact(Pred keep)
+    {
+        std::size_t n = size(), kept = 0;
+        for (std::size_t r = 0; r < n; ++r)
+        {
+            if (!keep(r)) continue;
+            if (kept != r)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    _origin[i][kept] = _origin[i][r];
+                    _direction[i][kept] = _direction[i][r];
+                }
+                _tmin[kept] = _tmin[r];
+                _tmax[kept] = _tmax[r];
+                _ids[kept] = _ids[r];
+            }
+            ++kept;
+        }
+
+        for (int i = 0; i < 3; ++i)
+        {
+            _origin[i].resize(kept);
+            _direction[i].resize(kept);
+        }
+        _tmin.resize(kept);
+        _tmax.resize(kept);
+        _ids.resize(kept);
+        return n - kept;
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::permute(const std::vector<std::uint32_t>& order)
+    {
+        auto gather = [&](auto& values)
+        {
+            std::remove_reference_t<decltype(values)> sorted(values.size());
+            for (std::size_t r = 0; r < order.size(); ++r) sorted[r] = values[order[r]];
+            values.swap(sorted);
+        };
+
+        for (int i = 0; i < 3; ++i)
+        {
+            gather(_origin[i]);
+            gather(_direction[i]);
+        }
+        gather(_tmin);
+        gather(_tmax);
+        gather(_ids);
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::sort_by_keys(std::vector<std::uint64_t>& keys, int bits)
+    {
+        std::vector<std::uint32_t> order(size());
+        std::iota(order.begin(), order.end(), 0);
+        base::radix_sort(std::span<std::uint64_t>{ keys }, std::span<std::uint32_t>{ order }, bits);
+        permute(order);
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::sort_by_octant()
+    {
+        std::vector<std::uint64_t> keys(size());
+        for (std::size_t r = 0; r < size(); ++r)
+        {
+            keys[r] = direction_octant(vector<T, 3>{ _direction[0][r], _direction[1][r], _direction[2][r] });
+        }
+        sort_by_keys(keys, 3);
+    }
+
+    template<std::floating_point T>
+    void ray_stream<T>::sort_by_octant_and_origin()
+    {
+        if (empty()) return;
+
+        T lo[3], scale[3];
+        for (int i = 0; i < 3; ++i)
+        {
+            auto [min, max] = std::minmax_element(_origin[i].begin(), _origin[i].end());
+            lo[i] = *min;
+            scale[i] = *max > *min ? static_cast<T>(1023) / (*max - *min) : 0;
+        }
+
+        // the octant above a 30-bit Morton code of the origin quantized to 10 bits per axis
+        std::vector<std::uint64_t> keys(size());
+        for (std::size_t r = 0; r < size(); ++r)
+        {
+            std::uint32_t cell[3];
+            for (int i = 0; i < 3; ++i) cell[i] = static_cast<std::uint32_t>((_origin[i][r] - lo[i]) * scale[i]);
+            std::uint64_t morton = morton_encode_30(cell[0], cell[1], cell[2]);
+            std::uint64_t octant = direction_octant(vector<T, 3>{ _direction[0][r], _direction[1][r], _direction[2][r] });
+            keys[r] = octant << 30 | morton;
+        }
+        sort_by_keys(keys, 33);
+    }
+
+}
+
+#endif //GPU_RAYTRACE_RAY_STREAM_INL
@@ -0,0 +1,208 @@
+#ifndef GPU_RAYTRACE_TRANSFORM_INL
+#define GPU_RAYTRACE_TRANSFORM_INL
+
+#include "math/geometry/transform.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+namespace math
+{
+
+    namespace impl
+    {
+        template<typename T>
+        constexpr CPU_GPU void copy_matrix(const T (&from)[3][4], T (&to)[3][4])
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 4; ++j) to[i][j] = from[i][j];
+            }
+        }
+
+        /**
+         * composes two 3 by 4 affine matrices, applying b then a.
+         */
+        template<typename T>
+        constexpr CPU_GPU void compose(const T (&a)[3][4], const T (&b)[3][4], T (&out)[3][4])
+        {
+            for (int i = 0; i < 3; ++i)
+            {
+                for (int j = 0; j < 4; ++j)
+                {
+                    out[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j] + (j == 3 ? a[i][3] : 0);
+                }
+            }
+        }
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU transform<T>::transform() : _m{}, _inv{}
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            _m[i][i] = 1;
+            _inv[i][i] = 1;
+        }
+    }
+
+    template<std::floating_point T>
+    transform<T>::transform(const matrix_type& m) : _m{}, _inv{}
+    {
+        impl::copy_matrix(m, _m);
+
+        // inverse of the linear part from its adjugate
+        T cofactor[3][3];
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                int i0 = (i + 1) % 3, i1 = (i + 2) % 3, j0 = (j + 1) % 3, j1 = (j + 2) % 3;
+                cofactor[i][j] = m[i0][j0] * m[i1][j1] - m[i0][j1] * m[i1][j0];
+            }
+        }
+        T det = m[0][0] * cofactor[0][0] + m[0][1] * cofactor[0][1] + m[0][2] * cofactor[0][2];
+        if (det == 0 || !std::isfinite(det)) throw std::invalid_argument{ "transform matrix must be invertible" };
+
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j) _inv[i][j] = cofactor[j][i] / det;
+        }
+        for (int i = 0; i < 3; ++i)
+        {
+            _inv[i][3] = -(_inv[i][0] * m[0][3] + _inv[i][1] * m[1][3] + _inv[i][2] * m[2][3]);
+        }
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU transform<T>::transform(const matrix_type& m, const matrix_type& inv) : _m{}, _inv{}
+    {
+        impl::copy_matrix(m, _m);
+        impl::copy_matrix(inv, _inv);
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU auto transform<T>::get_matrix() const -> const matrix_type&
+    {
+        return _m;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU auto transform<T>::get_inverse_matrix() const -> const matrix_type&
+    {
+        return _inv;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU transform<T> transform<T>::inverse() const
+    {
+        return { _inv, _m };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU bool transform<T>::swaps_handedness() const
+    {
+        T det = _m[0][0] * (_m[1][1] * _m[2][2] - _m[1][2] * _m[2][1])
+              - _m[0][1] * (_m[1][0] * _m[2][2] - _m[1][2] * _m[2][0])
+              + _m[0][2] * (_m[1][0] * _m[2][1] - _m[1][1] * _m[2][0]);
+        return det < 0;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU point<T, 3> transform<T>::operator()(const point<T, 3>& p) const
+    {
+        return { _m[0][0] * p[0] + _m[0][1] * p[1] + _m[0][2] * p[2] + _m[0][3],
+                 _m[1][0] * p[0] + _m[1][1] * p[1] + _m[1][2] * p[2] + _m[1][3],
+                 _m[2][0] * p[0] + _m[2][1] * p[1] + _m[2][2] * p[2] + _m[2][3] };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU vector<T, 3> transform<T>::operator()(const vector<T, 3>& v) const
+    {
+        return { _m[0][0] * v[0] + _m[0][1] * v[1] + _m[0][2] * v[2],
+                 _m[1][0] * v[0] + _m[1][1] * v[1] + _m[1][2] * v[2],
+                 _m[2][0] * v[0] + _m[2][1] * v[1] + _m[2][2] * v[2] };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU normal<T, 3> transform<T>::operator()(const normal<T, 3>& n) const
+    {
+        return { _inv[0][0] * n[0] + _inv[1][0] * n[1] + _inv[2][0] * n[2],
+                 _inv[0][1] * n[0] + _inv[1][1] * n[1] + _inv[2][1] * n[2],
+                 _inv[0][2] * n[0] + _inv[1][2] * n[1] + _inv[2][2] * n[2] };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU ray<T, 3> transform<T>::operator()(const ray<T, 3>& r) const
+    {
+        return { (*this)(r.get_origin()), (*this)(r.get_direction()) };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU bounds<T, 3> transform<T>::operator()(const bounds<T, 3>& b) const
+    {
+        if (b.is_empty()) return {};
+
+        // each output axis is the translation plus the smaller or larger of each scaled input extent (Arvo 1990)
+        point<T, 3> lo, hi;
+        for (int i = 0; i < 3; ++i)
+        {
+            lo[i] = hi[i] = _m[i][3];
+            for (int j = 0; j < 3; ++j)
+            {
+                T a = _m[i][j] * b.get_min()[j], c = _m[i][j] * b.get_max()[j];
+                lo[i] += a < c ? a : c;
+                hi[i] += a < c ? c : a;
+            }
+        }
+        return { lo, hi };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU transform<T> operator*(const transform<T>& t0, const transform<T>& t1)
+    {
+        T m[3][4], inv[3][4];
+        impl::compose(t0.get_matrix(), t1.get_matrix(), m);
+        impl::compose(t1.get_inverse_matrix(), t0.get_inverse_matrix(), inv);
+        return { m, inv };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU transform<T> translate(const vector<T, 3>& delta)
+    {
+        T m[3][4] = { { 1, 0, 0, delta[0] }, { 0, 1, 0, delta[1] }, { 0, 0, 1, delta[2] } };
+        T inv[3][4] = { { 1, 0, 0, -delta[0] }, { 0, 1, 0, -delta[1] }, { 0, 0, 1, -delta[2] } };
+        return { m, inv };
+    }
+
+    template<std::floating_point T>
+    transform<T> scale(T x, T y, T z)
+    {
+        if (x == 0 || y == 0 || z == 0) throw std::invalid_argument{ "scale factors must not be zero" };
+        T m[3][4] = { { x, 0, 0, 0 }, { 0, y, 0, 0 }, { 0, 0, z, 0 } };
+        T inv[3][4] = { { 1 / x, 0, 0, 0 }, { 0, 1 / y, 0, 0 }, { 0, 0, 1 / z, 0 } };
+        return { m, inv };
+    }
+
+    template<std::floating_point T>
+    CPU_GPU transform<T> rotate(T theta, const vector<T, 3>& axis)
+    {
+        T length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        T x = axis[0] / length, y = axis[1] / length, z = axis[2] / length;
+        T s = std::sin(theta), c = std::cos(theta), t = 1 - c;
+
+        // Rodrigues' rotation matrix, whose inverse is its transpose
+        T m[3][4] = { { t * x * x + c, t * x * y - s * z, t * x * z + s * y, 0 },
+                      { t * x * y + s * z, t * y * y + c, t * y * z - s * x, 0 },
+                      { t * x * z - s * y, t * y * z + s * x, t * z * z + c, 0 } };
+        T inv[3][4] = {};
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j) inv[i][j] = m[j][i];
+        }
+        return { m, inv };
+    }
+
+}
+
+#endif //GPU_RAYTRACE_TRANSFORM_INL
@@ -79,9 +79,9 @@ namespace math
         }
 
         template<typename T, vector_like Vector, std::size_t... Indices>
-        constexpr CPU_GPU lscale_ret_t<T, Vector> lscale(const T& t, const Vector& v, std::index_sequence<Indices...>)
+        constexpr CPU_GPU lscale_ret_t<Vector, T> lscale(const T& t, const Vector& v, std::index_sequence<Indices...>)
         {
-            return lscale_ret_t<T, Vector>{ (t * v[Indices])... };
+            return lscale_ret_t<Vector, T>{ (t * v[Indices])... };
         }
 
         template<vector_like Vector0, vector_like Vector1>
@@ -106,9 +106,9 @@ namespace math
         }
 
         template<typename T, vector_like Vector, std::size_t... Indices>
-        constexpr CPU_GPU ldscale_ret_t<T, Vector> ldscale(const T& t, const Vector& v, std::index_sequence<Indices...>)
+        constexpr CPU_GPU ldscale_ret_t<Vector, T> ldscale(const T& t, const Vector& v, std::index_sequence<Indices...>)
         {
-            return lscale_ret_t<T, Vector>{ (t / v[Indices])... };
+            return ldscale_ret_t<Vector, T>{ (t / v[Indices])... };
         }
 
         template<vector_like Vector0, vector_like Vector1, std::size_t... Indices>
@@ -193,7 +193,7 @@ namespace math
     template<typename T, vector_like Vector> requires requires(std::remove_cvref_t<T> a, typename std::remove_cvref_t<Vector>::value_type b) { a * b; }
     constexpr CPU_GPU auto operator*(T t, const Vector& v)
     {
-        return impl::lscale(v, t, std::make_index_sequence<std::remove_cvref_t<Vector>::size>{});
+        return impl::lscale(t, v, std::make_index_sequence<std::remove_cvref_t<Vector>::size>{});
     }
 
     template<vector_like Vector0, vector_like Vector1> requires (std::remove_cvref_t<Vector0>::size == std::remove_cvref_t<Vector1>::size) && requires(typename std::remove_cvref_t<Vector0>::value_type a, typename std::remove_cvref_t<Vector1>::value_type b) { a / b; }
@@ -211,7 +211,7 @@ namespace math
     template<typename T, vector_like Vector> requires requires(std::remove_cvref_t<T> a, typename std::remove_cvref_t<Vector>::value_type b) { a / b; }
     constexpr CPU_GPU auto operator/(T t, const Vector& v)
     {
-        return impl::ldscale(v, t, std::make_index_sequence<std::remove_cvref_t<Vector>::size>{});
+        return impl::ldscale(t, v, std::make_index_sequence<std::remove_cvref_t<Vector>::size>{});
     }
 
     template<vector_like Vector0, vector_like Vector1> requires (std::remove_cvref_t<Vector0>::size == std::remove_cvref_t<Vector1>::size) && requires(typename std::remove_cvref_t<Vector0>::value_type a, typename std::remove_cvref_t<Vector1>::value_type b) { a * b + a * b; }
@@ -255,13 +255,13 @@ namespace math
     }
 
     template<vector_like Vector> requires requires(typename std::remove_cvref_t<Vector>::value_type a) { { a < a } -> std::same_as<bool>; }
-    constexpr CPU_GPU auto min(const Vector& v0, const Vector& v1)
+    constexpr CPU_GPU auto min(const Vector& v0, const Vector& v1) -> std::remove_cvref_t<Vector>
     {
         return impl::min(v0, v1, std::make_index_sequence<std::remove_cvref_t<Vector>::size>{});
     }
 
     template<vector_like Vector> requires requires(typename std::remove_cvref_t<Vector>::value_type a) { { a < a } -> std::same_as<bool>; }
-    constexpr CPU_GPU auto max(const Vector& v0, const Vector& v1)
+    constexpr CPU_GPU auto max(const Vector& v0, const Vector& v1) -> std::remove_cvref_t<Vector>
     {
         return impl::max(v0, v1, std::make_index_sequence<std::remove_cvref_t<Vector>::size>{});
     }
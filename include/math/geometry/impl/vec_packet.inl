@@ -0,0 +1,246 @@
+#ifndef GPU_RAYTRACE_VEC_PACKET_INL
+#define GPU_RAYTRACE_VEC_PACKET_INL
+
+#include "math/geometry/vec_packet.hpp"
+
+namespace math
+{
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W>::vector_packet(const vector<T, N>& vec)
+    {
+        for (std::size_t i = 0; i < N; ++i) _lanes[i] = lane_type{ vec[i] };
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    template<typename... Lanes>
+    CPU_GPU vector_packet<T, N, W>::vector_packet(const Lanes&... lanes) requires (sizeof...(Lanes) == N && N > 1) && std::conjunction_v<std::is_convertible<Lanes, lane_type>...>
+    : _lanes{ lane_type{ lanes }... } {}
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> vector_packet<T, N, W>::load(std::span<const vector<T, N>> vecs)
+    {
+        // transpose through a buffer so that each lane is a single load
+        alignas(64) T components[N][W]{};
+        std::size_t count = vecs.size() < W ? vecs.size() : W;
+        for (std::size_t v = 0; v < count; ++v)
+        {
+            for (std::size_t i = 0; i < N; ++i) components[i][v] = vecs[v][i];
+        }
+
+        vector_packet p;
+        for (std::size_t i = 0; i < N; ++i) p._lanes[i] = lane_type::load_aligned(components[i]);
+        return p;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU void vector_packet<T, N, W>::store(std::span<vector<T, N>> vecs) const
+    {
+        alignas(64) T components[N][W];
+        for (std::size_t i = 0; i < N; ++i) _lanes[i].store_aligned(components[i]);
+
+        std::size_t count = vecs.size() < W ? vecs.size() : W;
+        for (std::size_t v = 0; v < count; ++v)
+        {
+            for (std::size_t i = 0; i < N; ++i) vecs[v][i] = components[i][v];
+        }
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector<T, N> vector_packet<T, N, W>::extract(std::size_t idx) const
+    {
+        vector<T, N> vec;
+        for (std::size_t i = 0; i < N; ++i) vec[i] = _lanes[i][idx];
+        return vec;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU void vector_packet<T, N, W>::insert(std::size_t idx, const vector<T, N>& vec)
+    {
+        for (std::size_t i = 0; i < N; ++i) _lanes[i].set(idx, vec[i]);
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU typename vector_packet<T, N, W>::lane_type& vector_packet<T, N, W>::operator[](int idx)
+    {
+        return _lanes[idx];
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU const typename vector_packet<T, N, W>::lane_type& vector_packet<T, N, W>::operator[](int idx) const
+    {
+        return _lanes[idx];
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W>& vector_packet<T, N, W>::operator+=(const vector_packet& p)
+    {
+        for (std::size_t i = 0; i < N; ++i) _lanes[i] += p._lanes[i];
+        return *this;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W>& vector_packet<T, N, W>::operator-=(const vector_packet& p)
+    {
+        for (std::size_t i = 0; i < N; ++i) _lanes[i] -= p._lanes[i];
+        return *this;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W>& vector_packet<T, N, W>::operator*=(const vector_packet& p)
+    {
+        for (std::size_t i = 0; i < N; ++i) _lanes[i] *= p._lanes[i];
+        return *this;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W>& vector_packet<T, N, W>::operator*=(const lane_type& l)
+    {
+        for (std::size_t i = 0; i < N; ++i) _lanes[i] *= l;
+        return *this;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W>& vector_packet<T, N, W>::operator/=(const lane_type& l)
+    {
+        // one division shared by every component
+        lane_type inverse = lane_type{ 1 } / l;
+        for (std::size_t i = 0; i < N; ++i) _lanes[i] *= inverse;
+        return *this;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator+(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1)
+    {
+        vector_packet<T, N, W> p = p0;
+        return p += p1;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator-(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1)
+    {
+        vector_packet<T, N, W> p = p0;
+        return p -= p1;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator-(const vector_packet<T, N, W>& p)
+    {
+        vector_packet<T, N, W> negated;
+        for (std::size_t i = 0; i < N; ++i) negated[i] = -p[i];
+        return negated;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator*(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1)
+    {
+        vector_packet<T, N, W> p = p0;
+        return p *= p1;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator*(const vector_packet<T, N, W>& p, const std::type_identity_t<lane<T, W>>& l)
+    {
+        vector_packet<T, N, W> scaled = p;
+        return scaled *= l;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator*(const std::type_identity_t<lane<T, W>>& l, const vector_packet<T, N, W>& p)
+    {
+        return p * l;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator/(const vector_packet<T, N, W>& p, const std::type_identity_t<lane<T, W>>& l)
+    {
+        vector_packet<T, N, W> scaled = p;
+        return scaled /= l;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU lane<T, W> dot(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1)
+    {
+        lane<T, W> sum = p0[0] * p1[0];
+        for (std::size_t i = 1; i < N; ++i) sum = fma(p0[i], p1[i], sum);
+        return sum;
+    }
+
+    template<typename T, std::size_t W>
+    CPU_GPU vector_packet<T, 3, W> cross(const vector_packet<T, 3, W>& p0, const vector_packet<T, 3, W>& p1)
+    {
+        return vector_packet<T, 3, W>{
+            p0[1] * p1[2] - p0[2] * p1[1],
+            p0[2] * p1[0] - p0[0] * p1[2],
+            p0[0] * p1[1] - p0[1] * p1[0]
+        };
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU lane<T, W> magnitude(const vector_packet<T, N, W>& p)
+    {
+        return sqrt(dot(p, p));
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> normalize(const vector_packet<T, N, W>& p)
+    {
+        return p / magnitude(p);
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> lerp(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1, const std::type_identity_t<lane<T, W>>& t)
+    {
+        vector_packet<T, N, W> p;
+        for (std::size_t i = 0; i < N; ++i) p[i] = fma(t, p1[i] - p0[i], p0[i]);
+        return p;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> fma(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1, const vector_packet<T, N, W>& p2)
+    {
+        vector_packet<T, N, W> p;
+        for (std::size_t i = 0; i < N; ++i) p[i] = fma(p0[i], p1[i], p2[i]);
+        return p;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> min(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1)
+    {
+        vector_packet<T, N, W> p;
+        for (std::size_t i = 0; i < N; ++i) p[i] = min(p0[i], p1[i]);
+        return p;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> max(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1)
+    {
+        vector_packet<T, N, W> p;
+        for (std::size_t i = 0; i < N; ++i) p[i] = max(p0[i], p1[i]);
+        return p;
+    }
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> select(const typename lane<T, W>::mask_type& m, const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1)
+    {
+        vector_packet<T, N, W> p;
+        for (std::size_t i = 0; i < N; ++i) p[i] = select(m, p0[i], p1[i]);
+        return p;
+    }
+
+    template<typename T, std::size_t W>
+    CPU_GPU std::pair<vector_packet<T, 3, W>, vector_packet<T, 3, W>> coordinate_system(const vector_packet<T, 3, W>& p)
+    {
+        using lane_t = lane<T, W>;
+        lane_t sign = copysign(lane_t{ 1 }, p[2]);
+        lane_t a = lane_t{ -1 } / (sign + p[2]);
+        lane_t b = p[0] * p[1] * a;
+        return std::pair{
+            vector_packet<T, 3, W>{ fma(sign * p[0] * p[0], a, lane_t{ 1 }), sign * b, -sign * p[0] },
+            vector_packet<T, 3, W>{ b, fma(p[1] * p[1], a, sign), -p[1] }
+        };
+    }
+
+}
+
+#endif //GPU_RAYTRACE_VEC_PACKET_INL
@@ -0,0 +1,58 @@
+#ifndef GPU_RAYTRACE_MORTON_HPP
+#define GPU_RAYTRACE_MORTON_HPP
+
+#include <concepts>
+#include <cstdint>
+
+#include "gpu/gpu.hpp"
+#include "bounds.hpp"
+#include "point.hpp"
+
+namespace math
+{
+
+    /**
+     * moves the low 10 bits of v to every third bit, so that three of them interleave into a 30-bit Morton code.
+     */
+    constexpr CPU_GPU std::uint32_t spread_bits_10(std::uint32_t v);
+
+    /**
+     * moves the low 21 bits of v to every third bit, so that three of them interleave into a 63-bit Morton code.
+     */
+    constexpr CPU_GPU std::uint64_t spread_bits_21(std::uint64_t v);
+
+    /**
+     * interleaves three 10-bit coordinates, x in the lowest bit of each triple and z in the highest.
+     * @return code in the low 30 bits
+     */
+    constexpr CPU_GPU std::uint32_t morton_encode_30(std::uint32_t x, std::uint32_t y, std::uint32_t z);
+
+    /**
+     * interleaves three 21-bit coordinates, x in the lowest bit of each triple and z in the highest.
+     * @return code in the low 63 bits
+     */
+    constexpr CPU_GPU std::uint64_t morton_encode_63(std::uint64_t x, std::uint64_t y, std::uint64_t z);
+
+    /**
+     * Morton code of a point on a grid of 2^10 cells per axis over a box.
+     * @param p point inside b. points outside are clamped to it
+     * @param b box the grid spans
+     * @return code in the low 30 bits
+     */
+    template<std::floating_point T>
+    constexpr CPU_GPU std::uint32_t morton_code_30(const point<T, 3>& p, const bounds<T, 3>& b);
+
+    /**
+     * Morton code of a point on a grid of 2^21 cells per axis over a box.
+     * @param p point inside b. points outside are clamped to it
+     * @param b box the grid spans
+     * @return code in the low 63 bits
+     */
+    template<std::floating_point T>
+    constexpr CPU_GPU std::uint64_t morton_code_63(const point<T, 3>& p, const bounds<T, 3>& b);
+
+}
+
+#include "impl/morton.inl"
+
+#endif //GPU_RAYTRACE_MORTON_HPP
@@ -58,4 +58,6 @@ namespace math
 
 }
 
+#include "impl/ray.inl"
+
 #endif //GPU_RAYTRACE_RAY_HPP
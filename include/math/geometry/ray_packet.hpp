@@ -0,0 +1,118 @@
+#ifndef GPU_RAYTRACE_RAY_PACKET_HPP
+#define GPU_RAYTRACE_RAY_PACKET_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <span>
+
+#include "ray.hpp"
+#include "vec_packet.hpp"
+
+namespace math
+{
+
+    /**
+     * W rays of three dimensions stored as lanes (structure of arrays), the input of the packet traversal kernels.
+     * along with the origins and directions it keeps the reciprocals of the directions for slab tests, the interval
+     * [tmin, tmax] searched along each ray and the mask of the lanes still being traced.
+     * a zero direction component has an infinite reciprocal of the same sign, which the slab tests rely on.
+     * @tparam T floating point type
+     * @tparam W number of rays in the packet
+     */
+    template<std::floating_point T, std::size_t W = native_width<T>>
+    class ray_packet
+    {
+    public:
+        using value_type = T;
+        using lane_type = lane<T, W>;
+        using mask_type = typename lane_type::mask_type;
+        using vector_type = vector_packet<T, 3, W>;
+        constexpr static std::size_t width = W;
+    private:
+        vector_type _origin;
+        vector_type _direction;
+        vector_type _inv_direction;
+        lane_type _tmin;
+        lane_type _tmax;
+        mask_type _active;
+    public:
+        /**
+         * an empty packet. no lane is active.
+         */
+        CPU_GPU ray_packet() = default;
+
+        /**
+         * @param origin origins of the rays
+         * @param direction directions of the rays
+         * @param tmin start of the interval searched along each ray
+         * @param tmax end of the interval searched along each ray
+         * @param active lanes holding rays
+         */
+        CPU_GPU ray_packet(const vector_type& origin, const vector_type& direction, const lane_type& tmin, const lane_type& tmax, const mask_type& active);
+
+        /**
+         * gathers up to W rays into the lanes. the lanes past the rays are inactive.
+         * @param rays rays in lane order
+         * @param tmin start of the interval searched along every ray
+         * @param tmax end of the interval searched along every ray
+         * @return packet of the rays
+         */
+        static CPU_GPU ray_packet load(std::span<const ray<T, 3>> rays, T tmin = 0, T tmax = std::numeric_limits<T>::infinity());
+
+        /**
+         * @param idx lane index
+         * @return the ray held by a lane
+         */
+        CPU_GPU ray<T, 3> extract(std::size_t idx) const;
+
+        /**
+         * places a ray in a lane and activates it.
+         * @param idx lane index
+         * @param r ray to place in the lane
+         * @param tmin start of the interval searched along the ray
+         * @param tmax end of the interval searched along the ray
+         */
+        CPU_GPU void insert(std::size_t idx, const ray<T, 3>& r, T tmin = 0, T tmax = std::numeric_limits<T>::infinity());
+
+        CPU_GPU const vector_type& get_origin() const;
+        CPU_GPU const vector_type& get_direction() const;
+        CPU_GPU const vector_type& get_inv_direction() const;
+
+        CPU_GPU lane_type& get_tmin();
+        CPU_GPU const lane_type& get_tmin() const;
+
+        /**
+         * traversal shortens the rays by lowering tmax to the closest hit found so far.
+         */
+        CPU_GPU lane_type& get_tmax();
+        CPU_GPU const lane_type& get_tmax() const;
+
+        CPU_GPU const mask_type& get_active() const;
+        CPU_GPU void set_active(const mask_type& active);
+
+        /**
+         * @return the octant shared by the directions of every active lane, with bit i set when component i is
+         * negative, or -1 if they differ. a packet with a common octant visits children in the same order on every lane.
+         */
+        CPU_GPU int common_octant() const;
+
+        /**
+         * @param t distance along each ray
+         * @return the points at t along the rays
+         */
+        CPU_GPU vector_type at(const lane_type& t) const;
+    };
+
+    /**
+     * @param direction direction of a ray
+     * @return bit i set when component i of the direction is negative, negative zero included
+     */
+    template<std::floating_point T>
+    CPU_GPU std::uint32_t direction_octant(const vector<T, 3>& direction);
+
+}
+
+#include "impl/ray_packet.inl"
+
+#endif //GPU_RAYTRACE_RAY_PACKET_HPP
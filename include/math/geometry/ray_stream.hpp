@@ -0,0 +1,129 @@
+#ifndef GPU_RAYTRACE_RAY_STREAM_HPP
+#define GPU_RAYTRACE_RAY_STREAM_HPP
+
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "morton.hpp"
+#include "ray.hpp"
+#include "ray_packet.hpp"
+
+namespace math
+{
+
+    /**
+     * a large batch of rays stored as one array per component (structure of arrays), e.g. every primary or shadow ray
+     * of a frame. each ray carries the interval [tmin, tmax] searched along it and an id, by default its index at
+     * insertion, which follows it through compaction and sorting so that results can be written back.
+     * traversal kernels consume the stream W rays at a time through packet(), and incoherent streams are reordered by
+     * sort_by_octant or sort_by_octant_and_origin first so that neighbouring rays visit similar nodes.
+     * @tparam T floating point type
+     */
+    template<std::floating_point T>
+    class ray_stream
+    {
+    private:
+        std::vector<T> _origin[3];
+        std::vector<T> _direction[3];
+        std::vector<T> _tmin;
+        std::vector<T> _tmax;
+        std::vector<std::uint32_t> _ids;
+
+        void permute(const std::vector<std::uint32_t>& order);
+
+        /**
+         * reorders the rays in ascending order of their key, keeping the order of rays with equal keys.
+         * @param keys sort key of each ray. left sorted
+         * @param bits number of low bits of the keys that may be set
+         */
+        void sort_by_keys(std::vector<std::uint64_t>& keys, int bits);
+    public:
+        ray_stream() = default;
+
+        /**
+         * @param capacity number of rays to reserve room for
+         */
+        explicit ray_stream(std::size_t capacity);
+
+        std::size_t size() const;
+        bool empty() const;
+        void reserve(std::size_t capacity);
+        void clear();
+
+        /**
+         * appends a ray with its index as id.
+         * @param r ray to append
+         * @param tmin start of the interval searched along the ray
+         * @param tmax end of the interval searched along the ray
+         */
+        void push_back(const ray<T, 3>& r, T tmin = 0, T tmax = std::numeric_limits<T>::infinity());
+
+        /**
+         * appends a ray.
+         * @param r ray to append
+         * @param tmin start of the interval searched along the ray
+         * @param tmax end of the interval searched along the ray
+         * @param id identifies the ray to whoever consumes the results
+         */
+        void push_back(const ray<T, 3>& r, T tmin, T tmax, std::uint32_t id);
+
+        ray<T, 3> get_ray(std::size_t idx) const;
+        T get_tmin(std::size_t idx) const;
+        T get_tmax(std::size_t idx) const;
+        void set_tmax(std::size_t idx, T tmax);
+        std::uint32_t get_id(std::size_t idx) const;
+
+        // the arrays themselves, for kernels that stream over one component
+        std::span<const T> origins(int axis) const;
+        std::span<const T> directions(int axis) const;
+        std::span<const T> tmins() const;
+        std::span<T> tmaxs();
+        std::span<const T> tmaxs() const;
+        std::span<const std::uint32_t> ids() const;
+
+        /**
+         * loads W consecutive rays into a packet. the lanes past the end of the stream are inactive.
+         * @tparam W width of the packet
+         * @param first index of the ray in the first lane
+         * @return packet of the rays
+         */
+        template<std::size_t W = native_width<T>>
+        ray_packet<T, W> packet(std::size_t first) const;
+
+        /**
+         * writes the tmax of the active lanes of a packet loaded from first back to the stream.
+         * @tparam W width of the packet
+         * @param first index of the ray in the first lane
+         * @param p packet loaded by packet(first)
+         */
+        template<std::size_t W>
+        void store_tmax(std::size_t first, const ray_packet<T, W>& p);
+
+        /**
+         * removes the rays for which keep returns false, e.g. terminated paths, preserving the order of the others.
+         * @param keep callable taking the index of a ray and returning whether to keep it
+         * @return number of rays removed
+         */
+        template<typename Pred>
+        std::size_t compact(Pred keep);
+
+        /**
+         * groups the rays by the octant of their direction, see direction_octant. stable within an octant.
+         */
+        void sort_by_octant();
+
+        /**
+         * groups the rays by the octant of their direction and, within an octant, orders them along a Morton curve
+         * through the bounds of their origins, so that rays leaving nearby points in similar directions are adjacent.
+         */
+        void sort_by_octant_and_origin();
+    };
+
+}
+
+#include "impl/ray_stream.inl"
+
+#endif //GPU_RAYTRACE_RAY_STREAM_HPP
@@ -0,0 +1,107 @@
+#ifndef GPU_RAYTRACE_TRANSFORM_HPP
+#define GPU_RAYTRACE_TRANSFORM_HPP
+
+#include <concepts>
+
+#include "gpu/gpu.hpp"
+#include "bounds.hpp"
+#include "normal.hpp"
+#include "point.hpp"
+#include "ray.hpp"
+#include "vec.hpp"
+
+namespace math
+{
+
+    /**
+     * affine map of 3D space, kept together with its inverse so that neither inverting it nor transforming normals,
+     * which takes the transpose of the inverse, ever inverts a matrix.
+     * the matrices are 3 by 4: a linear part followed by the translation, with the implicit last row (0, 0, 0, 1).
+     * @tparam T value type
+     */
+    template<std::floating_point T>
+    class transform
+    {
+    public:
+        using matrix_type = T[3][4];
+    private:
+        matrix_type _m;
+        matrix_type _inv;
+    public:
+        /**
+         * the identity.
+         */
+        constexpr CPU_GPU transform();
+
+        /**
+         * @param m rows of the matrix
+         * @throws std::invalid_argument if the matrix is singular.
+         */
+        explicit transform(const matrix_type& m);
+
+        /**
+         * @param m rows of the matrix
+         * @param inv rows of its inverse, which is not checked
+         */
+        constexpr CPU_GPU transform(const matrix_type& m, const matrix_type& inv);
+
+        constexpr CPU_GPU const matrix_type& get_matrix() const;
+        constexpr CPU_GPU const matrix_type& get_inverse_matrix() const;
+
+        constexpr CPU_GPU transform inverse() const;
+
+        /**
+         * @return whether the transform mirrors space, which flips the winding of triangles
+         */
+        constexpr CPU_GPU bool swaps_handedness() const;
+
+        constexpr CPU_GPU point<T, 3> operator()(const point<T, 3>& p) const;
+        constexpr CPU_GPU vector<T, 3> operator()(const vector<T, 3>& v) const;
+
+        /**
+         * transforms a normal by the transpose of the inverse, so that it stays perpendicular to transformed
+         * tangents under non-uniform scales. the result is not normalized.
+         */
+        constexpr CPU_GPU normal<T, 3> operator()(const normal<T, 3>& n) const;
+
+        /**
+         * transforms the origin and direction of a ray. the direction is not normalized, so that a distance along
+         * the transformed ray is the same distance along the original.
+         */
+        constexpr CPU_GPU ray<T, 3> operator()(const ray<T, 3>& r) const;
+
+        /**
+         * @return the smallest box holding the transformed box. empty if b is empty
+         */
+        constexpr CPU_GPU bounds<T, 3> operator()(const bounds<T, 3>& b) const;
+    };
+
+    using transformf = transform<float>;
+
+    /**
+     * @return the transform applying t1 then t0
+     */
+    template<std::floating_point T>
+    constexpr CPU_GPU transform<T> operator*(const transform<T>& t0, const transform<T>& t1);
+
+    template<std::floating_point T>
+    constexpr CPU_GPU transform<T> translate(const vector<T, 3>& delta);
+
+    /**
+     * @throws std::invalid_argument if a factor is zero.
+     */
+    template<std::floating_point T>
+    transform<T> scale(T x, T y, T z);
+
+    /**
+     * @param theta angle in radians, counterclockwise seen from the tip of the axis
+     * @param axis axis of rotation, which need not be normalized
+     */
+    template<std::floating_point T>
+    CPU_GPU transform<T> rotate(T theta, const vector<T, 3>& axis);
+
+}
+
+#include "impl/transform.inl"
+
+#endif //GPU_RAYTRACE_TRANSFORM_HPP
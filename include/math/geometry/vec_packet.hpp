@@ -0,0 +1,149 @@
+#ifndef GPU_RAYTRACE_VEC_PACKET_HPP
+#define GPU_RAYTRACE_VEC_PACKET_HPP
+
+#include <span>
+#include <utility>
+
+#include "vec.hpp"
+#include "math/simd/lane.hpp"
+
+namespace math
+{
+
+    /**
+     * W vectors of dimension N stored as N lanes (structure of arrays), so that operating on the packet operates on
+     * all W vectors at once with the SIMD width of the lanes.
+     * the operators mirror those of vector, with lanes taking the place of scalars.
+     * @tparam T value type
+     * @tparam N dimension of each vector
+     * @tparam W number of vectors in the packet
+     */
+    template<typename T, std::size_t N, std::size_t W = native_width<T>>
+    class vector_packet
+    {
+    public:
+        using value_type = T;
+        using lane_type = lane<T, W>;
+        using mask_type = typename lane_type::mask_type;
+        constexpr static std::size_t size = N;
+        constexpr static std::size_t width = W;
+    private:
+        lane_type _lanes[N];
+    public:
+        CPU_GPU vector_packet() = default;
+
+        /**
+         * broadcasts a vector to every lane.
+         * @param vec vector held by every lane.
+         */
+        CPU_GPU explicit vector_packet(const vector<T, N>& vec);
+
+        /**
+         * @param lanes one lane per component.
+         */
+        template<typename... Lanes>
+        CPU_GPU vector_packet(const Lanes&... lanes) requires (sizeof...(Lanes) == N && N > 1) && std::conjunction_v<std::is_convertible<Lanes, lane_type>...>;
+
+        /**
+         * gathers up to W vectors into the lanes. missing lanes are zero.
+         * @param vecs vectors in lane order.
+         * @return packet of the vectors.
+         */
+        static CPU_GPU vector_packet load(std::span<const vector<T, N>> vecs);
+
+        /**
+         * scatters the lanes back to up to W vectors.
+         * @param vecs receives the first min(W, vecs.size()) lanes.
+         */
+        CPU_GPU void store(std::span<vector<T, N>> vecs) const;
+
+        /**
+         * @param idx lane index.
+         * @return the vector held by a lane.
+         */
+        CPU_GPU vector<T, N> extract(std::size_t idx) const;
+
+        /**
+         * @param idx lane index.
+         * @param vec vector to place in the lane.
+         */
+        CPU_GPU void insert(std::size_t idx, const vector<T, N>& vec);
+
+        CPU_GPU lane_type& operator[](int idx);
+        CPU_GPU const lane_type& operator[](int idx) const;
+
+        CPU_GPU vector_packet& operator+=(const vector_packet& p);
+        CPU_GPU vector_packet& operator-=(const vector_packet& p);
+        CPU_GPU vector_packet& operator*=(const vector_packet& p);
+        CPU_GPU vector_packet& operator*=(const lane_type& l);
+        CPU_GPU vector_packet& operator/=(const lane_type& l);
+    };
+
+    template<std::size_t W = native_width<float>>
+    using vec2f_packet = vector_packet<float, 2, W>;
+    template<std::size_t W = native_width<float>>
+    using vec3f_packet = vector_packet<float, 3, W>;
+    template<std::size_t W = native_width<float>>
+    using vec4f_packet = vector_packet<float, 4, W>;
+
+    // the lane arguments are not deduced so that scalars broadcast into them
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator+(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator-(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator-(const vector_packet<T, N, W>& p);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator*(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator*(const vector_packet<T, N, W>& p, const std::type_identity_t<lane<T, W>>& l);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator*(const std::type_identity_t<lane<T, W>>& l, const vector_packet<T, N, W>& p);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> operator/(const vector_packet<T, N, W>& p, const std::type_identity_t<lane<T, W>>& l);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU lane<T, W> dot(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1);
+
+    template<typename T, std::size_t W>
+    CPU_GPU vector_packet<T, 3, W> cross(const vector_packet<T, 3, W>& p0, const vector_packet<T, 3, W>& p1);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU lane<T, W> magnitude(const vector_packet<T, N, W>& p);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> normalize(const vector_packet<T, N, W>& p);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> lerp(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1, const std::type_identity_t<lane<T, W>>& t);
+
+    // p0 * p1 + p2, component-wise
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> fma(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1, const vector_packet<T, N, W>& p2);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> min(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1);
+
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> max(const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1);
+
+    // p0 in the lanes set in the mask and p1 elsewhere
+    template<typename T, std::size_t N, std::size_t W>
+    CPU_GPU vector_packet<T, N, W> select(const typename lane<T, W>::mask_type& m, const vector_packet<T, N, W>& p0, const vector_packet<T, N, W>& p1);
+
+    // requires normalized vectors
+    template<typename T, std::size_t W>
+    CPU_GPU std::pair<vector_packet<T, 3, W>, vector_packet<T, 3, W>> coordinate_system(const vector_packet<T, 3, W>& p);
+
+}
+
+#include "impl/vec_packet.inl"
+
+#endif //GPU_RAYTRACE_VEC_PACKET_HPP
@@ -0,0 +1,438 @@
+#ifndef GPU_RAYTRACE_DISTRIBUTIONS_INL
+#define GPU_RAYTRACE_DISTRIBUTIONS_INL
+
+#include "math/distributions.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace math::sampling
+{
+
+    namespace impl
+    {
+        /**
+         * writes the absolute values of func and their normalized CDF, accumulated in double.
+         * @return integral of the function over [min, max]
+         */
+        template<std::floating_point T>
+        T build_cdf(std::span<const T> func, T min, T max, T* func_out, T* cdf_out)
+        {
+            std::size_t n = func.size();
+            double width = (static_cast<double>(max) - static_cast<double>(min)) / static_cast<double>(n);
+
+            std::vector<double> cdf(n + 1);
+            cdf[0] = 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (!std::isfinite(func[i])) throw std::invalid_argument{ "distribution values must be finite" };
+                func_out[i] = std::abs(func[i]);
+                cdf[i + 1] = cdf[i] + static_cast<double>(func_out[i]) * width;
+            }
+
+            double integral = cdf[n];
+            for (std::size_t i = 0; i <= n; ++i)
+            {
+                // a function that is zero everywhere is sampled uniformly
+                cdf_out[i] = static_cast<T>(integral == 0 ? static_cast<double>(i) / static_cast<double>(n) : cdf[i] / integral);
+            }
+            cdf_out[n] = 1;
+            return static_cast<T>(integral);
+        }
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU alias_table_view<T>::alias_table_view()
+        : _bins(nullptr), _size(0)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU alias_table_view<T>::alias_table_view(const alias_bin<T>* bins, std::size_t size)
+        : _bins(bins), _size(size)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU std::size_t alias_table_view<T>::size() const
+    {
+        return _size;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU int alias_table_view<T>::sample(T u, T* pmf, T* u_remapped) const
+    {
+        if (_size == 0) return -1;
+
+        // the integer part of u * n picks the bin, the fraction decides between the bin and its alias
+        T scaled = u * static_cast<T>(_size);
+        auto idx = static_cast<std::size_t>(scaled);
+        if (idx >= _size) idx = _size - 1;
+        T up = scaled - static_cast<T>(idx);
+        if (up > math::one_minus_epsilon<T>) up = math::one_minus_epsilon<T>;
+
+        const alias_bin<T>& bin = _bins[idx];
+        if (up < bin.q)
+        {
+            if (pmf) *pmf = bin.p;
+            if (u_remapped) *u_remapped = up / bin.q < math::one_minus_epsilon<T> ? up / bin.q : math::one_minus_epsilon<T>;
+            return static_cast<int>(idx);
+        }
+
+        if (pmf) *pmf = _bins[bin.alias].p;
+        if (u_remapped)
+        {
+            T remapped = (up - bin.q) / (1 - bin.q);
+            *u_remapped = remapped < math::one_minus_epsilon<T> ? remapped : math::one_minus_epsilon<T>;
+        }
+        return static_cast<int>(bin.alias);
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T alias_table_view<T>::pmf(std::size_t idx) const
+    {
+        return _bins[idx].p;
+    }
+
+    template<std::floating_point T>
+    alias_table<T>::alias_table(std::span<const T> weights)
+        : _bins(weights.size())
+    {
+        std::size_t n = weights.size();
+        if (n > static_cast<std::size_t>(std::numeric_limits<int>::max())) throw std::invalid_argument{ "alias tables hold at most 2^31 - 1 weights" };
+        if (n == 0) return;
+
+        double sum = 0;
+        for (T weight : weights)
+        {
+            if (!(weight >= 0) || !std::isfinite(weight)) throw std::invalid_argument{ "alias table weights must be finite and non-negative" };
+            sum += weight;
+        }
+
+        // Vose: bins below the average are topped up from one above it, which then gives the rest of its excess away
+        std::vector<double> scaled(n);
+        std::vector<std::uint32_t> small, large;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            double p = sum == 0 ? 1.0 / static_cast<double>(n) : weights[i] / sum;
+            _bins[i].p = static_cast<T>(p);
+            scaled[i] = p * static_cast<double>(n);
+            (scaled[i] < 1 ? small : large).push_back(static_cast<std::uint32_t>(i));
+        }
+
+        while (!small.empty() && !large.empty())
+        {
+            std::uint32_t s = small.back(), l = large.back();
+            small.pop_back();
+            large.pop_back();
+
+            _bins[s].q = static_cast<T>(scaled[s]);
+            _bins[s].alias = l;
+
+            scaled[l] = (scaled[l] + scaled[s]) - 1;
+            (scaled[l] < 1 ? small : large).push_back(l);
+        }
+
+        // whatever is left is within rounding of 1
+        for (std::uint32_t i : large)
+        {
+            _bins[i].q = 1;
+            _bins[i].alias = i;
+        }
+        for (std::uint32_t i : small)
+        {
+            _bins[i].q = 1;
+            _bins[i].alias = i;
+        }
+    }
+
+    template<std::floating_point T>
+    std::size_t alias_table<T>::size() const
+    {
+        return _bins.size();
+    }
+
+    template<std::floating_point T>
+    std::span<const alias_bin<T>> alias_table<T>::bins() const
+    {
+        return _bins;
+    }
+
+    template<std::floating_point T>
+    alias_table_view<T> alias_table<T>::view() const
+    {
+        return { _bins.data(), _bins.size() };
+    }
+
+    template<std::floating_point T>
+    int alias_table<T>::sample(T u, T* pmf, T* u_remapped) const
+    {
+        return view().sample(u, pmf, u_remapped);
+    }
+
+    template<std::floating_point T>
+    T alias_table<T>::pmf(std::size_t idx) const
+    {
+        return view().pmf(idx);
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU piecewise_constant_1d_view<T>::piecewise_constant_1d_view()
+        : _func(nullptr), _cdf(nullptr), _size(0), _integral(0), _min(0), _max(1)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU piecewise_constant_1d_view<T>::piecewise_constant_1d_view(const T* func, const T* cdf, std::size_t size, T integral, T min, T max)
+        : _func(func), _cdf(cdf), _size(size), _integral(integral), _min(min), _max(max)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU std::size_t piecewise_constant_1d_view<T>::find_interval(T u) const
+    {
+        // the last piece whose CDF starts at or below u. pieces of zero probability start where the next one does,
+        // so they are skipped
+        std::size_t lo = 0, hi = _size;
+        while (hi - lo > 1)
+        {
+            std::size_t mid = lo + (hi - lo) / 2;
+            if (_cdf[mid] <= u) lo = mid;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU std::size_t piecewise_constant_1d_view<T>::size() const
+    {
+        return _size;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T piecewise_constant_1d_view<T>::integral() const
+    {
+        return _integral;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T piecewise_constant_1d_view<T>::sample_continuous(T u, T* pdf, std::size_t* offset) const
+    {
+        std::size_t o = find_interval(u);
+        if (offset) *offset = o;
+
+        T du = u - _cdf[o];
+        if (_cdf[o + 1] - _cdf[o] > 0) du /= _cdf[o + 1] - _cdf[o];
+        if (pdf) *pdf = _integral > 0 ? _func[o] / _integral : 1 / (_max - _min);
+
+        T t = (static_cast<T>(o) + du) / static_cast<T>(_size);
+        T x = _min + t * (_max - _min);
+        return x < _max ? x : math::next_floating_down(_max);
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU std::size_t piecewise_constant_1d_view<T>::sample_discrete(T u, T* pmf, T* u_remapped) const
+    {
+        std::size_t o = find_interval(u);
+        T p = _cdf[o + 1] - _cdf[o];
+        if (pmf) *pmf = p;
+        if (u_remapped)
+        {
+            T remapped = p > 0 ? (u - _cdf[o]) / p : 0;
+            *u_remapped = remapped < math::one_minus_epsilon<T> ? remapped : math::one_minus_epsilon<T>;
+        }
+        return o;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T piecewise_constant_1d_view<T>::pdf(T x) const
+    {
+        if (!(_integral > 0)) return 1 / (_max - _min);
+
+        T t = (x - _min) / (_max - _min) * static_cast<T>(_size);
+        std::size_t o = t > 0 ? static_cast<std::size_t>(t) : 0;
+        if (o >= _size) o = _size - 1;
+        return _func[o] / _integral;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T piecewise_constant_1d_view<T>::pmf(std::size_t idx) const
+    {
+        return _cdf[idx + 1] - _cdf[idx];
+    }
+
+    template<std::floating_point T>
+    piecewise_constant_1d<T>::piecewise_constant_1d()
+        : _integral(0), _min(0), _max(1)
+    {}
+
+    template<std::floating_point T>
+    piecewise_constant_1d<T>::piecewise_constant_1d(std::span<const T> func, T min, T max)
+        : _func(func.size()), _cdf(func.size() + 1), _integral(0), _min(min), _max(max)
+    {
+        if (func.empty()) throw std::invalid_argument{ "a piecewise-constant distribution needs at least one piece" };
+        if (!(max > min)) throw std::invalid_argument{ "a piecewise-constant distribution needs a non-empty domain" };
+        _integral = impl::build_cdf(func, min, max, _func.data(), _cdf.data());
+    }
+
+    template<std::floating_point T>
+    std::size_t piecewise_constant_1d<T>::size() const
+    {
+        return _func.size();
+    }
+
+    template<std::floating_point T>
+    T piecewise_constant_1d<T>::integral() const
+    {
+        return _integral;
+    }
+
+    template<std::floating_point T>
+    piecewise_constant_1d_view<T> piecewise_constant_1d<T>::view() const
+    {
+        return { _func.data(), _cdf.data(), _func.size(), _integral, _min, _max };
+    }
+
+    template<std::floating_point T>
+    T piecewise_constant_1d<T>::sample_continuous(T u, T* pdf, std::size_t* offset) const
+    {
+        return view().sample_continuous(u, pdf, offset);
+    }
+
+    template<std::floating_point T>
+    std::size_t piecewise_constant_1d<T>::sample_discrete(T u, T* pmf, T* u_remapped) const
+    {
+        return view().sample_discrete(u, pmf, u_remapped);
+    }
+
+    template<std::floating_point T>
+    T piecewise_constant_1d<T>::pdf(T x) const
+    {
+        return view().pdf(x);
+    }
+
+    template<std::floating_point T>
+    T piecewise_constant_1d<T>::pmf(std::size_t idx) const
+    {
+        return view().pmf(idx);
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU piecewise_constant_2d_view<T>::piecewise_constant_2d_view()
+        : _conditional_func(nullptr), _conditional_cdf(nullptr), _conditional_integral(nullptr), _marginal(), _nu(0)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU piecewise_constant_2d_view<T>::piecewise_constant_2d_view(const T* conditional_func, const T* conditional_cdf,
+                                                                              const T* conditional_integral,
+                                                                              piecewise_constant_1d_view<T> marginal, std::size_t nu)
+        : _conditional_func(conditional_func), _conditional_cdf(conditional_cdf), _conditional_integral(conditional_integral),
+          _marginal(marginal), _nu(nu)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU piecewise_constant_1d_view<T> piecewise_constant_2d_view<T>::row(std::size_t v) const
+    {
+        return { _conditional_func + v * _nu, _conditional_cdf + v * (_nu + 1), _nu, _conditional_integral[v], 0, 1 };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU std::size_t piecewise_constant_2d_view<T>::width() const
+    {
+        return _nu;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU std::size_t piecewise_constant_2d_view<T>::height() const
+    {
+        return _marginal.size();
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T piecewise_constant_2d_view<T>::integral() const
+    {
+        return _marginal.integral();
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU point<T, 2> piecewise_constant_2d_view<T>::sample(point<T, 2> u, T* pdf) const
+    {
+        T pdf_v = 0, pdf_u = 0;
+        std::size_t v = 0;
+        T y = _marginal.sample_continuous(u[1], &pdf_v, &v);
+        T x = row(v).sample_continuous(u[0], &pdf_u);
+        if (pdf) *pdf = pdf_u * pdf_v;
+        return { x, y };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T piecewise_constant_2d_view<T>::pdf(point<T, 2> p) const
+    {
+        if (!(_marginal.integral() > 0)) return 1;
+
+        std::size_t nv = _marginal.size();
+        T tu = p[0] * static_cast<T>(_nu), tv = p[1] * static_cast<T>(nv);
+        std::size_t iu = tu > 0 ? static_cast<std::size_t>(tu) : 0;
+        std::size_t iv = tv > 0 ? static_cast<std::size_t>(tv) : 0;
+        if (iu >= _nu) iu = _nu - 1;
+        if (iv >= nv) iv = nv - 1;
+        return _conditional_func[iv * _nu + iu] / _marginal.integral();
+    }
+
+    template<std::floating_point T>
+    piecewise_constant_2d<T>::piecewise_constant_2d()
+        : _nu(0)
+    {}
+
+    template<std::floating_point T>
+    piecewise_constant_2d<T>::piecewise_constant_2d(std::span<const T> func, std::size_t nu, std::size_t nv)
+        : _conditional_func(nu * nv), _conditional_cdf((nu + 1) * nv), _conditional_integral(nv), _nu(nu)
+    {
+        if (nu == 0 || nv == 0) throw std::invalid_argument{ "a piecewise-constant distribution needs at least one piece" };
+        if (func.size() != nu * nv) throw std::invalid_argument{ "a piecewise-constant 2d distribution needs nu * nv values" };
+
+        for (std::size_t v = 0; v < nv; ++v)
+        {
+            _conditional_integral[v] = impl::build_cdf(func.subspan(v * nu, nu), static_cast<T>(0), static_cast<T>(1),
+                                                       _conditional_func.data() + v * nu,
+                                                       _conditional_cdf.data() + v * (nu + 1));
+        }
+        _marginal = piecewise_constant_1d<T>(std::span<const T>(_conditional_integral));
+    }
+
+    template<std::floating_point T>
+    std::size_t piecewise_constant_2d<T>::width() const
+    {
+        return _nu;
+    }
+
+    template<std::floating_point T>
+    std::size_t piecewise_constant_2d<T>::height() const
+    {
+        return _marginal.size();
+    }
+
+    template<std::floating_point T>
+    T piecewise_constant_2d<T>::integral() const
+    {
+        return _marginal.integral();
+    }
+
+    template<std::floating_point T>
+    piecewise_constant_2d_view<T> piecewise_constant_2d<T>::view() const
+    {
+        return { _conditional_func.data(), _conditional_cdf.data(), _conditional_integral.data(), _marginal.view(), _nu };
+    }
+
+    template<std::floating_point T>
+    point<T, 2> piecewise_constant_2d<T>::sample(point<T, 2> u, T* pdf) const
+    {
+        return view().sample(u, pdf);
+    }
+
+    template<std::floating_point T>
+    T piecewise_constant_2d<T>::pdf(point<T, 2> p) const
+    {
+        return view().pdf(p);
+    }
+
+}
+
+#endif //GPU_RAYTRACE_DISTRIBUTIONS_INL
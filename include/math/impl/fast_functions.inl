@@ -0,0 +1,420 @@
+#ifndef GPU_RAYTRACE_FAST_FUNCTIONS_INL
+#define GPU_RAYTRACE_FAST_FUNCTIONS_INL
+
+#include "math/fast_functions.hpp"
+
+#include <cmath>
+#include <limits>
+
+namespace math::fast
+{
+
+    namespace impl
+    {
+        template<typename V> struct scalar_of { using type = V; };
+        template<typename T, std::size_t W> struct scalar_of<lane<T, W>> { using type = T; };
+
+        template<typename V> using scalar_t = typename scalar_of<V>::type;
+
+        // scalar counterparts of the lane operations, so that the kernels below are written once for both
+
+        template<std::floating_point T>
+        CPU_GPU T select(bool m, T a, T b) { return m ? a : b; }
+
+        template<std::floating_point T>
+        CPU_GPU T fma(T a, T b, T c)
+        {
+            // without hardware support std::fma is emulated, which costs more than the whole kernel
+#if defined(__FMA__) || defined(__CUDA_ARCH__)
+            return std::fma(a, b, c);
+#else
+            return a * b + c;
+#endif
+        }
+
+        // return the second argument when either is NaN, like the lanes
+        template<std::floating_point T>
+        CPU_GPU T min(T a, T b) { return a < b ? a : b; }
+
+        template<std::floating_point T>
+        CPU_GPU T max(T a, T b) { return a > b ? a : b; }
+
+        template<std::floating_point T>
+        CPU_GPU T abs(T a) { return std::abs(a); }
+
+        template<std::floating_point T>
+        CPU_GPU T sqrt(T a) { return std::sqrt(a); }
+
+        template<std::floating_point T>
+        CPU_GPU T copysign(T value, T sign) { return std::copysign(value, sign); }
+
+        template<std::floating_point T>
+        CPU_GPU T round(T a)
+        {
+            // adding and removing 2^mantissa drops the fraction, ties to even. std::nearbyint is a library call on most
+            // targets. values that large are already integral
+            constexpr T shift = T(1ull << mantissa_size<T>);
+            T magnitude = std::abs(a);
+            return magnitude < shift ? std::copysign((magnitude + shift) - shift, a) : a;
+        }
+
+        template<std::floating_point T>
+        CPU_GPU T ldexp(T a, T e)
+        {
+            using uint_type = math::_impl::to_uint_t<T>;
+            constexpr int bias = (1 << (exponent_size<T> - 1)) - 1;
+            auto pow2 = [](int n) { return to_floating(static_cast<uint_type>(n + bias) << mantissa_size<T>); };
+
+            // NaN must not reach the cast to int, which is undefined for it
+            if (e != e) return a + e;
+
+            // two factors, so that exponents reaching into the subnormals or past the largest value work
+            int k = static_cast<int>(e < -2 * (bias - 1) ? -2 * (bias - 1) : (e > 2 * bias ? 2 * bias : e));
+            int half = k >> 1;
+            return a * pow2(half) * pow2(k - half);
+        }
+
+        template<std::floating_point T>
+        CPU_GPU T frexp(T a, T& e)
+        {
+            using uint_type = math::_impl::to_uint_t<T>;
+            constexpr int bias = (1 << (exponent_size<T> - 1)) - 1;
+            constexpr uint_type exponent_mask = ((uint_type{ 1 } << exponent_size<T>) - 1) << mantissa_size<T>;
+
+            uint_type bits = to_bits(a);
+            e = static_cast<T>(static_cast<int>((bits & exponent_mask) >> mantissa_size<T>) - (bias - 1));
+            return to_floating((bits & ~exponent_mask) | (static_cast<uint_type>(bias - 1) << mantissa_size<T>));
+        }
+
+        template<typename V>
+        CPU_GPU V floor(const V& a)
+        {
+            V r = round(a);
+            return select(r > a, r - 1, r);
+        }
+
+        template<std::floating_point T> struct limits;
+        template<> struct limits<float>
+        {
+            constexpr static float exp_max = 88.72283935546875f; // largest x with a finite e^x
+            constexpr static float exp_min = -103.97208404541015625f; // smallest x with a nonzero e^x
+        };
+        template<> struct limits<double>
+        {
+            constexpr static double exp_max = 709.782712893383973096;
+            constexpr static double exp_min = -745.133219101941108420;
+        };
+
+        /**
+         * evaluates c0 + c1 x + c2 x^2 + ... with Horner's scheme.
+         */
+        template<typename V>
+        CPU_GPU V polynomial(const V&, double c)
+        {
+            return V(static_cast<scalar_t<V>>(c));
+        }
+
+        template<typename V, typename... Coefficients>
+        CPU_GPU V polynomial(const V& x, double c, Coefficients... cs)
+        {
+            return fma(polynomial(x, cs...), x, V(static_cast<scalar_t<V>>(c)));
+        }
+
+        // minimax coefficients of the relative error, fitted with the Remez exchange algorithm
+
+        // sin(r) = r + r^3 p(r^2) for |r| <= pi / 4
+        template<precision P, typename V>
+        CPU_GPU V sin_polynomial(const V& z)
+        {
+            if constexpr (P == precision::low) return polynomial(z, -0.16160110138864951208);
+            else if constexpr (P == precision::medium) return polynomial(z, -0.16662940017463039275, 0.0081515709552466060915);
+            else return polynomial(z, -0.16666654674256119689, 0.0083321009531328700001, -0.00019503963125734417038);
+        }
+
+        // cos(r) = 1 - r^2 / 2 + r^4 p(r^2) for |r| <= pi / 4
+        template<precision P, typename V>
+        CPU_GPU V cos_polynomial(const V& z)
+        {
+            if constexpr (P == precision::low) return polynomial(z, 0.04081930290349469961);
+            else if constexpr (P == precision::medium) return polynomial(z, 0.041661996359009174895, -0.0013661231737660535318);
+            else return polynomial(z, 0.041666654651801625777, -0.001388765438451258721, 0.000024463837438996785494);
+        }
+
+        // ln((1 + s) / (1 - s)) = 2s + s^3 p(s^2) for |s| <= 3 - 2 sqrt(2)
+        template<precision P, typename V>
+        CPU_GPU V log_polynomial(const V& z)
+        {
+            if constexpr (P == precision::low) return polynomial(z, 0.67869496216216335489);
+            else if constexpr (P == precision::medium) return polynomial(z, 0.66653849933407643249, 0.41296188330105667644);
+            else return polynomial(z, 0.66666778258713145243, 0.39976082772288008435, 0.29925452486972178475);
+        }
+
+        // e^r = 1 + r + r^2 p(r) for |r| <= ln(2) / 2
+        template<precision P, typename V>
+        CPU_GPU V exp_polynomial(const V& r)
+        {
+            if constexpr (P == precision::low) return polynomial(r, 0.50502479969996703055, 0.16767047776470631777);
+            else if constexpr (P == precision::medium) return polynomial(r, 0.50005116015360787578, 0.16753513915053334405, 0.041277748066314051556);
+            else return polynomial(r, 0.49999993451708433777, 0.16666520689833019231, 0.041668387361261078691, 0.0083687098241711431833, 0.0013814613260784653943);
+        }
+
+        // arcsin(s) = s + s^3 p(s^2) for |s| <= 1 / 2
+        template<precision P, typename V>
+        CPU_GPU V arcsin_polynomial(const V& z)
+        {
+            if constexpr (P == precision::low) return polynomial(z, 0.16481899920160537266, 0.09588482233914244784);
+            else if constexpr (P == precision::medium) return polynomial(z, 0.16680025310559973709, 0.071716352157538837878, 0.064973818262504608983);
+            else return polynomial(z, 0.16666731146014484859, 0.074956682702434721726, 0.045465701293601273411, 0.024057044689794720502, 0.042553599106389374834);
+        }
+
+        // arctan(t) = t + t^3 p(t^2) for |t| <= tan(pi / 8)
+        template<precision P, typename V>
+        CPU_GPU V arctan_polynomial(const V& z)
+        {
+            if constexpr (P == precision::low) return polynomial(z, -0.33159192234169254126, 0.16820960651768041938);
+            else if constexpr (P == precision::medium) return polynomial(z, -0.33325255673756303231, 0.19695276567164263768, -0.11111472351665220144);
+            else return polynomial(z, -0.33333318656700040061, 0.1999853316792761121, -0.14242971133195379637, 0.1058148557968164907, -0.060332417009767229359);
+        }
+
+        template<precision P, typename V>
+        CPU_GPU void sincos(const V& theta, V& s, V& c)
+        {
+            using T = scalar_t<V>;
+
+            // theta = q pi / 2 + r. pi / 2 is split in three so the leading products are exact (Cody and Waite)
+            V q = round(theta * T(0.63661977236758134308));
+            V r = fma(q, V(T(-1.5703125)), theta);
+            r = fma(q, V(T(-4.837512969970703125e-4)), r);
+            r = fma(q, V(T(-7.54978995489188216e-8)), r);
+
+            V z = r * r;
+            V sin_r = fma(r * z, sin_polynomial<P>(z), r);
+            V cos_r = fma(z * z, cos_polynomial<P>(z), fma(z, V(T(-0.5)), V(T(1))));
+
+            V quadrant = q - T(4) * floor(q * T(0.25));
+            auto odd = (quadrant == V(T(1))) | (quadrant == V(T(3)));
+            V sin_q = select(odd, cos_r, sin_r);
+            V cos_q = select(odd, sin_r, cos_r);
+            s = select(quadrant >= V(T(2)), -sin_q, sin_q);
+            c = select((quadrant == V(T(1))) | (quadrant == V(T(2))), -cos_q, cos_q);
+        }
+
+        template<precision P, typename V>
+        CPU_GPU V log(const V& x)
+        {
+            using T = scalar_t<V>;
+            constexpr T min_normal = std::numeric_limits<T>::min();
+            constexpr T subnormal_scale = T(1ull << mantissa_size<T>);
+
+            // subnormals are scaled into the normals first, since frexp only handles those
+            auto subnormal = x < V(min_normal);
+            V e;
+            V m = frexp(select(subnormal, x * subnormal_scale, x), e);
+            e = select(subnormal, e - T(mantissa_size<T>), e);
+
+            // center the mantissa on 1, in [sqrt(2) / 2, sqrt(2))
+            auto below = m < V(T(0.70710678118654752440));
+            m = select(below, m + m, m);
+            e = select(below, e - T(1), e);
+
+            // ln(m) = ln((1 + s) / (1 - s)) with s = (m - 1) / (m + 1)
+            V s = (m - T(1)) / (m + T(1));
+            V z = s * s;
+            V ln_m = fma(s * z, log_polynomial<P>(z), s + s);
+
+            // ln(2) split in two, so that e ln(2) stays exact
+            V result = fma(e, V(T(0.693359375)), fma(e, V(T(-2.12194440e-4)), ln_m));
+
+            result = select(x == V(std::numeric_limits<T>::infinity()), x, result);
+            result = select(x == V(T(0)), V(-std::numeric_limits<T>::infinity()), result);
+            return select((x < V(T(0))) | (x != x), V(std::numeric_limits<T>::quiet_NaN()), result);
+        }
+
+        template<precision P, typename V>
+        CPU_GPU V exp(const V& x)
+        {
+            using T = scalar_t<V>;
+
+            // the clamp keeps NaN, which is passed as the second argument
+            V clamped = min(V(limits<T>::exp_max), max(V(limits<T>::exp_min), x));
+
+            // x = n ln(2) + r
+            V n = round(clamped * T(1.44269504088896340736));
+            V r = fma(n, V(T(-0.693359375)), clamped);
+            r = fma(n, V(T(2.12194440e-4)), r);
+
+            V e_r = fma(r * r, exp_polynomial<P>(r), r) + T(1);
+            V result = ldexp(e_r, n);
+
+            result = select(x > V(limits<T>::exp_max), V(std::numeric_limits<T>::infinity()), result);
+            return select(x < V(limits<T>::exp_min), V(T(0)), result);
+        }
+
+        template<precision P, typename V>
+        CPU_GPU V pow(const V& a, const V& b)
+        {
+            using T = scalar_t<V>;
+
+            V result = exp<P>(b * log<P>(abs(a)));
+
+            // a negative base takes its sign from the parity of the exponent, which must be integral
+            auto negative = a < V(T(0));
+            auto odd = (b - T(2) * floor(b * T(0.5))) == V(T(1));
+            result = select(negative & odd, -result, result);
+            result = select(negative & (round(b) != b), V(std::numeric_limits<T>::quiet_NaN()), result);
+            return select((b == V(T(0))) | (a == V(T(1))), V(T(1)), result);
+        }
+
+        template<precision P, typename V>
+        CPU_GPU V arccos(const V& ratio)
+        {
+            using T = scalar_t<V>;
+            constexpr T pi = math::pi<T>;
+
+            // past 1/2, arccos(x) = 2 arcsin(sqrt((1 - x) / 2)) keeps the polynomial on [0, 1/2]
+            V magnitude = abs(ratio);
+            auto far = magnitude > V(T(0.5));
+            V z = select(far, (T(1) - magnitude) * T(0.5), ratio * ratio);
+            V s = select(far, sqrt(z), magnitude);
+            V arcsin_s = fma(s * z, arcsin_polynomial<P>(z), s);
+
+            V near_result = T(pi / 2) - copysign(arcsin_s, ratio);
+            V far_result = select(ratio < V(T(0)), T(pi) - (arcsin_s + arcsin_s), arcsin_s + arcsin_s);
+            return select(far, far_result, near_result);
+        }
+
+        template<precision P, typename V>
+        CPU_GPU V arctan2(const V& y, const V& x)
+        {
+            using T = scalar_t<V>;
+            constexpr T pi = math::pi<T>;
+
+            // reduce to t = min / max in [0, 1], then to [0, tan(pi / 8)] with arctan(t) = pi / 4 + arctan((t - 1) / (t + 1))
+            V ax = abs(x), ay = abs(y);
+            V lo = min(ax, ay), hi = max(ax, ay);
+            auto shifted = lo > hi * T(0.41421356237309504880);
+            V t = select(shifted, lo - hi, lo) / select(shifted, lo + hi, hi);
+            t = select(hi == V(T(0)), V(T(0)), t);
+
+            V z = t * t;
+            V angle = fma(t * z, arctan_polynomial<P>(z), t);
+            angle = select(shifted, angle + T(pi / 4), angle);
+
+            // both infinite points along a diagonal
+            V infinity = V(std::numeric_limits<T>::infinity());
+            angle = select((ax == infinity) & (ay == infinity), V(T(pi / 4)), angle);
+
+            angle = select(ay > ax, T(pi / 2) - angle, angle);
+            angle = select(copysign(V(T(1)), x) < V(T(0)), T(pi) - angle, angle);
+            angle = copysign(angle, y);
+            return select((x != x) | (y != y), x + y, angle);
+        }
+    }
+
+    template<precision P, std::floating_point T>
+    CPU_GPU T sin(T theta)
+    {
+        T s, c;
+        impl::sincos<P>(theta, s, c);
+        return s;
+    }
+
+    template<precision P, std::floating_point T>
+    CPU_GPU T cos(T theta)
+    {
+        T s, c;
+        impl::sincos<P>(theta, s, c);
+        return c;
+    }
+
+    template<precision P, std::floating_point T>
+    CPU_GPU void sincos(T theta, T& s, T& c)
+    {
+        impl::sincos<P>(theta, s, c);
+    }
+
+    template<precision P, std::floating_point T>
+    CPU_GPU T log(T x)
+    {
+        return impl::log<P>(x);
+    }
+
+    template<precision P, std::floating_point T>
+    CPU_GPU T exp(T x)
+    {
+        return impl::exp<P>(x);
+    }
+
+    template<precision P, std::floating_point T>
+    CPU_GPU T pow(T a, T b)
+    {
+        return impl::pow<P>(a, b);
+    }
+
+    template<precision P, std::floating_point T>
+    CPU_GPU T arccos(T ratio)
+    {
+        return impl::arccos<P>(ratio);
+    }
+
+    template<precision P, std::floating_point T>
+    CPU_GPU T arctan2(T y, T x)
+    {
+        return impl::arctan2<P>(y, x);
+    }
+
+    template<precision P, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> sin(const lane<T, W>& theta)
+    {
+        lane<T, W> s, c;
+        impl::sincos<P>(theta, s, c);
+        return s;
+    }
+
+    template<precision P, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> cos(const lane<T, W>& theta)
+    {
+        lane<T, W> s, c;
+        impl::sincos<P>(theta, s, c);
+        return c;
+    }
+
+    template<precision P, std::floating_point T, std::size_t W>
+    CPU_GPU void sincos(const lane<T, W>& theta, lane<T, W>& s, lane<T, W>& c)
+    {
+        impl::sincos<P>(theta, s, c);
+    }
+
+    template<precision P, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> log(const lane<T, W>& x)
+    {
+        return impl::log<P>(x);
+    }
+
+    template<precision P, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> exp(const lane<T, W>& x)
+    {
+        return impl::exp<P>(x);
+    }
+
+    template<precision P, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> pow(const lane<T, W>& a, const lane<T, W>& b)
+    {
+        return impl::pow<P>(a, b);
+    }
+
+    template<precision P, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> arccos(const lane<T, W>& ratio)
+    {
+        return impl::arccos<P>(ratio);
+    }
+
+    template<precision P, std::floating_point T, std::size_t W>
+    CPU_GPU lane<T, W> arctan2(const lane<T, W>& y, const lane<T, W>& x)
+    {
+        return impl::arctan2<P>(y, x);
+    }
+
+}
+
+#endif //GPU_RAYTRACE_FAST_FUNCTIONS_INL
@@ -0,0 +1,262 @@
+#ifndef GPU_RAYTRACE_SAMPLERS_INL
+#define GPU_RAYTRACE_SAMPLERS_INL
+
+#include "math/samplers.hpp"
+
+#include <type_traits>
+
+namespace math::samplers
+{
+
+    constexpr CPU_GPU std::uint64_t mix_bits(std::uint64_t v)
+    {
+        v ^= v >> 31;
+        v *= 0x7fb5d329728ea185ull;
+        v ^= v >> 27;
+        v *= 0x81dadef4bc2dd44dull;
+        v ^= v >> 33;
+        return v;
+    }
+
+    template<std::integral... Ts>
+    constexpr CPU_GPU std::uint64_t hash(Ts... values)
+    {
+        std::uint64_t h = 0;
+        ((h = mix_bits(h + 0x9e3779b97f4a7c15ull + static_cast<std::uint64_t>(static_cast<std::make_unsigned_t<Ts>>(values)))), ...);
+        return h;
+    }
+
+    constexpr CPU_GPU std::uint32_t reverse_bits(std::uint32_t v)
+    {
+        v = (v << 16) | (v >> 16);
+        v = ((v & 0x00ff00ffu) << 8) | ((v & 0xff00ff00u) >> 8);
+        v = ((v & 0x0f0f0f0fu) << 4) | ((v & 0xf0f0f0f0u) >> 4);
+        v = ((v & 0x33333333u) << 2) | ((v & 0xccccccccu) >> 2);
+        v = ((v & 0x55555555u) << 1) | ((v & 0xaaaaaaaau) >> 1);
+        return v;
+    }
+
+    constexpr CPU_GPU std::uint32_t owen_scramble(std::uint32_t v, std::uint32_t seed)
+    {
+        // reversed, the value is scrambled by a hash in which carries only move up, so bit i of the result depends on
+        // the bits below it. reversed back, that is a flip of each bit driven by the bits above it
+        v = reverse_bits(v);
+        v ^= v * 0x3d20adeau;
+        v += seed;
+        v *= (seed >> 16) | 1;
+        v ^= v * 0x05526c56u;
+        v ^= v * 0x53a22864u;
+        return reverse_bits(v);
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T to_unit(std::uint32_t bits)
+    {
+        T value = static_cast<T>(bits) * static_cast<T>(0x1p-32);
+        return value < math::one_minus_epsilon<T> ? value : math::one_minus_epsilon<T>;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T owen_scrambled_radical_inverse(std::uint32_t base, std::uint64_t index, std::uint64_t seed)
+    {
+        // digits are generated until they fall below 32 bits of precision, past the end of index as well, since the
+        // scramble turns its trailing zeros into random digits
+        double inv_base = 1.0 / base, inv_base_m = 1;
+        std::uint64_t reversed = 0;
+        while (inv_base_m > 0x1p-32)
+        {
+            std::uint64_t next = index / base;
+            auto digit = static_cast<std::uint32_t>(index - next * base);
+            digit = static_cast<std::uint32_t>((digit + mix_bits(seed ^ reversed) % base) % base);
+            reversed = reversed * base + digit;
+            inv_base_m *= inv_base;
+            index = next;
+        }
+
+        auto value = static_cast<T>(static_cast<double>(reversed) * inv_base_m);
+        return value < math::one_minus_epsilon<T> ? value : math::one_minus_epsilon<T>;
+    }
+
+    namespace impl
+    {
+        constexpr std::uint64_t PCG32_MULTIPLIER = 0x5851f42d4c957f2dull;
+        constexpr std::uint64_t PCG32_DEFAULT_STATE = 0x853c49e6748fea9bull;
+        constexpr std::uint64_t PCG32_DEFAULT_STREAM = 0xda3e39cb94b95bdbull;
+
+        struct prime_table
+        {
+            std::uint32_t values[HALTON_DIMENSIONS];
+        };
+
+        constexpr prime_table generate_primes()
+        {
+            prime_table table{};
+            std::size_t count = 0;
+            for (std::uint32_t candidate = 2; count < HALTON_DIMENSIONS; ++candidate)
+            {
+                bool is_prime = true;
+                for (std::size_t i = 0; i < count && table.values[i] * table.values[i] <= candidate; ++i)
+                {
+                    if (candidate % table.values[i] == 0) is_prime = false;
+                }
+                if (is_prime) table.values[count++] = candidate;
+            }
+            return table;
+        }
+
+        constexpr CONSTANT inline prime_table primes = generate_primes();
+
+        constexpr CPU_GPU std::uint64_t pixel_hash(point<int, 2> pixel, std::uint32_t dimension, std::uint32_t seed)
+        {
+            return hash(pixel[0], pixel[1], dimension, seed);
+        }
+    }
+
+    constexpr CPU_GPU pcg32::pcg32()
+        : _state(impl::PCG32_DEFAULT_STATE), _inc(impl::PCG32_DEFAULT_STREAM)
+    {}
+
+    constexpr CPU_GPU pcg32::pcg32(std::uint64_t sequence, std::uint64_t seed)
+        : _state(0), _inc(0)
+    {
+        set_sequence(sequence, seed);
+    }
+
+    constexpr CPU_GPU pcg32::pcg32(std::uint64_t sequence)
+        : pcg32(sequence, mix_bits(sequence))
+    {}
+
+    constexpr CPU_GPU void pcg32::set_sequence(std::uint64_t sequence, std::uint64_t seed)
+    {
+        _state = 0;
+        _inc = (sequence << 1) | 1;
+        next_uint();
+        _state += seed;
+        next_uint();
+    }
+
+    constexpr CPU_GPU std::uint32_t pcg32::next_uint()
+    {
+        std::uint64_t old_state = _state;
+        _state = old_state * impl::PCG32_MULTIPLIER + _inc;
+        auto xorshifted = static_cast<std::uint32_t>(((old_state >> 18) ^ old_state) >> 27);
+        auto rotation = static_cast<std::uint32_t>(old_state >> 59);
+        return (xorshifted >> rotation) | (xorshifted << ((~rotation + 1) & 31));
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T pcg32::uniform()
+    {
+        if constexpr (sizeof(T) <= sizeof(std::uint32_t)) return to_unit<T>(next_uint());
+        else
+        {
+            std::uint64_t bits = static_cast<std::uint64_t>(next_uint()) << 32;
+            bits |= next_uint();
+            T value = static_cast<T>(bits) * static_cast<T>(0x1p-64);
+            return value < math::one_minus_epsilon<T> ? value : math::one_minus_epsilon<T>;
+        }
+    }
+
+    constexpr CPU_GPU void pcg32::advance(std::int64_t delta)
+    {
+        // the affine map of one step composed with itself by repeated squaring. a negative delta wraps around the
+        // period of 2^64
+        std::uint64_t step_mult = impl::PCG32_MULTIPLIER, step_plus = _inc;
+        std::uint64_t acc_mult = 1, acc_plus = 0;
+        for (auto remaining = static_cast<std::uint64_t>(delta); remaining; remaining >>= 1)
+        {
+            if (remaining & 1)
+            {
+                acc_mult *= step_mult;
+                acc_plus = acc_plus * step_mult + step_plus;
+            }
+            step_plus *= step_mult + 1;
+            step_mult *= step_mult;
+        }
+        _state = acc_mult * _state + acc_plus;
+    }
+
+    constexpr CPU_GPU independent_sampler::independent_sampler(std::uint32_t seed)
+        : _seed(seed)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T independent_sampler::get_1d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const
+    {
+        pcg32 rng(hash(pixel[0], pixel[1], _seed));
+        rng.advance(static_cast<std::int64_t>(index) * 65536 + dimension);
+        return rng.uniform<T>();
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU point<T, 2> independent_sampler::get_2d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const
+    {
+        pcg32 rng(hash(pixel[0], pixel[1], _seed));
+        rng.advance(static_cast<std::int64_t>(index) * 65536 + dimension);
+        T x = rng.uniform<T>();
+        return { x, rng.uniform<T>() };
+    }
+
+    constexpr CPU_GPU sobol_sampler::sobol_sampler(std::uint32_t seed)
+        : _seed(seed)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T sobol_sampler::get_1d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const
+    {
+        // the shuffle is shared by the dimensions of a pass over the matrices so that they stay one Sobol point
+        auto pass = static_cast<std::uint32_t>(dimension / tables::SOBOL_DIMENSIONS);
+        auto shuffled = owen_scramble(index, static_cast<std::uint32_t>(hash(pixel[0], pixel[1], pass, _seed, 0u)));
+        std::uint32_t bits = tables::sobol(shuffled, dimension % tables::SOBOL_DIMENSIONS);
+        return to_unit<T>(owen_scramble(bits, static_cast<std::uint32_t>(impl::pixel_hash(pixel, dimension, _seed))));
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU point<T, 2> sobol_sampler::get_2d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const
+    {
+        return { get_1d<T>(pixel, index, dimension), get_1d<T>(pixel, index, dimension + 1) };
+    }
+
+    constexpr CPU_GPU halton_sampler::halton_sampler(std::uint32_t seed)
+        : _seed(seed)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T halton_sampler::get_1d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const
+    {
+        std::uint32_t base = impl::primes.values[dimension % HALTON_DIMENSIONS];
+        return owen_scrambled_radical_inverse<T>(base, index, impl::pixel_hash(pixel, dimension, _seed));
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU point<T, 2> halton_sampler::get_2d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const
+    {
+        return { get_1d<T>(pixel, index, dimension), get_1d<T>(pixel, index, dimension + 1) };
+    }
+
+    constexpr CPU_GPU pmj02_sampler::pmj02_sampler(std::uint32_t seed)
+        : _seed(seed)
+    {}
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T pmj02_sampler::get_1d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const
+    {
+        std::uint64_t h = impl::pixel_hash(pixel, dimension, _seed);
+        auto shuffled = owen_scramble(index, static_cast<std::uint32_t>(h));
+        return to_unit<T>(owen_scramble(tables::sobol(shuffled, 0), static_cast<std::uint32_t>(h >> 32)));
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU point<T, 2> pmj02_sampler::get_2d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const
+    {
+        std::uint64_t h = impl::pixel_hash(pixel, dimension, _seed), g = mix_bits(h);
+        auto shuffled = owen_scramble(index, static_cast<std::uint32_t>(h));
+        return {
+            to_unit<T>(owen_scramble(tables::sobol(shuffled, 0), static_cast<std::uint32_t>(h >> 32))),
+            to_unit<T>(owen_scramble(tables::sobol(shuffled, 1), static_cast<std::uint32_t>(g)))
+        };
+    }
+
+}
+
+#endif //GPU_RAYTRACE_SAMPLERS_INL
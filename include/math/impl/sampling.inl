@@ -3,8 +3,12 @@
 
 #include "math/sampling.hpp"
 #include "math/floats.hpp"
+#include "math/tables.hpp"
 
-namespace math
+#include <algorithm>
+#include <cmath>
+
+namespace math::sampling
 {
 
     template<std::floating_point T>
@@ -29,14 +33,14 @@ namespace math
     constexpr CPU_GPU T linear_pdf(T u, T a, T b)
     {
         if (u < 0 || u > 1) return 0;
-        return 2 * std::lerp(a, b, x) / (a + b);
+        return 2 * std::lerp(a, b, u) / (a + b);
     }
 
     template<std::floating_point T>
     constexpr CPU_GPU T sample_linear(T u, T a, T b)
     {
         if (u == 0 && a == 0) return 0;
-        T uu = u * (a + b) / (a + std::sqrt(std::lerp(u, a * a, b * b)));
+        T uu = u * (a + b) / (a + std::sqrt(std::lerp(a * a, b * b, u)));
         return std::min(uu, math::one_minus_epsilon<T>);
     }
 
@@ -61,7 +65,18 @@ namespace math
         return {
             1,
             u[0] >= 0 && u[0] < 1 ? 2 * math::pi<T> * u[0] : 0,
-            u[1] >= 0 && u[1] < 1 ? math::arccos(1 - 2 * u[1]) : 0
+            u[1] >= 0 && u[1] < 1 ? tables::polar_angle(u[1]) : 0
+        };
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU point<T, 3> sample_cosine_hemisphere(point<T, 2> u)
+    {
+        // Malley's method: the projection of a uniform disk sample, at polar angle arcsin(sqrt(u))
+        return {
+            1,
+            u[0] >= 0 && u[0] < 1 ? 2 * math::pi<T> * u[0] : 0,
+            u[1] >= 0 && u[1] < 1 ? tables::polar_angle(u[1]) / 2 : 0
         };
     }
 
@@ -69,9 +84,9 @@ namespace math
     constexpr CPU_GPU point<T, 3> sample_sphere(point<T, 3> u)
     {
         return {
-            u[0] >= 0 && u[1] < 1 ? math::pow(u[0], static_cast<T>(1) / 3) : 0,
+            u[0] >= 0 && u[0] < 1 ? math::pow(u[0], static_cast<T>(1) / 3) : 0,
             u[1] >= 0 && u[1] < 1 ? 2 * math::pi<T> * u[1] : 0,
-            u[2] >= 0 && u[1] < 1 ? math::arccos(1 - 2 * u[2]) : 0
+            u[2] >= 0 && u[2] < 1 ? tables::polar_angle(u[2]) : 0
         };
     }
 
@@ -0,0 +1,188 @@
+#ifndef GPU_RAYTRACE_SAMPLING_BATCH_INL
+#define GPU_RAYTRACE_SAMPLING_BATCH_INL
+
+#include "math/sampling_batch.hpp"
+#include "math/fast_functions.hpp"
+#include "math/floats.hpp"
+#include "math/simd/lane.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace math::sampling
+{
+
+    namespace impl
+    {
+        // samples per chunk handed to the pool. below this, scheduling costs more than the kernels
+        constexpr std::size_t BATCH_GRAIN = 4096;
+
+        inline void check_batch_sizes(std::size_t in, std::size_t out)
+        {
+            if (in != out) throw std::invalid_argument{ "batch sampling needs an output span the size of its input span" };
+        }
+
+        /**
+         * calls kernel(first, n) for every packet of native_width<T> values, the last one holding the n < W left over.
+         */
+        template<std::floating_point T, typename Kernel>
+        void for_each_packet(std::size_t count, base::thread_pool& pool, Kernel&& kernel)
+        {
+            constexpr std::size_t W = native_width<T>;
+            pool.parallel_for(0, (count + W - 1) / W, BATCH_GRAIN / W, [&](std::size_t lo, std::size_t hi)
+            {
+                for (std::size_t p = lo; p < hi; ++p) kernel(p * W, std::min(W, count - p * W));
+            });
+        }
+
+        /**
+         * loads component c of the n points starting at first into a lane. missing lanes are zero.
+         */
+        template<std::floating_point T, std::size_t N>
+        lane<T, native_width<T>> gather(std::span<const point<T, N>> src, std::size_t first, std::size_t n, int c)
+        {
+            T buffer[native_width<T>] = {};
+            for (std::size_t i = 0; i < n; ++i) buffer[i] = src[first + i][c];
+            return lane<T, native_width<T>>::load(buffer);
+        }
+
+        /**
+         * writes the first n lanes of one lane per component to the points starting at first.
+         */
+        template<std::floating_point T, std::size_t N, typename... Lanes>
+        void scatter(std::span<point<T, N>> dst, std::size_t first, std::size_t n, const Lanes&... components)
+        {
+            static_assert(sizeof...(Lanes) == N, "scatter needs one lane per component");
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                int c = 0;
+                ((dst[first + i][c++] = components[i]), ...);
+            }
+        }
+
+        template<std::floating_point T, std::size_t W>
+        typename lane<T, W>::mask_type in_unit(const lane<T, W>& u)
+        {
+            return (u >= lane<T, W>(0)) & (u < lane<T, W>(1));
+        }
+
+        /**
+         * arccos(1 - 2u) for u in [0, 1), and zero elsewhere, as the single-sample functions do.
+         */
+        template<std::floating_point T, std::size_t W>
+        lane<T, W> polar_angle(const lane<T, W>& u)
+        {
+            lane<T, W> one(1);
+            return select(in_unit(u), math::fast::arccos(one - (u + u)), lane<T, W>(0));
+        }
+
+        template<std::floating_point T, std::size_t W>
+        lane<T, W> azimuth(const lane<T, W>& u)
+        {
+            return select(in_unit(u), u * lane<T, W>(tau<T>), lane<T, W>(0));
+        }
+    }
+
+    template<std::floating_point T>
+    void sample_disk(std::span<const point<T, 2>> u, std::span<point<T, 2>> out, base::thread_pool& pool)
+    {
+        using lane_type = lane<T, native_width<T>>;
+        impl::check_batch_sizes(u.size(), out.size());
+        impl::for_each_packet<T>(u.size(), pool, [&](std::size_t first, std::size_t n)
+        {
+            lane_type u0 = impl::gather(u, first, n, 0), u1 = impl::gather(u, first, n, 1);
+            lane_type r = select(impl::in_unit(u0), sqrt(u0), lane_type(0));
+            impl::scatter(out, first, n, r, impl::azimuth(u1));
+        });
+    }
+
+    template<std::floating_point T>
+    void sample_sphere_surface(std::span<const point<T, 2>> u, std::span<point<T, 3>> out, base::thread_pool& pool)
+    {
+        using lane_type = lane<T, native_width<T>>;
+        impl::check_batch_sizes(u.size(), out.size());
+        impl::for_each_packet<T>(u.size(), pool, [&](std::size_t first, std::size_t n)
+        {
+            lane_type u0 = impl::gather(u, first, n, 0), u1 = impl::gather(u, first, n, 1);
+            impl::scatter(out, first, n, lane_type(1), impl::azimuth(u0), impl::polar_angle(u1));
+        });
+    }
+
+    template<std::floating_point T>
+    void sample_cosine_hemisphere(std::span<const point<T, 2>> u, std::span<point<T, 3>> out, base::thread_pool& pool)
+    {
+        using lane_type = lane<T, native_width<T>>;
+        impl::check_batch_sizes(u.size(), out.size());
+        impl::for_each_packet<T>(u.size(), pool, [&](std::size_t first, std::size_t n)
+        {
+            lane_type u0 = impl::gather(u, first, n, 0), u1 = impl::gather(u, first, n, 1);
+            impl::scatter(out, first, n, lane_type(1), impl::azimuth(u0), impl::polar_angle(u1) * lane_type(0.5));
+        });
+    }
+
+    template<std::floating_point T>
+    void sample_sphere(std::span<const point<T, 3>> u, std::span<point<T, 3>> out, base::thread_pool& pool)
+    {
+        using lane_type = lane<T, native_width<T>>;
+        impl::check_batch_sizes(u.size(), out.size());
+        impl::for_each_packet<T>(u.size(), pool, [&](std::size_t first, std::size_t n)
+        {
+            lane_type u0 = impl::gather(u, first, n, 0), u1 = impl::gather(u, first, n, 1), u2 = impl::gather(u, first, n, 2);
+            lane_type r = select(impl::in_unit(u0), math::fast::pow(u0, lane_type(static_cast<T>(1) / 3)), lane_type(0));
+            impl::scatter(out, first, n, r, impl::azimuth(u1), impl::polar_angle(u2));
+        });
+    }
+
+    template<std::floating_point T>
+    void sample_linear(std::span<const T> u, T a, T b, std::span<T> out, base::thread_pool& pool)
+    {
+        using lane_type = lane<T, native_width<T>>;
+        impl::check_batch_sizes(u.size(), out.size());
+        impl::for_each_packet<T>(u.size(), pool, [&](std::size_t first, std::size_t n)
+        {
+            T buffer[lane_type::width] = {};
+            std::copy_n(u.data() + first, n, buffer);
+            lane_type x = lane_type::load(buffer);
+
+            lane_type aa(a * a), bb(b * b);
+            lane_type sampled = x * lane_type(a + b) / (lane_type(a) + sqrt(fma(x, bb - aa, aa)));
+            sampled = min(sampled, lane_type(math::one_minus_epsilon<T>));
+            // 0 / 0 at the origin of a density that starts at zero
+            if (a == 0) sampled = select(x == lane_type(0), lane_type(0), sampled);
+
+            sampled.store(buffer);
+            std::copy_n(buffer, n, out.data() + first);
+        });
+    }
+
+    template<std::floating_point T>
+    void sample_discrete(std::span<const T> weights, std::span<const T> u, std::span<int> out, base::thread_pool& pool)
+    {
+        impl::check_batch_sizes(u.size(), out.size());
+        if (weights.empty())
+        {
+            std::fill(out.begin(), out.end(), -1);
+            return;
+        }
+
+        // summed in the order of the single-sample scan, so the comparisons below see the same partial sums
+        std::vector<T> prefix(weights.size());
+        T sum = 0;
+        for (std::size_t i = 0; i < weights.size(); ++i) prefix[i] = sum += weights[i];
+
+        pool.parallel_for(0, u.size(), impl::BATCH_GRAIN, [&](std::size_t lo, std::size_t hi)
+        {
+            for (std::size_t i = lo; i < hi; ++i)
+            {
+                T uu = sum * u[i];
+                if (uu == sum) uu = math::next_floating_down(uu);
+                auto idx = static_cast<std::size_t>(std::upper_bound(prefix.begin(), prefix.end(), uu) - prefix.begin());
+                out[i] = static_cast<int>(std::min(idx, weights.size() - 1));
+            }
+        });
+    }
+
+}
+
+#endif //GPU_RAYTRACE_SAMPLING_BATCH_INL
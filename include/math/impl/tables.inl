@@ -0,0 +1,130 @@
+#ifndef GPU_RAYTRACE_TABLES_INL
+#define GPU_RAYTRACE_TABLES_INL
+
+#include "math/tables.hpp"
+
+namespace math::tables
+{
+
+    template<std::floating_point T, std::size_t N>
+    constexpr CPU_GPU T lookup_table<T, N>::lerp(T u) const
+    {
+        T x = u * static_cast<T>(N - 1);
+        if (!(x > 0)) return values[0];
+        if (x >= static_cast<T>(N - 1)) return values[N - 1];
+
+        auto i = static_cast<std::size_t>(x);
+        T t = x - static_cast<T>(i);
+        return values[i] + t * (values[i + 1] - values[i]);
+    }
+
+    template<std::floating_point T, std::size_t N, typename Fn>
+    constexpr lookup_table<T, N> tabulate(Fn fn)
+    {
+        lookup_table<T, N> table{};
+        for (std::size_t i = 0; i < N; ++i) table.values[i] = static_cast<T>(fn(static_cast<double>(i) / static_cast<double>(N - 1)));
+        return table;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU T polar_angle(T u)
+    {
+        // arccos(1 - 2u) = 2 arcsin(sqrt(u)), and pi minus that past 1/2, so the arcsin stays away from its pole
+        bool upper = u > static_cast<T>(0.5);
+        T s = math::sqrt(upper ? 1 - u : u);
+        T angle = std::is_constant_evaluated()
+                ? 2 * math::arcsin(s)
+                : half_angle_arcsin<T>.lerp(s * static_cast<T>(1.41421356237309504880));
+        return upper ? pi<T> - angle : angle;
+    }
+
+    template<std::floating_point T>
+    constexpr CPU_GPU void sincos_turn(T u, T& s, T& c)
+    {
+        if (std::is_constant_evaluated())
+        {
+            s = math::sin(tau<T> * u);
+            c = math::cos(tau<T> * u);
+            return;
+        }
+
+        // fold the turn onto the quarter wave. cos(x) is sin(x) a quadrant later
+        T quarters = u * 4;
+        int quadrant = static_cast<int>(quarters);
+        T t = quarters - static_cast<T>(quadrant);
+        quadrant &= 3;
+
+        T rising = quarter_sine<T>.lerp(t), falling = quarter_sine<T>.lerp(1 - t);
+        s = (quadrant & 1 ? falling : rising) * (quadrant & 2 ? -1 : 1);
+        c = (quadrant & 1 ? rising : falling) * (quadrant == 1 || quadrant == 2 ? -1 : 1);
+    }
+
+    namespace impl
+    {
+        struct sobol_polynomial
+        {
+            std::uint32_t degree; // degree s of the primitive polynomial
+            std::uint32_t coefficients; // its s - 1 inner coefficients, highest first
+            std::uint32_t initial[8]; // the odd initial direction numbers m_1 ... m_s
+        };
+
+        // dimensions 1 and up of the new-joe-kuo-6 set. dimension 0 is the van der Corput sequence
+        constexpr sobol_polynomial sobol_polynomials[SOBOL_DIMENSIONS - 1] = {
+            { 1, 0, { 1 } },
+            { 2, 1, { 1, 3 } },
+            { 3, 1, { 1, 3, 1 } },
+            { 3, 2, { 1, 1, 1 } },
+            { 4, 1, { 1, 1, 3, 3 } },
+            { 4, 4, { 1, 3, 5, 13 } },
+            { 5, 2, { 1, 1, 5, 5, 17 } },
+            { 5, 4, { 1, 1, 5, 5, 5 } },
+            { 5, 7, { 1, 1, 7, 11, 19 } },
+            { 5, 11, { 1, 1, 5, 1, 1 } },
+            { 5, 13, { 1, 1, 1, 3, 11 } },
+            { 5, 14, { 1, 3, 5, 5, 31 } },
+            { 6, 1, { 1, 3, 3, 9, 7, 49 } },
+            { 6, 13, { 1, 1, 1, 15, 21, 21 } },
+            { 6, 16, { 1, 3, 1, 13, 27, 49 } }
+        };
+    }
+
+    constexpr sobol_matrix_set generate_sobol_matrices()
+    {
+        sobol_matrix_set set{};
+        for (std::size_t bit = 0; bit < SOBOL_BITS; ++bit) set.columns[0][bit] = 1u << (SOBOL_BITS - 1 - bit);
+
+        for (std::size_t dim = 1; dim < SOBOL_DIMENSIONS; ++dim)
+        {
+            const impl::sobol_polynomial& p = impl::sobol_polynomials[dim - 1];
+            std::uint32_t* v = set.columns[dim];
+            for (std::size_t k = 0; k < p.degree; ++k) v[k] = p.initial[k] << (SOBOL_BITS - 1 - k);
+
+            // v_k = v_(k-s) ^ (v_(k-s) >> s) ^ a_1 v_(k-1) ^ ... ^ a_(s-1) v_(k-s+1)
+            for (std::size_t k = p.degree; k < SOBOL_BITS; ++k)
+            {
+                std::uint32_t next = v[k - p.degree] ^ (v[k - p.degree] >> p.degree);
+                for (std::size_t j = 1; j < p.degree; ++j)
+                {
+                    if ((p.coefficients >> (p.degree - 1 - j)) & 1) next ^= v[k - j];
+                }
+                v[k] = next;
+            }
+        }
+        return set;
+    }
+
+    constexpr CONSTANT inline sobol_matrix_set sobol_matrices = generate_sobol_matrices();
+
+    constexpr CPU_GPU std::uint32_t sobol(std::uint32_t index, std::size_t dimension)
+    {
+        std::uint32_t value = 0;
+        for (std::size_t bit = 0; index; ++bit, index >>= 1)
+        {
+            if (index & 1) value ^= sobol_matrices.columns[dimension][bit];
+        }
+        return value;
+    }
+
+}
+
+#endif //GPU_RAYTRACE_TABLES_INL
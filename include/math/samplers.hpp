@@ -0,0 +1,211 @@
+#ifndef GPU_RAYTRACE_SAMPLERS_HPP
+#define GPU_RAYTRACE_SAMPLERS_HPP
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+#include "gpu/gpu.hpp"
+#include "floats.hpp"
+#include "tables.hpp"
+#include "geometry/point.hpp"
+
+/**
+ * generators of the uniform values consumed by math::sampling. every sampler is stateless: a value is a pure function
+ * of the pixel, the index of the sample within the pixel and the dimension, so any sample can be regenerated on any
+ * thread or device without replaying the ones before it.
+ */
+namespace math::samplers
+{
+
+    /**
+     * scrambles the bits of a 64-bit value with a variant of the MurmurHash3 finalizer.
+     * @param v value to mix
+     * @return the mixed value. the mapping is a bijection
+     */
+    constexpr CPU_GPU std::uint64_t mix_bits(std::uint64_t v);
+
+    /**
+     * hashes a sequence of integers into 64 bits.
+     * @tparam Ts integral types
+     * @param values values to hash, in order
+     * @return the hash
+     */
+    template<std::integral... Ts>
+    constexpr CPU_GPU std::uint64_t hash(Ts... values);
+
+    /**
+     * reverses the order of the bits of a 32-bit value.
+     * @param v value to reverse
+     * @return v with bit i moved to bit 31 - i
+     */
+    constexpr CPU_GPU std::uint32_t reverse_bits(std::uint32_t v);
+
+    /**
+     * a nested uniform (Owen) scramble of a 0.32 fixed point value. every bit is flipped by a hash of the seed and the
+     * bits above it, so a stratified set of values stays stratified at every power of two after the scramble.
+     * @param v value to scramble
+     * @param seed selects the scramble
+     * @return the scrambled value
+     */
+    constexpr CPU_GPU std::uint32_t owen_scramble(std::uint32_t v, std::uint32_t seed);
+
+    /**
+     * converts a 0.32 fixed point value to a floating point value in [0, 1).
+     * @tparam T floating point type
+     * @param bits value scaled by 2^32
+     * @return the value, rounded down to below 1 if it would round up to it
+     */
+    template<std::floating_point T>
+    constexpr CPU_GPU T to_unit(std::uint32_t bits);
+
+    /**
+     * the radical inverse of an index in some base with its digits scrambled by a nested random digit shift: the shift
+     * of each digit is a hash of the seed and the digits before it.
+     * @tparam T floating point type
+     * @param base base of the radical inverse
+     * @param index index of the point
+     * @param seed selects the scramble
+     * @return the scrambled radical inverse in [0, 1)
+     */
+    template<std::floating_point T>
+    constexpr CPU_GPU T owen_scrambled_radical_inverse(std::uint32_t base, std::uint64_t index, std::uint64_t seed);
+
+    /**
+     * the PCG32 generator of O'Neill: a 64-bit linear congruential state with a permuted 32-bit output.
+     * each sequence is an independent stream and it can be advanced by any distance in logarithmic time.
+     */
+    class pcg32
+    {
+    private:
+        std::uint64_t _state; // current state of the congruential generator
+        std::uint64_t _inc; // odd increment selecting the stream
+    public:
+        constexpr CPU_GPU pcg32();
+
+        /**
+         * @param sequence index of the stream
+         * @param seed starting offset within the stream
+         */
+        constexpr CPU_GPU pcg32(std::uint64_t sequence, std::uint64_t seed);
+
+        /**
+         * @param sequence index of the stream. the offset within it is a hash of the index
+         */
+        constexpr CPU_GPU explicit pcg32(std::uint64_t sequence);
+
+        constexpr CPU_GPU void set_sequence(std::uint64_t sequence, std::uint64_t seed);
+
+        /**
+         * @return the next 32 random bits
+         */
+        constexpr CPU_GPU std::uint32_t next_uint();
+
+        /**
+         * @tparam T floating point type
+         * @return the next uniform value in [0, 1)
+         */
+        template<std::floating_point T>
+        constexpr CPU_GPU T uniform();
+
+        /**
+         * skips ahead in the stream.
+         * @param delta number of values to skip. negative values move back
+         */
+        constexpr CPU_GPU void advance(std::int64_t delta);
+    };
+
+    /**
+     * anything that generates uniform values in [0, 1) indexed by pixel, sample index and dimension.
+     * get_2d consumes the dimensions dimension and dimension + 1.
+     */
+    template<typename S>
+    concept sampler = requires(const S s, point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension)
+    {
+        { s.template get_1d<float>(pixel, index, dimension) } -> std::same_as<float>;
+        { s.template get_2d<float>(pixel, index, dimension) } -> std::same_as<point<float, 2>>;
+    };
+
+    /**
+     * white noise from PCG32. the stream is picked by the pixel and the position in it by the sample index and
+     * dimension. it is the baseline the other samplers are measured against.
+     */
+    class independent_sampler
+    {
+    private:
+        std::uint32_t _seed; // decorrelates renders
+    public:
+        constexpr CPU_GPU explicit independent_sampler(std::uint32_t seed = 0);
+
+        template<std::floating_point T>
+        constexpr CPU_GPU T get_1d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const;
+
+        template<std::floating_point T>
+        constexpr CPU_GPU point<T, 2> get_2d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const;
+    };
+
+    /**
+     * the Sobol sequence of tables::sobol_matrices with an Owen scramble per pixel and dimension. the indices of each
+     * pixel are shuffled by a nested scramble, which keeps every power-of-two prefix of them stratified. dimensions
+     * past tables::SOBOL_DIMENSIONS reuse the generator matrices under a different shuffle.
+     */
+    class sobol_sampler
+    {
+    private:
+        std::uint32_t _seed; // decorrelates renders
+    public:
+        constexpr CPU_GPU explicit sobol_sampler(std::uint32_t seed = 0);
+
+        template<std::floating_point T>
+        constexpr CPU_GPU T get_1d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const;
+
+        template<std::floating_point T>
+        constexpr CPU_GPU point<T, 2> get_2d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const;
+    };
+
+    constexpr inline std::size_t HALTON_DIMENSIONS = 64;
+
+    /**
+     * the Halton sequence with dimension i in the radical inverse of the i-th prime, scrambled per pixel and dimension.
+     * dimensions past HALTON_DIMENSIONS reuse the bases under a different scramble.
+     */
+    class halton_sampler
+    {
+    private:
+        std::uint32_t _seed; // decorrelates renders
+    public:
+        constexpr CPU_GPU explicit halton_sampler(std::uint32_t seed = 0);
+
+        template<std::floating_point T>
+        constexpr CPU_GPU T get_1d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const;
+
+        template<std::floating_point T>
+        constexpr CPU_GPU point<T, 2> get_2d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const;
+    };
+
+    /**
+     * progressive multi-jittered (0,2) samples. every 2D pair is a (0,2) sequence: any power-of-two prefix of it has
+     * one point in each elementary interval of its size, so it is stratified in both 1D projections and every
+     * power-of-two grid at once. the pairs are drawn from the first two Sobol dimensions, which form such a sequence,
+     * with an index shuffle and an Owen scramble that are independent per pixel and pair, as in Burley's construction,
+     * so no precomputed point sets are needed.
+     */
+    class pmj02_sampler
+    {
+    private:
+        std::uint32_t _seed; // decorrelates renders
+    public:
+        constexpr CPU_GPU explicit pmj02_sampler(std::uint32_t seed = 0);
+
+        template<std::floating_point T>
+        constexpr CPU_GPU T get_1d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const;
+
+        template<std::floating_point T>
+        constexpr CPU_GPU point<T, 2> get_2d(point<int, 2> pixel, std::uint32_t index, std::uint32_t dimension) const;
+    };
+
+}
+
+#include "impl/samplers.inl"
+
+#endif //GPU_RAYTRACE_SAMPLERS_HPP
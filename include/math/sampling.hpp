@@ -5,14 +5,15 @@
 #include <span>
 
 #include "gpu/gpu.hpp"
-#include "math/linalg/point.hpp"
+#include "math/geometry/point.hpp"
 
 namespace math::sampling
 {
 
     /**
      * performs a discrete sampling based on a provided PMF via the inversion method.
-     * The PMF does not need to be normalized.
+     * The PMF does not need to be normalized. each call costs O(n), so a PMF that is sampled repeatedly should be
+     * built into an alias_table or a piecewise_constant_1d instead.
      * @tparam T floating point type used in calculations
      * @param weights weights that form PMF to sample from
      * @param u uniform random value in interval [0,1)
@@ -74,6 +75,15 @@ namespace math::sampling
     template<std::floating_point T>
     constexpr CPU_GPU point<T, 3> sample_sphere_surface(point<T, 2> u);
 
+    /**
+     * performs a cosine-weighted sample from the hemisphere around the z axis with radius of 1
+     * @tparam T floating point type
+     * @param u vector of two with sampled values in interval [0, 1)
+     * @return the spherical coordinates (r, theta, phi) of the sampled surface
+     */
+    template<std::floating_point T>
+    constexpr CPU_GPU point<T, 3> sample_cosine_hemisphere(point<T, 2> u);
+
     /**
      * performs a uniform sample from the volume of a sphere with radius of 1
      * @tparam T floating point type
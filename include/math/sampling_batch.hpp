@@ -0,0 +1,85 @@
+#ifndef GPU_RAYTRACE_SAMPLING_BATCH_HPP
+#define GPU_RAYTRACE_SAMPLING_BATCH_HPP
+
+#include <concepts>
+#include <span>
+
+#include "base/thread_pool.hpp"
+#include "sampling.hpp"
+#include "geometry/point.hpp"
+
+/**
+ * span versions of the functions of math/sampling.hpp, which turn a whole buffer of uniform values into samples in one
+ * call. the continuous samplings process native_width<T> values at a time in SIMD lanes, and spans of more than a few
+ * thousand samples are split across the thread pool.
+ * the transcendental functions come from math::fast at high precision, so the results agree with the single-sample
+ * functions to within the error of their lookup tables rather than bit for bit.
+ * every function throws std::invalid_argument if its output span is not the size of its input span.
+ */
+namespace math::sampling
+{
+
+    /**
+     * @see sample_disk(point<T, 2>)
+     * @param u sampled values in interval [0, 1)
+     * @param out receives the polar coordinates (r, theta) of each sample
+     * @param pool pool running the batch
+     */
+    template<std::floating_point T>
+    void sample_disk(std::span<const point<T, 2>> u, std::span<point<T, 2>> out, base::thread_pool& pool = base::thread_pool::global());
+
+    /**
+     * @see sample_sphere_surface(point<T, 2>)
+     * @param u sampled values in interval [0, 1)
+     * @param out receives the spherical coordinates (r, theta, phi) of each sample
+     * @param pool pool running the batch
+     */
+    template<std::floating_point T>
+    void sample_sphere_surface(std::span<const point<T, 2>> u, std::span<point<T, 3>> out, base::thread_pool& pool = base::thread_pool::global());
+
+    /**
+     * @see sample_cosine_hemisphere(point<T, 2>)
+     * @param u sampled values in interval [0, 1)
+     * @param out receives the spherical coordinates (r, theta, phi) of each sample
+     * @param pool pool running the batch
+     */
+    template<std::floating_point T>
+    void sample_cosine_hemisphere(std::span<const point<T, 2>> u, std::span<point<T, 3>> out, base::thread_pool& pool = base::thread_pool::global());
+
+    /**
+     * @see sample_sphere(point<T, 3>)
+     * @param u sampled values in interval [0, 1)
+     * @param out receives the spherical coordinates (r, theta, phi) of each sample
+     * @param pool pool running the batch
+     */
+    template<std::floating_point T>
+    void sample_sphere(std::span<const point<T, 3>> u, std::span<point<T, 3>> out, base::thread_pool& pool = base::thread_pool::global());
+
+    /**
+     * @see sample_linear(T, T, T)
+     * @param u uniform random values in interval [0, 1)
+     * @param a lower bound
+     * @param b upper bound
+     * @param out receives the linearly sampled values
+     * @param pool pool running the batch
+     */
+    template<std::floating_point T>
+    void sample_linear(std::span<const T> u, T a, T b, std::span<T> out, base::thread_pool& pool = base::thread_pool::global());
+
+    /**
+     * @see sample_discrete(std::span<const T>, T)
+     * the prefix sums of the weights are computed once, so each sample costs a binary search instead of a scan. the
+     * indices are the same as those of the single-sample function.
+     * @param weights weights that form the PMF to sample from
+     * @param u uniform random values in interval [0, 1)
+     * @param out receives the index sampled by each value. -1 on an empty PMF
+     * @param pool pool running the batch
+     */
+    template<std::floating_point T>
+    void sample_discrete(std::span<const T> weights, std::span<const T> u, std::span<int> out, base::thread_pool& pool = base::thread_pool::global());
+
+}
+
+#include "impl/sampling_batch.inl"
+
+#endif //GPU_RAYTRACE_SAMPLING_BATCH_HPP
@@ -0,0 +1,176 @@
+#ifndef GPU_RAYTRACE_LANE_AVX_INL
+#define GPU_RAYTRACE_LANE_AVX_INL
+
+#include "math/simd/lane.hpp"
+
+namespace math
+{
+
+    namespace impl
+    {
+        // applies op between the upper and lower half
+        template<typename Op>
+        inline __m128 fold(__m256 v, Op op)
+        {
+            return op(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        }
+
+#ifdef __AVX2__
+        // 2^e for integral e in [-126, 127]
+        inline __m256 pow2(__m256i e)
+        {
+            return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(e, _mm256_set1_epi32(127)), 23));
+        }
+#else
+        // AVX has no 256 bit integer instructions, so the bit manipulation runs on the SSE halves
+        template<typename Op>
+        inline __m256 halves(__m256 v, __m256 w, Op op)
+        {
+            __m128 lo = op(_mm256_castps256_ps128(v), _mm256_castps256_ps128(w));
+            __m128 hi = op(_mm256_extractf128_ps(v, 1), _mm256_extractf128_ps(w, 1));
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+        }
+#endif
+
+        inline __m256 ldexp(__m256 v, __m256 e)
+        {
+#ifdef __AVX2__
+            __m256i k = _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(e, _mm256_set1_ps(-252.0f)), _mm256_set1_ps(254.0f)));
+            __m256i half = _mm256_srai_epi32(k, 1);
+            return _mm256_mul_ps(_mm256_mul_ps(v, pow2(half)), pow2(_mm256_sub_epi32(k, half)));
+#else
+            return halves(v, e, [](__m128 x, __m128 y) { return ldexp(x, y); });
+#endif
+        }
+
+        inline __m256 frexp(__m256 v, __m256& e)
+        {
+#ifdef __AVX2__
+            __m256i bits = _mm256_castps_si256(v);
+            __m256i exponent = _mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xFF));
+            e = _mm256_cvtepi32_ps(_mm256_sub_epi32(exponent, _mm256_set1_epi32(126)));
+            __m256i mantissa = _mm256_and_si256(bits, _mm256_set1_epi32(static_cast<int>(0x807FFFFF)));
+            return _mm256_castsi256_ps(_mm256_or_si256(mantissa, _mm256_set1_epi32(0x3F000000)));
+#else
+            __m128 e_lo, e_hi;
+            __m128 lo = frexp(_mm256_castps256_ps128(v), e_lo);
+            __m128 hi = frexp(_mm256_extractf128_ps(v, 1), e_hi);
+            e = _mm256_insertf128_ps(_mm256_castps128_ps256(e_lo), e_hi, 1);
+            return _mm256_insertf128_ps(_mm256_castps128_ps256(lo), hi, 1);
+#endif
+        }
+    }
+
+    template<>
+    class lane_mask<float, 8>
+    {
+    public:
+        constexpr static std::size_t width = 8;
+        constexpr static std::uint32_t full = 0xFF;
+    private:
+        __m256 _mask;
+    public:
+        lane_mask() : _mask{ _mm256_setzero_ps() } {}
+        explicit lane_mask(bool value) : _mask{ value ? _mm256_castsi256_ps(_mm256_set1_epi32(-1)) : _mm256_setzero_ps() } {}
+        explicit lane_mask(__m256 mask) : _mask{ mask } {}
+
+        static lane_mask from_bits(std::uint32_t bits)
+        {
+            return lane_mask{ _mm256_set_m128(impl::mask_from_bits(bits >> 4), impl::mask_from_bits(bits)) };
+        }
+
+        __m256 native() const { return _mask; }
+        std::uint32_t bits() const { return static_cast<std::uint32_t>(_mm256_movemask_ps(_mask)); }
+        bool operator[](std::size_t idx) const { return (bits() >> idx) & 1; }
+
+        bool any() const { return !_mm256_testz_ps(_mask, _mask); }
+        bool all() const { return bits() == full; }
+        bool none() const { return _mm256_testz_ps(_mask, _mask); }
+
+        lane_mask& operator&=(const lane_mask& m) { _mask = _mm256_and_ps(_mask, m._mask); return *this; }
+        lane_mask& operator|=(const lane_mask& m) { _mask = _mm256_or_ps(_mask, m._mask); return *this; }
+        lane_mask& operator^=(const lane_mask& m) { _mask = _mm256_xor_ps(_mask, m._mask); return *this; }
+
+        friend lane_mask operator&(lane_mask a, const lane_mask& b) { return a &= b; }
+        friend lane_mask operator|(lane_mask a, const lane_mask& b) { return a |= b; }
+        friend lane_mask operator^(lane_mask a, const lane_mask& b) { return a ^= b; }
+        friend lane_mask operator~(const lane_mask& a) { return lane_mask{ _mm256_xor_ps(a._mask, _mm256_castsi256_ps(_mm256_set1_epi32(-1))) }; }
+    };
+
+    template<>
+    class lane<float, 8>
+    {
+    public:
+        using value_type = float;
+        using mask_type = lane_mask<float, 8>;
+        constexpr static std::size_t width = 8;
+    private:
+        __m256 _values;
+    public:
+        lane() : _values{ _mm256_setzero_ps() } {}
+        lane(float value) : _values{ _mm256_set1_ps(value) } {}
+        explicit lane(__m256 values) : _values{ values } {}
+
+        static lane load(const float* src) { return lane{ _mm256_loadu_ps(src) }; }
+        static lane load_aligned(const float* src) { return lane{ _mm256_load_ps(src) }; }
+
+        void store(float* dst) const { _mm256_storeu_ps(dst, _values); }
+        void store_aligned(float* dst) const { _mm256_store_ps(dst, _values); }
+
+        __m256 native() const { return _values; }
+
+        float operator[](std::size_t idx) const { alignas(32) float v[8]; store_aligned(v); return v[idx]; }
+        void set(std::size_t idx, float value) { alignas(32) float v[8]; store_aligned(v); v[idx] = value; _values = _mm256_load_ps(v); }
+
+        lane& operator+=(const lane& l) { _values = _mm256_add_ps(_values, l._values); return *this; }
+        lane& operator-=(const lane& l) { _values = _mm256_sub_ps(_values, l._values); return *this; }
+        lane& operator*=(const lane& l) { _values = _mm256_mul_ps(_values, l._values); return *this; }
+        lane& operator/=(const lane& l) { _values = _mm256_div_ps(_values, l._values); return *this; }
+
+        friend lane operator+(lane a, const lane& b) { return a += b; }
+        friend lane operator-(lane a, const lane& b) { return a -= b; }
+        friend lane operator*(lane a, const lane& b) { return a *= b; }
+        friend lane operator/(lane a, const lane& b) { return a /= b; }
+        friend lane operator-(const lane& a) { return lane{ _mm256_xor_ps(a._values, _mm256_set1_ps(-0.0f)) }; }
+
+        friend mask_type operator==(const lane& a, const lane& b) { return mask_type{ _mm256_cmp_ps(a._values, b._values, _CMP_EQ_OQ) }; }
+        friend mask_type operator!=(const lane& a, const lane& b) { return mask_type{ _mm256_cmp_ps(a._values, b._values, _CMP_NEQ_UQ) }; }
+        friend mask_type operator<(const lane& a, const lane& b) { return mask_type{ _mm256_cmp_ps(a._values, b._values, _CMP_LT_OQ) }; }
+        friend mask_type operator<=(const lane& a, const lane& b) { return mask_type{ _mm256_cmp_ps(a._values, b._values, _CMP_LE_OQ) }; }
+        friend mask_type operator>(const lane& a, const lane& b) { return mask_type{ _mm256_cmp_ps(a._values, b._values, _CMP_GT_OQ) }; }
+        friend mask_type operator>=(const lane& a, const lane& b) { return mask_type{ _mm256_cmp_ps(a._values, b._values, _CMP_GE_OQ) }; }
+
+        friend lane min(const lane& a, const lane& b) { return lane{ _mm256_min_ps(a._values, b._values) }; }
+        friend lane max(const lane& a, const lane& b) { return lane{ _mm256_max_ps(a._values, b._values) }; }
+
+        friend lane fma(const lane& a, const lane& b, const lane& c)
+        {
+#ifdef __FMA__
+            return lane{ _mm256_fmadd_ps(a._values, b._values, c._values) };
+#else
+            return lane{ _mm256_add_ps(_mm256_mul_ps(a._values, b._values), c._values) };
+#endif
+        }
+
+        friend lane sqrt(const lane& a) { return lane{ _mm256_sqrt_ps(a._values) }; }
+        friend lane abs(const lane& a) { return lane{ _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a._values) }; }
+        friend lane copysign(const lane& value, const lane& sign)
+        {
+            __m256 sign_bit = _mm256_set1_ps(-0.0f);
+            return lane{ _mm256_or_ps(_mm256_andnot_ps(sign_bit, value._values), _mm256_and_ps(sign_bit, sign._values)) };
+        }
+
+        friend lane round(const lane& a) { return lane{ _mm256_round_ps(a._values, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+        friend lane ldexp(const lane& a, const lane& e) { return lane{ impl::ldexp(a._values, e._values) }; }
+        friend lane frexp(const lane& a, lane& e) { return lane{ impl::frexp(a._values, e._values) }; }
+
+        friend lane select(const mask_type& m, const lane& a, const lane& b) { return lane{ _mm256_blendv_ps(b._values, a._values, m.native()) }; }
+
+        friend float reduce_add(const lane& a) { return reduce_add(lane<float, 4>{ impl::fold(a._values, [](__m128 x, __m128 y) { return _mm_add_ps(x, y); }) }); }
+        friend float reduce_min(const lane& a) { return reduce_min(lane<float, 4>{ impl::fold(a._values, [](__m128 x, __m128 y) { return _mm_min_ps(x, y); }) }); }
+        friend float reduce_max(const lane& a) { return reduce_max(lane<float, 4>{ impl::fold(a._values, [](__m128 x, __m128 y) { return _mm_max_ps(x, y); }) }); }
+    };
+
+}
+
+#endif //GPU_RAYTRACE_LANE_AVX_INL
@@ -0,0 +1,118 @@
+#ifndef GPU_RAYTRACE_LANE_AVX512_INL
+#define GPU_RAYTRACE_LANE_AVX512_INL
+
+#include "math/simd/lane.hpp"
+
+namespace math
+{
+
+    template<>
+    class lane_mask<float, 16>
+    {
+    public:
+        constexpr static std::size_t width = 16;
+        constexpr static std::uint32_t full = 0xFFFF;
+    private:
+        __mmask16 _mask;
+    public:
+        lane_mask() : _mask{ 0 } {}
+        explicit lane_mask(bool value) : _mask{ static_cast<__mmask16>(value ? full : 0) } {}
+        explicit lane_mask(__mmask16 mask) : _mask{ mask } {}
+
+        static lane_mask from_bits(std::uint32_t bits) { return lane_mask{ static_cast<__mmask16>(bits & full) }; }
+
+        __mmask16 native() const { return _mask; }
+        std::uint32_t bits() const { return _mask; }
+        bool operator[](std::size_t idx) const { return (_mask >> idx) & 1; }
+
+        bool any() const { return _mask != 0; }
+        bool all() const { return _mask == full; }
+        bool none() const { return _mask == 0; }
+
+        lane_mask& operator&=(const lane_mask& m) { _mask &= m._mask; return *this; }
+        lane_mask& operator|=(const lane_mask& m) { _mask |= m._mask; return *this; }
+        lane_mask& operator^=(const lane_mask& m) { _mask ^= m._mask; return *this; }
+
+        friend lane_mask operator&(lane_mask a, const lane_mask& b) { return a &= b; }
+        friend lane_mask operator|(lane_mask a, const lane_mask& b) { return a |= b; }
+        friend lane_mask operator^(lane_mask a, const lane_mask& b) { return a ^= b; }
+        friend lane_mask operator~(const lane_mask& a) { return lane_mask{ static_cast<__mmask16>(~a._mask) }; }
+    };
+
+    template<>
+    class lane<float, 16>
+    {
+    public:
+        using value_type = float;
+        using mask_type = lane_mask<float, 16>;
+        constexpr static std::size_t width = 16;
+    private:
+        __m512 _values;
+
+        // AVX-512F has no float logic instructions, so these go through the integer ones
+        static __m512i bits_of(__m512 v) { return _mm512_castps_si512(v); }
+    public:
+        lane() : _values{ _mm512_setzero_ps() } {}
+        lane(float value) : _values{ _mm512_set1_ps(value) } {}
+        explicit lane(__m512 values) : _values{ values } {}
+
+        static lane load(const float* src) { return lane{ _mm512_loadu_ps(src) }; }
+        static lane load_aligned(const float* src) { return lane{ _mm512_load_ps(src) }; }
+
+        void store(float* dst) const { _mm512_storeu_ps(dst, _values); }
+        void store_aligned(float* dst) const { _mm512_store_ps(dst, _values); }
+
+        __m512 native() const { return _values; }
+
+        float operator[](std::size_t idx) const { alignas(64) float v[16]; store_aligned(v); return v[idx]; }
+        void set(std::size_t idx, float value) { _values = _mm512_mask_mov_ps(_values, static_cast<__mmask16>(1u << idx), _mm512_set1_ps(value)); }
+
+        lane& operator+=(const lane& l) { _values = _mm512_add_ps(_values, l._values); return *this; }
+        lane& operator-=(const lane& l) { _values = _mm512_sub_ps(_values, l._values); return *this; }
+        lane& operator*=(const lane& l) { _values = _mm512_mul_ps(_values, l._values); return *this; }
+        lane& operator/=(const lane& l) { _values = _mm512_div_ps(_values, l._values); return *this; }
+
+        friend lane operator+(lane a, const lane& b) { return a += b; }
+        friend lane operator-(lane a, const lane& b) { return a -= b; }
+        friend lane operator*(lane a, const lane& b) { return a *= b; }
+        friend lane operator/(lane a, const lane& b) { return a /= b; }
+        friend lane operator-(const lane& a) { return lane{ _mm512_castsi512_ps(_mm512_xor_epi32(bits_of(a._values), _mm512_set1_epi32(INT32_MIN))) }; }
+
+        friend mask_type operator==(const lane& a, const lane& b) { return mask_type{ _mm512_cmp_ps_mask(a._values, b._values, _CMP_EQ_OQ) }; }
+        friend mask_type operator!=(const lane& a, const lane& b) { return mask_type{ _mm512_cmp_ps_mask(a._values, b._values, _CMP_NEQ_UQ) }; }
+        friend mask_type operator<(const lane& a, const lane& b) { return mask_type{ _mm512_cmp_ps_mask(a._values, b._values, _CMP_LT_OQ) }; }
+        friend mask_type operator<=(const lane& a, const lane& b) { return mask_type{ _mm512_cmp_ps_mask(a._values, b._values, _CMP_LE_OQ) }; }
+        friend mask_type operator>(const lane& a, const lane& b) { return mask_type{ _mm512_cmp_ps_mask(a._values, b._values, _CMP_GT_OQ) }; }
+        friend mask_type operator>=(const lane& a, const lane& b) { return mask_type{ _mm512_cmp_ps_mask(a._values, b._values, _CMP_GE_OQ) }; }
+
+        friend lane min(const lane& a, const lane& b) { return lane{ _mm512_min_ps(a._values, b._values) }; }
+        friend lane max(const lane& a, const lane& b) { return lane{ _mm512_max_ps(a._values, b._values) }; }
+
+        friend lane fma(const lane& a, const lane& b, const lane& c) { return lane{ _mm512_fmadd_ps(a._values, b._values, c._values) }; }
+        friend lane sqrt(const lane& a) { return lane{ _mm512_sqrt_ps(a._values) }; }
+        friend lane abs(const lane& a) { return lane{ _mm512_abs_ps(a._values) }; }
+        friend lane copysign(const lane& value, const lane& sign)
+        {
+            __m512i sign_bit = _mm512_set1_epi32(INT32_MIN);
+            return lane{ _mm512_castsi512_ps(_mm512_or_epi32(_mm512_andnot_epi32(sign_bit, bits_of(value._values)), _mm512_and_epi32(sign_bit, bits_of(sign._values)))) };
+        }
+
+        friend lane round(const lane& a) { return lane{ _mm512_roundscale_ps(a._values, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC) }; }
+        friend lane ldexp(const lane& a, const lane& e) { return lane{ _mm512_scalef_ps(a._values, e._values) }; }
+        friend lane frexp(const lane& a, lane& e)
+        {
+            // getexp returns floor(log2 |a|), one less than the exponent of a mantissa in [0.5, 1)
+            e._values = _mm512_add_ps(_mm512_getexp_ps(a._values), _mm512_set1_ps(1.0f));
+            return lane{ _mm512_getmant_ps(a._values, _MM_MANT_NORM_p5_1, _MM_MANT_SIGN_src) };
+        }
+
+        friend lane select(const mask_type& m, const lane& a, const lane& b) { return lane{ _mm512_mask_blend_ps(m.native(), b._values, a._values) }; }
+
+        friend float reduce_add(const lane& a) { return _mm512_reduce_add_ps(a._values); }
+        friend float reduce_min(const lane& a) { return _mm512_reduce_min_ps(a._values); }
+        friend float reduce_max(const lane& a) { return _mm512_reduce_max_ps(a._values); }
+    };
+
+}
+
+#endif //GPU_RAYTRACE_LANE_AVX512_INL
@@ -0,0 +1,182 @@
+#ifndef GPU_RAYTRACE_LANE_SSE_INL
+#define GPU_RAYTRACE_LANE_SSE_INL
+
+#include "math/simd/lane.hpp"
+
+namespace math
+{
+
+    namespace impl
+    {
+        inline __m128 blend(__m128 m, __m128 a, __m128 b)
+        {
+#ifdef __SSE4_1__
+            return _mm_blendv_ps(b, a, m);
+#else
+            return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b));
+#endif
+        }
+
+        // applies op between the halves, then between the two remaining values
+        template<typename Op>
+        inline float reduce(__m128 v, Op op)
+        {
+            __m128 swapped = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+            __m128 pairs = op(v, swapped);
+            return _mm_cvtss_f32(op(pairs, _mm_movehl_ps(swapped, pairs)));
+        }
+
+        inline __m128 mask_from_bits(std::uint32_t bits)
+        {
+            __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+            __m128i selected = _mm_and_si128(_mm_set1_epi32(static_cast<int>(bits)), lanes);
+            return _mm_castsi128_ps(_mm_cmpeq_epi32(selected, lanes));
+        }
+
+        inline __m128 round(__m128 v)
+        {
+#ifdef __SSE4_1__
+            return _mm_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+#else
+            // adding and removing 2^23 drops the fraction. values that large are already integral
+            __m128 magnitude = _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+            __m128 rounded = _mm_sub_ps(_mm_add_ps(magnitude, _mm_set1_ps(0x1p23f)), _mm_set1_ps(0x1p23f));
+            rounded = _mm_or_ps(rounded, _mm_and_ps(_mm_set1_ps(-0.0f), v));
+            return blend(_mm_cmplt_ps(magnitude, _mm_set1_ps(0x1p23f)), rounded, v);
+#endif
+        }
+
+        // 2^e for integral e in [-126, 127]
+        inline __m128 pow2(__m128i e)
+        {
+            return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(e, _mm_set1_epi32(127)), 23));
+        }
+
+        // scales by two powers of two, so that exponents reaching into the subnormals or past the largest float work
+        inline __m128 ldexp(__m128 v, __m128 e)
+        {
+            __m128i k = _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(e, _mm_set1_ps(-252.0f)), _mm_set1_ps(254.0f)));
+            __m128i half = _mm_srai_epi32(k, 1);
+            return _mm_mul_ps(_mm_mul_ps(v, pow2(half)), pow2(_mm_sub_epi32(k, half)));
+        }
+
+        inline __m128 frexp(__m128 v, __m128& e)
+        {
+            __m128i bits = _mm_castps_si128(v);
+            __m128i exponent = _mm_and_si128(_mm_srli_epi32(bits, 23), _mm_set1_epi32(0xFF));
+            e = _mm_cvtepi32_ps(_mm_sub_epi32(exponent, _mm_set1_epi32(126)));
+            __m128i mantissa = _mm_and_si128(bits, _mm_set1_epi32(static_cast<int>(0x807FFFFF)));
+            return _mm_castsi128_ps(_mm_or_si128(mantissa, _mm_set1_epi32(0x3F000000)));
+        }
+    }
+
+    template<>
+    class lane_mask<float, 4>
+    {
+    public:
+        constexpr static std::size_t width = 4;
+        constexpr static std::uint32_t full = 0xF;
+    private:
+        __m128 _mask;
+    public:
+        lane_mask() : _mask{ _mm_setzero_ps() } {}
+        explicit lane_mask(bool value) : _mask{ value ? _mm_castsi128_ps(_mm_set1_epi32(-1)) : _mm_setzero_ps() } {}
+        explicit lane_mask(__m128 mask) : _mask{ mask } {}
+
+        static lane_mask from_bits(std::uint32_t bits) { return lane_mask{ impl::mask_from_bits(bits) }; }
+
+        __m128 native() const { return _mask; }
+        std::uint32_t bits() const { return static_cast<std::uint32_t>(_mm_movemask_ps(_mask)); }
+        bool operator[](std::size_t idx) const { return (bits() >> idx) & 1; }
+
+        bool any() const { return bits() != 0; }
+        bool all() const { return bits() == full; }
+        bool none() const { return bits() == 0; }
+
+        lane_mask& operator&=(const lane_mask& m) { _mask = _mm_and_ps(_mask, m._mask); return *this; }
+        lane_mask& operator|=(const lane_mask& m) { _mask = _mm_or_ps(_mask, m._mask); return *this; }
+        lane_mask& operator^=(const lane_mask& m) { _mask = _mm_xor_ps(_mask, m._mask); return *this; }
+
+        friend lane_mask operator&(lane_mask a, const lane_mask& b) { return a &= b; }
+        friend lane_mask operator|(lane_mask a, const lane_mask& b) { return a |= b; }
+        friend lane_mask operator^(lane_mask a, const lane_mask& b) { return a ^= b; }
+        friend lane_mask operator~(const lane_mask& a) { return lane_mask{ _mm_xor_ps(a._mask, _mm_castsi128_ps(_mm_set1_epi32(-1))) }; }
+    };
+
+    template<>
+    class lane<float, 4>
+    {
+    public:
+        using value_type = float;
+        using mask_type = lane_mask<float, 4>;
+        constexpr static std::size_t width = 4;
+    private:
+        __m128 _values;
+    public:
+        lane() : _values{ _mm_setzero_ps() } {}
+        lane(float value) : _values{ _mm_set1_ps(value) } {}
+        explicit lane(__m128 values) : _values{ values } {}
+
+        static lane load(const float* src) { return lane{ _mm_loadu_ps(src) }; }
+        static lane load_aligned(const float* src) { return lane{ _mm_load_ps(src) }; }
+
+        void store(float* dst) const { _mm_storeu_ps(dst, _values); }
+        void store_aligned(float* dst) const { _mm_store_ps(dst, _values); }
+
+        __m128 native() const { return _values; }
+
+        float operator[](std::size_t idx) const { alignas(16) float v[4]; store_aligned(v); return v[idx]; }
+        void set(std::size_t idx, float value) { alignas(16) float v[4]; store_aligned(v); v[idx] = value; _values = _mm_load_ps(v); }
+
+        lane& operator+=(const lane& l) { _values = _mm_add_ps(_values, l._values); return *this; }
+        lane& operator-=(const lane& l) { _values = _mm_sub_ps(_values, l._values); return *this; }
+        lane& operator*=(const lane& l) { _values = _mm_mul_ps(_values, l._values); return *this; }
+        lane& operator/=(const lane& l) { _values = _mm_div_ps(_values, l._values); return *this; }
+
+        friend lane operator+(lane a, const lane& b) { return a += b; }
+        friend lane operator-(lane a, const lane& b) { return a -= b; }
+        friend lane operator*(lane a, const lane& b) { return a *= b; }
+        friend lane operator/(lane a, const lane& b) { return a /= b; }
+        friend lane operator-(const lane& a) { return lane{ _mm_xor_ps(a._values, _mm_set1_ps(-0.0f)) }; }
+
+        friend mask_type operator==(const lane& a, const lane& b) { return mask_type{ _mm_cmpeq_ps(a._values, b._values) }; }
+        friend mask_type operator!=(const lane& a, const lane& b) { return mask_type{ _mm_cmpneq_ps(a._values, b._values) }; }
+        friend mask_type operator<(const lane& a, const lane& b) { return mask_type{ _mm_cmplt_ps(a._values, b._values) }; }
+        friend mask_type operator<=(const lane& a, const lane& b) { return mask_type{ _mm_cmple_ps(a._values, b._values) }; }
+        friend mask_type operator>(const lane& a, const lane& b) { return mask_type{ _mm_cmpgt_ps(a._values, b._values) }; }
+        friend mask_type operator>=(const lane& a, const lane& b) { return mask_type{ _mm_cmpge_ps(a._values, b._values) }; }
+
+        friend lane min(const lane& a, const lane& b) { return lane{ _mm_min_ps(a._values, b._values) }; }
+        friend lane max(const lane& a, const lane& b) { return lane{ _mm_max_ps(a._values, b._values) }; }
+
+        friend lane fma(const lane& a, const lane& b, const lane& c)
+        {
+#ifdef __FMA__
+            return lane{ _mm_fmadd_ps(a._values, b._values, c._values) };
+#else
+            return lane{ _mm_add_ps(_mm_mul_ps(a._values, b._values), c._values) };
+#endif
+        }
+
+        friend lane sqrt(const lane& a) { return lane{ _mm_sqrt_ps(a._values) }; }
+        friend lane abs(const lane& a) { return lane{ _mm_andnot_ps(_mm_set1_ps(-0.0f), a._values) }; }
+        friend lane copysign(const lane& value, const lane& sign)
+        {
+            __m128 sign_bit = _mm_set1_ps(-0.0f);
+            return lane{ _mm_or_ps(_mm_andnot_ps(sign_bit, value._values), _mm_and_ps(sign_bit, sign._values)) };
+        }
+
+        friend lane round(const lane& a) { return lane{ impl::round(a._values) }; }
+        friend lane ldexp(const lane& a, const lane& e) { return lane{ impl::ldexp(a._values, e._values) }; }
+        friend lane frexp(const lane& a, lane& e) { return lane{ impl::frexp(a._values, e._values) }; }
+
+        friend lane select(const mask_type& m, const lane& a, const lane& b) { return lane{ impl::blend(m.native(), a._values, b._values) }; }
+
+        friend float reduce_add(const lane& a) { return impl::reduce(a._values, [](__m128 x, __m128 y) { return _mm_add_ps(x, y); }); }
+        friend float reduce_min(const lane& a) { return impl::reduce(a._values, [](__m128 x, __m128 y) { return _mm_min_ps(x, y); }); }
+        friend float reduce_max(const lane& a) { return impl::reduce(a._values, [](__m128 x, __m128 y) { return _mm_max_ps(x, y); }); }
+    };
+
+}
+
+#endif //GPU_RAYTRACE_LANE_SSE_INL
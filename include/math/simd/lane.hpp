@@ -0,0 +1,238 @@
+#ifndef GPU_RAYTRACE_LANE_HPP
+#define GPU_RAYTRACE_LANE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <type_traits>
+
+#include "gpu/gpu.hpp"
+#include "math/functions.hpp"
+
+// the intrinsic backends are picked from the target flags of the compiler (e.g. -mavx2 -mfma or -mavx512f).
+// device code always uses the portable lanes
+#if !defined(__CUDA_ARCH__) && defined(__SSE2__)
+#define RAYTRACE_SIMD_SSE2
+#include <immintrin.h>
+#endif
+
+#if defined(RAYTRACE_SIMD_SSE2) && defined(__SSE4_1__)
+#define RAYTRACE_SIMD_SSE41
+#endif
+
+#if defined(RAYTRACE_SIMD_SSE2) && defined(__AVX__)
+#define RAYTRACE_SIMD_AVX
+#endif
+
+#if defined(RAYTRACE_SIMD_SSE2) && defined(__AVX512F__)
+#define RAYTRACE_SIMD_AVX512
+#endif
+
+namespace math
+{
+
+    /**
+     * per-lane booleans produced by comparing lanes.
+     * the portable version stores one bit per lane, the intrinsic backends keep the comparison result in a register.
+     * @tparam T value type of the compared lanes
+     * @tparam W number of lanes
+     */
+    template<typename T, std::size_t W>
+    class lane_mask
+    {
+        static_assert(W > 0 && W <= 32, "lane masks hold at most 32 lanes");
+    public:
+        constexpr static std::size_t width = W;
+        constexpr static std::uint32_t full = W == 32 ? ~0u : (1u << W) - 1;
+    private:
+        std::uint32_t _bits;
+    public:
+        constexpr CPU_GPU lane_mask() : _bits{ 0 } {}
+        constexpr CPU_GPU explicit lane_mask(bool value) : _bits{ value ? full : 0 } {}
+
+        /**
+         * @param bits bit i set when lane i is set. bits past the width are ignored.
+         */
+        constexpr static CPU_GPU lane_mask from_bits(std::uint32_t bits) { lane_mask m; m._bits = bits & full; return m; }
+
+        constexpr CPU_GPU std::uint32_t bits() const { return _bits; }
+        constexpr CPU_GPU bool operator[](std::size_t idx) const { return (_bits >> idx) & 1; }
+
+        constexpr CPU_GPU bool any() const { return _bits != 0; }
+        constexpr CPU_GPU bool all() const { return _bits == full; }
+        constexpr CPU_GPU bool none() const { return _bits == 0; }
+
+        constexpr CPU_GPU lane_mask& operator&=(const lane_mask& m) { _bits &= m._bits; return *this; }
+        constexpr CPU_GPU lane_mask& operator|=(const lane_mask& m) { _bits |= m._bits; return *this; }
+        constexpr CPU_GPU lane_mask& operator^=(const lane_mask& m) { _bits ^= m._bits; return *this; }
+
+        friend constexpr CPU_GPU lane_mask operator&(lane_mask a, const lane_mask& b) { return a &= b; }
+        friend constexpr CPU_GPU lane_mask operator|(lane_mask a, const lane_mask& b) { return a |= b; }
+        friend constexpr CPU_GPU lane_mask operator^(lane_mask a, const lane_mask& b) { return a ^= b; }
+        friend constexpr CPU_GPU lane_mask operator~(const lane_mask& a) { return from_bits(~a._bits); }
+    };
+
+    /**
+     * W values of T operated on together, one per SIMD lane.
+     * this portable version is a plain array which the compiler may vectorize on its own. float lanes of width 4, 8
+     * and 16 are specialized with SSE, AVX and AVX-512 intrinsics when the target supports them.
+     * scalars convert implicitly to lanes by broadcasting, so lanes mix freely with values of T in expressions.
+     * @tparam T value type
+     * @tparam W number of lanes
+     */
+    template<typename T, std::size_t W>
+    class lane
+    {
+    public:
+        using value_type = T;
+        using mask_type = lane_mask<T, W>;
+        constexpr static std::size_t width = W;
+    private:
+        T _values[W];
+
+        template<typename Fn>
+        constexpr static CPU_GPU lane map(Fn fn)
+        {
+            lane l;
+            for (std::size_t i = 0; i < W; ++i) l._values[i] = fn(i);
+            return l;
+        }
+
+        template<typename Fn>
+        constexpr static CPU_GPU mask_type test(Fn fn)
+        {
+            std::uint32_t bits = 0;
+            for (std::size_t i = 0; i < W; ++i) bits |= static_cast<std::uint32_t>(fn(i)) << i;
+            return mask_type::from_bits(bits);
+        }
+    public:
+        constexpr CPU_GPU lane() : _values{} {}
+        constexpr CPU_GPU lane(T value) { for (auto& v : _values) v = value; }
+
+        /**
+         * @param src W consecutive values. need not be aligned.
+         */
+        constexpr static CPU_GPU lane load(const T* src) { return map([=](std::size_t i) { return src[i]; }); }
+
+        /**
+         * @param src W consecutive values aligned to sizeof(lane).
+         */
+        constexpr static CPU_GPU lane load_aligned(const T* src) { return load(src); }
+
+        constexpr CPU_GPU void store(T* dst) const { for (std::size_t i = 0; i < W; ++i) dst[i] = _values[i]; }
+        constexpr CPU_GPU void store_aligned(T* dst) const { store(dst); }
+
+        constexpr CPU_GPU T operator[](std::size_t idx) const { return _values[idx]; }
+        constexpr CPU_GPU void set(std::size_t idx, T value) { _values[idx] = value; }
+
+        constexpr CPU_GPU lane& operator+=(const lane& l) { for (std::size_t i = 0; i < W; ++i) _values[i] += l._values[i]; return *this; }
+        constexpr CPU_GPU lane& operator-=(const lane& l) { for (std::size_t i = 0; i < W; ++i) _values[i] -= l._values[i]; return *this; }
+        constexpr CPU_GPU lane& operator*=(const lane& l) { for (std::size_t i = 0; i < W; ++i) _values[i] *= l._values[i]; return *this; }
+        constexpr CPU_GPU lane& operator/=(const lane& l) { for (std::size_t i = 0; i < W; ++i) _values[i] /= l._values[i]; return *this; }
+
+        friend constexpr CPU_GPU lane operator+(lane a, const lane& b) { return a += b; }
+        friend constexpr CPU_GPU lane operator-(lane a, const lane& b) { return a -= b; }
+        friend constexpr CPU_GPU lane operator*(lane a, const lane& b) { return a *= b; }
+        friend constexpr CPU_GPU lane operator/(lane a, const lane& b) { return a /= b; }
+        friend constexpr CPU_GPU lane operator-(const lane& a) { return map([&](std::size_t i) { return -a._values[i]; }); }
+
+        friend constexpr CPU_GPU mask_type operator==(const lane& a, const lane& b) { return test([&](std::size_t i) { return a._values[i] == b._values[i]; }); }
+        friend constexpr CPU_GPU mask_type operator!=(const lane& a, const lane& b) { return test([&](std::size_t i) { return a._values[i] != b._values[i]; }); }
+        friend constexpr CPU_GPU mask_type operator<(const lane& a, const lane& b) { return test([&](std::size_t i) { return a._values[i] < b._values[i]; }); }
+        friend constexpr CPU_GPU mask_type operator<=(const lane& a, const lane& b) { return test([&](std::size_t i) { return a._values[i] <= b._values[i]; }); }
+        friend constexpr CPU_GPU mask_type operator>(const lane& a, const lane& b) { return test([&](std::size_t i) { return a._values[i] > b._values[i]; }); }
+        friend constexpr CPU_GPU mask_type operator>=(const lane& a, const lane& b) { return test([&](std::size_t i) { return a._values[i] >= b._values[i]; }); }
+
+        // like the SSE instructions, these return the second argument when either is NaN
+        friend constexpr CPU_GPU lane min(const lane& a, const lane& b) { return map([&](std::size_t i) { return a._values[i] < b._values[i] ? a._values[i] : b._values[i]; }); }
+        friend constexpr CPU_GPU lane max(const lane& a, const lane& b) { return map([&](std::size_t i) { return a._values[i] > b._values[i] ? a._values[i] : b._values[i]; }); }
+
+        friend CPU_GPU lane fma(const lane& a, const lane& b, const lane& c) { return map([&](std::size_t i) { return std::fma(a._values[i], b._values[i], c._values[i]); }); }
+        friend CPU_GPU lane sqrt(const lane& a) { return map([&](std::size_t i) { return math::sqrt(a._values[i]); }); }
+        friend CPU_GPU lane abs(const lane& a) { return map([&](std::size_t i) { return std::abs(a._values[i]); }); }
+        friend CPU_GPU lane copysign(const lane& value, const lane& sign) { return map([&](std::size_t i) { return math::copysign(value._values[i], sign._values[i]); }); }
+
+        /**
+         * rounds to the nearest integer, ties to even.
+         */
+        friend CPU_GPU lane round(const lane& a) { return map([&](std::size_t i) { return std::rint(a._values[i]); }); }
+
+        /**
+         * @param a value to scale
+         * @param e integral exponents
+         * @return a * 2^e. results past the range of T overflow to infinity or underflow through the subnormals. a NaN
+         * exponent gives NaN.
+         */
+        friend CPU_GPU lane ldexp(const lane& a, const lane& e)
+        {
+            return map([&](std::size_t i)
+            {
+                // NaN must not reach the cast to int, which is undefined for it
+                T x = a._values[i], n = e._values[i];
+                return n != n ? x + n : std::ldexp(x, static_cast<int>(n));
+            });
+        }
+
+        /**
+         * splits finite, nonzero and normal values into a mantissa and an exponent, so that a = mantissa * 2^e.
+         * @param a value to split
+         * @param e receives the integral exponents
+         * @return the mantissas, with magnitudes in [0.5, 1) and the sign of a
+         */
+        friend CPU_GPU lane frexp(const lane& a, lane& e)
+        {
+            lane m;
+            for (std::size_t i = 0; i < W; ++i)
+            {
+                int exponent;
+                m._values[i] = std::frexp(a._values[i], &exponent);
+                e._values[i] = static_cast<T>(exponent);
+            }
+            return m;
+        }
+
+        /**
+         * @return a where the mask is set and b elsewhere.
+         */
+        friend constexpr CPU_GPU lane select(const mask_type& m, const lane& a, const lane& b) { return map([&](std::size_t i) { return m[i] ? a._values[i] : b._values[i]; }); }
+
+        friend constexpr CPU_GPU T reduce_add(const lane& a) { T sum = a._values[0]; for (std::size_t i = 1; i < W; ++i) sum += a._values[i]; return sum; }
+        friend constexpr CPU_GPU T reduce_min(const lane& a) { T m = a._values[0]; for (std::size_t i = 1; i < W; ++i) m = a._values[i] < m ? a._values[i] : m; return m; }
+        friend constexpr CPU_GPU T reduce_max(const lane& a) { T m = a._values[0]; for (std::size_t i = 1; i < W; ++i) m = a._values[i] > m ? a._values[i] : m; return m; }
+    };
+
+    using float4_lane = lane<float, 4>;
+    using float8_lane = lane<float, 8>;
+    using float16_lane = lane<float, 16>;
+
+}
+
+#ifdef RAYTRACE_SIMD_SSE2
+#include "impl/lane_sse.inl"
+#endif
+#ifdef RAYTRACE_SIMD_AVX
+#include "impl/lane_avx.inl"
+#endif
+#ifdef RAYTRACE_SIMD_AVX512
+#include "impl/lane_avx512.inl"
+#endif
+
+namespace math
+{
+
+    /**
+     * widest lane of T backed by intrinsics on this target, or 4 when none is.
+     */
+    template<typename T>
+    constexpr inline std::size_t native_width =
+#if defined(RAYTRACE_SIMD_AVX512)
+            std::is_same_v<T, float> ? 16 : 4;
+#elif defined(RAYTRACE_SIMD_AVX)
+            std::is_same_v<T, float> ? 8 : 4;
+#else
+            4;
+#endif
+
+}
+
+#endif //GPU_RAYTRACE_LANE_HPP
@@ -0,0 +1,114 @@
+#ifndef GPU_RAYTRACE_TABLES_HPP
+#define GPU_RAYTRACE_TABLES_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <concepts>
+
+#include "gpu/gpu.hpp"
+#include "functions.hpp"
+
+/**
+ * lookup tables generated at compile time with the series of math/functions.hpp. they are constexpr, so they are
+ * placed in .rodata on the CPU and in constant memory under CUDA, and sampling them costs a fetch and a lerp instead of
+ * a call into libm.
+ */
+namespace math::tables
+{
+
+    /**
+     * samples of a function at N evenly spaced points of [0, 1], the first at 0 and the last at 1.
+     * @tparam T floating point type
+     * @tparam N number of samples
+     */
+    template<std::floating_point T, std::size_t N>
+    struct lookup_table
+    {
+        static_assert(N >= 2, "a lookup table needs both of its end points");
+
+        T values[N];
+
+        constexpr CPU_GPU T operator[](std::size_t idx) const { return values[idx]; }
+
+        /**
+         * linearly interpolates between the two samples surrounding u.
+         * @param u position in [0, 1]. values outside are clamped
+         * @return the interpolated value
+         */
+        constexpr CPU_GPU T lerp(T u) const;
+    };
+
+    /**
+     * tabulates fn at N evenly spaced points of [0, 1].
+     * @tparam T floating point type
+     * @tparam N number of samples
+     * @param fn function of [0, 1], evaluated at compile time in double and rounded once to T
+     */
+    template<std::floating_point T, std::size_t N, typename Fn>
+    constexpr lookup_table<T, N> tabulate(Fn fn);
+
+    constexpr inline std::size_t ARCSIN_TABLE_SIZE = 2048;
+    constexpr inline std::size_t SINE_TABLE_SIZE = 1025;
+
+    /**
+     * 2 arcsin(s) for s in [0, sqrt(1/2)], where it is smooth. the polar angles of the sphere and hemisphere samplings
+     * are looked up in it after folding their argument into this range.
+     */
+    template<std::floating_point T>
+    constexpr CONSTANT inline lookup_table<T, ARCSIN_TABLE_SIZE> half_angle_arcsin = tabulate<T, ARCSIN_TABLE_SIZE>(
+            [](double u) { return 2 * math::arcsin(u * math::sqrt(0.5)); });
+
+    /**
+     * sin(x) over the quarter wave x in [0, pi / 2]. the other quadrants are folded onto it.
+     */
+    template<std::floating_point T>
+    constexpr CONSTANT inline lookup_table<T, SINE_TABLE_SIZE> quarter_sine = tabulate<T, SINE_TABLE_SIZE>(
+            [](double u) { return math::sin(u * pi<double> / 2); });
+
+    /**
+     * arccos(1 - 2u), the polar angle of a uniform sample of the sphere.
+     * at runtime it costs a square root and a lookup in half_angle_arcsin, with an absolute error below 2^-22 in double
+     * and 2^-21 in float, where the rounding of the fold dominates.
+     * @tparam T floating point type
+     * @param u uniform value in [0, 1]
+     * @return angle in [0, pi]
+     */
+    template<std::floating_point T>
+    constexpr CPU_GPU T polar_angle(T u);
+
+    /**
+     * sin(2 pi u) and cos(2 pi u) from a lookup in quarter_sine, with an absolute error below 2^-21.
+     * @tparam T floating point type
+     * @param u fraction of a turn in [0, 1]
+     * @param s receives the sine
+     * @param c receives the cosine
+     */
+    template<std::floating_point T>
+    constexpr CPU_GPU void sincos_turn(T u, T& s, T& c);
+
+    constexpr inline std::size_t SOBOL_DIMENSIONS = 16;
+    constexpr inline std::size_t SOBOL_BITS = 32;
+
+    /**
+     * generator matrices of the first dimensions of the Sobol sequence, from the primitive polynomials and initial
+     * direction numbers of Joe and Kuo. column i of a dimension is the direction number of bit i of the index.
+     * the matrices are generated at compile time into tables::sobol_matrices.
+     */
+    struct sobol_matrix_set
+    {
+        std::uint32_t columns[SOBOL_DIMENSIONS][SOBOL_BITS];
+    };
+
+    /**
+     * a dimension of a point of the Sobol sequence as a 0.32 fixed point value.
+     * @param index index of the point
+     * @param dimension dimension below SOBOL_DIMENSIONS
+     * @return the coordinate scaled by 2^32
+     */
+    constexpr CPU_GPU std::uint32_t sobol(std::uint32_t index, std::size_t dimension);
+
+}
+
+#include "impl/tables.inl"
+
+#endif //GPU_RAYTRACE_TABLES_HPP
@@ -1,7 +1,10 @@
 #ifndef GPU_RAYTRACE_VIDEO_BUILDER_HPP
 #define GPU_RAYTRACE_VIDEO_BUILDER_HPP
 
+#include <cstdint>
 #include <exception>
+#include <map>
+#include <string>
 
 #include <fmt/core.h>
 extern "C"
@@ -10,13 +13,106 @@ extern "C"
 #include <libavcodec/avcodec.h>
 #include <libswscale/swscale.h>
 #include <libavutil/timestamp.h>
+#include <libavutil/pixdesc.h>
 }
 
 #include "base/image.hpp"
+#include "base/tiled_image.hpp"
 
 namespace media
 {
 
+    /**
+     * filter used by swscale when converting frames from RGB0. frames are never resized, so the filter only decides
+     * how the chroma planes are subsampled. the cheaper filters are usually indistinguishable after encoding.
+     */
+    enum class scaler_quality : int
+    {
+        point = SWS_POINT,
+        fast_bilinear = SWS_FAST_BILINEAR,
+        bilinear = SWS_BILINEAR,
+        bicubic = SWS_BICUBIC
+    };
+
+    /**
+     * what a video_builder writes its frames as.
+     */
+    enum class output_mode
+    {
+        encoded, // compressed by the configured encoder and muxed into the container deduced from the file name
+        y4m, // uncompressed YUV420P frames in a YUV4MPEG2 stream. needs no encoder
+        raw_rgb0, // the RGB0 frames exactly as pushed, back to back without any header. needs neither encoder nor conversion
+        ffv1, // lossless, intra-only FFV1 in planar RGB. the file name must name a container supporting it (e.g. .mkv)
+        fragmented_mp4, // encoded into an mp4 written as a series of self-contained fragments, playable before the video is finished
+        segmented // encoded into rolling HLS segments in the directory named by the file name, listed in its index.m3u8
+    };
+
+    /**
+     * snapshot of where a video_builder spent its time and what it produced.
+     * stages run on the encoding threads in asynchronous mode, so their times may add up to more than the wall time.
+     */
+    struct encoder_stats
+    {
+        struct stage
+        {
+            std::uint64_t calls = 0;
+            double seconds = 0; // total time spent in the stage
+        };
+
+        stage copy; // copying pushed frames into the builder's frames
+        stage convert; // sws_scale conversion from RGB0
+        stage send_frame; // avcodec_send_frame
+        stage receive_packet; // avcodec_receive_packet, including the calls finding no packet
+        stage mux; // av_interleaved_write_frame, or the file writes of the raw modes
+
+        std::uint64_t frames_pushed = 0; // frames committed by the caller
+        std::uint64_t frames_written = 0; // frames handed to the encoder or the raw output
+        std::uint64_t packets = 0; // packets muxed
+        std::uint64_t bytes_written = 0; // payload bytes of the muxed packets, or bytes written by the raw modes
+
+        /**
+         * @return number of frames committed but not yet handed to the encoder or the raw output.
+         */
+        std::uint64_t frames_queued() const;
+
+        /**
+         * @return the stats as a single JSON object.
+         */
+        std::string to_json() const;
+    };
+
+    /**
+     * settings used to open a video_builder.
+     */
+    struct video_settings
+    {
+        int width = 1080; // must be a multiple of two
+        int height = 720; // must be a multiple of two
+        int fps = 30;
+        int bitrate = 400000; // ignored when crf is set
+        int gop = 12; // group of pictures size
+        int b_frames = 2; // max number of b-frames in a gop
+
+        std::string codec; // name of the encoder (e.g. "libx264"). empty picks the default encoder of the container
+        int thread_count = 0; // threads used by the encoder. zero uses one per hardware thread
+        int thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE; // kinds of threading the encoder may use
+        std::string preset; // encoder speed preset (e.g. "veryfast" for libx264). empty keeps the encoder default
+        std::string tune; // encoder tuning (e.g. "animation" for libx264). empty keeps the encoder default
+        int crf = -1; // constant rate factor for encoders supporting it. negative encodes at the set bitrate
+        std::map<std::string, std::string> codec_options; // further private options passed to the encoder
+
+        output_mode mode = output_mode::encoded;
+        std::size_t write_buffer_size = 1 << 24; // bytes buffered before writing to disk in the raw modes
+        int segment_seconds = 4; // length of the segments in segmented mode. segments are only cut on keyframes
+        std::map<std::string, std::string> format_options; // further options passed to the muxer
+
+        std::size_t queue_depth = 0; // frames in flight when encoding asynchronously. zero encodes synchronously
+        int conversion_threads = 1; // horizontal slices converted in parallel
+        scaler_quality quality = scaler_quality::fast_bilinear; // filter used for the color conversion
+
+        std::string stats_file; // when set, the encoder stats are written there as JSON once the video is finished
+    };
+
     /**
      * class for errors that occur while using ffmpeg library functions.
      */
@@ -58,18 +154,93 @@ namespace media
         const AVCodec* codec = nullptr;
         AVCodecContext* codec_ctx = nullptr;
         AVFrame* yuv_frame = nullptr, * rgb_frame = nullptr;
-        SwsContext* sws_ctx = nullptr;
+        struct slice_converter; // converts RGB0 frames in horizontal slices, possibly in parallel
+        slice_converter* converter = nullptr;
         AVPacket* pkt = nullptr;
 
         int* pts;
         uint8_t* ref_count;
+        bool* frame_lent; // whether the frame of the synchronous mode is lent
+
+        struct encode_pipeline; // state of the asynchronous mode. null when encoding synchronously
+        encode_pipeline* pipeline = nullptr;
+
+        struct raw_writer; // output of the y4m and raw_rgb0 modes. null when writing through ffmpeg
+        raw_writer* writer = nullptr;
+
+        struct stats_recorder; // counters behind stats(), shared by every copy
+        stats_recorder* recorder;
 
         struct private_methods; // forward declare inner class for private member functions
     public:
 
+        /**
+         * writable view over an RGB0 frame lent by a video_builder. move-only.
+         * a frame destroyed without being committed goes back to the builder unencoded, so that an exception thrown
+         * while rendering into it does not lose the frame. must not outlive every copy of the builder which lent it.
+         */
+        class lent_frame
+        {
+        private:
+            friend class video_builder;
+
+            encode_pipeline* pipeline = nullptr; // pipeline owning the slot in asynchronous mode
+            bool* lent = nullptr; // flag of the builder owning the frame in synchronous mode
+            int slot = -1;
+            base::image view{ nullptr, 0, 0, 0 };
+
+            lent_frame(encode_pipeline* pipeline, bool* lent, int slot, base::image&& view);
+
+            /**
+             * gives the frame back to its builder, unencoded. does nothing if the frame is empty.
+             */
+            void release();
+
+            /**
+             * empties the handle without giving the frame back.
+             */
+            void detach();
+        public:
+            lent_frame() = default;
+
+            lent_frame(const lent_frame&) = delete;
+            lent_frame(lent_frame&& mv) noexcept;
+
+            lent_frame& operator=(const lent_frame&) = delete;
+            lent_frame& operator=(lent_frame&& mv) noexcept;
+
+            /**
+             * gives the frame back to its builder if it was not committed.
+             */
+            ~lent_frame();
+
+            /**
+             * @return whether the handle holds a frame which has not been committed.
+             */
+            bool empty() const;
+
+            /**
+             * rows of the view are padded as ffmpeg requires, so pixels must be addressed through the image (or its
+             * stride) rather than as a packed buffer.
+             * @return view over the frame. empty if the handle is.
+             */
+            base::image& get();
+            const base::image& get() const;
+        };
+
         /**
          * initializes the builder for the video. after construction, frames can be readily appended to the video.
          * upon its destruction, the video is outputted.
+         * @param fn file name of the video. requires an extension for ffmpeg to deduce the formatting type, unless
+         * settings.mode is one of the raw modes. in segmented mode, the directory receiving the segments, which is
+         * created if needed.
+         * @param settings encoding settings of the video.
+         * @throws ffmpeg_error if the encoder or the container could not be set up.
+         */
+        video_builder(const std::string& fn, const video_settings& settings);
+
+        /**
+         * initializes the builder for the video with the default settings of video_settings for anything not given.
          * @param fn file name of the video. requires an extension for ffmpeg to deduce the formatting type.
          * @param width width in pixels of the video. must be a multiple of two.
          * @param height height in pixels of the video. must be a multiple of two.
@@ -77,8 +248,14 @@ namespace media
          * @param fps frames per second for the video
          * @param gop group of pictures numbers.
          * @param b_frames max number of b-frames in the gop.
+         * @param queue_depth number of frames that may be in flight when encoding asynchronously. when zero, frames are
+         * converted and encoded on the calling thread. otherwise, push_frame only copies the frame into a ring of
+         * pre-allocated frames while dedicated threads convert and encode them.
+         * @param conversion_threads number of horizontal slices converted in parallel from RGB0 to YUV420P.
+         * @param quality filter used for the color conversion.
          */
-        video_builder(const std::string& fn, int width, int height, int bitrate, int fps, int gop, int b_frames);
+        video_builder(const std::string& fn, int width, int height, int bitrate, int fps, int gop, int b_frames, std::size_t queue_depth = 0,
+                      int conversion_threads = 1, scaler_quality quality = scaler_quality::fast_bilinear);
 
         /**
          * performs a shallow copy and increments one to the reference counter.
@@ -104,16 +281,58 @@ namespace media
 
         /**
          * pushes a single frame of data from rgbx data.
+         * in asynchronous mode, this blocks only while every frame of the ring is in flight.
          * @param rgbx_data bytes in the format RGBXRGBX...
          * @note every fourth byte is unused (marked X). this is for alignment.
+         * @throws ffmpeg_error if converting or encoding a previously pushed frame failed.
          */
         void push_frame(uint8_t* rgbx_data);
 
         /**
          * pushes a single frame of data from an image.
          * @param img image object to be recorded.
+         * @throws std::invalid_argument if the image does not have the size of the video.
          */
         void push_frame(const base::image& img);
+
+        /**
+         * pushes a single frame of data from a tiled image. the tiles are written straight into the builder's frame
+         * as scanlines, in parallel, so no intermediate row-major copy is made.
+         * @param img image object to be recorded.
+         * @throws std::invalid_argument if the image does not have the size of the video.
+         */
+        void push_frame(const base::tiled_image& img);
+
+        /**
+         * lends an RGB0 frame owned by the builder so that pixels can be rendered in place, saving the copy made by
+         * push_frame.
+         * in asynchronous mode, this blocks while every frame of the ring is in flight.
+         * @return the lent frame. it is encoded by commit_frame, or goes back to the builder unencoded when destroyed.
+         * @throws ffmpeg_error in synchronous mode if the frame is already lent, or if a previously pushed frame failed.
+         */
+        lent_frame lend_frame();
+
+        /**
+         * encodes a frame previously obtained from lend_frame. the frame is left empty once accepted.
+         * @param frame frame returned by lend_frame.
+         * @throws ffmpeg_error if the frame was not lent by this builder, in which case it is left untouched, or if
+         * converting or encoding failed.
+         */
+        void commit_frame(lent_frame&& frame);
+
+        /**
+         * blocks until every pushed frame has been handed to the muxer and, in the raw modes, writes the buffered
+         * frames to the output file. call it before the builder is destroyed to observe write errors on the last
+         * frames, since the destructor cannot report them.
+         * @throws ffmpeg_error if converting, encoding or writing any pushed frame failed.
+         */
+        void flush();
+
+        /**
+         * can be called at any time, including while frames are being encoded asynchronously.
+         * @return the stats gathered since the builder was opened.
+         */
+        encoder_stats stats() const;
     };
 
 }
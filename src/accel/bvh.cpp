@@ -0,0 +1,490 @@
+#include "accel/bvh.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace accel
+{
+
+    namespace
+    {
+        constexpr std::uint32_t MAX_BINS = 32;
+        constexpr std::size_t PARALLEL_BINNING_THRESHOLD = 1 << 16; // ranges this large bin on the pool
+        constexpr std::size_t BINNING_GRAIN = 1 << 14;
+        constexpr std::size_t PARALLEL_SUBTREE_THRESHOLD = 4096; // nodes this large build their children in parallel
+        constexpr int MEDIAN_SPLIT_DEPTH = 32; // below it every split halves the range, bounding the depth by 64
+
+        /**
+         * box of plain floats for the inner loops of the build, which the bounds of points and vectors do not inline
+         * as well.
+         */
+        struct box
+        {
+            float lower[3] = { std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity() };
+            float upper[3] = { -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity() };
+
+            void extend(const box& b)
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    lower[i] = std::min(lower[i], b.lower[i]);
+                    upper[i] = std::max(upper[i], b.upper[i]);
+                }
+            }
+
+            void extend(const float p[3])
+            {
+                for (int i = 0; i < 3; ++i)
+                {
+                    lower[i] = std::min(lower[i], p[i]);
+                    upper[i] = std::max(upper[i], p[i]);
+                }
+            }
+
+            float surface_area() const
+            {
+                if (lower[0] > upper[0]) return 0;
+                float dx = upper[0] - lower[0], dy = upper[1] - lower[1], dz = upper[2] - lower[2];
+                return 2 * (dx * dy + dx * dz + dy * dz);
+            }
+        };
+
+        /**
+         * the builder partitions these records rather than indices into them, so that every pass over a range reads
+         * memory in order.
+         */
+        struct primitive
+        {
+            box bounds;
+            float centroid[3];
+            std::uint32_t index;
+        };
+
+        struct build_node
+        {
+            box bounds;
+            std::uint32_t children[2];
+            std::uint32_t first;
+            std::uint32_t count; // zero for interior nodes
+            std::uint8_t axis;
+        };
+
+        struct bin
+        {
+            box bounds;
+            std::uint32_t count = 0;
+        };
+
+        struct range_bounds
+        {
+            box bounds;
+            box centroid_bounds;
+        };
+
+        /**
+         * maps centroids to the bins of a range along each axis.
+         */
+        struct binning
+        {
+            float origin[3];
+            float scale[3];
+            int bins;
+
+            int bin_of(const primitive& prim, int axis) const
+            {
+                auto b = static_cast<int>((prim.centroid[axis] - origin[axis]) * scale[axis]);
+                return std::clamp(b, 0, bins - 1);
+            }
+        };
+
+        class builder
+        {
+        private:
+            std::vector<primitive> _primitives;
+            std::vector<build_node> _nodes;
+            std::atomic<std::uint32_t> _node_count;
+            bvh_build_settings _settings;
+            base::thread_pool& _pool;
+
+            range_bounds compute_bounds(std::size_t begin, std::size_t end);
+            void compute_bins(std::size_t begin, std::size_t end, const binning& binner, bin (&bins)[3][MAX_BINS]);
+            std::size_t median_split(std::size_t begin, std::size_t end, int axis);
+            std::uint32_t make_leaf(std::uint32_t node, const box& bounds, std::size_t begin, std::size_t end);
+            std::uint32_t flatten(std::uint32_t node, std::vector<bvh_node>& out) const;
+        public:
+            builder(std::span<const math::bounds3f> bounds, const bvh_build_settings& settings, base::thread_pool& pool);
+
+            std::uint32_t build(std::size_t begin, std::size_t end, int depth);
+            std::vector<bvh_node> flatten() const;
+
+            /**
+             * @return the primitives in the order the leaves reference them
+             */
+            std::vector<std::uint32_t> primitive_order() const;
+        };
+
+        builder::builder(std::span<const math::bounds3f> bounds, const bvh_build_settings& settings, base::thread_pool& pool)
+            : _primitives(bounds.size()), _nodes(2 * bounds.size() - 1),
+              _node_count{ 0 }, _settings{ settings }, _pool{ pool }
+        {
+            _settings.bins = std::clamp<std::uint32_t>(_settings.bins, 2, MAX_BINS);
+            _settings.max_leaf_size = std::max<std::uint32_t>(_settings.max_leaf_size, 1);
+
+            _pool.parallel_for(0, bounds.size(), BINNING_GRAIN, [&](std::size_t lo, std::size_t hi)
+            {
+                for (std::size_t i = lo; i < hi; ++i)
+                {
+                    for (int axis = 0; axis < 3; ++axis)
+                    {
+                        _primitives[i].bounds.lower[axis] = bounds[i].get_min()[axis];
+                        _primitives[i].bounds.upper[axis] = bounds[i].get_max()[axis];
+                        _primitives[i].centroid[axis] = (bounds[i].get_min()[axis] + bounds[i].get_max()[axis]) / 2;
+                    }
+                    _primitives[i].index = static_cast<std::uint32_t>(i);
+                }
+            });
+        }
+
+        range_bounds builder::compute_bounds(std::size_t begin, std::size_t end)
+        {
+            auto accumulate = [&](std::size_t lo, std::size_t hi)
+            {
+                range_bounds r;
+                for (std::size_t i = lo; i < hi; ++i)
+                {
+                    const primitive& prim = _primitives[i];
+                    r.bounds.extend(prim.bounds);
+                    r.centroid_bounds.extend(prim.centroid);
+                }
+                return r;
+            };
+
+            if (end - begin < PARALLEL_BINNING_THRESHOLD) return accumulate(begin, end);
+
+            range_bounds total;
+            std::mutex mtx;
+            _pool.parallel_for(begin, end, BINNING_GRAIN, [&](std::size_t lo, std::size_t hi)
+            {
+                range_bounds r = accumulate(lo, hi);
+                std::lock_guard lock{ mtx };
+                total.bounds.extend(r.bounds);
+                total.centroid_bounds.extend(r.centroid_bounds);
+            });
+            return total;
+        }
+
+        void builder::compute_bins(std::size_t begin, std::size_t end, const binning& binner, bin (&bins)[3][MAX_BINS])
+        {
+            auto accumulate = [&](std::size_t lo, std::size_t hi, bin (&local)[3][MAX_BINS])
+            {
+                for (std::size_t i = lo; i < hi; ++i)
+                {
+                    const primitive& prim = _primitives[i];
+                    for (int axis = 0; axis < 3; ++axis)
+                    {
+                        bin& b = local[axis][binner.bin_of(prim, axis)];
+                        b.bounds.extend(prim.bounds);
+                        ++b.count;
+                    }
+                }
+            };
+
+            if (end - begin < PARALLEL_BINNING_THRESHOLD)
+            {
+                accumulate(begin, end, bins);
+                return;
+            }
+
+            std::mutex mtx;
+            _pool.parallel_for(begin, end, BINNING_GRAIN, [&](std::size_t lo, std::size_t hi)
+            {
+                bin local[3][MAX_BINS];
+                accumulate(lo, hi, local);
+                std::lock_guard lock{ mtx };
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    for (int b = 0; b < binner.bins; ++b)
+                    {
+                        bins[axis][b].bounds.extend(local[axis][b].bounds);
+                        bins[axis][b].count += local[axis][b].count;
+                    }
+                }
+            });
+        }
+
+        std::size_t builder::median_split(std::size_t begin, std::size_t end, int axis)
+        {
+            std::size_t mid = begin + (end - begin) / 2;
+            std::nth_element(_primitives.begin() + begin, _primitives.begin() + mid, _primitives.begin() + end,
+                             [&](const primitive& a, const primitive& b) { return a.centroid[axis] < b.centroid[axis]; });
+            return mid;
+        }
+
+        std::uint32_t builder::make_leaf(std::uint32_t node, const box& bounds, std::size_t begin, std::size_t end)
+        {
+            _nodes[node] = { bounds, { 0, 0 }, static_cast<std::uint32_t>(begin), static_cast<std::uint32_t>(end - begin), 0 };
+            return node;
+        }
+
+        std::uint32_t builder::build(std::size_t begin, std::size_t end, int depth)
+        {
+            std::uint32_t node = _node_count.fetch_add(1, std::memory_order_relaxed);
+            std::size_t count = end - begin;
+            auto [bounds, centroid_bounds] = compute_bounds(begin, end);
+            if (count == 1) return make_leaf(node, bounds, begin, end);
+
+            float extent[3];
+            for (int a = 0; a < 3; ++a) extent[a] = centroid_bounds.upper[a] - centroid_bounds.lower[a];
+            int axis = static_cast<int>(std::max_element(extent, extent + 3) - extent);
+
+            std::size_t mid = end;
+            if (extent[axis] == 0)
+            {
+                // every centroid coincides, so no plane separates the primitives
+                if (count <= _settings.max_leaf_size) return make_leaf(node, bounds, begin, end);
+                mid = begin + count / 2;
+            }
+            else if (depth >= MEDIAN_SPLIT_DEPTH)
+            {
+                mid = median_split(begin, end, axis);
+            }
+            else
+            {
+                binning binner;
+                // small nodes cannot use more bins than primitives, and sweeping empty ones dominates their cost
+                binner.bins = static_cast<int>(std::min<std::size_t>(_settings.bins, count));
+                for (int a = 0; a < 3; ++a)
+                {
+                    binner.origin[a] = centroid_bounds.lower[a];
+                    binner.scale[a] = extent[a] > 0 ? binner.bins / extent[a] : 0;
+                }
+
+                bin bins[3][MAX_BINS];
+                compute_bins(begin, end, binner, bins);
+
+                // sweep each axis from the right to get the cost of the primitives past each plane, then from the left
+                float best_cost = std::numeric_limits<float>::infinity();
+                int best_axis = -1, best_plane = 0;
+                for (int a = 0; a < 3; ++a)
+                {
+                    if (extent[a] == 0) continue;
+
+                    float right_cost[MAX_BINS];
+                    box right;
+                    std::uint32_t right_count = 0;
+                    for (int b = binner.bins - 1; b > 0; --b)
+                    {
+                        right.extend(bins[a][b].bounds);
+                        right_count += bins[a][b].count;
+                        right_cost[b - 1] = right_count * right.surface_area();
+                    }
+
+                    box left;
+                    std::uint32_t left_count = 0;
+                    for (int plane = 0; plane < binner.bins - 1; ++plane)
+                    {
+                        left.extend(bins[a][plane].bounds);
+                        left_count += bins[a][plane].count;
+                        float cost = left_count * left.surface_area() + right_cost[plane];
+                        if (left_count > 0 && left_count < count && cost < best_cost)
+                        {
+                            best_cost = cost;
+                            best_axis = a;
+                            best_plane = plane;
+                        }
+                    }
+                }
+
+                float area = bounds.surface_area();
+                float split_cost = _settings.traversal_cost + _settings.intersection_cost * (area > 0 ? best_cost / area : 0);
+                float leaf_cost = _settings.intersection_cost * count;
+                if (count <= _settings.max_leaf_size && (best_axis < 0 || leaf_cost <= split_cost))
+                {
+                    return make_leaf(node, bounds, begin, end);
+                }
+
+                if (best_axis >= 0)
+                {
+                    axis = best_axis;
+                    auto it = std::partition(_primitives.begin() + begin, _primitives.begin() + end, [&](const primitive& prim)
+                    {
+                        return binner.bin_of(prim, best_axis) <= best_plane;
+                    });
+                    mid = it - _primitives.begin();
+                }
+                if (mid == begin || mid == end) mid = median_split(begin, end, axis);
+            }
+
+            std::uint32_t children[2];
+            if (count >= PARALLEL_SUBTREE_THRESHOLD)
+            {
+                _pool.parallel_for(0, 2, 1, [&](std::size_t lo, std::size_t hi)
+                {
+                    for (std::size_t c = lo; c < hi; ++c)
+                    {
+                        children[c] = c == 0 ? build(begin, mid, depth + 1) : build(mid, end, depth + 1);
+                    }
+                });
+            }
+            else
+            {
+                children[0] = build(begin, mid, depth + 1);
+                children[1] = build(mid, end, depth + 1);
+            }
+
+            _nodes[node] = { bounds, { children[0], children[1] }, 0, 0, static_cast<std::uint8_t>(axis) };
+            return node;
+        }
+
+        std::uint32_t builder::flatten(std::uint32_t node, std::vector<bvh_node>& out) const
+        {
+            const build_node& n = _nodes[node];
+            auto flat = static_cast<std::uint32_t>(out.size());
+            out.emplace_back();
+            for (int i = 0; i < 3; ++i)
+            {
+                out[flat].lower[i] = n.bounds.lower[i];
+                out[flat].upper[i] = n.bounds.upper[i];
+            }
+
+            if (n.count > 0)
+            {
+                out[flat].offset = n.first;
+                out[flat].count = static_cast<std::uint16_t>(n.count);
+                return flat;
+            }
+
+            out[flat].axis = n.axis;
+            flatten(n.children[0], out);
+            out[flat].offset = flatten(n.children[1], out);
+            return flat;
+        }
+
+        std::vector<bvh_node> builder::flatten() const
+        {
+            std::vector<bvh_node> out;
+            out.reserve(_node_count.load());
+            flatten(0, out);
+            return out;
+        }
+
+        std::vector<std::uint32_t> builder::primitive_order() const
+        {
+            std::vector<std::uint32_t> order(_primitives.size());
+            for (std::size_t i = 0; i < order.size(); ++i) order[i] = _primitives[i].index;
+            return order;
+        }
+    }
+
+    bvh::bvh(std::span<const math::bounds3f> primitive_bounds, const bvh_build_settings& settings, base::thread_pool& pool)
+    {
+        if (primitive_bounds.size() >= std::numeric_limits<std::uint32_t>::max())
+        {
+            throw std::invalid_argument{ "bvh supports fewer than 2^32 primitives" };
+        }
+        if (settings.max_leaf_size > std::numeric_limits<std::uint16_t>::max())
+        {
+            throw std::invalid_argument{ "bvh leaves hold at most 65535 primitives" };
+        }
+        if (primitive_bounds.empty()) return;
+        for (const auto& b : primitive_bounds)
+        {
+            if (b.is_empty()) throw std::invalid_argument{ "bvh primitive bounds must not be empty" };
+        }
+
+        builder b{ primitive_bounds, settings, pool };
+        b.build(0, primitive_bounds.size(), 0);
+        _nodes = b.flatten();
+        _indices = b.primitive_order();
+    }
+
+    bvh::bvh(std::vector<bvh_node> nodes, std::vector<std::uint32_t> primitive_indices)
+        : _nodes{ std::move(nodes) }, _indices{ std::move(primitive_indices) } {}
+
+    bool bvh::empty() const
+    {
+        return _nodes.empty();
+    }
+
+    math::bounds3f bvh::get_bounds() const
+    {
+        return _nodes.empty() ? math::bounds3f{} : _nodes[0].get_bounds();
+    }
+
+    std::span<const bvh_node> bvh::nodes() const
+    {
+        return _nodes;
+    }
+
+    std::span<const std::uint32_t> bvh::primitive_indices() const
+    {
+        return _indices;
+    }
+
+    void bvh::fit_node(std::uint32_t node, std::span<const math::bounds3f> primitive_bounds)
+    {
+        bvh_node& n = _nodes[node];
+        box b;
+        if (n.is_leaf())
+        {
+            for (std::uint32_t i = n.offset; i < n.offset + n.count; ++i)
+            {
+                const math::bounds3f& prim = primitive_bounds[_indices[i]];
+                for (int a = 0; a < 3; ++a)
+                {
+                    b.lower[a] = std::min(b.lower[a], prim.get_min()[a]);
+                    b.upper[a] = std::max(b.upper[a], prim.get_max()[a]);
+                }
+            }
+        }
+        else
+        {
+            for (std::uint32_t child : { node + 1, n.offset })
+            {
+                b.extend(_nodes[child].lower);
+                b.extend(_nodes[child].upper);
+            }
+        }
+        std::copy(b.lower, b.lower + 3, n.lower);
+        std::copy(b.upper, b.upper + 3, n.upper);
+    }
+
+    void bvh::refit(std::uint32_t node, std::uint32_t end, std::span<const math::bounds3f> primitive_bounds, base::thread_pool& pool)
+    {
+        if (!_nodes[node].is_leaf())
+        {
+            std::uint32_t second = _nodes[node].offset;
+            if (end - node >= PARALLEL_SUBTREE_THRESHOLD)
+            {
+                pool.parallel_for(0, 2, 1, [&](std::size_t lo, std::size_t hi)
+                {
+                    for (std::size_t c = lo; c < hi; ++c)
+                    {
+                        if (c == 0) refit(node + 1, second, primitive_bounds, pool);
+                        else refit(second, end, primitive_bounds, pool);
+                    }
+                });
+            }
+            else
+            {
+                refit(node + 1, second, primitive_bounds, pool);
+                refit(second, end, primitive_bounds, pool);
+            }
+        }
+        fit_node(node, primitive_bounds);
+    }
+
+    void bvh::refit(std::span<const math::bounds3f> primitive_bounds, base::thread_pool& pool)
+    {
+        if (primitive_bounds.size() != _indices.size())
+        {
+            throw std::invalid_argument{ "refit needs the bounds of every primitive of the bvh" };
+        }
+        if (!_nodes.empty()) refit(0, static_cast<std::uint32_t>(_nodes.size()), primitive_bounds, pool);
+    }
+
+}
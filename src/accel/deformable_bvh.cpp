@@ -0,0 +1,280 @@
+#include "accel/deformable_bvh.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace accel
+{
+
+    namespace
+    {
+        constexpr std::uint32_t PARALLEL_SUBTREE_THRESHOLD = 4096; // dirty subtrees this large refit their children in parallel
+
+        /**
+         * @return the axis along which the second child lies furthest past the first, so that traversal visits the
+         * first child first along it
+         */
+        std::uint8_t split_axis(const bvh_node& first, const bvh_node& second)
+        {
+            std::uint8_t axis = 0;
+            float best = -std::numeric_limits<float>::infinity();
+            for (std::uint8_t a = 0; a < 3; ++a)
+            {
+                float d = (second.lower[a] + second.upper[a]) - (first.lower[a] + first.upper[a]);
+                if (d > best)
+                {
+                    best = d;
+                    axis = a;
+                }
+            }
+            return axis;
+        }
+    }
+
+    deformable_bvh::deformable_bvh(bvh tree)
+        : _tree{ std::move(tree) }, _parents(_tree._nodes.size()), _leaves(_tree._indices.size()),
+          _heights(_tree._nodes.size()), _dirty(_tree._nodes.size())
+    {
+        auto n = static_cast<std::uint32_t>(_tree._nodes.size());
+        if (n == 0) return;
+
+        link(0, n);
+        // children follow their parents, so a reverse pass sees them first
+        for (std::uint32_t node = n; node-- > 0;)
+        {
+            const bvh_node& nd = _tree._nodes[node];
+            _heights[node] = static_cast<std::uint8_t>(nd.is_leaf() ? 1 : 1 + std::max(_heights[node + 1], _heights[nd.offset]));
+        }
+    }
+
+    void deformable_bvh::link(std::uint32_t begin, std::uint32_t end)
+    {
+        for (std::uint32_t node = begin; node < end; ++node)
+        {
+            const bvh_node& nd = _tree._nodes[node];
+            if (nd.is_leaf())
+            {
+                for (std::uint32_t i = nd.offset; i < nd.offset + nd.count; ++i) _leaves[_tree._indices[i]] = node;
+            }
+            else
+            {
+                _parents[node + 1] = node;
+                _parents[nd.offset] = node;
+            }
+        }
+    }
+
+    const bvh& deformable_bvh::tree() const
+    {
+        return _tree;
+    }
+
+    void deformable_bvh::mark_moved(std::uint32_t primitive)
+    {
+        // every ancestor of a dirty node is already dirty, so the climb stops at the first one
+        std::uint32_t node = _leaves[primitive];
+        while (!_dirty[node])
+        {
+            _dirty[node] = 1;
+            if (node == 0) break;
+            node = _parents[node];
+        }
+    }
+
+    void deformable_bvh::mark_moved(std::span<const std::uint32_t> primitives)
+    {
+        for (std::uint32_t primitive : primitives) mark_moved(primitive);
+    }
+
+    void deformable_bvh::mark_all_moved()
+    {
+        std::fill(_dirty.begin(), _dirty.end(), std::uint8_t{ 1 });
+    }
+
+    std::size_t deformable_bvh::refit(std::span<const math::bounds3f> primitive_bounds, const bvh_refit_settings& settings,
+                                      base::thread_pool& pool)
+    {
+        if (primitive_bounds.size() != _leaves.size())
+        {
+            throw std::invalid_argument{ "refit needs the bounds of every primitive of the bvh" };
+        }
+        if (_dirty.empty() || !_dirty[0]) return 0;
+        return refit(0, static_cast<std::uint32_t>(_dirty.size()), 0, primitive_bounds, settings, pool);
+    }
+
+    std::size_t deformable_bvh::refit(std::uint32_t node, std::uint32_t end, std::uint32_t depth,
+                                      std::span<const math::bounds3f> primitive_bounds, const bvh_refit_settings& settings,
+                                      base::thread_pool& pool)
+    {
+        _dirty[node] = 0;
+        if (_tree._nodes[node].is_leaf())
+        {
+            _tree.fit_node(node, primitive_bounds);
+            return 1;
+        }
+
+        subtree children[2] = { { node + 1, _tree._nodes[node].offset }, { _tree._nodes[node].offset, end } };
+        bool dirty[2] = { _dirty[children[0].begin] != 0, _dirty[children[1].begin] != 0 };
+        std::size_t counts[2] = { 0, 0 };
+        auto refit_child = [&](std::size_t c)
+        {
+            if (dirty[c]) counts[c] = refit(children[c].begin, children[c].end, depth + 1, primitive_bounds, settings, pool);
+        };
+
+        if (dirty[0] && dirty[1] && end - node >= PARALLEL_SUBTREE_THRESHOLD)
+        {
+            pool.parallel_for(0, 2, 1, [&](std::size_t lo, std::size_t hi)
+            {
+                for (std::size_t c = lo; c < hi; ++c) refit_child(c);
+            });
+        }
+        else
+        {
+            refit_child(0);
+            refit_child(1);
+        }
+
+        _tree.fit_node(node, primitive_bounds);
+        if (settings.rotate) rotate(node, end, depth);
+        _heights[node] = static_cast<std::uint8_t>(1 + std::max(_heights[node + 1], _heights[_tree._nodes[node].offset]));
+        return 1 + counts[0] + counts[1];
+    }
+
+    void deformable_bvh::rotate(std::uint32_t node, std::uint32_t end, std::uint32_t depth)
+    {
+        const auto& nodes = _tree._nodes;
+        subtree left{ node + 1, nodes[node].offset }, right{ nodes[node].offset, end };
+        auto area = [&](subtree t) { return nodes[t.begin].get_bounds().surface_area(); };
+        auto group_area = [&](subtree a, subtree b) { return math::merge(nodes[a.begin].get_bounds(), nodes[b.begin].get_bounds()).surface_area(); };
+
+        // the sibling moved under the other child must not push the tree past the depth traversal supports
+        auto fits = [&](subtree lowered) { return depth + 2 + _heights[lowered.begin] <= bvh::max_depth; };
+
+        float best_gain = 0;
+        side best_first{}, best_second{};
+        auto consider = [&](float gain, const side& first, const side& second)
+        {
+            if (gain > best_gain)
+            {
+                best_gain = gain;
+                best_first = first;
+                best_second = second;
+            }
+        };
+
+        // each candidate keeps in place whatever part of the layout it can, so that fewer nodes move
+        bool left_interior = !nodes[left.begin].is_leaf(), right_interior = !nodes[right.begin].is_leaf();
+        subtree l1{}, l2{}, r1{}, r2{};
+        if (left_interior)
+        {
+            l1 = { left.begin + 1, nodes[left.begin].offset };
+            l2 = { nodes[left.begin].offset, left.end };
+        }
+        if (right_interior)
+        {
+            r1 = { right.begin + 1, nodes[right.begin].offset };
+            r2 = { nodes[right.begin].offset, end };
+        }
+
+        if (right_interior && fits(left))
+        {
+            consider(area(right) - group_area(left, r1), { { left, r1 }, 2 }, { { r2 }, 1 });
+            consider(area(right) - group_area(left, r2), { { r1 }, 1 }, { { left, r2 }, 2 });
+        }
+        if (left_interior && fits(right))
+        {
+            consider(area(left) - group_area(l2, right), { { l1 }, 1 }, { { l2, right }, 2 });
+            consider(area(left) - group_area(l1, right), { { l1, right }, 2 }, { { l2 }, 1 });
+        }
+        if (left_interior && right_interior)
+        {
+            float areas = area(left) + area(right);
+            consider(areas - group_area(l1, r1) - group_area(l2, r2), { { l1, r1 }, 2 }, { { l2, r2 }, 2 });
+            consider(areas - group_area(l1, r2) - group_area(r1, l2), { { l1, r2 }, 2 }, { { r1, l2 }, 2 });
+        }
+
+        if (best_gain > 0) regroup(node, best_first, best_second);
+    }
+
+    void deformable_bvh::regroup(std::uint32_t node, const side& first, const side& second)
+    {
+        auto& nodes = _tree._nodes;
+        auto size = [](subtree t) { return t.end - t.begin; };
+
+        // the new layout is node, then each side: the node grouping its parts, if any, followed by the parts
+        std::pair<subtree, std::uint32_t> moves[4];
+        std::size_t move_count = 0;
+        std::uint32_t roots[2];
+        std::uint32_t to = node + 1;
+        for (int s = 0; s < 2; ++s)
+        {
+            const side& sd = s == 0 ? first : second;
+            roots[s] = to;
+            if (sd.count == 2) ++to;
+            for (int p = 0; p < sd.count; ++p)
+            {
+                moves[move_count++] = { sd.parts[p], to };
+                to += size(sd.parts[p]);
+            }
+        }
+
+        // the subtrees that move are copied out first, since their old and new places may overlap
+        std::vector<bvh_node> moved_nodes;
+        std::vector<std::uint8_t> moved_heights;
+        for (std::size_t m = 0; m < move_count; ++m)
+        {
+            auto [from, dest] = moves[m];
+            if (from.begin == dest) continue;
+            moved_nodes.insert(moved_nodes.end(), nodes.begin() + from.begin, nodes.begin() + from.end);
+            moved_heights.insert(moved_heights.end(), _heights.begin() + from.begin, _heights.begin() + from.end);
+        }
+
+        std::size_t read = 0;
+        for (std::size_t m = 0; m < move_count; ++m)
+        {
+            auto [from, dest] = moves[m];
+            if (from.begin == dest) continue;
+            for (std::uint32_t i = 0; i < size(from); ++i, ++read)
+            {
+                bvh_node moved = moved_nodes[read];
+                if (!moved.is_leaf()) moved.offset = moved.offset - from.begin + dest;
+                nodes[dest + i] = moved;
+                _heights[dest + i] = moved_heights[read];
+            }
+            link(dest, dest + size(from));
+        }
+
+        std::size_t m = 0;
+        for (int s = 0; s < 2; ++s)
+        {
+            const side& sd = s == 0 ? first : second;
+            if (sd.count == 1)
+            {
+                ++m;
+                continue;
+            }
+
+            std::uint32_t a = moves[m].second, b = moves[m + 1].second;
+            m += 2;
+            bvh_node& group = nodes[roots[s]];
+            group = {};
+            math::bounds3f gb = math::merge(nodes[a].get_bounds(), nodes[b].get_bounds());
+            for (int i = 0; i < 3; ++i)
+            {
+                group.lower[i] = gb.get_min()[i];
+                group.upper[i] = gb.get_max()[i];
+            }
+            group.offset = b;
+            group.axis = split_axis(nodes[a], nodes[b]);
+            _heights[roots[s]] = static_cast<std::uint8_t>(1 + std::max(_heights[a], _heights[b]));
+            link(roots[s], roots[s] + 1);
+        }
+
+        nodes[node].offset = roots[1];
+        nodes[node].axis = split_axis(nodes[roots[0]], nodes[roots[1]]);
+        link(node, node + 1);
+    }
+
+}
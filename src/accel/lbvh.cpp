@@ -0,0 +1,203 @@
+#include "accel/lbvh.hpp"
+
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "base/radix_sort.hpp"
+#include "math/geometry/morton.hpp"
+
+namespace accel
+{
+
+    namespace
+    {
+        constexpr std::size_t GRAIN = 1 << 12;
+        constexpr std::uint32_t PARALLEL_SUBTREE_THRESHOLD = 4096; // subtrees this large are flattened in parallel
+
+        class flattener
+        {
+        private:
+            std::uint32_t _n;
+            const std::vector<lbvh_node>& _nodes;
+            const std::vector<math::bounds3f>& _bounds;
+            std::uint32_t _max_leaf_size;
+            base::thread_pool& _pool;
+            std::vector<std::uint32_t> _sizes; // number of flattened nodes in the subtree of each node
+            std::vector<bvh_node> _out;
+
+            bool is_leaf(std::uint32_t node) const { return node >= _n - 1 || count(node) <= _max_leaf_size; }
+            std::uint32_t first(std::uint32_t node) const { return node >= _n - 1 ? node - (_n - 1) : _nodes[node].first; }
+            std::uint32_t count(std::uint32_t node) const { return node >= _n - 1 ? 1 : _nodes[node].last - _nodes[node].first + 1; }
+
+            void count_subtrees(const std::vector<std::uint32_t>& parents);
+            void write(std::uint32_t node, std::uint32_t pos);
+        public:
+            flattener(std::uint32_t n, const std::vector<lbvh_node>& nodes, const std::vector<std::uint32_t>& parents,
+                      const std::vector<math::bounds3f>& bounds, std::uint32_t max_leaf_size, base::thread_pool& pool);
+
+            std::vector<bvh_node> flatten();
+        };
+
+        flattener::flattener(std::uint32_t n, const std::vector<lbvh_node>& nodes, const std::vector<std::uint32_t>& parents,
+                             const std::vector<math::bounds3f>& bounds, std::uint32_t max_leaf_size, base::thread_pool& pool)
+            : _n{ n }, _nodes{ nodes }, _bounds{ bounds }, _max_leaf_size{ max_leaf_size }, _pool{ pool }, _sizes(2 * n - 1)
+        {
+            count_subtrees(parents);
+        }
+
+        void flattener::count_subtrees(const std::vector<std::uint32_t>& parents)
+        {
+            // climbs from the leaves like the refit, so that the last child to arrive sums the sizes of both
+            std::vector<std::uint32_t> visits(_n - 1);
+            _pool.parallel_for(_n - 1, 2 * _n - 1, GRAIN, [&](std::size_t lo, std::size_t hi)
+            {
+                for (auto leaf = static_cast<std::uint32_t>(lo); leaf < hi; ++leaf)
+                {
+                    _sizes[leaf] = 1;
+                    std::uint32_t node = leaf;
+                    while (node != 0)
+                    {
+                        std::uint32_t parent = parents[node];
+                        if (impl::atomic_increment(&visits[parent]) == 0) break;
+                        const lbvh_node& p = _nodes[parent];
+                        _sizes[parent] = is_leaf(parent) ? 1 : 1 + _sizes[p.children[0]] + _sizes[p.children[1]];
+                        node = parent;
+                    }
+                }
+            });
+        }
+
+        void flattener::write(std::uint32_t node, std::uint32_t pos)
+        {
+            bvh_node& out = _out[pos];
+            for (int i = 0; i < 3; ++i)
+            {
+                out.lower[i] = _bounds[node].get_min()[i];
+                out.upper[i] = _bounds[node].get_max()[i];
+            }
+
+            if (is_leaf(node))
+            {
+                out.offset = first(node);
+                out.count = static_cast<std::uint16_t>(count(node));
+                return;
+            }
+
+            const lbvh_node& n = _nodes[node];
+            std::uint32_t second = pos + 1 + _sizes[n.children[0]];
+            out.offset = second;
+            out.count = 0;
+            out.axis = n.axis;
+
+            if (count(node) >= PARALLEL_SUBTREE_THRESHOLD)
+            {
+                _pool.parallel_for(0, 2, 1, [&](std::size_t lo, std::size_t hi)
+                {
+                    for (std::size_t c = lo; c < hi; ++c) write(n.children[c], c == 0 ? pos + 1 : second);
+                });
+            }
+            else
+            {
+                write(n.children[0], pos + 1);
+                write(n.children[1], second);
+            }
+        }
+
+        std::vector<bvh_node> flattener::flatten()
+        {
+            _out.resize(_sizes[0]);
+            write(0, 0);
+            return std::move(_out);
+        }
+
+        template<typename Code>
+        bvh build(std::span<const math::bounds3f> primitive_bounds, const lbvh_build_settings& settings, int code_bits,
+                  base::thread_pool& pool)
+        {
+            auto n = static_cast<std::uint32_t>(primitive_bounds.size());
+
+            math::bounds3f centroid_bounds;
+            std::mutex mtx;
+            pool.parallel_for(0, n, GRAIN, [&](std::size_t lo, std::size_t hi)
+            {
+                math::bounds3f local;
+                for (std::size_t i = lo; i < hi; ++i) local.extend(primitive_bounds[i].centroid());
+                std::lock_guard lock{ mtx };
+                centroid_bounds.extend(local);
+            });
+
+            std::vector<Code> codes(n);
+            std::vector<std::uint32_t> order(n);
+            pool.parallel_for(0, n, GRAIN, [&](std::size_t lo, std::size_t hi)
+            {
+                for (std::size_t i = lo; i < hi; ++i)
+                {
+                    math::point<float, 3> c = primitive_bounds[i].centroid();
+                    if constexpr (sizeof(Code) == 8) codes[i] = math::morton_code_63(c, centroid_bounds);
+                    else codes[i] = math::morton_code_30(c, centroid_bounds);
+                    order[i] = static_cast<std::uint32_t>(i);
+                }
+            });
+            base::radix_sort(std::span<Code>{ codes }, std::span<std::uint32_t>{ order }, code_bits, pool);
+
+            std::vector<lbvh_node> nodes(n - 1);
+            std::vector<std::uint32_t> parents(2 * n - 1);
+            pool.parallel_for(0, n - 1, GRAIN, [&](std::size_t lo, std::size_t hi)
+            {
+                for (auto i = static_cast<std::uint32_t>(lo); i < hi; ++i)
+                {
+                    lbvh_emit_node(codes.data(), n, code_bits, i, nodes.data(), parents.data());
+                }
+            });
+
+            std::vector<math::bounds3f> bounds(2 * n - 1);
+            std::vector<std::uint32_t> visits(n - 1);
+            pool.parallel_for(n - 1, 2 * n - 1, GRAIN, [&](std::size_t lo, std::size_t hi)
+            {
+                for (auto leaf = static_cast<std::uint32_t>(lo); leaf < hi; ++leaf)
+                {
+                    bounds[leaf] = primitive_bounds[order[leaf - (n - 1)]];
+                    lbvh_refit_from_leaf(leaf, nodes.data(), parents.data(), bounds.data(), visits.data());
+                }
+            });
+
+            flattener f{ n, nodes, parents, bounds, settings.max_leaf_size, pool };
+            return { f.flatten(), std::move(order) };
+        }
+    }
+
+    bvh build_lbvh(std::span<const math::bounds3f> primitive_bounds, const lbvh_build_settings& settings, base::thread_pool& pool)
+    {
+        if (primitive_bounds.size() >= (std::size_t{ 1 } << 31))
+        {
+            throw std::invalid_argument{ "lbvh supports fewer than 2^31 primitives" };
+        }
+        if (settings.max_leaf_size > std::numeric_limits<std::uint16_t>::max())
+        {
+            throw std::invalid_argument{ "bvh leaves hold at most 65535 primitives" };
+        }
+        for (const auto& b : primitive_bounds)
+        {
+            if (b.is_empty()) throw std::invalid_argument{ "bvh primitive bounds must not be empty" };
+        }
+
+        if (primitive_bounds.empty()) return {};
+        if (primitive_bounds.size() == 1)
+        {
+            bvh_node root{};
+            for (int i = 0; i < 3; ++i)
+            {
+                root.lower[i] = primitive_bounds[0].get_min()[i];
+                root.upper[i] = primitive_bounds[0].get_max()[i];
+            }
+            root.count = 1;
+            return { std::vector<bvh_node>{ root }, std::vector<std::uint32_t>{ 0 } };
+        }
+
+        if (settings.use_63_bit_codes) return build<std::uint64_t>(primitive_bounds, settings, 63, pool);
+        return build<std::uint32_t>(primitive_bounds, settings, 30, pool);
+    }
+
+}
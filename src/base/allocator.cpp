@@ -0,0 +1,88 @@
+#include "base/allocator.hpp"
+
+#include <new>
+
+#include <sys/mman.h>
+
+#include "base/image.hpp"
+
+namespace base
+{
+
+    namespace
+    {
+        constexpr std::size_t huge_page_size = std::size_t{ 2 } << 20;
+    }
+
+    pixel_allocator& pixel_allocator::heap()
+    {
+        static heap_allocator allocator;
+        return allocator;
+    }
+
+    heap_allocator::heap_allocator(bool huge_pages) : _huge_pages{ huge_pages } {}
+
+    pixel* heap_allocator::allocate(std::size_t count)
+    {
+        // pixel is an implicit-lifetime type, so raw storage holds pixels without running their constructor
+        if (!_huge_pages) return static_cast<pixel*>(::operator new(count * sizeof(pixel), std::align_val_t{ alignment }));
+
+        const std::size_t size = (count * sizeof(pixel) + huge_page_size - 1) / huge_page_size * huge_page_size;
+        void* buffer = ::operator new(size, std::align_val_t{ huge_page_size });
+#ifdef MADV_HUGEPAGE
+        ::madvise(buffer, size, MADV_HUGEPAGE); // only a hint. the buffer works the same when it is refused
+#endif
+        return static_cast<pixel*>(buffer);
+    }
+
+    void heap_allocator::deallocate(pixel* buffer, std::size_t)
+    {
+        ::operator delete(buffer, std::align_val_t{ _huge_pages ? huge_page_size : alignment });
+    }
+
+    frame_pool::frame_pool(pixel_allocator& upstream, std::size_t max_cached) : _upstream{ upstream }, _max_cached{ max_cached }
+    {
+        _cache.reserve(max_cached); // releasing a buffer never allocates
+    }
+
+    frame_pool::~frame_pool()
+    {
+        for (const buffer& buf : _cache) _upstream.deallocate(buf.data, buf.count);
+    }
+
+    pixel* frame_pool::allocate(std::size_t count)
+    {
+        {
+            std::lock_guard lock{ _mtx };
+            for (std::size_t i = 0; i < _cache.size(); ++i)
+            {
+                if (_cache[i].count != count) continue;
+                pixel* data = _cache[i].data;
+                _cache[i] = _cache.back();
+                _cache.pop_back();
+                return data;
+            }
+        }
+        return _upstream.allocate(count);
+    }
+
+    void frame_pool::deallocate(pixel* buffer, std::size_t count)
+    {
+        {
+            std::lock_guard lock{ _mtx };
+            if (_cache.size() < _max_cached)
+            {
+                _cache.push_back({ buffer, count });
+                return;
+            }
+        }
+        _upstream.deallocate(buffer, count);
+    }
+
+    std::size_t frame_pool::cached()
+    {
+        std::lock_guard lock{ _mtx };
+        return _cache.size();
+    }
+
+}
@@ -0,0 +1,238 @@
+#include "base/hdr_image.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace base
+{
+
+    namespace
+    {
+        /**
+         * sRGB transfer function sampled over [0, 1] and scaled to [0, 255]. interpolating between the samples stays
+         * well within a hundredth of a step, and unlike pow it vectorizes.
+         */
+        struct srgb_table
+        {
+            static constexpr int size = 4096;
+            float values[size + 1];
+
+            srgb_table()
+            {
+                for (int i = 0; i <= size; ++i)
+                {
+                    double v = static_cast<double>(i) / size;
+                    v = v <= 0.0031308 ? 12.92 * v : 1.055 * std::pow(v, 1 / 2.4) - 0.055;
+                    values[i] = static_cast<float>(255 * v);
+                }
+            }
+
+            float operator()(float v) const // v in [0, 1]
+            {
+                float pos = v * size;
+                int i = std::min(static_cast<int>(pos), size - 1);
+                float t = pos - static_cast<float>(i);
+                return values[i] + t * (values[i + 1] - values[i]);
+            }
+        };
+
+        const srgb_table& srgb()
+        {
+            static const srgb_table table;
+            return table;
+        }
+
+        /**
+         * every value resolved goes through here first, so the table lookup and the casts of quantize only ever see
+         * values in [0, 1]. a single NaN or infinite sample, e.g. from a degenerate BSDF, resolves to black rather
+         * than being cast to an integer, which is undefined.
+         */
+        float apply_curve(tone_map curve, float v)
+        {
+            v = std::isfinite(v) ? std::max(v, 0.0f) : 0.0f;
+            switch (curve)
+            {
+                case tone_map::reinhard: v = v / (1 + v); break;
+                case tone_map::aces:
+                    v = std::min(v, 1e4f); // keeps v * v finite. the curve is flat past one long before
+                    v = (v * (2.51f * v + 0.03f)) / (v * (2.43f * v + 0.59f) + 0.14f);
+                    break;
+                default: break;
+            }
+            return std::clamp(v, 0.0f, 1.0f);
+        }
+
+        /**
+         * @return noise in [-0.5, 0.5) that is stable for a pixel and seed.
+         */
+        float dither_noise(uint32_t x, uint32_t y, uint32_t seed)
+        {
+            uint32_t h = x * 0x8DA6B343u ^ y * 0xD8163841u ^ seed * 0xCB1AB31Fu;
+            h ^= h >> 16;
+            h *= 0x7FEB352Du;
+            h ^= h >> 15;
+            h *= 0x846CA68Bu;
+            h ^= h >> 16;
+            return static_cast<float>(h >> 8) * (1.0f / (1 << 24)) - 0.5f;
+        }
+
+        uint8_t quantize(float v)
+        {
+            return static_cast<uint8_t>(std::clamp(v + 0.5f, 0.0f, 255.0f));
+        }
+    }
+
+    hdr_image::hdr_image(int width, int height) :
+    _width{ width }, _height{ height },
+    _red{ std::make_unique<float[]>(width * height) }, _green{ std::make_unique<float[]>(width * height) },
+    _blue{ std::make_unique<float[]>(width * height) }, _samples{ std::make_unique<uint32_t[]>(width * height) } {}
+
+    hdr_image::hdr_image(const hdr_image& img) :
+    _width{ img._width }, _height{ img._height },
+    _red{ std::make_unique_for_overwrite<float[]>(_width * _height) }, _green{ std::make_unique_for_overwrite<float[]>(_width * _height) },
+    _blue{ std::make_unique_for_overwrite<float[]>(_width * _height) }, _samples{ std::make_unique_for_overwrite<uint32_t[]>(_width * _height) }
+    {
+        const std::size_t count = _width * _height;
+        std::memcpy(_red.get(), img._red.get(), count * sizeof(float));
+        std::memcpy(_green.get(), img._green.get(), count * sizeof(float));
+        std::memcpy(_blue.get(), img._blue.get(), count * sizeof(float));
+        std::memcpy(_samples.get(), img._samples.get(), count * sizeof(uint32_t));
+    }
+
+    hdr_image::hdr_image(hdr_image&& img) = default;
+
+    hdr_image& hdr_image::operator=(const hdr_image& img)
+    {
+        if (this == &img) return *this;
+
+        // copied aside first so that a failed allocation leaves the image as it was
+        hdr_image cpy{ img };
+        return *this = std::move(cpy);
+    }
+
+    hdr_image& hdr_image::operator=(hdr_image&& img) = default;
+
+    hdr_image::~hdr_image() = default;
+
+    int hdr_image::width() const
+    {
+        return _width;
+    }
+
+    int hdr_image::height() const
+    {
+        return _height;
+    }
+
+    float* hdr_image::red() const
+    {
+        return _red.get();
+    }
+
+    float* hdr_image::green() const
+    {
+        return _green.get();
+    }
+
+    float* hdr_image::blue() const
+    {
+        return _blue.get();
+    }
+
+    uint32_t* hdr_image::samples() const
+    {
+        return _samples.get();
+    }
+
+    void hdr_image::add_sample(hdr_image::coordinate coord, float r, float g, float b)
+    {
+        const int i = coord.y * _width + coord.x;
+        _red[i] += r;
+        _green[i] += g;
+        _blue[i] += b;
+        ++_samples[i];
+    }
+
+    void hdr_image::clear()
+    {
+        const std::size_t count = _width * _height;
+        std::fill(_red.get(), _red.get() + count, 0.0f);
+        std::fill(_green.get(), _green.get() + count, 0.0f);
+        std::fill(_blue.get(), _blue.get() + count, 0.0f);
+        std::fill(_samples.get(), _samples.get() + count, 0u);
+    }
+
+    void hdr_image::resolve(image& dst, const resolve_settings& settings, thread_pool& pool) const
+    {
+        if (dst.width() != _width || dst.height() != _height) throw std::invalid_argument{ "resolve requires images of the same dimensions" };
+
+        const float exposure = std::exp2(settings.exposure);
+        const srgb_table& table = srgb();
+
+        pool.parallel_for(0, _height, 8, [&](std::size_t begin, std::size_t end) {
+            // rows are resolved in blocks: each step runs over a short array of floats so that it vectorizes
+            constexpr int block = 64;
+            float r[block], g[block], b[block];
+
+            for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
+            {
+                pixel* line = &dst[{ 0, y }];
+                for (int x0 = 0; x0 < _width; x0 += block)
+                {
+                    const int n = std::min(block, _width - x0);
+                    const int base = y * _width + x0;
+
+                    for (int i = 0; i < n; ++i)
+                    {
+                        const float scale = _samples[base + i] ? exposure / static_cast<float>(_samples[base + i]) : 0.0f;
+                        r[i] = _red[base + i] * scale;
+                        g[i] = _green[base + i] * scale;
+                        b[i] = _blue[base + i] * scale;
+                    }
+
+                    for (int i = 0; i < n; ++i)
+                    {
+                        r[i] = apply_curve(settings.curve, r[i]);
+                        g[i] = apply_curve(settings.curve, g[i]);
+                        b[i] = apply_curve(settings.curve, b[i]);
+                    }
+
+                    if (settings.srgb)
+                    {
+                        for (int i = 0; i < n; ++i)
+                        {
+                            r[i] = table(r[i]);
+                            g[i] = table(g[i]);
+                            b[i] = table(b[i]);
+                        }
+                    }
+                    else
+                    {
+                        for (int i = 0; i < n; ++i)
+                        {
+                            r[i] *= 255;
+                            g[i] *= 255;
+                            b[i] *= 255;
+                        }
+                    }
+
+                    if (settings.dither)
+                    {
+                        for (int i = 0; i < n; ++i)
+                        {
+                            const float noise = dither_noise(x0 + i, y, settings.seed);
+                            r[i] += noise;
+                            g[i] += noise;
+                            b[i] += noise;
+                        }
+                    }
+
+                    for (int i = 0; i < n; ++i) line[x0 + i] = pixel{ quantize(r[i]), quantize(g[i]), quantize(b[i]) };
+                }
+            }
+        });
+    }
+
+}
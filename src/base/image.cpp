@@ -16,27 +16,56 @@ namespace base
 
     pixel operator""_rgb(unsigned long long pix) { return pixel{ static_cast<uint32_t>(pix) }; }
 
-    image::image(int width, int height) : _width{ width }, _height{ height }, _buf{ new pixel[width * height] } {}
+    image::image(int width, int height, pixel_allocator& allocator, bool clear) :
+    _width{ width }, _height{ height }, _stride{ width }, _buf{ allocator.allocate(width * height) }, _owner{ true }, _allocator{ &allocator }
+    {
+        if (clear) std::memset(static_cast<void*>(_buf), 0, _width * _height * sizeof(pixel));
+    }
+
+    image::image(pixel* buffer, int width, int height, int stride) :
+    _width{ width }, _height{ height }, _stride{ stride }, _buf{ buffer }, _owner{ false }, _allocator{ nullptr } {}
 
-    image::image(const image& img) : _width{ img._width }, _height{ img._height }, _buf{ new pixel[_width * _height] }
+    image::image(const image& img) :
+    _width{ img._width }, _height{ img._height }, _stride{ img._width },
+    _buf{ nullptr }, _owner{ true }, _allocator{ img._allocator ? img._allocator : &pixel_allocator::heap() }
     {
-        std::memcpy(_buf, img._buf, _width * _height * sizeof(pixel));
+        _buf = _allocator->allocate(_width * _height);
+        for (int y = 0; y < _height; ++y)
+        {
+            std::memcpy(_buf + y * _stride, img._buf + y * img._stride, _width * sizeof(pixel));
+        }
     }
 
-    image::image(image&& img) : _width{ img._width }, _height{ img._height }, _buf{ img._buf }
+    image::image(image&& img) :
+    _width{ img._width }, _height{ img._height }, _stride{ img._stride }, _buf{ img._buf }, _owner{ img._owner }, _allocator{ img._allocator }
     {
         img._buf = nullptr;
+        img._owner = false;
+        img._allocator = nullptr;
     }
 
     image& image::operator=(const image& img)
     {
         if (this == &img) return *this;
 
+        if (!_owner || _width * _height != img._width * img._height)
+        {
+            pixel_allocator* allocator = img._allocator ? img._allocator : &pixel_allocator::heap();
+            pixel* buf = allocator->allocate(img._width * img._height);
+            if (_owner) _allocator->deallocate(_buf, _width * _height);
+            _buf = buf;
+            _owner = true;
+            _allocator = allocator;
+        }
+
         _width = img._width;
         _height = img._height;
+        _stride = img._width;
 
-        delete[] _buf;
-        _buf = img._buf;
+        for (int y = 0; y < _height; ++y)
+        {
+            std::memcpy(_buf + y * _stride, img._buf + y * img._stride, _width * sizeof(pixel));
+        }
 
         return *this;
     }
@@ -45,19 +74,24 @@ namespace base
     {
         if (this == &img) return *this;
 
+        if (_owner) _allocator->deallocate(_buf, _width * _height);
+
         _width = img._width;
         _height = img._height;
-
-        delete[] _buf;
+        _stride = img._stride;
         _buf = img._buf;
+        _owner = img._owner;
+        _allocator = img._allocator;
         img._buf = nullptr;
+        img._owner = false;
+        img._allocator = nullptr;
 
         return *this;
     }
 
     image::~image()
     {
-        delete[] _buf;
+        if (_owner) _allocator->deallocate(_buf, _width * _height);
     }
 
     int image::width() const
@@ -70,6 +104,21 @@ namespace base
         return _height;
     }
 
+    int image::stride() const
+    {
+        return _stride;
+    }
+
+    bool image::owns_buffer() const
+    {
+        return _owner;
+    }
+
+    pixel_allocator* image::allocator() const
+    {
+        return _allocator;
+    }
+
     pixel* image::get_buffer() const
     {
         return _buf;
@@ -77,19 +126,23 @@ namespace base
 
     pixel& image::operator[](image::coordinate coord)
     {
-        return _buf[coord.y * _width + coord.x];
+        return _buf[coord.y * _stride + coord.x];
     }
 
     const pixel& image::operator[](image::coordinate coord) const
     {
-        return _buf[coord.y * _width + coord.x];
+        return _buf[coord.y * _stride + coord.x];
     }
 
     void image::fill(pixel pix)
     {
-        for (int i = 0; i < _width * _height; ++i)
+        for (int y = 0; y < _height; ++y)
         {
-            _buf[i] = pix;
+            pixel* row = _buf + y * _stride;
+            for (int x = 0; x < _width; ++x)
+            {
+                row[x] = pix;
+            }
         }
     }
 
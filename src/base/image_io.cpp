@@ -0,0 +1,304 @@
+#include "base/image_io.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace base
+{
+
+    namespace
+    {
+        [[noreturn]] void throw_errno(const std::string& what)
+        {
+            throw std::system_error{ errno, std::generic_category(), what };
+        }
+
+        struct file_closer
+        {
+            void operator()(std::FILE* file) const { std::fclose(file); }
+        };
+
+        using file_ptr = std::unique_ptr<std::FILE, file_closer>;
+
+        file_ptr open_for_writing(const std::string& path)
+        {
+            file_ptr file{ std::fopen(path.c_str(), "wb") };
+            if (!file) throw_errno("could not open " + path);
+            return file;
+        }
+
+        void write_bytes(std::FILE* file, const void* data, std::size_t size, const std::string& path)
+        {
+            if (std::fwrite(data, 1, size, file) != size) throw_errno("could not write to " + path);
+        }
+
+        void finish(file_ptr& file, const std::string& path)
+        {
+            if (std::fclose(file.release()) != 0) throw_errno("could not write to " + path);
+        }
+
+        raw_image_header make_header(int width, int height, int stride)
+        {
+            raw_image_header header{};
+            std::memcpy(header.magic, raw_image_header::signature, sizeof(header.magic));
+            header.version = raw_image_header::current_version;
+            header.format = raw_pixel_format::rgb0;
+            header.width = width;
+            header.height = height;
+            header.stride = stride;
+            header.data_offset = sizeof(raw_image_header);
+            return header;
+        }
+
+        /**
+         * converts a value between the byte order of the host and little endian. converting twice gives it back.
+         */
+        template<typename T>
+        T little_endian(T value)
+        {
+            if constexpr (std::endian::native == std::endian::little) return value;
+            else
+            {
+                auto bytes = std::bit_cast<std::array<uint8_t, sizeof(T)>>(value);
+                std::reverse(bytes.begin(), bytes.end());
+                return std::bit_cast<T>(bytes);
+            }
+        }
+
+        /**
+         * converts a header between the byte order of the host and the one of the file. converting twice gives it back.
+         */
+        raw_image_header file_byte_order(raw_image_header header)
+        {
+            header.version = little_endian(header.version);
+            header.format = static_cast<raw_pixel_format>(little_endian(static_cast<uint32_t>(header.format)));
+            header.width = little_endian(header.width);
+            header.height = little_endian(header.height);
+            header.stride = little_endian(header.stride);
+            header.reserved = little_endian(header.reserved);
+            header.data_offset = little_endian(header.data_offset);
+            return header;
+        }
+
+        std::size_t file_size(const raw_image_header& header)
+        {
+            return header.data_offset + static_cast<std::size_t>(header.stride) * header.height * sizeof(pixel);
+        }
+
+        /**
+         * checks a header read from a file of the given size, so that every pixel it describes lies inside the file.
+         * the sizes are compared without ever adding them, since a crafted data_offset could wrap the sum around.
+         */
+        bool is_valid(const raw_image_header& header, std::size_t size)
+        {
+            if (std::memcmp(header.magic, raw_image_header::signature, sizeof(header.magic)) != 0 ||
+                header.version != raw_image_header::current_version || header.format != raw_pixel_format::rgb0)
+            {
+                return false;
+            }
+            if (header.width < 0 || header.height < 0 || header.stride < header.width) return false;
+            if (header.data_offset % 64 != 0 || header.data_offset < sizeof(raw_image_header) || header.data_offset > size) return false;
+
+            // at most (2^31 - 1)^2 * 4 bytes, which fits in 64 bits
+            const uint64_t pixel_bytes = static_cast<uint64_t>(header.stride) * static_cast<uint64_t>(header.height) * sizeof(pixel);
+            return pixel_bytes <= size - header.data_offset;
+        }
+
+        class fd_guard
+        {
+        private:
+            int fd;
+        public:
+            explicit fd_guard(int fd) : fd{ fd } {}
+            fd_guard(const fd_guard&) = delete;
+            fd_guard& operator=(const fd_guard&) = delete;
+            ~fd_guard() { if (fd >= 0) ::close(fd); }
+            int get() const { return fd; }
+        };
+    }
+
+    mapped_image::mapped_image(void* map, std::size_t size, image view) : _map{ map }, _size{ size }, _view{ std::move(view) } {}
+
+    mapped_image mapped_image::map_file(const std::string& path, bool writable)
+    {
+        fd_guard fd{ ::open(path.c_str(), writable ? O_RDWR : O_RDONLY) };
+        if (fd.get() < 0) throw_errno("could not open " + path);
+
+        struct stat st{};
+        if (::fstat(fd.get(), &st) != 0) throw_errno("could not stat " + path);
+        const auto size = static_cast<std::size_t>(st.st_size);
+        if (size < sizeof(raw_image_header)) throw std::runtime_error{ path + " is not a raw image file" };
+
+        void* map = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd.get(), 0);
+        if (map == MAP_FAILED) throw_errno("could not map " + path);
+
+        raw_image_header header;
+        std::memcpy(&header, map, sizeof(header));
+        header = file_byte_order(header);
+        if (!is_valid(header, size))
+        {
+            ::munmap(map, size);
+            throw std::runtime_error{ path + " is not a raw image file" };
+        }
+
+        auto* pixels = reinterpret_cast<pixel*>(static_cast<uint8_t*>(map) + header.data_offset);
+        return mapped_image{ map, size, image{ pixels, header.width, header.height, header.stride } };
+    }
+
+    mapped_image mapped_image::open(const std::string& path)
+    {
+        return map_file(path, true);
+    }
+
+    mapped_image mapped_image::create(const std::string& path, int width, int height)
+    {
+        fd_guard fd{ ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) };
+        if (fd.get() < 0) throw_errno("could not create " + path);
+
+        const raw_image_header header = make_header(width, height, width);
+        const std::size_t size = file_size(header);
+        if (::ftruncate(fd.get(), static_cast<off_t>(size)) != 0) throw_errno("could not resize " + path); // zero filled
+
+        void* map = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+        if (map == MAP_FAILED) throw_errno("could not map " + path);
+        const raw_image_header stored = file_byte_order(header);
+        std::memcpy(map, &stored, sizeof(stored));
+
+        auto* pixels = reinterpret_cast<pixel*>(static_cast<uint8_t*>(map) + header.data_offset);
+        return mapped_image{ map, size, image{ pixels, width, height, width } };
+    }
+
+    mapped_image::mapped_image(mapped_image&& img) : _map{ img._map }, _size{ img._size }, _view{ std::move(img._view) }
+    {
+        img._map = nullptr;
+        img._size = 0;
+    }
+
+    mapped_image& mapped_image::operator=(mapped_image&& img)
+    {
+        if (this == &img) return *this;
+
+        if (_map) ::munmap(_map, _size);
+
+        _map = img._map;
+        _size = img._size;
+        _view = std::move(img._view);
+        img._map = nullptr;
+        img._size = 0;
+
+        return *this;
+    }
+
+    mapped_image::~mapped_image()
+    {
+        if (_map) ::munmap(_map, _size);
+    }
+
+    image& mapped_image::get()
+    {
+        return _view;
+    }
+
+    const image& mapped_image::get() const
+    {
+        return _view;
+    }
+
+    void mapped_image::sync()
+    {
+        if (::msync(_map, _size, MS_SYNC) != 0) throw_errno("could not sync mapped image");
+    }
+
+    read_only_mapped_image::read_only_mapped_image(mapped_image&& mapped) : _mapped{ std::move(mapped) } {}
+
+    read_only_mapped_image read_only_mapped_image::open(const std::string& path)
+    {
+        return read_only_mapped_image{ mapped_image::map_file(path, false) };
+    }
+
+    const image& read_only_mapped_image::get() const
+    {
+        return _mapped._view;
+    }
+
+    void save_raw(const image& img, const std::string& path)
+    {
+        file_ptr file = open_for_writing(path);
+
+        const raw_image_header header = file_byte_order(make_header(img.width(), img.height(), img.stride()));
+        write_bytes(file.get(), &header, sizeof(header), path);
+        // the rows are written with their padding so that the whole buffer goes out in one call
+        if (img.height() > 0)
+        {
+            const std::size_t size = (static_cast<std::size_t>(img.stride()) * (img.height() - 1) + img.width()) * sizeof(pixel);
+            write_bytes(file.get(), img.get_buffer(), size, path);
+            const std::size_t tail = (img.stride() - img.width()) * sizeof(pixel); // the last row's padding may not exist
+            if (tail > 0)
+            {
+                const std::vector<uint8_t> zeros(tail, 0);
+                write_bytes(file.get(), zeros.data(), tail, path);
+            }
+        }
+
+        finish(file, path);
+    }
+
+    void save_ppm(const image& img, const std::string& path)
+    {
+        file_ptr file = open_for_writing(path);
+        if (std::fprintf(file.get(), "P6\n%d %d\n255\n", img.width(), img.height()) < 0) throw_errno("could not write to " + path);
+
+        std::vector<uint8_t> row(static_cast<std::size_t>(img.width()) * 3);
+        for (int y = 0; y < img.height(); ++y)
+        {
+            for (int x = 0; x < img.width(); ++x)
+            {
+                const pixel& p = img[{ x, y }];
+                row[3 * x + 0] = p.red;
+                row[3 * x + 1] = p.green;
+                row[3 * x + 2] = p.blue;
+            }
+            write_bytes(file.get(), row.data(), row.size(), path);
+        }
+
+        finish(file, path);
+    }
+
+    void save_pfm(const hdr_image& img, const std::string& path)
+    {
+        file_ptr file = open_for_writing(path);
+        // the floats are written in the byte order of the host, which the sign of the scale tells: negative for little endian
+        const char* scale = std::endian::native == std::endian::little ? "-1.0" : "1.0";
+        if (std::fprintf(file.get(), "PF\n%d %d\n%s\n", img.width(), img.height(), scale) < 0) throw_errno("could not write to " + path);
+
+        std::vector<float> row(static_cast<std::size_t>(img.width()) * 3);
+        for (int y = img.height() - 1; y >= 0; --y) // PFM stores the bottom row first
+        {
+            for (int x = 0; x < img.width(); ++x)
+            {
+                const int i = y * img.width() + x;
+                const float scale = img.samples()[i] ? 1.0f / static_cast<float>(img.samples()[i]) : 0.0f;
+                row[3 * x + 0] = img.red()[i] * scale;
+                row[3 * x + 1] = img.green()[i] * scale;
+                row[3 * x + 2] = img.blue()[i] * scale;
+            }
+            write_bytes(file.get(), row.data(), row.size() * sizeof(float), path);
+        }
+
+        finish(file, path);
+    }
+
+}
@@ -0,0 +1,183 @@
+#include "base/image_ops.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace base
+{
+
+    namespace
+    {
+        void fill_row(pixel* row, int count, pixel pix)
+        {
+            int x = 0;
+#if defined(__AVX2__)
+            uint32_t bits;
+            std::memcpy(&bits, &pix, sizeof(bits));
+            const __m256i v = _mm256_set1_epi32(static_cast<int>(bits));
+            for (; x + 8 <= count; x += 8) _mm256_storeu_si256(reinterpret_cast<__m256i*>(row + x), v);
+#elif defined(__SSE2__)
+            uint32_t bits;
+            std::memcpy(&bits, &pix, sizeof(bits));
+            const __m128i v = _mm_set1_epi32(static_cast<int>(bits));
+            for (; x + 4 <= count; x += 4) _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), v);
+#endif
+            for (; x < count; ++x) row[x] = pix;
+        }
+
+        uint8_t blend_channel(uint8_t s, uint8_t d, uint8_t alpha)
+        {
+            unsigned t = s * alpha + d * (255 - alpha) + 128;
+            return static_cast<uint8_t>((t + (t >> 8)) >> 8); // exact rounded division by 255
+        }
+
+        void blend_row(const pixel* src, pixel* dst, int count, uint8_t alpha)
+        {
+            auto* s = reinterpret_cast<const uint8_t*>(src);
+            auto* d = reinterpret_cast<uint8_t*>(dst);
+            const int bytes = count * static_cast<int>(sizeof(pixel));
+            int i = 0;
+            // the channels are widened to 16 bits: s * a + d * (255 - a) + 128 never exceeds 65153
+#if defined(__AVX2__)
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i a = _mm256_set1_epi16(alpha), inv_a = _mm256_set1_epi16(static_cast<short>(255 - alpha));
+            const __m256i half = _mm256_set1_epi16(128);
+            for (; i + 32 <= bytes; i += 32)
+            {
+                __m256i vs = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+                __m256i vd = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(d + i));
+                auto blend = [&](__m256i s16, __m256i d16) {
+                    __m256i t = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(s16, a), _mm256_mullo_epi16(d16, inv_a)), half);
+                    return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+                };
+                __m256i lo = blend(_mm256_unpacklo_epi8(vs, zero), _mm256_unpacklo_epi8(vd, zero));
+                __m256i hi = blend(_mm256_unpackhi_epi8(vs, zero), _mm256_unpackhi_epi8(vd, zero));
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + i), _mm256_packus_epi16(lo, hi)); // unpack and pack stay within lanes
+            }
+#elif defined(__SSE2__)
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i a = _mm_set1_epi16(alpha), inv_a = _mm_set1_epi16(static_cast<short>(255 - alpha));
+            const __m128i half = _mm_set1_epi16(128);
+            for (; i + 16 <= bytes; i += 16)
+            {
+                __m128i vs = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+                __m128i vd = _mm_loadu_si128(reinterpret_cast<const __m128i*>(d + i));
+                auto blend = [&](__m128i s16, __m128i d16) {
+                    __m128i t = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(s16, a), _mm_mullo_epi16(d16, inv_a)), half);
+                    return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+                };
+                __m128i lo = blend(_mm_unpacklo_epi8(vs, zero), _mm_unpacklo_epi8(vd, zero));
+                __m128i hi = blend(_mm_unpackhi_epi8(vs, zero), _mm_unpackhi_epi8(vd, zero));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packus_epi16(lo, hi));
+            }
+#endif
+            for (; i < bytes; ++i) d[i] = blend_channel(s[i], d[i], alpha);
+        }
+
+        void downsample_row(const pixel* top, const pixel* bottom, pixel* dst, int count)
+        {
+            auto* t = reinterpret_cast<const uint8_t*>(top);
+            auto* b = reinterpret_cast<const uint8_t*>(bottom);
+            auto* d = reinterpret_cast<uint8_t*>(dst);
+            int x = 0;
+#if defined(__SSE2__)
+            // two output pixels per step. the horizontal pairs straddle 128-bit lanes, so AVX2 is not used here
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i two = _mm_set1_epi16(2);
+            for (; x + 2 <= count; x += 2)
+            {
+                __m128i vt = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t + 8 * x));
+                __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + 8 * x));
+                __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(vt, zero), _mm_unpacklo_epi8(vb, zero)); // input pixels 0 and 1
+                __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(vt, zero), _mm_unpackhi_epi8(vb, zero)); // input pixels 2 and 3
+                lo = _mm_add_epi16(lo, _mm_srli_si128(lo, 8));
+                hi = _mm_add_epi16(hi, _mm_srli_si128(hi, 8));
+                __m128i sum = _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), two), 2);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(d + 4 * x), _mm_packus_epi16(sum, zero));
+            }
+#endif
+            for (; x < count; ++x)
+            {
+                for (int c = 0; c < 4; ++c)
+                {
+                    int sum = t[8 * x + c] + t[8 * x + 4 + c] + b[8 * x + c] + b[8 * x + 4 + c];
+                    d[4 * x + c] = static_cast<uint8_t>((sum + 2) >> 2);
+                }
+            }
+        }
+    }
+
+    std::size_t row_grain(int width)
+    {
+        constexpr int pixels_per_chunk = 16384;
+        return static_cast<std::size_t>(std::max(1, pixels_per_chunk / std::max(width, 1)));
+    }
+
+    void fill(image& dst, pixel pix, thread_pool& pool)
+    {
+        pool.parallel_for(0, dst.height(), row_grain(dst.width()), [&](std::size_t begin, std::size_t end) {
+            for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y) fill_row(&dst[{ 0, y }], dst.width(), pix);
+        });
+    }
+
+    void blit(const image& src, rect area, image& dst, int dst_x, int dst_y, thread_pool& pool)
+    {
+        if (area.x < 0 || area.y < 0 || area.x + area.width > src.width() || area.y + area.height > src.height() ||
+            dst_x < 0 || dst_y < 0 || dst_x + area.width > dst.width() || dst_y + area.height > dst.height())
+        {
+            throw std::out_of_range{ "blit rectangle does not fit in both images" };
+        }
+        if (area.width <= 0 || area.height <= 0) return;
+
+        pool.parallel_for(0, area.height, row_grain(area.width), [&](std::size_t begin, std::size_t end) {
+            for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
+            {
+                std::memcpy(&dst[{ dst_x, dst_y + y }], &src[{ area.x, area.y + y }], area.width * sizeof(pixel));
+            }
+        });
+    }
+
+    void alpha_blend(const image& src, image& dst, uint8_t alpha, thread_pool& pool)
+    {
+        if (src.width() != dst.width() || src.height() != dst.height()) throw std::invalid_argument{ "alpha_blend requires images of the same dimensions" };
+
+        pool.parallel_for(0, dst.height(), row_grain(dst.width()), [&](std::size_t begin, std::size_t end) {
+            for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y) blend_row(&src[{ 0, y }], &dst[{ 0, y }], dst.width(), alpha);
+        });
+    }
+
+    void apply_gamma(image& img, float gamma, thread_pool& pool)
+    {
+        if (!(gamma > 0)) throw std::invalid_argument{ "apply_gamma requires a positive gamma" };
+
+        // a byte has only 256 values, so the curve is tabulated once rather than evaluated per channel
+        uint8_t table[256];
+        for (int i = 0; i < 256; ++i)
+        {
+            table[i] = static_cast<uint8_t>(std::lround(255 * std::pow(i / 255.0, static_cast<double>(gamma))));
+        }
+
+        map(img, [&](pixel p) { return pixel{ table[p.red], table[p.green], table[p.blue] }; }, pool);
+    }
+
+    void downsample(const image& src, image& dst, thread_pool& pool)
+    {
+        if (dst.width() != src.width() / 2 || dst.height() != src.height() / 2) throw std::invalid_argument{ "downsample requires an image of half the dimensions" };
+
+        pool.parallel_for(0, dst.height(), row_grain(dst.width()), [&](std::size_t begin, std::size_t end) {
+            for (int y = static_cast<int>(begin); y < static_cast<int>(end); ++y)
+            {
+                downsample_row(&src[{ 0, 2 * y }], &src[{ 0, 2 * y + 1 }], &dst[{ 0, y }], dst.width());
+            }
+        });
+    }
+
+}
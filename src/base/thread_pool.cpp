@@ -0,0 +1,81 @@
+#include "base/thread_pool.hpp"
+
+namespace base
+{
+
+    thread_pool::thread_pool(std::size_t threads) : _stopping{ false }
+    {
+        _workers.reserve(threads);
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            _workers.emplace_back(&thread_pool::worker_loop, this);
+        }
+    }
+
+    thread_pool::~thread_pool()
+    {
+        {
+            std::lock_guard lock{ _mtx };
+            _stopping = true;
+        }
+        _cv.notify_all();
+        for (auto& worker : _workers) worker.join();
+    }
+
+    std::size_t thread_pool::concurrency() const
+    {
+        return _workers.size() + 1;
+    }
+
+    thread_pool& thread_pool::global()
+    {
+        static thread_pool pool{ std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0 };
+        return pool;
+    }
+
+    void thread_pool::worker_loop()
+    {
+        std::unique_lock lock{ _mtx };
+        while (true)
+        {
+            _cv.wait(lock, [this] { return _stopping || !_tasks.empty(); });
+            if (_tasks.empty()) return; // stopping
+            run_one(lock);
+        }
+    }
+
+    bool thread_pool::run_one(std::unique_lock<std::mutex>& lock)
+    {
+        if (_tasks.empty()) return false;
+
+        task t = std::move(_tasks.front());
+        _tasks.pop_front();
+        lock.unlock();
+
+        try { t.fn(); }
+        catch (...)
+        {
+            std::lock_guard error_lock{ t.group->error_mtx };
+            if (!t.group->error) t.group->error = std::current_exception();
+        }
+
+        lock.lock();
+        // the last chunk wakes everyone so that the thread waiting on this group notices
+        if (--t.group->remaining == 0) _cv.notify_all();
+        return true;
+    }
+
+    void thread_pool::run_group(task_group& group, std::vector<std::function<void()>>& fns)
+    {
+        std::unique_lock lock{ _mtx };
+        for (auto& fn : fns) _tasks.push_back(task{ std::move(fn), &group });
+        _cv.notify_all();
+
+        while (group.remaining > 0)
+        {
+            // help with any queued chunk (possibly of another loop) rather than sleeping
+            if (!run_one(lock)) _cv.wait(lock, [&] { return group.remaining == 0 || !_tasks.empty(); });
+        }
+    }
+
+}
@@ -0,0 +1,150 @@
+#include "base/tiled_image.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace base
+{
+
+    tiled_image::tiled_image(int width, int height) :
+    _width{ width }, _height{ height },
+    _tiles_x{ (width + tile_size - 1) / tile_size }, _tiles_y{ (height + tile_size - 1) / tile_size },
+    _buf{ new pixel[_tiles_x * _tiles_y * tile_pixels] } {}
+
+    tiled_image::tiled_image(const image& img) : tiled_image{ img.width(), img.height() }
+    {
+        for (int y = 0; y < _height; ++y)
+        {
+            for (int x = 0; x < _width; ++x)
+            {
+                (*this)[{ x, y }] = img[{ x, y }];
+            }
+        }
+    }
+
+    tiled_image::tiled_image(const tiled_image& img) :
+    _width{ img._width }, _height{ img._height }, _tiles_x{ img._tiles_x }, _tiles_y{ img._tiles_y },
+    _buf{ new pixel[_tiles_x * _tiles_y * tile_pixels] }
+    {
+        std::memcpy(_buf, img._buf, _tiles_x * _tiles_y * tile_pixels * sizeof(pixel));
+    }
+
+    tiled_image::tiled_image(tiled_image&& img) :
+    _width{ img._width }, _height{ img._height }, _tiles_x{ img._tiles_x }, _tiles_y{ img._tiles_y }, _buf{ img._buf }
+    {
+        img._buf = nullptr;
+    }
+
+    tiled_image& tiled_image::operator=(const tiled_image& img)
+    {
+        if (this == &img) return *this;
+
+        delete[] _buf;
+
+        _width = img._width;
+        _height = img._height;
+        _tiles_x = img._tiles_x;
+        _tiles_y = img._tiles_y;
+        _buf = new pixel[_tiles_x * _tiles_y * tile_pixels];
+        std::memcpy(_buf, img._buf, _tiles_x * _tiles_y * tile_pixels * sizeof(pixel));
+
+        return *this;
+    }
+
+    tiled_image& tiled_image::operator=(tiled_image&& img)
+    {
+        if (this == &img) return *this;
+
+        delete[] _buf;
+
+        _width = img._width;
+        _height = img._height;
+        _tiles_x = img._tiles_x;
+        _tiles_y = img._tiles_y;
+        _buf = img._buf;
+        img._buf = nullptr;
+
+        return *this;
+    }
+
+    tiled_image::~tiled_image()
+    {
+        delete[] _buf;
+    }
+
+    int tiled_image::width() const
+    {
+        return _width;
+    }
+
+    int tiled_image::height() const
+    {
+        return _height;
+    }
+
+    int tiled_image::tiles_x() const
+    {
+        return _tiles_x;
+    }
+
+    int tiled_image::tiles_y() const
+    {
+        return _tiles_y;
+    }
+
+    pixel* tiled_image::get_buffer() const
+    {
+        return _buf;
+    }
+
+    pixel* tiled_image::tile(int tile_x, int tile_y) const
+    {
+        return _buf + (tile_y * _tiles_x + tile_x) * tile_pixels;
+    }
+
+    pixel& tiled_image::operator[](tiled_image::coordinate coord)
+    {
+        return tile(coord.x / tile_size, coord.y / tile_size)[(coord.y % tile_size) * tile_size + coord.x % tile_size];
+    }
+
+    const pixel& tiled_image::operator[](tiled_image::coordinate coord) const
+    {
+        return tile(coord.x / tile_size, coord.y / tile_size)[(coord.y % tile_size) * tile_size + coord.x % tile_size];
+    }
+
+    void tiled_image::fill(pixel pix)
+    {
+        std::fill(_buf, _buf + _tiles_x * _tiles_y * tile_pixels, pix);
+    }
+
+    void tiled_image::untile(image& dst, thread_pool& pool) const
+    {
+        if (dst.width() != _width || dst.height() != _height) throw std::invalid_argument{ "untile requires images of the same dimensions" };
+
+        pool.parallel_for(0, _tiles_y, 1, [&](std::size_t begin, std::size_t end) {
+            for (int tile_y = static_cast<int>(begin); tile_y < static_cast<int>(end); ++tile_y)
+            {
+                const int rows = std::min(tile_size, _height - tile_y * tile_size);
+                for (int row = 0; row < rows; ++row)
+                {
+                    // each tile contributes one contiguous run of pixels to the scanline
+                    pixel* line = &dst[{ 0, tile_y * tile_size + row }];
+                    for (int tile_x = 0; tile_x < _tiles_x; ++tile_x)
+                    {
+                        const int columns = std::min(tile_size, _width - tile_x * tile_size);
+                        std::memcpy(line + tile_x * tile_size, tile(tile_x, tile_y) + row * tile_size, columns * sizeof(pixel));
+                    }
+                }
+            }
+        });
+    }
+
+    image tiled_image::to_image() const
+    {
+        image img{ _width, _height };
+        untile(img);
+        return img;
+    }
+
+}
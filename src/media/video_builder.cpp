@@ -1,10 +1,129 @@
 #include "media/video_builder.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "base/thread_pool.hpp"
 #include "media/constants.hpp"
 
 namespace media
 {
 
+    namespace
+    {
+        /**
+         * blocking queue of frame slot indices handed between the stages of the asynchronous pipeline.
+         * it never holds more indices than there are slots, so it is bounded by construction.
+         */
+        class slot_queue
+        {
+        private:
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::deque<int> slots;
+            bool closed = false;
+        public:
+            void push(int slot)
+            {
+                {
+                    std::lock_guard lock{ mtx };
+                    slots.push_back(slot);
+                }
+                cv.notify_one();
+            }
+
+            /**
+             * waits for a slot to become available.
+             * @param slot receives the popped slot
+             * @return false once the queue has been closed and emptied.
+             */
+            bool pop(int& slot)
+            {
+                std::unique_lock lock{ mtx };
+                cv.wait(lock, [this] { return !slots.empty() || closed; });
+                if (slots.empty()) return false;
+                slot = slots.front();
+                slots.pop_front();
+                return true;
+            }
+
+            void close()
+            {
+                {
+                    std::lock_guard lock{ mtx };
+                    closed = true;
+                }
+                cv.notify_all();
+            }
+        };
+
+        struct stage_counter
+        {
+            std::atomic<std::uint64_t> calls{ 0 };
+            std::atomic<std::uint64_t> nanoseconds{ 0 };
+
+            encoder_stats::stage snapshot() const
+            {
+                return { calls.load(std::memory_order_relaxed), static_cast<double>(nanoseconds.load(std::memory_order_relaxed)) * 1e-9 };
+            }
+        };
+
+        /**
+         * adds the time between its construction and destruction to a stage.
+         */
+        class stage_timer
+        {
+        private:
+            stage_counter& stage;
+            std::chrono::steady_clock::time_point start;
+        public:
+            explicit stage_timer(stage_counter& stage) : stage{ stage }, start{ std::chrono::steady_clock::now() } {}
+
+            stage_timer(const stage_timer&) = delete;
+            stage_timer& operator=(const stage_timer&) = delete;
+
+            ~stage_timer()
+            {
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                stage.calls.fetch_add(1, std::memory_order_relaxed);
+                stage.nanoseconds.fetch_add(static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+            }
+        };
+
+        void append_stage(std::string& json, const char* name, const encoder_stats::stage& stage)
+        {
+            json += fmt::format("\"{}\":{{\"calls\":{},\"seconds\":{}}},", name, stage.calls, stage.seconds);
+        }
+    }
+
+    std::uint64_t encoder_stats::frames_queued() const
+    {
+        return frames_pushed - frames_written;
+    }
+
+    std::string encoder_stats::to_json() const
+    {
+        std::string json = "{";
+        append_stage(json, "copy", copy);
+        append_stage(json, "convert", convert);
+        append_stage(json, "send_frame", send_frame);
+        append_stage(json, "receive_packet", receive_packet);
+        append_stage(json, "mux", mux);
+        json += fmt::format("\"frames_pushed\":{},\"frames_written\":{},\"frames_queued\":{},\"packets\":{},\"bytes_written\":{}}}",
+                            frames_pushed, frames_written, frames_queued(), packets, bytes_written);
+        return json;
+    }
+
     ffmpeg_error::ffmpeg_error(int error_code) : error_buffer{ 0 }, msg{ nullptr }
     {
         av_make_error_string(error_buffer, AV_ERROR_MAX_STRING_SIZE, error_code);
@@ -17,18 +136,113 @@ namespace media
         return msg ? msg : error_buffer;
     }
 
+    /**
+     * converts RGB0 frames into the codec's pixel format. the frame is cut into horizontal slices, each with its own
+     * swscale context, and the slices are converted in parallel when more than one is used.
+     */
+    struct video_builder::slice_converter
+    {
+        std::vector<SwsContext*> contexts; // one per slice
+        std::vector<int> offsets; // first row of every slice, followed by the frame height
+        int chroma_shift = 0; // log2 of the vertical chroma subsampling
+        base::thread_pool* pool = nullptr; // null when converting in a single slice
+    };
+
+    /**
+     * sink of the raw output modes. frames are written through a large stdio buffer so that the render loop only
+     * pays for a copy into memory most of the time.
+     */
+    struct video_builder::raw_writer
+    {
+        std::FILE* file = nullptr;
+        std::vector<char> buffer;
+        output_mode mode;
+    };
+
+    /**
+     * live counters behind video_builder::stats. updated with relaxed atomics from whichever thread runs a stage.
+     */
+    struct video_builder::stats_recorder
+    {
+        stage_counter copy, convert, send_frame, receive_packet, mux;
+        std::atomic<std::uint64_t> frames_pushed{ 0 }, frames_written{ 0 }, packets{ 0 }, bytes_written{ 0 };
+        std::string stats_file;
+
+        encoder_stats snapshot() const
+        {
+            encoder_stats stats;
+            stats.copy = copy.snapshot();
+            stats.convert = convert.snapshot();
+            stats.send_frame = send_frame.snapshot();
+            stats.receive_packet = receive_packet.snapshot();
+            stats.mux = mux.snapshot();
+            stats.frames_pushed = frames_pushed.load(std::memory_order_relaxed);
+            stats.frames_written = frames_written.load(std::memory_order_relaxed);
+            stats.packets = packets.load(std::memory_order_relaxed);
+            stats.bytes_written = bytes_written.load(std::memory_order_relaxed);
+            return stats;
+        }
+    };
+
     struct video_builder::private_methods
     {
-        static void init_context(video_builder& builder, const std::string& fn)
+        static bool is_raw(output_mode mode)
+        {
+            return mode == output_mode::y4m || mode == output_mode::raw_rgb0;
+        }
+
+        static AVPixelFormat pixel_format(output_mode mode)
         {
-            avformat_alloc_output_context2(&builder.fmt_ctx, nullptr, nullptr, fn.c_str());
+            switch (mode)
+            {
+                case output_mode::raw_rgb0: return AV_PIX_FMT_RGB0;
+                case output_mode::ffv1: return AV_PIX_FMT_GBRP; // planar RGB keeps ffv1 lossless with respect to the pushed frames
+                default: return AV_PIX_FMT_YUV420P;
+            }
+        }
+
+        static video_settings make_settings(int width, int height, int bitrate, int fps, int gop, int b_frames, std::size_t queue_depth,
+                                            int conversion_threads, scaler_quality quality)
+        {
+            video_settings settings;
+            settings.width = width;
+            settings.height = height;
+            settings.bitrate = bitrate;
+            settings.fps = fps;
+            settings.gop = gop;
+            settings.b_frames = b_frames;
+            settings.queue_depth = queue_depth;
+            settings.conversion_threads = conversion_threads;
+            settings.quality = quality;
+            return settings;
+        }
+
+        /**
+         * @return file name given to the muxer. segmented mode writes its playlist inside the directory named by fn.
+         */
+        static std::string output_path(const std::string& fn, const video_settings& settings)
+        {
+            if (settings.mode != output_mode::segmented) return fn;
+
+            std::error_code err;
+            std::filesystem::create_directories(fn, err);
+            if (err) throw ffmpeg_error{ "Could not create the segment directory." };
+            return (std::filesystem::path{ fn } / "index.m3u8").string();
+        }
+
+        static void init_context(video_builder& builder, const std::string& fn, const video_settings& settings)
+        {
+            const char* format_name = settings.mode == output_mode::segmented ? "hls" : nullptr;
+            avformat_alloc_output_context2(&builder.fmt_ctx, nullptr, format_name, fn.c_str());
             if (!builder.fmt_ctx) throw ffmpeg_error{ "Could not retrieve format information for this file name." };
             builder.output_fmt = builder.fmt_ctx->oformat; // set the output format
         }
 
-        static void init_stream(video_builder& builder)
+        static void init_stream(video_builder& builder, const video_settings& settings)
         {
-            builder.codec = avcodec_find_encoder(builder.output_fmt->video_codec);
+            if (settings.mode == output_mode::ffv1) builder.codec = avcodec_find_encoder(AV_CODEC_ID_FFV1);
+            else if (settings.codec.empty()) builder.codec = avcodec_find_encoder(builder.output_fmt->video_codec);
+            else builder.codec = avcodec_find_encoder_by_name(settings.codec.c_str());
             if (!builder.codec) throw ffmpeg_error{ "Could not retrieve codec." };
 
             builder.pkt = av_packet_alloc();
@@ -42,53 +256,161 @@ namespace media
             if (!builder.codec_ctx) throw ffmpeg_error{ "Failed to allocate codec context." };
         }
 
-        static void set_settings(video_builder& builder, int width, int height, int bitrate, int fps, int gop, int b_frames)
+        static void set_settings(video_builder& builder, const video_settings& settings)
         {
-            builder.codec_ctx->codec_id = builder.output_fmt->video_codec;
-            builder.codec_ctx->bit_rate = bitrate;
-            builder.codec_ctx->width = width;
-            builder.codec_ctx->height = height;
-            builder.codec_ctx->time_base = builder.stream->time_base = { 1, fps };
-            builder.codec_ctx->gop_size = gop;
-            builder.codec_ctx->max_b_frames = b_frames;
-            builder.codec_ctx->pix_fmt = AV_PIX_FMT_YUV420P;
+            builder.codec_ctx->codec_id = builder.codec->id;
+            builder.codec_ctx->bit_rate = settings.crf < 0 ? settings.bitrate : 0; // encoders prefer a set bitrate over crf
+            builder.codec_ctx->width = settings.width;
+            builder.codec_ctx->height = settings.height;
+            builder.codec_ctx->time_base = builder.stream->time_base = { 1, settings.fps };
+            builder.codec_ctx->framerate = { settings.fps, 1 };
+            builder.codec_ctx->gop_size = settings.mode == output_mode::ffv1 ? 1 : settings.gop; // intra-only
+            if (settings.mode == output_mode::segmented)
+            {
+                // segments start on keyframes, so a longer gop would stretch them past segment_seconds
+                builder.codec_ctx->gop_size = std::min(builder.codec_ctx->gop_size, settings.fps * settings.segment_seconds);
+            }
+            builder.codec_ctx->max_b_frames = settings.mode == output_mode::ffv1 ? 0 : settings.b_frames;
+            builder.codec_ctx->pix_fmt = pixel_format(settings.mode);
+
+            int threads = settings.thread_count > 0 ? settings.thread_count : static_cast<int>(std::thread::hardware_concurrency());
+            builder.codec_ctx->thread_count = threads;
+            builder.codec_ctx->thread_type = settings.thread_type;
 
             if (builder.fmt_ctx->oformat->flags & AVFMT_GLOBALHEADER) builder.codec_ctx->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
         }
 
-        static void init_codec(video_builder& builder)
+        static void init_codec(video_builder& builder, const video_settings& settings)
         {
+            AVDictionary* options = nullptr;
+            if (!settings.preset.empty()) av_dict_set(&options, "preset", settings.preset.c_str(), 0);
+            if (!settings.tune.empty()) av_dict_set(&options, "tune", settings.tune.c_str(), 0);
+            if (settings.crf >= 0) av_dict_set_int(&options, "crf", settings.crf, 0);
+            if (settings.mode == output_mode::ffv1) av_dict_set(&options, "level", "3", 0); // version 3 supports slice threading
+            for (const auto& [key, value] : settings.codec_options) av_dict_set(&options, key.c_str(), value.c_str(), 0);
+
             int ret;
-            ret = avcodec_open2(builder.codec_ctx, builder.codec, nullptr);
+            ret = avcodec_open2(builder.codec_ctx, builder.codec, &options);
+
+            // avcodec_open2 leaves behind the options the encoder does not know about
+            const AVDictionaryEntry* unused = nullptr;
+            while ((unused = av_dict_get(options, "", unused, AV_DICT_IGNORE_SUFFIX)))
+            {
+                fmt::print(stderr, "{} ignored the option {}={}\n", builder.codec->name, unused->key, unused->value);
+            }
+            av_dict_free(&options);
+
             if (ret < 0) throw ffmpeg_error{ ret };
 
             ret = avcodec_parameters_from_context(builder.stream->codecpar, builder.codec_ctx);
             if (ret < 0) throw ffmpeg_error{ ret };
         }
 
-        static void init_frames(video_builder& builder, int width, int height)
+        static AVFrame* alloc_frame(AVPixelFormat format, int width, int height)
         {
-            builder.yuv_frame = av_frame_alloc();
-            if (!builder.yuv_frame) throw ffmpeg_error{ "Could not allocate a new frame for YUV420P format." };
+            AVFrame* frame = av_frame_alloc();
+            if (!frame) throw ffmpeg_error{ "Could not allocate a new frame." };
 
-            builder.rgb_frame = av_frame_alloc();
-            if (!builder.rgb_frame) throw ffmpeg_error{ "Could not allocate a new frame for RGB format." };
+            frame->format = format;
+            frame->width = width;
+            frame->height = height;
 
-            builder.yuv_frame->format = AV_PIX_FMT_YUV420P;
-            builder.rgb_frame->format = AV_PIX_FMT_RGB0;
+            int ret = av_frame_get_buffer(frame, 0);
+            if (ret < 0)
+            {
+                av_frame_free(&frame);
+                throw ffmpeg_error{ ret };
+            }
+            return frame;
+        }
 
-            builder.yuv_frame->width = builder.rgb_frame->width = width;
-            builder.yuv_frame->height = builder.rgb_frame->height = height;
+        static void init_frames(video_builder& builder, int width, int height, AVPixelFormat format)
+        {
+            if (format != AV_PIX_FMT_RGB0) builder.yuv_frame = alloc_frame(format, width, height);
+            builder.rgb_frame = alloc_frame(AV_PIX_FMT_RGB0, width, height);
+        }
 
-            int ret;
-            ret = av_frame_get_buffer(builder.yuv_frame, 0);
-            if (ret < 0) throw ffmpeg_error{ ret };
+        static void open_raw_file(video_builder& builder, const std::string& fn, const video_settings& settings)
+        {
+            auto* writer = new raw_writer{};
+            builder.writer = writer;
+            writer->mode = settings.mode;
 
-            ret = av_frame_get_buffer(builder.rgb_frame, 0);
-            if (ret < 0) throw ffmpeg_error{ ret };
+            writer->file = std::fopen(fn.c_str(), "wb");
+            if (!writer->file) throw ffmpeg_error{ "Could not open the output file." };
+
+            writer->buffer.resize(settings.write_buffer_size);
+            if (!writer->buffer.empty()) std::setvbuf(writer->file, writer->buffer.data(), _IOFBF, writer->buffer.size());
+
+            if (settings.mode == output_mode::y4m)
+            {
+                // C420jpeg matches the center chroma siting of swscale
+                int header = std::fprintf(writer->file, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", settings.width, settings.height, settings.fps);
+                if (header < 0) throw ffmpeg_error{ "Failed to write to the output file." };
+                builder.recorder->bytes_written.fetch_add(header, std::memory_order_relaxed);
+            }
         }
 
-        static void open_file(video_builder& builder, const std::string& fn)
+        static void close_raw_file(video_builder& builder)
+        {
+            if (builder.writer->file) std::fclose(builder.writer->file); // flushes the buffer
+            delete builder.writer;
+            builder.writer = nullptr;
+        }
+
+        static std::size_t write_rows(std::FILE* file, const uint8_t* data, int linesize, int row_size, int rows)
+        {
+            for (int y = 0; y < rows; ++y)
+            {
+                if (std::fwrite(data + y * linesize, 1, row_size, file) != static_cast<std::size_t>(row_size))
+                    throw ffmpeg_error{ "Failed to write to the output file." };
+            }
+            return static_cast<std::size_t>(row_size) * rows;
+        }
+
+        /**
+         * writes a frame to the output of a raw mode: an RGB0 frame for raw_rgb0 and a YUV420P frame for y4m.
+         */
+        static void write_raw_frame(raw_writer& writer, stats_recorder& stats, const AVFrame* frame)
+        {
+            stage_timer timer{ stats.mux };
+
+            std::size_t bytes;
+            if (writer.mode == output_mode::y4m)
+            {
+                if (std::fputs("FRAME\n", writer.file) < 0) throw ffmpeg_error{ "Failed to write to the output file." };
+                bytes = 6;
+                bytes += write_rows(writer.file, frame->data[0], frame->linesize[0], frame->width, frame->height);
+                bytes += write_rows(writer.file, frame->data[1], frame->linesize[1], frame->width / 2, frame->height / 2);
+                bytes += write_rows(writer.file, frame->data[2], frame->linesize[2], frame->width / 2, frame->height / 2);
+            }
+            else bytes = write_rows(writer.file, frame->data[0], frame->linesize[0], frame->width * 4, frame->height);
+
+            stats.bytes_written.fetch_add(bytes, std::memory_order_relaxed);
+            stats.frames_written.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        static AVDictionary* format_options(const video_settings& settings)
+        {
+            AVDictionary* options = nullptr;
+            if (settings.mode == output_mode::fragmented_mp4)
+            {
+                // a fragment per keyframe, with the moov written up front instead of by av_write_trailer
+                av_dict_set(&options, "movflags", "frag_keyframe+empty_moov+default_base_moof", 0);
+                av_dict_set(&options, "flush_packets", "1", 0);
+            }
+            else if (settings.mode == output_mode::segmented)
+            {
+                av_dict_set_int(&options, "hls_time", settings.segment_seconds, 0);
+                av_dict_set(&options, "hls_list_size", "0", 0); // keep every segment in the playlist
+                av_dict_set(&options, "hls_playlist_type", "event", 0); // segments are listed as soon as they are complete
+                av_dict_set(&options, "hls_flags", "independent_segments", 0);
+            }
+            for (const auto& [key, value] : settings.format_options) av_dict_set(&options, key.c_str(), value.c_str(), 0);
+            return options;
+        }
+
+        static void open_file(video_builder& builder, const std::string& fn, const video_settings& settings)
         {
             int ret;
             av_dump_format(builder.fmt_ctx, 0, fn.c_str(), true);
@@ -97,84 +419,415 @@ namespace media
                 ret = avio_open(&builder.fmt_ctx->pb, fn.c_str(), AVIO_FLAG_WRITE);
                 if (ret < 0) throw ffmpeg_error{ ret };
             }
-            ret = avformat_write_header(builder.fmt_ctx, nullptr);
+
+            AVDictionary* options = format_options(settings);
+            ret = avformat_write_header(builder.fmt_ctx, &options);
+
+            const AVDictionaryEntry* unused = nullptr;
+            while ((unused = av_dict_get(options, "", unused, AV_DICT_IGNORE_SUFFIX)))
+            {
+                fmt::print(stderr, "{} ignored the option {}={}\n", builder.output_fmt->name, unused->key, unused->value);
+            }
+            av_dict_free(&options);
+
             if (ret < 0) throw ffmpeg_error{ ret };
         }
 
-        static void init_sws(video_builder& builder, int width, int height)
+        static void init_sws(video_builder& builder, int width, int height, AVPixelFormat dst_format, int conversion_threads, scaler_quality quality)
+        {
+            auto* converter = new slice_converter{};
+            builder.converter = converter;
+
+            converter->chroma_shift = av_pix_fmt_desc_get(dst_format)->log2_chroma_h;
+
+            // slices start on rows shared by luma and subsampled chroma so that no chroma row is split
+            const int row_align = 1 << converter->chroma_shift;
+            const int rows = height / row_align;
+            const int slices = std::clamp(conversion_threads, 1, std::max(rows, 1));
+
+            for (int i = 0; i <= slices; ++i)
+            {
+                converter->offsets.push_back(i == slices ? height : rows * i / slices * row_align);
+            }
+
+            for (int i = 0; i < slices; ++i)
+            {
+                int slice_height = converter->offsets[i + 1] - converter->offsets[i];
+                SwsContext* ctx = sws_getContext(width, slice_height, AV_PIX_FMT_RGB0,
+                                                 width, slice_height, dst_format,
+                                                 static_cast<int>(quality), nullptr, nullptr, nullptr);
+                if (!ctx) throw ffmpeg_error{ "Failed to create sws_context." };
+                converter->contexts.push_back(ctx);
+            }
+
+            if (slices > 1) converter->pool = new base::thread_pool{ static_cast<std::size_t>(slices - 1) };
+        }
+
+        static void destroy_sws(video_builder& builder)
         {
-            builder.sws_ctx = sws_getContext(width, height, AV_PIX_FMT_RGB0,
-                                             width, height, AV_PIX_FMT_YUV420P,
-                                             SWS_BICUBIC, nullptr, nullptr, nullptr);
-            if (!builder.sws_ctx) throw ffmpeg_error{ "Failed to create sws_context." };
+            if (!builder.converter) return;
+            for (SwsContext* ctx : builder.converter->contexts) sws_freeContext(ctx);
+            delete builder.converter->pool;
+            delete builder.converter;
+            builder.converter = nullptr;
         }
 
-        static void write_to_frame(video_builder& builder, uint8_t *data)
+        static base::image view_frame(AVFrame* rgb_frame)
         {
-            int ret;
-            ret = av_frame_make_writable(builder.yuv_frame);
+            int ret = av_frame_make_writable(rgb_frame);
             if (ret < 0) throw ffmpeg_error{ ret };
 
-            ret = av_frame_make_writable(builder.rgb_frame);
+            return base::image{ reinterpret_cast<base::pixel*>(rgb_frame->data[0]), rgb_frame->width, rgb_frame->height,
+                                static_cast<int>(rgb_frame->linesize[0] / sizeof(base::pixel)) };
+        }
+
+        /**
+         * checks an image pushed as a whole frame against the size of the video, before a frame is lent for it.
+         * @throws std::invalid_argument if the sizes differ.
+         */
+        static void check_frame_size(const video_builder& builder, int width, int height);
+
+        static void copy_to_view(base::image& view, const uint8_t* data, std::size_t src_linesize)
+        {
+            const std::size_t row_size = view.width() * sizeof(base::pixel);
+            for (int y = 0; y < view.height(); ++y)
+            {
+                std::memcpy(&view[{ 0, y }], data + y * src_linesize, row_size);
+            }
+        }
+
+        static void convert_slice(const slice_converter& converter, std::size_t slice, const AVFrame* rgb_frame, AVFrame* yuv_frame)
+        {
+            const int first_row = converter.offsets[slice];
+            const int rows = converter.offsets[slice + 1] - first_row;
+
+            const uint8_t* src[1] = { rgb_frame->data[0] + first_row * rgb_frame->linesize[0] };
+            uint8_t* dst[AV_NUM_DATA_POINTERS] = {};
+            for (int plane = 0; plane < AV_NUM_DATA_POINTERS && yuv_frame->data[plane]; ++plane)
+            {
+                // the two chroma planes of a planar format have subsampled rows
+                int plane_row = plane == 1 || plane == 2 ? first_row >> converter.chroma_shift : first_row;
+                dst[plane] = yuv_frame->data[plane] + plane_row * yuv_frame->linesize[plane];
+            }
+
+            sws_scale(converter.contexts[slice], src, rgb_frame->linesize, 0, rows, dst, yuv_frame->linesize);
+        }
+
+        static void convert_frame(const slice_converter& converter, stats_recorder& stats, const AVFrame* rgb_frame, AVFrame* yuv_frame)
+        {
+            stage_timer timer{ stats.convert };
+
+            int ret = av_frame_make_writable(yuv_frame);
             if (ret < 0) throw ffmpeg_error{ ret };
 
-            std::memcpy(builder.rgb_frame->data[0], data, builder.codec_ctx->width * builder.codec_ctx->height * 4);
-            sws_scale(builder.sws_ctx, builder.rgb_frame->data, builder.rgb_frame->linesize,
-                      0, builder.codec_ctx->height, builder.yuv_frame->data, builder.yuv_frame->linesize);
-            builder.yuv_frame->pts = ++*builder.pts;
+            const std::size_t slices = converter.contexts.size();
+            if (converter.pool)
+            {
+                converter.pool->parallel_for(0, slices, 1, [&](std::size_t begin, std::size_t end) {
+                    for (std::size_t slice = begin; slice < end; ++slice) convert_slice(converter, slice, rgb_frame, yuv_frame);
+                });
+            }
+            else convert_slice(converter, 0, rgb_frame, yuv_frame);
+
+            yuv_frame->pts = rgb_frame->pts;
         }
 
-        static void log_packet(video_builder& builder)
+        static void log_packet(const AVFormatContext* fmt_ctx, AVPacket* pkt)
         {
-            AVRational *time_base = &builder.fmt_ctx->streams[builder.pkt->stream_index]->time_base;
+            AVRational *time_base = &fmt_ctx->streams[pkt->stream_index]->time_base;
             char buf0[AV_TS_MAX_STRING_SIZE], buf1[AV_TS_MAX_STRING_SIZE];
-            fmt::print("pts:{} pts_time:{} ", av_ts_make_string(buf0, builder.pkt->pts), av_ts_make_time_string(buf1, builder.pkt->pts, time_base));
-            fmt::print("dts:{} dts_time:{} \n", av_ts_make_string(buf0, builder.pkt->dts), av_ts_make_time_string(buf1, builder.pkt->dts, time_base));
+            fmt::print("pts:{} pts_time:{} ", av_ts_make_string(buf0, pkt->pts), av_ts_make_time_string(buf1, pkt->pts, time_base));
+            fmt::print("dts:{} dts_time:{} \n", av_ts_make_string(buf0, pkt->dts), av_ts_make_time_string(buf1, pkt->dts, time_base));
         }
 
-        static void send_frame_to_codec(video_builder& builder)
+        /**
+         * sends a frame to the codec and writes out every packet it produces.
+         * the handles are passed explicitly as the asynchronous stages may outlive the builder that started them.
+         * @param frame frame to encode. null drains the codec.
+         */
+        static void send_frame_to_codec(AVFormatContext* fmt_ctx, AVCodecContext* codec_ctx, AVStream* stream, AVPacket* pkt,
+                                        stats_recorder& stats, const AVFrame* frame)
         {
             int ret;
-            ret = avcodec_send_frame(builder.codec_ctx, builder.yuv_frame);
+            {
+                stage_timer timer{ stats.send_frame };
+                ret = avcodec_send_frame(codec_ctx, frame);
+            }
             if (ret < 0) throw ffmpeg_error{ ret };
+            if (frame) stats.frames_written.fetch_add(1, std::memory_order_relaxed);
 
             while (true)
             {
-                ret = avcodec_receive_packet(builder.codec_ctx, builder.pkt);
+                {
+                    stage_timer timer{ stats.receive_packet };
+                    ret = avcodec_receive_packet(codec_ctx, pkt);
+                }
                 if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
                 else if (ret < 0) throw ffmpeg_error{ ret };
 
-                av_packet_rescale_ts(builder.pkt, builder.codec_ctx->time_base, builder.stream->time_base);
-                builder.pkt->stream_index = builder.stream->index;
+                av_packet_rescale_ts(pkt, codec_ctx->time_base, stream->time_base);
+                pkt->stream_index = stream->index;
 
-                if constexpr (LOG_PACKETS) { log_packet(builder); }
+                if constexpr (LOG_PACKETS) { log_packet(fmt_ctx, pkt); }
 
-                ret = av_interleaved_write_frame(builder.fmt_ctx, builder.pkt);
+                const int size = pkt->size; // the muxer takes the packet's reference
+                {
+                    stage_timer timer{ stats.mux };
+                    ret = av_interleaved_write_frame(fmt_ctx, pkt);
+                }
                 if (ret < 0) throw ffmpeg_error{ ret };
+
+                stats.packets.fetch_add(1, std::memory_order_relaxed);
+                stats.bytes_written.fetch_add(static_cast<std::uint64_t>(size), std::memory_order_relaxed);
+            }
+        }
+
+        static void send_frame_to_codec(video_builder& builder, const AVFrame* frame)
+        {
+            send_frame_to_codec(builder.fmt_ctx, builder.codec_ctx, builder.stream, builder.pkt, *builder.recorder, frame);
+        }
+
+        /**
+         * writes out a converted frame through whichever output the builder was opened with.
+         */
+        static void output_frame(AVFormatContext* fmt_ctx, AVCodecContext* codec_ctx, AVStream* stream, AVPacket* pkt, raw_writer* writer,
+                                 stats_recorder& stats, const AVFrame* frame)
+        {
+            if (writer) write_raw_frame(*writer, stats, frame);
+            else send_frame_to_codec(fmt_ctx, codec_ctx, stream, pkt, stats, frame);
+        }
+
+        static void write_stats(const stats_recorder& stats)
+        {
+            std::FILE* file = std::fopen(stats.stats_file.c_str(), "w");
+            if (!file) return; // called from the destructor, where errors cannot be reported
+            fmt::print(file, "{}\n", stats.snapshot().to_json());
+            std::fclose(file);
+        }
+
+        static void init_pipeline(video_builder& builder, std::size_t queue_depth, int width, int height, AVPixelFormat format);
+
+        static void destroy_pipeline(video_builder& builder);
+
+    };
+
+    /**
+     * state of the asynchronous mode, shared by every copy of a builder.
+     * frames travel through a fixed ring of pre-allocated slots: push_frame fills an RGB0 slot, the conversion stage
+     * turns it into a YUV420P slot and the encoding stage hands that slot to the codec and muxer. a stage waits when
+     * every slot it needs is in flight, which in turn makes push_frame wait once the whole ring is queued.
+     */
+    struct video_builder::encode_pipeline
+    {
+        // copies of the builder's handles. the stages must not refer back to a builder since any one copy may be
+        // destroyed while the others keep pushing frames.
+        AVFormatContext* fmt_ctx;
+        AVCodecContext* codec_ctx;
+        AVStream* stream;
+        const slice_converter* converter; // null in raw_rgb0 mode, where frames are written as pushed
+        AVPacket* pkt;
+        raw_writer* writer;
+        stats_recorder* stats;
+
+        std::vector<AVFrame*> rgb_slots;
+        std::vector<AVFrame*> yuv_slots;
+
+        slot_queue free_rgb, free_yuv; // slots which are ready to be written to
+        slot_queue to_convert, to_encode; // slots which are waiting on the next stage
+
+        std::mutex state_mtx;
+        std::condition_variable drained;
+        std::size_t in_flight = 0;
+        std::exception_ptr error;
+
+        std::thread convert_stage, encode_stage;
+
+        bool failed()
+        {
+            std::lock_guard lock{ state_mtx };
+            return static_cast<bool>(error);
+        }
+
+        void rethrow_if_failed()
+        {
+            std::lock_guard lock{ state_mtx };
+            if (error) std::rethrow_exception(error);
+        }
+
+        void record_error(std::exception_ptr err)
+        {
+            std::lock_guard lock{ state_mtx };
+            if (!error) error = err; // keep only the first error
+        }
+
+        void begin_frame()
+        {
+            std::lock_guard lock{ state_mtx };
+            ++in_flight;
+        }
+
+        void finish_frame()
+        {
+            {
+                std::lock_guard lock{ state_mtx };
+                --in_flight;
             }
+            drained.notify_all();
+        }
+
+        void wait_drained()
+        {
+            std::unique_lock lock{ state_mtx };
+            drained.wait(lock, [this] { return in_flight == 0; });
         }
 
+        void run_convert_stage()
+        {
+            int rgb, yuv;
+            while (to_convert.pop(rgb))
+            {
+                if (!converter)
+                {
+                    // nothing to convert: write the frame from here and leave the encoding stage idle
+                    if (!failed())
+                    {
+                        try { private_methods::write_raw_frame(*writer, *stats, rgb_slots[rgb]); }
+                        catch (...) { record_error(std::current_exception()); }
+                    }
+                    free_rgb.push(rgb);
+                    finish_frame();
+                    continue;
+                }
+
+                free_yuv.pop(yuv); // never closed while this stage is running
+                bool ok = false;
+                if (!failed())
+                {
+                    try
+                    {
+                        private_methods::convert_frame(*converter, *stats, rgb_slots[rgb], yuv_slots[yuv]);
+                        ok = true;
+                    }
+                    catch (...) { record_error(std::current_exception()); }
+                }
+                free_rgb.push(rgb);
+
+                if (ok) to_encode.push(yuv);
+                else
+                {
+                    free_yuv.push(yuv);
+                    finish_frame();
+                }
+            }
+            to_encode.close();
+        }
+
+        void run_encode_stage()
+        {
+            int yuv;
+            while (to_encode.pop(yuv))
+            {
+                if (!failed())
+                {
+                    try { private_methods::output_frame(fmt_ctx, codec_ctx, stream, pkt, writer, *stats, yuv_slots[yuv]); }
+                    catch (...) { record_error(std::current_exception()); }
+                }
+                free_yuv.push(yuv);
+                finish_frame();
+            }
+        }
     };
 
-    video_builder::video_builder(const std::string& fn, int video_width, int video_height, int video_bitrate, int video_fps, int gop, int b_frames) :
-    pts{ new int{ 0 } }, ref_count{ new uint8_t{ 1 } }
+    void video_builder::private_methods::init_pipeline(video_builder& builder, std::size_t queue_depth, int width, int height, AVPixelFormat format)
     {
-        private_methods::init_context(*this, fn);
+        auto* pipeline = new encode_pipeline{};
+        builder.pipeline = pipeline;
+
+        pipeline->fmt_ctx = builder.fmt_ctx;
+        pipeline->codec_ctx = builder.codec_ctx;
+        pipeline->stream = builder.stream;
+        pipeline->converter = builder.converter;
+        pipeline->pkt = builder.pkt;
+        pipeline->writer = builder.writer;
+        pipeline->stats = builder.recorder;
 
-        private_methods::init_stream(*this);
-        private_methods::set_settings(*this, video_width, video_height, video_bitrate, video_fps, gop, b_frames);
+        for (std::size_t i = 0; i < queue_depth; ++i)
+        {
+            pipeline->rgb_slots.push_back(alloc_frame(AV_PIX_FMT_RGB0, width, height));
+            pipeline->free_rgb.push(static_cast<int>(i));
+            if (format == AV_PIX_FMT_RGB0) continue; // frames are written without conversion
+            pipeline->yuv_slots.push_back(alloc_frame(format, width, height));
+            pipeline->free_yuv.push(static_cast<int>(i));
+        }
+
+        pipeline->convert_stage = std::thread{ &encode_pipeline::run_convert_stage, pipeline };
+        pipeline->encode_stage = std::thread{ &encode_pipeline::run_encode_stage, pipeline };
+    }
+
+    void video_builder::private_methods::check_frame_size(const video_builder& builder, int width, int height)
+    {
+        const AVFrame* frame = builder.pipeline ? builder.pipeline->rgb_slots.front() : builder.rgb_frame;
+        if (width != frame->width || height != frame->height)
+        {
+            throw std::invalid_argument{ "pushed image must have the size of the video" };
+        }
+    }
+
+    void video_builder::private_methods::destroy_pipeline(video_builder& builder)
+    {
+        encode_pipeline* pipeline = builder.pipeline;
 
-        private_methods::init_codec(*this);
+        // closing the first queue lets both stages run through every queued frame before exiting
+        pipeline->to_convert.close();
+        if (pipeline->convert_stage.joinable()) pipeline->convert_stage.join();
+        if (pipeline->encode_stage.joinable()) pipeline->encode_stage.join();
 
-        private_methods::init_frames(*this, video_width, video_height);
-        private_methods::open_file(*this, fn);
+        for (AVFrame*& frame : pipeline->rgb_slots) av_frame_free(&frame);
+        for (AVFrame*& frame : pipeline->yuv_slots) av_frame_free(&frame);
 
-        private_methods::init_sws(*this, video_width, video_height);
+        delete pipeline;
+        builder.pipeline = nullptr;
     }
 
+    video_builder::video_builder(const std::string& fn, const video_settings& settings) :
+    pts{ new int{ 0 } }, ref_count{ new uint8_t{ 1 } }, frame_lent{ new bool{ false } }, recorder{ new stats_recorder{} }
+    {
+        recorder->stats_file = settings.stats_file;
+
+        const AVPixelFormat format = private_methods::pixel_format(settings.mode);
+
+        if (private_methods::is_raw(settings.mode)) private_methods::open_raw_file(*this, fn, settings);
+        else
+        {
+            const std::string path = private_methods::output_path(fn, settings);
+            private_methods::init_context(*this, path, settings);
+
+            private_methods::init_stream(*this, settings);
+            private_methods::set_settings(*this, settings);
+
+            private_methods::init_codec(*this, settings);
+
+            private_methods::open_file(*this, path, settings);
+        }
+
+        if (settings.queue_depth == 0) private_methods::init_frames(*this, settings.width, settings.height, format);
+
+        if (format != AV_PIX_FMT_RGB0)
+        {
+            private_methods::init_sws(*this, settings.width, settings.height, format, settings.conversion_threads, settings.quality);
+        }
+
+        if (settings.queue_depth > 0) private_methods::init_pipeline(*this, settings.queue_depth, settings.width, settings.height, format);
+    }
+
+    video_builder::video_builder(const std::string& fn, int video_width, int video_height, int video_bitrate, int video_fps, int gop, int b_frames, std::size_t queue_depth,
+                                 int conversion_threads, scaler_quality quality) :
+    video_builder{ fn, private_methods::make_settings(video_width, video_height, video_bitrate, video_fps, gop, b_frames, queue_depth, conversion_threads, quality) } {}
+
     video_builder::video_builder(const video_builder& cpy) :
     output_fmt{ cpy.output_fmt }, fmt_ctx{ cpy.fmt_ctx }, stream{ cpy.stream }, codec{ cpy.codec }, codec_ctx{ cpy.codec_ctx },
-    yuv_frame{ cpy.yuv_frame }, rgb_frame{ cpy.rgb_frame }, sws_ctx{ cpy.sws_ctx }, pkt{ cpy.pkt }, pts{ cpy.pts }, ref_count{ cpy.ref_count }
+    yuv_frame{ cpy.yuv_frame }, rgb_frame{ cpy.rgb_frame }, converter{ cpy.converter }, pkt{ cpy.pkt }, pts{ cpy.pts }, ref_count{ cpy.ref_count },
+    frame_lent{ cpy.frame_lent }, pipeline{ cpy.pipeline }, writer{ cpy.writer }, recorder{ cpy.recorder }
     {
         ++*ref_count;
     }
@@ -192,11 +845,15 @@ namespace media
         codec_ctx = cpy.codec_ctx;
         yuv_frame = cpy.yuv_frame;
         rgb_frame = cpy.rgb_frame;
-        sws_ctx = cpy.sws_ctx;
+        converter = cpy.converter;
         pkt = cpy.pkt;
 
         pts = cpy.pts;
         ref_count = cpy.ref_count;
+        frame_lent = cpy.frame_lent;
+        pipeline = cpy.pipeline;
+        writer = cpy.writer;
+        recorder = cpy.recorder;
 
         ++*ref_count;
 
@@ -208,32 +865,197 @@ namespace media
         --*ref_count;
         if (*ref_count == 0)
         {
-            av_write_trailer(fmt_ctx);
-            avcodec_free_context(&codec_ctx);
-            av_frame_free(&yuv_frame);
-            av_frame_free(&rgb_frame);
-            av_packet_free(&pkt);
-            sws_freeContext(sws_ctx);
-            if (!(output_fmt->flags & AVFMT_NOFILE)) // close file
+            if (pipeline) private_methods::destroy_pipeline(*this);
+
+            if (writer) private_methods::close_raw_file(*this);
+            else
             {
-                avio_closep(&fmt_ctx->pb);
+                // drain the frames still buffered by the codec. errors cannot be reported from here
+                try { private_methods::send_frame_to_codec(*this, nullptr); }
+                catch (const ffmpeg_error&) {}
+
+                av_write_trailer(fmt_ctx);
+                avcodec_free_context(&codec_ctx);
+                av_packet_free(&pkt);
+                if (!(output_fmt->flags & AVFMT_NOFILE)) // close file
+                {
+                    avio_closep(&fmt_ctx->pb);
+                }
+                avformat_free_context(fmt_ctx);
             }
-            avformat_free_context(fmt_ctx);
 
+            av_frame_free(&yuv_frame);
+            av_frame_free(&rgb_frame);
+            private_methods::destroy_sws(*this);
+
+            if (!recorder->stats_file.empty()) private_methods::write_stats(*recorder);
+
+            delete recorder;
             delete pts;
             delete ref_count;
+            delete frame_lent;
+        }
+    }
+
+    video_builder::lent_frame::lent_frame(encode_pipeline* pipeline, bool* lent, int slot, base::image&& view) :
+    pipeline{ pipeline }, lent{ lent }, slot{ slot }, view{ std::move(view) } {}
+
+    video_builder::lent_frame::lent_frame(lent_frame&& mv) noexcept :
+    pipeline{ mv.pipeline }, lent{ mv.lent }, slot{ mv.slot }, view{ std::move(mv.view) }
+    {
+        mv.detach();
+    }
+
+    video_builder::lent_frame& video_builder::lent_frame::operator=(lent_frame&& mv) noexcept
+    {
+        if (&mv == this) return *this;
+
+        release();
+        pipeline = mv.pipeline;
+        lent = mv.lent;
+        slot = mv.slot;
+        view = std::move(mv.view);
+        mv.detach();
+
+        return *this;
+    }
+
+    video_builder::lent_frame::~lent_frame()
+    {
+        release();
+    }
+
+    void video_builder::lent_frame::release()
+    {
+        if (pipeline) pipeline->free_rgb.push(slot);
+        else if (lent) *lent = false;
+        detach();
+    }
+
+    void video_builder::lent_frame::detach()
+    {
+        pipeline = nullptr;
+        lent = nullptr;
+        slot = -1;
+        view = base::image{ nullptr, 0, 0, 0 };
+    }
+
+    bool video_builder::lent_frame::empty() const
+    {
+        return !pipeline && !lent;
+    }
+
+    base::image& video_builder::lent_frame::get()
+    {
+        return view;
+    }
+
+    const base::image& video_builder::lent_frame::get() const
+    {
+        return view;
+    }
+
+    video_builder::lent_frame video_builder::lend_frame()
+    {
+        if (!pipeline)
+        {
+            if (*frame_lent) throw ffmpeg_error{ "The frame of a synchronous video builder is already lent." };
+            lent_frame frame{ nullptr, frame_lent, -1, private_methods::view_frame(rgb_frame) };
+            *frame_lent = true;
+            return frame;
+        }
+
+        pipeline->rethrow_if_failed();
+
+        int slot;
+        pipeline->free_rgb.pop(slot);
+        try { return lent_frame{ pipeline, nullptr, slot, private_methods::view_frame(pipeline->rgb_slots[slot]) }; }
+        catch (...)
+        {
+            pipeline->free_rgb.push(slot);
+            throw;
+        }
+    }
+
+    void video_builder::commit_frame(lent_frame&& frame)
+    {
+        // a frame of another builder, or an empty one, is refused before touching it so that the caller keeps it
+        if (pipeline ? frame.pipeline != pipeline : frame.lent != frame_lent)
+        {
+            throw ffmpeg_error{ "Committed frame was not lent by this video builder." };
+        }
+
+        const int slot = frame.slot;
+        frame.detach(); // the frame is now the builder's to encode and must not go back to the free slots
+
+        if (pipeline)
+        {
+            pipeline->rgb_slots[slot]->pts = ++*pts;
+            recorder->frames_pushed.fetch_add(1, std::memory_order_relaxed);
+            pipeline->begin_frame();
+            pipeline->to_convert.push(slot);
+        }
+        else
+        {
+            *frame_lent = false; // whether encoding succeeds or not, the frame can be lent again
+
+            rgb_frame->pts = ++*pts;
+            recorder->frames_pushed.fetch_add(1, std::memory_order_relaxed);
+            if (!converter) private_methods::write_raw_frame(*writer, *recorder, rgb_frame);
+            else
+            {
+                private_methods::convert_frame(*converter, *recorder, rgb_frame, yuv_frame);
+                private_methods::output_frame(fmt_ctx, codec_ctx, stream, pkt, writer, *recorder, yuv_frame);
+            }
         }
     }
 
     void video_builder::push_frame(uint8_t* rgbx_data)
     {
-        private_methods::write_to_frame(*this, rgbx_data);
-        private_methods::send_frame_to_codec(*this);
+        lent_frame frame = lend_frame();
+        {
+            stage_timer timer{ recorder->copy };
+            private_methods::copy_to_view(frame.get(), rgbx_data, frame.get().width() * sizeof(base::pixel));
+        }
+        commit_frame(std::move(frame));
     }
 
     void video_builder::push_frame(const base::image& img)
     {
-        push_frame(reinterpret_cast<uint8_t*>(img.get_buffer()));
+        private_methods::check_frame_size(*this, img.width(), img.height());
+        lent_frame frame = lend_frame();
+        {
+            stage_timer timer{ recorder->copy };
+            private_methods::copy_to_view(frame.get(), reinterpret_cast<const uint8_t*>(img.get_buffer()), img.stride() * sizeof(base::pixel));
+        }
+        commit_frame(std::move(frame));
+    }
+
+    void video_builder::push_frame(const base::tiled_image& img)
+    {
+        private_methods::check_frame_size(*this, img.width(), img.height());
+        lent_frame frame = lend_frame();
+        {
+            stage_timer timer{ recorder->copy };
+            img.untile(frame.get());
+        }
+        commit_frame(std::move(frame));
+    }
+
+    void video_builder::flush()
+    {
+        if (pipeline)
+        {
+            pipeline->wait_drained();
+            pipeline->rethrow_if_failed();
+        }
+        // the tail of a raw output otherwise only reaches the disk in the destructor, which cannot report a failure
+        if (writer && std::fflush(writer->file) != 0) throw ffmpeg_error{ "Failed to write to the output file." };
+    }
+
+    encoder_stats video_builder::stats() const
+    {
+        return recorder->snapshot();
     }
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,170 @@
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "accel/bvh.hpp"
+#include "accel/lbvh.hpp"
+#include "accel/triangle.hpp"
+#include "accel/wide_bvh.hpp"
+
+// traces the same rays through the binary, 4-wide and 8-wide trees built over the same scenes
+
+using namespace math;
+using accel::triangle;
+using ray3f = ray<float, 3>;
+
+constexpr int repetitions = 3;
+
+// a grid of tessellated spheres, the kind of coherent surfaces real scenes are made of
+std::vector<triangle> sphere_grid(int spheres_per_axis, int rings)
+{
+    std::vector<triangle> tris;
+    int segments = 2 * rings;
+    for (int gx = 0; gx < spheres_per_axis; ++gx)
+    {
+        for (int gz = 0; gz < spheres_per_axis; ++gz)
+        {
+            point<float, 3> center{ 3.0f * gx, 0, 3.0f * gz };
+            auto at = [&](int ring, int segment)
+            {
+                float theta = pi<float> * ring / rings, phi = tau<float> * segment / segments;
+                return center + vector<float, 3>{ std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+            };
+            for (int ring = 0; ring < rings; ++ring)
+            {
+                for (int segment = 0; segment < segments; ++segment)
+                {
+                    tris.push_back({ at(ring, segment), at(ring + 1, segment), at(ring + 1, segment + 1) });
+                    tris.push_back({ at(ring, segment), at(ring + 1, segment + 1), at(ring, segment + 1) });
+                }
+            }
+        }
+    }
+    return tris;
+}
+
+// small triangles scattered through a cube, the worst case for any hierarchy
+std::vector<triangle> triangle_soup(std::size_t count)
+{
+    std::mt19937 gen{ 1 };
+    std::uniform_real_distribution<float> center{ 0, 60 }, offset{ -0.5f, 0.5f };
+    std::vector<triangle> tris(count);
+    for (auto& t : tris)
+    {
+        point<float, 3> c{ center(gen), center(gen), center(gen) };
+        t.p0 = c + vector<float, 3>{ offset(gen), offset(gen), offset(gen) };
+        t.p1 = c + vector<float, 3>{ offset(gen), offset(gen), offset(gen) };
+        t.p2 = c + vector<float, 3>{ offset(gen), offset(gen), offset(gen) };
+    }
+    return tris;
+}
+
+// pinhole camera rays looking at the center of the scene from outside it
+std::vector<ray3f> primary_rays(const bounds3f& scene, int resolution)
+{
+    point<float, 3> target = scene.centroid();
+    vector<float, 3> extent = scene.diagonal();
+    point<float, 3> eye = target + vector<float, 3>{ 0.3f * extent[0], 0.6f * extent[1] + 0.5f * extent[2], -1.2f * extent[2] };
+    vector<float, 3> forward = normalize<float>(target - eye);
+    vector<float, 3> right = normalize<float>(cross(vector<float, 3>{ 0, 1, 0 }, forward));
+    vector<float, 3> up = cross(forward, right);
+
+    std::vector<ray3f> rays;
+    for (int y = 0; y < resolution; ++y)
+    {
+        for (int x = 0; x < resolution; ++x)
+        {
+            float u = (x + 0.5f) / resolution - 0.5f, v = (y + 0.5f) / resolution - 0.5f;
+            rays.push_back({ eye, forward + right * u + up * v });
+        }
+    }
+    return rays;
+}
+
+// rays from random points inside the scene in random directions, like diffuse bounces
+std::vector<ray3f> incoherent_rays(const bounds3f& scene, std::size_t count)
+{
+    std::mt19937 gen{ 2 };
+    std::uniform_real_distribution<float> unit{ 0, 1 }, direction{ -1, 1 };
+    std::vector<ray3f> rays(count);
+    for (auto& r : rays)
+    {
+        point<float, 3> o;
+        for (int i = 0; i < 3; ++i) o[i] = std::lerp(scene.get_min()[i], scene.get_max()[i], unit(gen));
+        r = { o, vector<float, 3>{ direction(gen), direction(gen), direction(gen) } };
+    }
+    return rays;
+}
+
+template<typename Tree>
+double mrays_per_second(const Tree& tree, const std::vector<triangle>& tris, const std::vector<ray3f>& rays, std::size_t& hits)
+{
+    auto intersect = [&](std::uint32_t prim, const ray3f& r, float& tmax) { return tris[prim].intersect(r, tmax); };
+
+    hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repetitions; ++rep)
+    {
+        for (const auto& r : rays)
+        {
+            float tmax = std::numeric_limits<float>::infinity();
+            hits += tree.closest_hit(r, tmax, intersect);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    hits /= repetitions;
+    return static_cast<double>(rays.size()) * repetitions / elapsed.count() * 1e-6;
+}
+
+void run(const char* name, const std::vector<triangle>& tris)
+{
+    std::vector<bounds3f> prim_bounds;
+    for (const auto& t : tris) prim_bounds.push_back(t.get_bounds());
+
+    auto start = std::chrono::steady_clock::now();
+    accel::bvh binary{ prim_bounds };
+    std::chrono::duration<double, std::milli> build_ms = std::chrono::steady_clock::now() - start;
+    accel::bvh4 wide4{ binary };
+    accel::bvh8 wide8{ binary };
+
+    start = std::chrono::steady_clock::now();
+    accel::bvh linear = accel::build_lbvh(prim_bounds);
+    std::chrono::duration<double, std::milli> lbvh_ms = std::chrono::steady_clock::now() - start;
+
+    fmt::print("{}: {} triangles, built in {:.1f} ms (lbvh {:.1f} ms), {} / {} / {} / {} nodes\n", name, tris.size(),
+               build_ms.count(), lbvh_ms.count(), binary.nodes().size(), wide4.nodes().size(), wide8.nodes().size(),
+               linear.nodes().size());
+
+    for (auto [kind, rays] : { std::pair{ "primary", primary_rays(binary.get_bounds(), 512) },
+                               std::pair{ "incoherent", incoherent_rays(binary.get_bounds(), 1 << 16) } })
+    {
+        // the hit counts are printed so that none of the loops can be optimized away
+        std::size_t binary_hits, wide4_hits, wide8_hits, linear_hits;
+        double binary_rate = mrays_per_second(binary, tris, rays, binary_hits);
+        double wide4_rate = mrays_per_second(wide4, tris, rays, wide4_hits);
+        double wide8_rate = mrays_per_second(wide8, tris, rays, wide8_hits);
+        double linear_rate = mrays_per_second(linear, tris, rays, linear_hits);
+        fmt::print("  {:<11} {:>9.2f} {:>9.2f} {:>9.2f} {:>9.2f}   ({} / {} / {} / {} of {} rays hit)\n", kind, binary_rate,
+                   wide4_rate, wide8_rate, linear_rate, binary_hits, wide4_hits, wide8_hits, linear_hits, rays.size());
+    }
+}
+
+int main()
+{
+#if defined(RAYTRACE_SIMD_AVX)
+    fmt::print("bvh4 uses SSE and bvh8 AVX\n");
+#elif defined(RAYTRACE_SIMD_SSE2)
+    fmt::print("bvh4 uses SSE and bvh8 the scalar fallback. build with -mavx or -march=native for the intrinsics\n");
+#else
+    fmt::print("bvh4 and bvh8 use the scalar fallback\n");
+#endif
+    fmt::print("single-threaded closest hit, Mrays/s ({} repetitions)\n", repetitions);
+    fmt::print("  {:<11} {:>9} {:>9} {:>9} {:>9}\n", "rays", "binary", "bvh4", "bvh8", "lbvh");
+
+    run("spheres", sphere_grid(12, 32));
+    run("soup", triangle_soup(250000));
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include <fmt/core.h>
+
+#include "math/geometry/aligned.hpp"
+
+// compares the packed vector<float, 3> against the padded, aligned vec3fa on the same workload
+
+constexpr std::size_t count = 1 << 12; // small enough to stay in cache, so the arithmetic is measured rather than memory
+constexpr int repetitions = 2000;
+
+template<typename Fn>
+double time_per_element(Fn fn)
+{
+    fn(); // warm up the caches
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < repetitions; ++r) fn();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / (static_cast<double>(count) * repetitions);
+}
+
+template<typename Vec, typename Normalize>
+void run(const char* name, const std::vector<Vec>& a, const std::vector<Vec>& b, Normalize normalize)
+{
+    using namespace math;
+
+    std::vector<Vec> out(count);
+    float sink = 0;
+
+    double add_ns = time_per_element([&] {
+        for (std::size_t i = 0; i < count; ++i) out[i] = a[i] + b[i];
+    });
+    double dot_ns = time_per_element([&] {
+        float sum = 0;
+        for (std::size_t i = 0; i < count; ++i) sum += dot(a[i], b[i]);
+        sink += sum;
+    });
+    double cross_ns = time_per_element([&] {
+        for (std::size_t i = 0; i < count; ++i) out[i] = cross(a[i], b[i]);
+    });
+    double normalize_ns = time_per_element([&] {
+        for (std::size_t i = 0; i < count; ++i) out[i] = normalize(a[i]);
+    });
+    double min_max_ns = time_per_element([&] {
+        for (std::size_t i = 0; i < count; ++i) out[i] = max(min(a[i], b[i]), out[i]);
+    });
+    double shade_ns = time_per_element([&] {
+        // the mix of operations of a typical shading frame
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Vec n = normalize(cross(a[i], b[i]));
+            out[i] = n * dot(n, a[i]) + b[i];
+        }
+    });
+
+    fmt::print("{:<10} {:>8.3f} {:>8.3f} {:>8.3f} {:>10.3f} {:>8.3f} {:>8.3f}   (sink {})\n",
+               name, add_ns, dot_ns, cross_ns, normalize_ns, min_max_ns, shade_ns, sink + out[count / 2][0]);
+}
+
+int main()
+{
+    using namespace math;
+
+    std::mt19937 gen{ 1 };
+    std::uniform_real_distribution<float> dist{ -1, 1 };
+
+    std::vector<vec3f> a(count), b(count);
+    std::vector<vec3fa> aa(count), ba(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        a[i] = vec3f{ dist(gen), dist(gen), dist(gen) };
+        b[i] = vec3f{ dist(gen), dist(gen), dist(gen) };
+        aa[i] = vec3fa{ a[i] };
+        ba[i] = vec3fa{ b[i] };
+    }
+
+#ifdef RAYTRACE_SIMD_SSE41
+    fmt::print("vec3fa uses SSE4.1\n");
+#else
+    fmt::print("vec3fa uses the scalar fallback. build with -msse4.1 or -march=native for the intrinsics\n");
+#endif
+    fmt::print("ns per element ({} elements, {} repetitions)\n", count, repetitions);
+    fmt::print("{:<10} {:>8} {:>8} {:>8} {:>10} {:>8} {:>8}\n", "layout", "add", "dot", "cross", "normalize", "min/max", "shade");
+
+    run("vec3f", a, b, [](const vec3f& v) { return normalize<float>(v); });
+    run("vec3fa", aa, ba, [](const vec3fa& v) { return normalize(v); });
+}
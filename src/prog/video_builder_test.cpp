@@ -1,4 +1,5 @@
 #include "media/video_builder.hpp"
+#include "base/image_ops.hpp"
 
 #include <cmath>
 
@@ -12,26 +13,35 @@ int main()
     constexpr int height = 720;
     constexpr int fps = 60;
 
-    media::video_builder builder{ "video.mp4", width, height, 12800000, fps, 12, 2 };
+    media::video_settings settings;
+    settings.width = width;
+    settings.height = height;
+    settings.fps = fps;
+    settings.bitrate = 12800000;
+    settings.gop = 12;
+    settings.b_frames = 2;
+    settings.preset = "veryfast";
+    settings.queue_depth = 4;
+    settings.conversion_threads = 4;
+
+    media::video_builder builder{ "video.mp4", settings };
 
-    base::image img{ width, height };
     for (int i = 0; i < fps * 10; ++i)
     {
-        for (int x = 0; x < width; ++x)
-        {
-            for (int y = 0; y < height; ++y)
-            {
-                double a = (std::sin((x / (y + 1) + i) / 32) + 1) / 2;
-                double b = (std::cos((x / (y + 1) + i) / 32) + 1) / 2;
-                double c = (a + b) / 2;
+        media::video_builder::lent_frame frame = builder.lend_frame();
+        base::generate(frame.get(), [i](int x, int y) {
+            double a = (std::sin((x / (y + 1) + i) / 32) + 1) / 2;
+            double b = (std::cos((x / (y + 1) + i) / 32) + 1) / 2;
+            double c = (a + b) / 2;
 
-                img[{x,y}] = base::pixel{
-                        (uint8_t) (a * 255),
-                        (uint8_t) (b * 255),
-                        (uint8_t) (c * 255)
-                };
-            }
-        }
-        builder.push_frame(img);
+            return base::pixel{
+                    (uint8_t) (a * 255),
+                    (uint8_t) (b * 255),
+                    (uint8_t) (c * 255)
+            };
+        });
+        builder.commit_frame(std::move(frame));
     }
+    builder.flush();
+    fmt::print("{}\n", builder.stats().to_json());
 }
\ No newline at end of file
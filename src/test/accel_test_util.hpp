@@ -0,0 +1,197 @@
+#ifndef GPU_RAYTRACE_ACCEL_TEST_UTIL_HPP
+#define GPU_RAYTRACE_ACCEL_TEST_UTIL_HPP
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "accel/bvh.hpp"
+#include "accel/triangle.hpp"
+#include "accel/wide_bvh.hpp"
+#include "math/geometry/bounds.hpp"
+#include "math/geometry/ray.hpp"
+
+/**
+ * scenes and tree checks shared by the tests of the acceleration structures.
+ */
+namespace accel_test
+{
+
+    using ray3f = math::ray<float, 3>;
+
+    /**
+     * @param extent half the side of the cube holding the centers of the triangles
+     * @param size half the side of the cube around its center holding each vertex
+     */
+    inline accel::triangle random_triangle(std::mt19937& rng, float extent = 10, float size = 0.5f)
+    {
+        std::uniform_real_distribution<float> center{ -extent, extent }, offset{ -size, size };
+        math::point<float, 3> c{ center(rng), center(rng), center(rng) };
+        return { c + math::vector<float, 3>{ offset(rng), offset(rng), offset(rng) },
+                 c + math::vector<float, 3>{ offset(rng), offset(rng), offset(rng) },
+                 c + math::vector<float, 3>{ offset(rng), offset(rng), offset(rng) } };
+    }
+
+    inline std::vector<accel::triangle> random_triangles(std::size_t count, unsigned seed, float extent = 10, float size = 0.5f)
+    {
+        std::mt19937 rng{ seed };
+        std::vector<accel::triangle> tris(count);
+        for (auto& t : tris) t = random_triangle(rng, extent, size);
+        return tris;
+    }
+
+    /**
+     * @param extent half the side of the cube holding the origins. directions are not normalized
+     */
+    inline std::vector<ray3f> random_rays(std::size_t count, unsigned seed, float extent = 12)
+    {
+        std::mt19937 rng{ seed };
+        std::uniform_real_distribution<float> origin{ -extent, extent }, direction{ -1, 1 };
+        std::vector<ray3f> rays(count);
+        for (auto& r : rays)
+        {
+            r = { math::point<float, 3>{ origin(rng), origin(rng), origin(rng) },
+                  math::vector<float, 3>{ direction(rng), direction(rng), direction(rng) } };
+        }
+        return rays;
+    }
+
+    inline std::vector<math::bounds3f> bounds_of(std::span<const accel::triangle> tris)
+    {
+        std::vector<math::bounds3f> b;
+        for (const auto& t : tris) b.push_back(t.get_bounds());
+        return b;
+    }
+
+    /**
+     * checks that the tree covers every primitive once, in leaves of at most max_leaf_size primitives, that children
+     * follow their parent and that every node holds its children or primitives exactly.
+     * @return depth of the tree
+     */
+    inline std::size_t check_tree(const accel::bvh& tree, std::span<const math::bounds3f> prim_bounds,
+                                  std::uint32_t max_leaf_size = std::numeric_limits<std::uint32_t>::max())
+    {
+        auto nodes = tree.nodes();
+        auto indices = tree.primitive_indices();
+        std::vector<int> seen(prim_bounds.size());
+
+        std::function<std::size_t(std::uint32_t)> visit = [&](std::uint32_t i) -> std::size_t
+        {
+            math::bounds3f expected;
+            std::size_t depth = 1;
+            if (nodes[i].is_leaf())
+            {
+                EXPECT_LE(nodes[i].count, max_leaf_size);
+                for (std::uint32_t p = nodes[i].offset; p < nodes[i].offset + nodes[i].count; ++p)
+                {
+                    ++seen[indices[p]];
+                    expected.extend(prim_bounds[indices[p]]);
+                }
+            }
+            else
+            {
+                EXPECT_GT(nodes[i].offset, i + 1);
+                depth += std::max(visit(i + 1), visit(nodes[i].offset));
+                expected = merge(nodes[i + 1].get_bounds(), nodes[nodes[i].offset].get_bounds());
+            }
+            for (int a = 0; a < 3; ++a)
+            {
+                EXPECT_EQ(nodes[i].lower[a], expected.get_min()[a]);
+                EXPECT_EQ(nodes[i].upper[a], expected.get_max()[a]);
+            }
+            return depth;
+        };
+
+        std::size_t depth = visit(0);
+        EXPECT_LE(depth, accel::bvh::max_depth);
+        for (int s : seen) EXPECT_EQ(s, 1);
+        return depth;
+    }
+
+    /**
+     * checks that a wide tree covers every primitive once, that every node uses at least two of its slots and that
+     * every child lies inside the bounds of its slot.
+     */
+    template<std::size_t W>
+    void check_tree(const accel::wide_bvh<W>& tree, std::span<const math::bounds3f> prim_bounds)
+    {
+        auto nodes = tree.nodes();
+        std::vector<int> seen(prim_bounds.size());
+
+        auto contains = [](const math::bounds3f& outer, const math::bounds3f& inner)
+        {
+            return outer.contains(inner.get_min()) && outer.contains(inner.get_max());
+        };
+
+        for (std::size_t i = 0; i < nodes.size(); ++i)
+        {
+            std::size_t used = 0;
+            for (std::size_t s = 0; s < W; ++s)
+            {
+                if (!nodes[i].is_used(s)) continue;
+                ++used;
+                math::bounds3f slot = nodes[i].get_bounds(s);
+                if (nodes[i].is_leaf(s))
+                {
+                    for (std::uint32_t p = nodes[i].child[s]; p < nodes[i].child[s] + nodes[i].count[s]; ++p)
+                    {
+                        std::uint32_t prim = tree.primitive_indices()[p];
+                        ++seen[prim];
+                        EXPECT_TRUE(contains(slot, prim_bounds[prim]));
+                    }
+                }
+                else
+                {
+                    EXPECT_GT(nodes[i].child[s], i);
+                    const auto& child = nodes[nodes[i].child[s]];
+                    for (std::size_t cs = 0; cs < W; ++cs)
+                    {
+                        if (!child.is_used(cs)) continue;
+                        EXPECT_TRUE(contains(slot, child.get_bounds(cs)));
+                    }
+                }
+            }
+            EXPECT_GE(used, 2u);
+        }
+        for (int s : seen) EXPECT_EQ(s, 1);
+    }
+
+    /**
+     * traces rays through a tree of triangles and through every triangle, expecting the same closest hits. any_hit
+     * must agree, and stop finding the hit when tmax ends just short of it.
+     * @tparam Tree bvh or wide_bvh over tris
+     * @return number of rays which hit a triangle
+     */
+    template<typename Tree>
+    std::size_t check_against_brute_force(const Tree& tree, std::span<const accel::triangle> tris, std::span<const ray3f> rays)
+    {
+        auto intersect = [&](std::uint32_t prim, const ray3f& r, float& tmax) { return tris[prim].intersect(r, tmax); };
+
+        std::size_t hits = 0;
+        for (const auto& r : rays)
+        {
+            float expected = std::numeric_limits<float>::infinity();
+            for (const auto& t : tris) t.intersect(r, expected);
+
+            float tmax = std::numeric_limits<float>::infinity();
+            bool hit = tree.closest_hit(r, tmax, intersect);
+            EXPECT_EQ(hit, std::isfinite(expected));
+            EXPECT_EQ(tree.any_hit(r, std::numeric_limits<float>::infinity(), intersect), hit);
+            if (!hit) continue;
+
+            ++hits;
+            EXPECT_FLOAT_EQ(tmax, expected);
+            EXPECT_FALSE(tree.any_hit(r, expected * 0.999f, intersect));
+        }
+        return hits;
+    }
+
+}
+
+#endif //GPU_RAYTRACE_ACCEL_TEST_UTIL_HPP
@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+#include "math/geometry/aligned.hpp"
+
+static_assert(sizeof(math::vec3fa) == 16 && alignof(math::vec3fa) == 16);
+static_assert(sizeof(math::point3fa) == 16 && alignof(math::point3fa) == 16);
+static_assert(sizeof(math::normal3fa) == 16 && alignof(math::normal3fa) == 16);
+static_assert(math::vector_like<math::vec3fa> && math::vector_like<math::normal3fa>);
+
+TEST(aligned_vector, matches_vector)
+{
+    using namespace math;
+
+    vec3f a{ 1.5f, -2.0f, 0.25f }, b{ -0.5f, 3.0f, 4.0f };
+    vec3fa aa{ a }, ba{ b };
+
+    auto check = [](const vec3fa& actual, const vec3f& expected) {
+        for (int i = 0; i < 3; ++i) ASSERT_FLOAT_EQ(actual[i], expected[i]);
+        ASSERT_FLOAT_EQ(actual.data.buffer[3], 0); // the pad stays zero
+    };
+
+    check(aa + ba, a + b);
+    check(aa - ba, a - b);
+    check(-aa, vec3f{ -1.5f, 2.0f, -0.25f });
+    check(aa * 2.0f, a * 2.0f);
+    check(2.0f * aa, a * 2.0f);
+    check(aa / 4.0f, vec3f{ 1.5f / 4, -2.0f / 4, 0.25f / 4 });
+    check(cross(aa, ba), cross(a, b));
+    check(normalize(aa), normalize<float>(a));
+    check(min(aa, ba), vec3f{ -0.5f, -2.0f, 0.25f });
+    check(max(aa, ba), vec3f{ 1.5f, 3.0f, 4.0f });
+
+    ASSERT_FLOAT_EQ(dot(aa, ba), dot(a, b));
+    ASSERT_FLOAT_EQ(magnitude(aa), magnitude(a));
+}
+
+TEST(aligned_vector, interoperates_with_vector_like)
+{
+    using namespace math;
+
+    vec3fa va{ 1, 2, 3 };
+    vec3f v{ 4, 5, 6 };
+
+    // the generic functions accept any mix of vector_like types
+    ASSERT_FLOAT_EQ(dot(va, v), 32);
+    vec3f c = cross(v, va);
+    ASSERT_FLOAT_EQ(c[0], 3);
+    ASSERT_FLOAT_EQ(c[1], -6);
+    ASSERT_FLOAT_EQ(c[2], 3);
+
+    vec3f back{ va };
+    ASSERT_EQ(back, va);
+
+    auto zyx = swizzle(va, math::zyx);
+    ASSERT_FLOAT_EQ(zyx[0], 3);
+    ASSERT_FLOAT_EQ(zyx[2], 1);
+    vec3fa reversed{ zyx };
+    ASSERT_FLOAT_EQ(reversed[0], 3);
+    ASSERT_FLOAT_EQ(reversed[1], 2);
+    ASSERT_FLOAT_EQ(reversed[2], 1);
+
+    auto xy = swizzle(va, math::xy);
+    ASSERT_FLOAT_EQ(dot(xy, vec2f{ 1, 1 }), 3);
+}
+
+TEST(aligned_point, operations)
+{
+    using namespace math;
+
+    point3fa p{ 1, 2, 3 }, q{ 4, 6, 3 };
+    vec3fa d = q - p;
+    ASSERT_FLOAT_EQ(d[0], 3);
+    ASSERT_FLOAT_EQ(d[1], 4);
+    ASSERT_FLOAT_EQ(d[2], 0);
+    ASSERT_FLOAT_EQ(distance(p, q), 5);
+
+    point3fa moved = p + d;
+    ASSERT_FLOAT_EQ(moved[0], q[0]);
+    ASSERT_FLOAT_EQ(moved[1], q[1]);
+    ASSERT_FLOAT_EQ(moved[2], q[2]);
+
+    point3fa lo = min(p, q), hi = max(p, q);
+    ASSERT_FLOAT_EQ(lo[1], 2);
+    ASSERT_FLOAT_EQ(hi[1], 6);
+
+    point3f unaligned{ p };
+    ASSERT_FLOAT_EQ(unaligned[2], 3);
+    point3fa round_trip{ unaligned };
+    ASSERT_FLOAT_EQ(round_trip[0], 1);
+
+    p += vec3f{ 1, 1, 1 };
+    ASSERT_FLOAT_EQ(p[0], 2);
+}
+
+TEST(aligned_normal, operations)
+{
+    using namespace math;
+
+    normal3fa n = normalize(normal3fa{ 0, 0, 2 });
+    ASSERT_FLOAT_EQ(n[2], 1);
+
+    vec3fa toward{ 0, 0, -1 };
+    normal3fa flipped = face_forward(n, toward);
+    ASSERT_FLOAT_EQ(flipped[2], -1);
+    ASSERT_FLOAT_EQ(face_forward(n, -toward)[2], 1);
+    ASSERT_FLOAT_EQ(dot(n, toward), -1);
+    ASSERT_FLOAT_EQ(dot(toward, n), -1);
+    ASSERT_FLOAT_EQ(dot(n, n), 1);
+}
+
+TEST(aligned_vector, dot_ignores_the_pad)
+{
+    using namespace math;
+
+    static_assert(std::is_same_v<decltype(std::declval<const vec3fa&>()[0]), float>);
+    static_assert(std::is_same_v<decltype(std::declval<const point3fa&>()[0]), float>);
+    static_assert(std::is_same_v<decltype(std::declval<const normal3fa&>()[0]), float>);
+
+    // a pad turned into NaN, as dividing a vector by zero does, must not reach the sums
+    vec3fa v{ 3, 0, 4 }, w{ 1, 2, 2 };
+    v.data.buffer[3] = std::numeric_limits<float>::quiet_NaN();
+    w.data.buffer[3] = std::numeric_limits<float>::infinity();
+
+    ASSERT_FLOAT_EQ(dot(v, w), 11);
+    ASSERT_FLOAT_EQ(magnitude(v), 5);
+    ASSERT_FLOAT_EQ(normalize(v)[2], 0.8f);
+    ASSERT_FLOAT_EQ(dot(normal3fa{ v }, w), 11);
+}
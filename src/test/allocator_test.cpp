@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+#include "base/image.hpp"
+
+namespace
+{
+    /**
+     * counts the calls reaching the heap.
+     */
+    class counting_allocator : public base::pixel_allocator
+    {
+    public:
+        int allocations = 0;
+        int deallocations = 0;
+
+        base::pixel* allocate(std::size_t count) override
+        {
+            ++allocations;
+            return heap().allocate(count);
+        }
+
+        void deallocate(base::pixel* buffer, std::size_t count) override
+        {
+            ++deallocations;
+            heap().deallocate(buffer, count);
+        }
+    };
+}
+
+TEST(allocator, buffers_are_aligned)
+{
+    using namespace base;
+    image img{ 13, 7 };
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(img.get_buffer()) % pixel_allocator::alignment, 0u);
+    EXPECT_EQ((img[{ 12, 6 }].red), 0); // cleared by default
+
+    heap_allocator huge{ true };
+    pixel* buffer = huge.allocate(1920 * 1080);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buffer) % pixel_allocator::alignment, 0u);
+    buffer[1920 * 1080 - 1] = 0xFFFFFF_rgb;
+    huge.deallocate(buffer, 1920 * 1080);
+}
+
+TEST(allocator, frame_pool_recycles_buffers)
+{
+    using namespace base;
+    counting_allocator upstream;
+    {
+        frame_pool pool{ upstream, 2 };
+        for (int frame = 0; frame < 10; ++frame)
+        {
+            image img{ 64, 32, pool, false };
+            img[{ 0, 0 }] = 0x010101_rgb;
+            image copy = img; // copies draw from the pool as well
+            EXPECT_EQ(copy.allocator(), &pool);
+        }
+        EXPECT_EQ(upstream.allocations, 2);
+        EXPECT_EQ(pool.cached(), 2u);
+
+        image other{ 8, 8, pool }; // different size, so nothing cached fits
+        EXPECT_EQ(upstream.allocations, 3);
+    }
+    EXPECT_EQ(upstream.deallocations, 3);
+}
+
+TEST(allocator, assignment_reuses_buffer)
+{
+    using namespace base;
+    counting_allocator upstream;
+    image src{ 4, 4, upstream };
+    image dst{ 2, 8, upstream };
+    src.fill(0x123456_rgb);
+
+    pixel* buffer = dst.get_buffer();
+    dst = src;
+    EXPECT_EQ(dst.get_buffer(), buffer);
+    EXPECT_EQ(dst.width(), 4);
+    EXPECT_EQ((dst[{ 3, 3 }].green), 0x34);
+    EXPECT_EQ(upstream.allocations, 2);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "accel/bvh.hpp"
+#include "accel/triangle.hpp"
+#include "accel_test_util.hpp"
+#include "math/geometry/bounds.hpp"
+
+using namespace math;
+using namespace accel_test;
+using accel::bvh;
+using accel::triangle;
+
+TEST(bounds, default_is_empty)
+{
+    bounds3f b;
+    ASSERT_TRUE(b.is_empty());
+    ASSERT_FLOAT_EQ(b.surface_area(), 0);
+
+    b.extend(point<float, 3>{ 1, 2, 3 });
+    ASSERT_FALSE(b.is_empty());
+    ASSERT_FLOAT_EQ(b.get_min()[1], 2);
+    ASSERT_FLOAT_EQ(b.get_max()[2], 3);
+}
+
+TEST(bounds, corners_in_any_order)
+{
+    bounds3f b{ point<float, 3>{ 1, -1, 4 }, point<float, 3>{ -1, 2, 0 } };
+    ASSERT_FLOAT_EQ(b.get_min()[0], -1);
+    ASSERT_FLOAT_EQ(b.get_min()[2], 0);
+    ASSERT_FLOAT_EQ(b.get_max()[1], 2);
+    ASSERT_FLOAT_EQ(b.get_max()[2], 4);
+    ASSERT_EQ(b.max_extent(), 2);
+    ASSERT_FLOAT_EQ(b.surface_area(), 2 * (2 * 3 + 2 * 4 + 3 * 4));
+    ASSERT_FLOAT_EQ(b.centroid()[1], 0.5f);
+    ASSERT_FLOAT_EQ(b.offset(point<float, 3>{ 0, 2, 1 })[2], 0.25f);
+}
+
+TEST(bounds, merge_and_intersection)
+{
+    bounds3f b0{ point<float, 3>{ 0, 0, 0 }, point<float, 3>{ 2, 2, 2 } };
+    bounds3f b1{ point<float, 3>{ 1, 1, 1 }, point<float, 3>{ 3, 3, 3 } };
+    bounds3f b2{ point<float, 3>{ 5, 5, 5 }, point<float, 3>{ 6, 6, 6 } };
+
+    bounds3f m = merge(b0, b2);
+    ASSERT_FLOAT_EQ(m.get_min()[0], 0);
+    ASSERT_FLOAT_EQ(m.get_max()[0], 6);
+
+    ASSERT_TRUE(b0.overlaps(b1));
+    ASSERT_FALSE(b0.overlaps(b2));
+    bounds3f i = intersection(b0, b1);
+    ASSERT_FLOAT_EQ(i.get_min()[0], 1);
+    ASSERT_FLOAT_EQ(i.get_max()[0], 2);
+    ASSERT_TRUE(intersection(b0, b2).is_empty());
+}
+
+TEST(bounds, ray_intersection)
+{
+    bounds3f b{ point<float, 3>{ -1, -1, -1 }, point<float, 3>{ 1, 1, 1 } };
+    float t0, t1;
+    ASSERT_TRUE(b.intersect(ray3f{ point<float, 3>{ -3, 0, 0 }, vector<float, 3>{ 1, 0, 0 } }, 10, &t0, &t1));
+    ASSERT_FLOAT_EQ(t0, 2);
+    ASSERT_NEAR(t1, 4, 1e-5);
+
+    // tmax ends the interval before the box
+    ASSERT_FALSE(b.intersect(ray3f{ point<float, 3>{ -3, 0, 0 }, vector<float, 3>{ 1, 0, 0 } }, 1.5f));
+    // behind the origin
+    ASSERT_FALSE(b.intersect(ray3f{ point<float, 3>{ 3, 0, 0 }, vector<float, 3>{ 1, 0, 0 } }, 10));
+    // parallel to a slab, inside and outside it
+    ASSERT_TRUE(b.intersect(ray3f{ point<float, 3>{ 0, 0.5f, -3 }, vector<float, 3>{ 0, 0, 1 } }, 10));
+    ASSERT_FALSE(b.intersect(ray3f{ point<float, 3>{ 0, 2, -3 }, vector<float, 3>{ 0, 0, 1 } }, 10));
+}
+
+TEST(bvh, node_layout)
+{
+    ASSERT_EQ(sizeof(accel::bvh_node), 32u);
+    ASSERT_EQ(alignof(accel::bvh_node), 32u);
+}
+
+TEST(bvh, empty)
+{
+    bvh tree{ std::span<const bounds3f>{} };
+    ASSERT_TRUE(tree.empty());
+    float tmax = 10;
+    ASSERT_FALSE(tree.closest_hit(ray3f{ point<float, 3>{ 0, 0, 0 }, vector<float, 3>{ 1, 0, 0 } }, tmax,
+                                  [](std::uint32_t, const ray3f&, float&) { return true; }));
+}
+
+TEST(bvh, rejects_empty_bounds)
+{
+    std::vector<bounds3f> b(3, bounds3f{ point<float, 3>{ 0, 0, 0 } });
+    b[1] = bounds3f{};
+    ASSERT_THROW(bvh{ b }, std::invalid_argument);
+}
+
+TEST(bvh, structure)
+{
+    auto tris = random_triangles(5000, 1);
+    auto prim_bounds = bounds_of(tris);
+    bvh tree{ prim_bounds };
+
+    check_tree(tree, prim_bounds, 4);
+
+    std::size_t leaves = 0;
+    for (const auto& n : tree.nodes()) leaves += n.is_leaf();
+    ASSERT_EQ(tree.nodes().size(), 2 * leaves - 1);
+}
+
+TEST(bvh, coincident_centroids)
+{
+    // identical primitives cannot be separated by any plane, yet the tree must stay within the traversal stack
+    std::vector<bounds3f> b(1000, bounds3f{ point<float, 3>{ 0, 0, 0 }, point<float, 3>{ 1, 1, 1 } });
+    bvh tree{ b };
+
+    std::size_t visited = 0;
+    float tmax = 10;
+    tree.closest_hit(ray3f{ point<float, 3>{ 0.5f, 0.5f, -1 }, vector<float, 3>{ 0, 0, 1 } }, tmax,
+                     [&](std::uint32_t, const ray3f&, float&) { ++visited; return false; });
+    ASSERT_EQ(visited, b.size());
+}
+
+TEST(bvh, matches_brute_force)
+{
+    auto tris = random_triangles(20000, 2);
+    auto rays = random_rays(2000, 3);
+    bvh tree{ bounds_of(tris) };
+    ASSERT_GT(check_against_brute_force(tree, tris, rays), rays.size() / 10);
+}
+
+TEST(bvh, tracked_ray)
+{
+    auto tris = random_triangles(100, 4);
+    bvh tree{ bounds_of(tris) };
+
+    point<float, 3> target = tris[7].p0 + (tris[7].p1 - tris[7].p0) * 0.25f + (tris[7].p2 - tris[7].p0) * 0.25f;
+    tracked_ray<float, 3> r{ point<float, 3>{ 0, 0, -20 }, target - point<float, 3>{ 0, 0, -20 }, 0.5f };
+
+    float tmax = 2;
+    ASSERT_TRUE(tree.closest_hit(r, tmax, [&](std::uint32_t prim, const ray3f& ray, float& t) { return tris[prim].intersect(ray, t); }));
+    ASSERT_LE(tmax, 1.0001f);
+}
+
+TEST(bvh, settings)
+{
+    auto tris = random_triangles(3000, 5);
+    auto prim_bounds = bounds_of(tris);
+    auto rays = random_rays(200, 6);
+
+    accel::bvh_build_settings settings;
+    settings.max_leaf_size = 1;
+    settings.bins = 64; // clamped to 32
+    bvh fine{ prim_bounds, settings };
+    for (const auto& n : fine.nodes()) ASSERT_LE(n.count, 1);
+
+    settings.max_leaf_size = 16;
+    settings.bins = 4;
+    settings.intersection_cost = 0.25f;
+    bvh coarse{ prim_bounds, settings };
+    ASSERT_LT(coarse.nodes().size(), fine.nodes().size());
+
+    auto intersect = [&](std::uint32_t prim, const ray3f& r, float& tmax) { return tris[prim].intersect(r, tmax); };
+    for (const auto& r : rays)
+    {
+        float t0 = std::numeric_limits<float>::infinity(), t1 = t0;
+        ASSERT_EQ(fine.closest_hit(r, t0, intersect), coarse.closest_hit(r, t1, intersect));
+        ASSERT_FLOAT_EQ(t0, t1);
+    }
+
+    settings.max_leaf_size = 1 << 16;
+    ASSERT_THROW((bvh{ prim_bounds, settings }), std::invalid_argument);
+}
+
+TEST(bvh, parallel_build)
+{
+    // large enough to bin and build subtrees on the pool
+    auto tris = random_triangles(150000, 7);
+    auto rays = random_rays(100, 8);
+    bvh tree{ bounds_of(tris) };
+
+    std::size_t leaf_prims = 0;
+    for (const auto& n : tree.nodes()) leaf_prims += n.count;
+    ASSERT_EQ(leaf_prims, tris.size());
+
+    check_against_brute_force(tree, tris, rays);
+}
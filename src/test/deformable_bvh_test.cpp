@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "accel/deformable_bvh.hpp"
+#include "accel/lbvh.hpp"
+#include "accel/triangle.hpp"
+#include "accel/wide_bvh.hpp"
+#include "accel_test_util.hpp"
+
+using namespace math;
+using namespace accel_test;
+using accel::bvh;
+using accel::deformable_bvh;
+using accel::triangle;
+
+// twists the triangles about the z axis by an angle growing with the distance from it
+static std::vector<triangle> swirl(const std::vector<triangle>& tris, float strength)
+{
+    auto twist = [&](const point<float, 3>& p)
+    {
+        float angle = strength * std::sqrt(p[0] * p[0] + p[1] * p[1]);
+        float c = std::cos(angle), s = std::sin(angle);
+        return point<float, 3>{ c * p[0] - s * p[1], s * p[0] + c * p[1], p[2] };
+    };
+    std::vector<triangle> out;
+    for (const auto& t : tris) out.push_back({ twist(t.p0), twist(t.p1), twist(t.p2) });
+    return out;
+}
+
+static void translate(triangle& t, const vector<float, 3>& v)
+{
+    t.p0 = t.p0 + v;
+    t.p1 = t.p1 + v;
+    t.p2 = t.p2 + v;
+}
+
+// SAH cost of the tree relative to its bounds, with unit traversal and intersection costs
+static float sah_cost(const bvh& tree)
+{
+    float cost = 0;
+    for (const auto& n : tree.nodes()) cost += n.get_bounds().surface_area() * (n.is_leaf() ? n.count : 1);
+    return cost / tree.get_bounds().surface_area();
+}
+
+TEST(bvh, refit)
+{
+    auto tris = random_triangles(20000, 1);
+    base::thread_pool pool{ 3 };
+    bvh tree{ bounds_of(tris), {}, pool };
+
+    std::mt19937 rng{ 2 };
+    std::uniform_real_distribution<float> jitter{ -1, 1 };
+    for (auto& t : tris) translate(t, vector<float, 3>{ jitter(rng), jitter(rng), jitter(rng) });
+    auto moved = bounds_of(tris);
+
+    tree.refit(moved, pool);
+    check_tree(tree, moved);
+    check_against_brute_force(tree, tris, random_rays(500, 3));
+
+    ASSERT_THROW(tree.refit(std::span<const bounds3f>{ moved }.first(10)), std::invalid_argument);
+}
+
+TEST(deformable_bvh, empty_and_single)
+{
+    deformable_bvh empty{ bvh{} };
+    ASSERT_EQ(empty.refit({}), 0u);
+    ASSERT_TRUE(empty.tree().empty());
+
+    std::vector<bounds3f> one{ bounds3f{ point<float, 3>{ 0, 0, 0 }, point<float, 3>{ 1, 1, 1 } } };
+    deformable_bvh single{ bvh{ one } };
+    one[0] = bounds3f{ point<float, 3>{ 2, 2, 2 }, point<float, 3>{ 3, 3, 3 } };
+    single.mark_moved(0);
+    ASSERT_EQ(single.refit(one), 1u);
+    ASSERT_FLOAT_EQ(single.tree().get_bounds().get_min()[0], 2);
+
+    ASSERT_THROW(single.refit({}), std::invalid_argument);
+}
+
+TEST(deformable_bvh, refits_only_what_moved)
+{
+    auto tris = random_triangles(50000, 4);
+    deformable_bvh tree{ bvh{ bounds_of(tris) } };
+    std::vector<accel::bvh_node> before(tree.tree().nodes().begin(), tree.tree().nodes().end());
+
+    // nothing moved, so nothing is visited
+    ASSERT_EQ(tree.refit(bounds_of(tris)), 0u);
+
+    std::vector<std::uint32_t> moved{ 7, 4242, 31337 };
+    for (std::uint32_t p : moved) translate(tris[p], vector<float, 3>{ 15, 0, 0 });
+    tree.mark_moved(moved);
+    auto prim_bounds = bounds_of(tris);
+
+    std::size_t refitted = tree.refit(prim_bounds);
+    ASSERT_GT(refitted, 0u);
+    ASSERT_LE(refitted, moved.size() * 64);
+    check_tree(tree.tree(), prim_bounds);
+    check_against_brute_force(tree.tree(), tris, random_rays(200, 3));
+
+    // the nodes off the paths to the moved primitives kept their bounds
+    std::size_t changed = 0;
+    for (std::size_t i = 0; i < before.size(); ++i)
+    {
+        changed += before[i].lower[0] != tree.tree().nodes()[i].lower[0] || before[i].upper[0] != tree.tree().nodes()[i].upper[0];
+    }
+    ASSERT_LE(changed, refitted);
+    ASSERT_EQ(tree.refit(prim_bounds), 0u);
+}
+
+TEST(deformable_bvh, rotations_recover_quality)
+{
+    auto rest = random_triangles(20000, 5);
+    deformable_bvh refitted{ bvh{ bounds_of(rest) } };
+    deformable_bvh rotated{ bvh{ bounds_of(rest) } };
+
+    // an animation that twists the scene far from where the tree was built, with one update per frame
+    accel::bvh_refit_settings settings;
+    settings.rotate = true;
+    constexpr int frames = 20;
+    std::vector<triangle> tris;
+    std::vector<bounds3f> prim_bounds;
+    for (int frame = 1; frame <= frames; ++frame)
+    {
+        tris = swirl(rest, 1.0f * frame / frames);
+        prim_bounds = bounds_of(tris);
+        rotated.mark_all_moved();
+        rotated.refit(prim_bounds, settings);
+    }
+    refitted.mark_all_moved();
+    refitted.refit(prim_bounds);
+
+    float refitted_cost = sah_cost(refitted.tree());
+    float rotated_cost = sah_cost(rotated.tree());
+    ASSERT_LT(rotated_cost, 0.8f * refitted_cost);
+
+    check_tree(rotated.tree(), prim_bounds);
+    check_against_brute_force(rotated.tree(), tris, random_rays(500, 3));
+
+    // the rotations kept the leaves of the primitives up to date for the next marks
+    translate(tris[123], vector<float, 3>{ 0, -20, 0 });
+    prim_bounds = bounds_of(tris);
+    rotated.mark_moved(123);
+    rotated.refit(prim_bounds, settings);
+    check_tree(rotated.tree(), prim_bounds);
+
+    // and the tree still collapses into a wide bvh
+    accel::bvh4 wide{ rotated.tree() };
+    ray3f r{ point<float, 3>{ -12, -12, -12 }, vector<float, 3>{ 1, 1, 1 } };
+    auto intersect = [&](std::uint32_t prim, const ray3f& ray, float& tmax) { return tris[prim].intersect(ray, tmax); };
+    float t0 = std::numeric_limits<float>::infinity(), t1 = t0;
+    ASSERT_EQ(wide.closest_hit(r, t0, intersect), rotated.tree().closest_hit(r, t1, intersect));
+    ASSERT_FLOAT_EQ(t0, t1);
+}
+
+TEST(deformable_bvh, parallel_refit)
+{
+    auto tris = random_triangles(200000, 7);
+    bvh initial = accel::build_lbvh(bounds_of(tris));
+    deformable_bvh parallel{ initial }, serial{ initial };
+
+    std::mt19937 rng{ 8 };
+    std::uniform_real_distribution<float> jitter{ -2, 2 };
+    for (auto& t : tris) translate(t, vector<float, 3>{ jitter(rng), jitter(rng), jitter(rng) });
+    auto prim_bounds = bounds_of(tris);
+
+    accel::bvh_refit_settings settings;
+    settings.rotate = true;
+    base::thread_pool pool{ 4 }, no_threads{ 0 };
+    parallel.mark_all_moved();
+    serial.mark_all_moved();
+    ASSERT_EQ(parallel.refit(prim_bounds, settings, pool), initial.nodes().size());
+    serial.refit(prim_bounds, settings, no_threads);
+    check_tree(parallel.tree(), prim_bounds);
+
+    // every node decides its rotation from its own subtree alone, so the schedule does not change the result
+    auto a = parallel.tree().nodes(), b = serial.tree().nodes();
+    ASSERT_EQ(a.size(), b.size());
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        ASSERT_EQ(a[i].offset, b[i].offset);
+        ASSERT_EQ(a[i].count, b[i].count);
+        ASSERT_EQ(a[i].lower[1], b[i].lower[1]);
+    }
+}
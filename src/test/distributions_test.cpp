@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+#include "math/distributions.hpp"
+
+using namespace math::sampling;
+
+TEST(distributions, alias_table_matches_weights)
+{
+    std::vector<double> weights = { 1, 0, 4, 2.5, 0.5, 0, 7 };
+    alias_table<double> table(weights);
+    ASSERT_EQ(table.size(), weights.size());
+
+    double sum = 15;
+    for (std::size_t i = 0; i < weights.size(); ++i) ASSERT_DOUBLE_EQ(table.pmf(i), weights[i] / sum);
+
+    // stratified values of u hit each index in proportion to its weight
+    constexpr int count = 700000;
+    std::vector<int> hits(weights.size());
+    for (int i = 0; i < count; ++i)
+    {
+        double pmf = 0, remapped = 0;
+        int idx = table.sample((i + 0.5) / count, &pmf, &remapped);
+        ASSERT_GE(idx, 0);
+        ASSERT_LT(idx, static_cast<int>(weights.size()));
+        ASSERT_DOUBLE_EQ(pmf, table.pmf(idx));
+        ASSERT_GE(remapped, 0);
+        ASSERT_LT(remapped, 1);
+        ++hits[idx];
+    }
+    for (std::size_t i = 0; i < weights.size(); ++i) ASSERT_NEAR(static_cast<double>(hits[i]) / count, weights[i] / sum, 1e-5);
+}
+
+TEST(distributions, alias_table_edge_cases)
+{
+    alias_table<float> empty(std::span<const float>{});
+    ASSERT_EQ(empty.sample(0.5f), -1);
+
+    std::vector<float> zeros(4, 0.0f);
+    alias_table<float> uniform(zeros);
+    ASSERT_FLOAT_EQ(uniform.pmf(2), 0.25f);
+    ASSERT_EQ(uniform.sample(0.6f), 2);
+    ASSERT_EQ(uniform.sample(math::one_minus_epsilon<float>), 3);
+
+    std::vector<float> negative = { 1, -1 };
+    ASSERT_THROW(alias_table<float>{ negative }, std::invalid_argument);
+}
+
+TEST(distributions, alias_table_view_is_trivially_copyable)
+{
+    static_assert(std::is_trivially_copyable_v<alias_table_view<float>>);
+    static_assert(std::is_trivially_copyable_v<piecewise_constant_1d_view<float>>);
+    static_assert(std::is_trivially_copyable_v<piecewise_constant_2d_view<float>>);
+
+    std::vector<float> weights = { 3, 1 };
+    alias_table<float> table(weights);
+    alias_table_view<float> view = table.view();
+    ASSERT_EQ(view.sample(0.1f), table.sample(0.1f));
+    ASSERT_EQ(view.sample(0.9f), table.sample(0.9f));
+}
+
+TEST(distributions, piecewise_constant_1d)
+{
+    std::vector<double> func = { 1, 3 };
+    piecewise_constant_1d<double> dist(func, 0, 2);
+    ASSERT_DOUBLE_EQ(dist.integral(), 4);
+
+    double pdf = 0;
+    std::size_t offset = 7;
+    ASSERT_DOUBLE_EQ(dist.sample_continuous(0.125, &pdf, &offset), 0.5);
+    ASSERT_DOUBLE_EQ(pdf, 0.25);
+    ASSERT_EQ(offset, 0u);
+
+    ASSERT_DOUBLE_EQ(dist.sample_continuous(0.625, &pdf, &offset), 1.5);
+    ASSERT_DOUBLE_EQ(pdf, 0.75);
+    ASSERT_EQ(offset, 1u);
+    ASSERT_DOUBLE_EQ(dist.pdf(1.5), 0.75);
+    ASSERT_DOUBLE_EQ(dist.pdf(0.5), 0.25);
+    ASSERT_DOUBLE_EQ(dist.pdf(-3), 0.25);
+
+    double pmf = 0, remapped = 0;
+    ASSERT_EQ(dist.sample_discrete(0.625, &pmf, &remapped), 1u);
+    ASSERT_DOUBLE_EQ(pmf, 0.75);
+    ASSERT_DOUBLE_EQ(remapped, 0.5);
+    ASSERT_DOUBLE_EQ(dist.pmf(0), 0.25);
+
+    ASSERT_LT(dist.sample_continuous(math::one_minus_epsilon<double>), 2);
+}
+
+TEST(distributions, piecewise_constant_1d_skips_empty_pieces)
+{
+    std::vector<float> func = { 0, 2, 0, 0, 2, 0 };
+    piecewise_constant_1d<float> dist(func);
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::size_t offset = 0;
+        float pdf = 0;
+        dist.sample_continuous((i + 0.5f) / 1000, &pdf, &offset);
+        ASSERT_TRUE(offset == 1 || offset == 4) << offset;
+        ASSERT_FLOAT_EQ(pdf, 3);
+    }
+    ASSERT_EQ(dist.sample_discrete(0.0f), 1u);
+
+    std::vector<float> zeros(3, 0.0f);
+    piecewise_constant_1d<float> uniform(zeros, 1, 3);
+    ASSERT_FLOAT_EQ(uniform.pdf(2), 0.5f);
+    ASSERT_FLOAT_EQ(uniform.sample_continuous(0.5f), 2);
+
+    ASSERT_THROW(piecewise_constant_1d<float>{ std::span<const float>{} }, std::invalid_argument);
+    ASSERT_THROW((piecewise_constant_1d<float>{ func, 1, 1 }), std::invalid_argument);
+}
+
+TEST(distributions, piecewise_constant_2d)
+{
+    constexpr std::size_t nu = 8, nv = 4;
+    std::vector<double> func(nu * nv);
+    for (std::size_t v = 0; v < nv; ++v)
+    {
+        for (std::size_t u = 0; u < nu; ++u) func[v * nu + u] = (u == 3 && v == 1) ? 0 : static_cast<double>(u + 2 * v + 1);
+    }
+    piecewise_constant_2d<double> dist(func, nu, nv);
+    ASSERT_EQ(dist.width(), nu);
+    ASSERT_EQ(dist.height(), nv);
+
+    // the density integrates to one and is proportional to the function
+    double total = 0;
+    for (std::size_t v = 0; v < nv; ++v)
+    {
+        for (std::size_t u = 0; u < nu; ++u)
+        {
+            math::point<double, 2> center{ (u + 0.5) / nu, (v + 0.5) / nv };
+            total += dist.pdf(center) / (nu * nv);
+            ASSERT_NEAR(dist.pdf(center), func[v * nu + u] / dist.integral(), 1e-12);
+        }
+    }
+    ASSERT_NEAR(total, 1, 1e-12);
+
+    for (int j = 0; j < 64; ++j)
+    {
+        for (int i = 0; i < 64; ++i)
+        {
+            double pdf = 0;
+            math::point<double, 2> p = dist.sample({ (i + 0.5) / 64, (j + 0.5) / 64 }, &pdf);
+            ASSERT_GE(p[0], 0);
+            ASSERT_LT(p[0], 1);
+            ASSERT_GE(p[1], 0);
+            ASSERT_LT(p[1], 1);
+            ASSERT_GT(pdf, 0);
+            ASSERT_NEAR(pdf, dist.pdf(p), 1e-12);
+        }
+    }
+
+    ASSERT_THROW((piecewise_constant_2d<double>{ func, nu, nv + 1 }), std::invalid_argument);
+}
@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+#include "math/fast_functions.hpp"
+
+using precision = math::fast::precision;
+
+namespace
+{
+    // distance between two floats in units in the last place
+    double ulp_distance(float a, float b)
+    {
+        if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b) ? 0 : std::numeric_limits<double>::infinity();
+        auto ordered = [](float f) {
+            auto bits = static_cast<std::int32_t>(math::to_bits(f));
+            return bits < 0 ? static_cast<std::int64_t>(INT32_MIN) - bits : static_cast<std::int64_t>(bits);
+        };
+        return static_cast<double>(std::llabs(ordered(a) - ordered(b)));
+    }
+
+    // largest error of fn against the reference, evaluated in double and rounded, over uniform samples of [lo, hi]
+    template<typename Fn, typename Reference>
+    double max_ulp(Fn fn, Reference reference, float lo, float hi)
+    {
+        std::mt19937 gen{ 5 };
+        std::uniform_real_distribution<float> dist{ lo, hi };
+        double worst = 0;
+        for (int i = 0; i < 100000; ++i)
+        {
+            float x = dist(gen);
+            worst = std::max(worst, ulp_distance(fn(x), static_cast<float>(reference(static_cast<double>(x)))));
+        }
+        return worst;
+    }
+
+    template<typename Fn, typename Reference>
+    double max_absolute(Fn fn, Reference reference, float lo, float hi)
+    {
+        std::mt19937 gen{ 5 };
+        std::uniform_real_distribution<float> dist{ lo, hi };
+        double worst = 0;
+        for (int i = 0; i < 100000; ++i)
+        {
+            float x = dist(gen);
+            worst = std::max(worst, std::abs(fn(x) - reference(static_cast<double>(x))));
+        }
+        return worst;
+    }
+
+    template<precision P>
+    void check_documented_errors(double sin_cos, double log, double exp, double pow, double arccos, double arctan2)
+    {
+        using namespace math;
+
+        EXPECT_LE(max_absolute([](float x) { return fast::sin<P>(x); }, [](double x) { return std::sin(x); }, -8192, 8192), sin_cos);
+        EXPECT_LE(max_absolute([](float x) { return fast::cos<P>(x); }, [](double x) { return std::cos(x); }, -8192, 8192), sin_cos);
+        EXPECT_LE(max_ulp([](float x) { return fast::log<P>(x); }, [](double x) { return std::log(x); }, 0, 1e6f), log);
+        EXPECT_LE(max_ulp([](float x) { return fast::exp<P>(x); }, [](double x) { return std::exp(x); }, -103, 88), exp);
+        EXPECT_LE(max_ulp([](float x) { return fast::pow<P>(x, 3.5f); }, [](double x) { return std::pow(x, 3.5); }, 0.125f, 8), pow);
+        EXPECT_LE(max_ulp([](float x) { return fast::arccos<P>(x); }, [](double x) { return std::acos(x); }, -1, 1), arccos);
+        EXPECT_LE(max_ulp([](float x) { return fast::arctan2<P>(x, 0.75f); }, [](double x) { return std::atan2(x, 0.75); }, -10, 10), arctan2);
+        EXPECT_LE(max_ulp([](float x) { return fast::arctan2<P>(0.75f, x); }, [](double x) { return std::atan2(0.75, x); }, -10, 10), arctan2);
+    }
+
+    template<typename T, std::size_t W>
+    void check_lanes_match_scalars()
+    {
+        using namespace math;
+        using lane_t = lane<T, W>;
+
+        T values[W];
+        for (std::size_t i = 0; i < W; ++i) values[i] = static_cast<T>(0.37) * static_cast<T>(i) - static_cast<T>(1.1);
+        lane_t x = lane_t::load(values);
+
+        lane_t s, c;
+        fast::sincos(x, s, c);
+        lane_t logs = fast::log(abs(x)), exps = fast::exp(x), powers = fast::pow(abs(x), x);
+        lane_t arccosines = fast::arccos(x * T(0.2)), arctangents = fast::arctan2(x, lane_t{ T(-0.5) });
+
+        // the lanes and the scalars may differ by the rounding of contracted multiplications and additions
+        auto near = [](T a, T b) { return std::abs(a - b) <= 4 * std::numeric_limits<T>::epsilon() * std::max(T(1), std::abs(b)); };
+        for (std::size_t i = 0; i < W; ++i)
+        {
+            T v = values[i];
+            ASSERT_TRUE(near(s[i], fast::sin(v)));
+            ASSERT_TRUE(near(c[i], fast::cos(v)));
+            ASSERT_TRUE(near(logs[i], fast::log(std::abs(v))));
+            ASSERT_TRUE(near(exps[i], fast::exp(v)));
+            ASSERT_TRUE(near(powers[i], fast::pow(std::abs(v), v)));
+            ASSERT_TRUE(near(arccosines[i], fast::arccos(v * T(0.2))));
+            ASSERT_TRUE(near(arctangents[i], fast::arctan2(v, T(-0.5))));
+        }
+    }
+}
+
+TEST(fast_functions, documented_errors)
+{
+    check_documented_errors<precision::low>(0x1p-11, 768, 2500, 3072, 800, 400);
+    check_documented_errors<precision::medium>(0x1p-19, 6, 72, 96, 40, 16);
+    check_documented_errors<precision::high>(0x1p-23, 2, 1, 12, 1, 4);
+}
+
+TEST(fast_functions, sincos_matches_sin_and_cos)
+{
+    float s, c;
+    for (float theta = -20; theta < 20; theta += 0.173f)
+    {
+        math::fast::sincos(theta, s, c);
+        ASSERT_EQ(s, math::fast::sin(theta));
+        ASSERT_EQ(c, math::fast::cos(theta));
+    }
+}
+
+TEST(fast_functions, special_values)
+{
+    using namespace math;
+    constexpr float inf = std::numeric_limits<float>::infinity();
+
+    EXPECT_EQ(fast::log(0.0f), -inf);
+    EXPECT_EQ(fast::log(inf), inf);
+    EXPECT_TRUE(std::isnan(fast::log(-1.0f)));
+    EXPECT_TRUE(std::isnan(fast::log(std::numeric_limits<float>::quiet_NaN())));
+    EXPECT_LE(ulp_distance(fast::log(1e-40f), static_cast<float>(std::log(1e-40))), 2); // subnormal
+
+    EXPECT_EQ(fast::exp(100.0f), inf);
+    EXPECT_EQ(fast::exp(-200.0f), 0);
+    EXPECT_EQ(fast::exp(0.0f), 1);
+    EXPECT_TRUE(std::isnan(fast::exp(std::numeric_limits<float>::quiet_NaN())));
+    EXPECT_GT(fast::exp(-100.0f), 0); // subnormal
+
+    EXPECT_FLOAT_EQ(fast::pow(-2.0f, 3.0f), -8);
+    EXPECT_FLOAT_EQ(fast::pow(-2.0f, 2.0f), 4);
+    EXPECT_TRUE(std::isnan(fast::pow(-2.0f, 0.5f)));
+    EXPECT_EQ(fast::pow(0.0f, 2.0f), 0);
+    EXPECT_EQ(fast::pow(0.0f, -2.0f), inf);
+    EXPECT_EQ(fast::pow(5.0f, 0.0f), 1);
+    EXPECT_EQ(fast::pow(1.0f, inf), 1);
+
+    EXPECT_TRUE(std::isnan(fast::arccos(1.5f)));
+    EXPECT_EQ(fast::arccos(1.0f), 0);
+    EXPECT_FLOAT_EQ(fast::arccos(-1.0f), pi<float>);
+
+    EXPECT_EQ(fast::arctan2(0.0f, 0.0f), 0);
+    EXPECT_FLOAT_EQ(fast::arctan2(0.0f, -1.0f), pi<float>);
+    EXPECT_FLOAT_EQ(fast::arctan2(-1.0f, 0.0f), -pi<float> / 2);
+    EXPECT_FLOAT_EQ(fast::arctan2(inf, inf), pi<float> / 4);
+    EXPECT_FLOAT_EQ(fast::arctan2(-inf, -inf), -3 * pi<float> / 4);
+    EXPECT_TRUE(std::isnan(fast::arctan2(std::numeric_limits<float>::quiet_NaN(), 1.0f)));
+}
+
+TEST(fast_functions, nan_scales_to_nan)
+{
+    using namespace math;
+    constexpr float nan = std::numeric_limits<float>::quiet_NaN();
+
+    // exp scales by 2^n with n rounded from its argument, so NaN reaches ldexp as an exponent
+    EXPECT_TRUE(std::isnan(fast::exp(nan)));
+    EXPECT_TRUE(std::isnan(fast::exp(std::numeric_limits<double>::quiet_NaN())));
+    EXPECT_TRUE(std::isnan(fast::pow(nan, 2.0f)));
+    EXPECT_TRUE(std::isnan(fast::pow(2.0f, nan)));
+
+    auto check_lanes = [](auto x)
+    {
+        using lane_t = decltype(x);
+        auto e = fast::exp(x);
+        auto p = fast::pow(lane_t{ 2 }, x);
+        for (std::size_t i = 0; i < lane_t::width; ++i)
+        {
+            EXPECT_TRUE(std::isnan(e[i]));
+            EXPECT_TRUE(std::isnan(p[i]));
+        }
+    };
+    check_lanes(lane<float, 4>{ nan });
+    check_lanes(lane<float, 8>{ nan });
+    check_lanes(lane<float, 16>{ nan });
+    check_lanes(lane<double, 4>{ std::numeric_limits<double>::quiet_NaN() });
+}
+
+TEST(fast_functions, double_precision)
+{
+    using namespace math;
+
+    // double runs the float polynomials, so it is as accurate relative to the value
+    for (double x = 0.05; x < 3; x += 0.05)
+    {
+        EXPECT_NEAR(fast::sin(x), std::sin(x), 1e-7);
+        EXPECT_NEAR(fast::cos(x), std::cos(x), 1e-7);
+        EXPECT_NEAR(fast::log(x) / std::log(x), 1, 1e-6);
+        EXPECT_NEAR(fast::exp(x) / std::exp(x), 1, 1e-7);
+        EXPECT_NEAR(fast::arccos(x / 3), std::acos(x / 3), 1e-7);
+        EXPECT_NEAR(fast::arctan2(x, 1 - x), std::atan2(x, 1 - x), 1e-7);
+    }
+    EXPECT_EQ(fast::exp(800.0), std::numeric_limits<double>::infinity());
+    EXPECT_NEAR(fast::log(1e-310) / std::log(1e-310), 1, 1e-6);
+}
+
+TEST(fast_functions, lanes)
+{
+    check_lanes_match_scalars<float, 4>();
+    check_lanes_match_scalars<float, 8>();
+    check_lanes_match_scalars<float, 16>();
+    check_lanes_match_scalars<double, 4>();
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "base/hdr_image.hpp"
+
+TEST(hdr_image, resolve_averages_samples)
+{
+    using namespace base;
+    hdr_image hdr{ 2, 1 };
+    hdr.add_sample({ 0, 0 }, 0.25f, 1.0f, 0.0f);
+    hdr.add_sample({ 0, 0 }, 0.75f, 1.0f, 4.0f);
+
+    image out{ 2, 1 };
+    resolve_settings settings;
+    settings.curve = tone_map::clamp;
+    settings.srgb = false;
+    settings.dither = false;
+    hdr.resolve(out, settings);
+
+    EXPECT_EQ((out[{ 0, 0 }].red), 128); // (0.25 + 0.75) / 2
+    EXPECT_EQ((out[{ 0, 0 }].green), 255);
+    EXPECT_EQ((out[{ 0, 0 }].blue), 255); // clipped
+    EXPECT_EQ((out[{ 1, 0 }].red), 0); // no samples
+}
+
+TEST(hdr_image, srgb_and_exposure)
+{
+    using namespace base;
+    hdr_image hdr{ 1, 1 };
+    hdr.add_sample({ 0, 0 }, 0.25f, 0.5f, 0.0f);
+
+    image out{ 1, 1 };
+    resolve_settings settings;
+    settings.curve = tone_map::clamp;
+    settings.dither = false;
+    settings.exposure = 1; // doubles the radiance
+    hdr.resolve(out, settings);
+
+    EXPECT_EQ((out[{ 0, 0 }].red), 188); // sRGB(0.5)
+    EXPECT_EQ((out[{ 0, 0 }].green), 255);
+    EXPECT_EQ((out[{ 0, 0 }].blue), 0);
+}
+
+TEST(hdr_image, dither_stays_within_a_step)
+{
+    using namespace base;
+    constexpr int width = 64, height = 16;
+    hdr_image hdr{ width, height };
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x) hdr.add_sample({ x, y }, 0.3f, 0.3f, 0.3f);
+    }
+
+    image plain{ width, height }, dithered{ width, height };
+    resolve_settings settings;
+    settings.dither = false;
+    hdr.resolve(plain, settings);
+    settings.dither = true;
+    hdr.resolve(dithered, settings);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x) EXPECT_LE(std::abs(plain[{ x, y }].red - dithered[{ x, y }].red), 1);
+    }
+}
+
+TEST(hdr_image, non_finite_samples_resolve_to_black)
+{
+    using namespace base;
+    hdr_image hdr{ 4, 1 };
+    hdr.add_sample({ 0, 0 }, std::numeric_limits<float>::quiet_NaN(), 0.5f, 0.5f);
+    hdr.add_sample({ 1, 0 }, std::numeric_limits<float>::infinity(), 0.5f, 0.5f);
+    hdr.add_sample({ 2, 0 }, -std::numeric_limits<float>::infinity(), 0.5f, 0.5f);
+    hdr.add_sample({ 3, 0 }, 3e38f, -2.0f, 0.5f);
+
+    image out{ 4, 1 };
+    for (tone_map curve : { tone_map::clamp, tone_map::reinhard, tone_map::aces })
+    {
+        for (bool srgb : { false, true })
+        {
+            resolve_settings settings;
+            settings.curve = curve;
+            settings.srgb = srgb;
+            settings.dither = false;
+            hdr.resolve(out, settings);
+
+            for (int x = 0; x < 3; ++x) EXPECT_EQ((out[{ x, 0 }].red), 0);
+            EXPECT_EQ((out[{ 0, 0 }].green), (out[{ 3, 0 }].blue)); // the other channels of the pixel are untouched
+            EXPECT_GE((out[{ 3, 0 }].red), 250); // huge but finite stays bright
+            EXPECT_EQ((out[{ 3, 0 }].green), 0); // negative is black, even through reinhard
+        }
+    }
+}
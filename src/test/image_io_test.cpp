@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "base/image_io.hpp"
+
+namespace
+{
+    std::string temp_path(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in{ path, std::ios::binary };
+        return { std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+    }
+}
+
+TEST(image_io, raw_round_trip_keeps_stride)
+{
+    using namespace base;
+    constexpr int width = 5, height = 3, stride = 8;
+    pixel buffer[stride * height];
+    image view{ buffer, width, height, stride };
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x) view[{ x, y }] = pixel{ static_cast<uint8_t>(x), static_cast<uint8_t>(y), 7 };
+    }
+
+    const std::string path = temp_path("image_io_test.rtimg");
+    save_raw(view, path);
+    EXPECT_EQ(std::filesystem::file_size(path), sizeof(raw_image_header) + stride * height * sizeof(pixel));
+
+    read_only_mapped_image mapped = read_only_mapped_image::open(path);
+    const image& img = mapped.get();
+    EXPECT_EQ(img.width(), width);
+    EXPECT_EQ(img.height(), height);
+    EXPECT_EQ(img.stride(), stride);
+    EXPECT_FALSE(img.owns_buffer());
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(img.get_buffer()) % 64, 0u);
+    EXPECT_EQ((img[{ 4, 2 }].red), 4);
+    EXPECT_EQ((img[{ 4, 2 }].green), 2);
+    EXPECT_EQ((img[{ 4, 2 }].blue), 7);
+
+    std::filesystem::remove(path);
+}
+
+TEST(image_io, create_writes_through)
+{
+    using namespace base;
+    const std::string path = temp_path("image_io_test_create.rtimg");
+    {
+        mapped_image mapped = mapped_image::create(path, 4, 4);
+        EXPECT_EQ((mapped.get()[{ 1, 1 }].red), 0);
+        mapped.get()[{ 3, 2 }] = 0x112233_rgb;
+        mapped.sync();
+    }
+
+    {
+        mapped_image reopened = mapped_image::open(path);
+        EXPECT_EQ((reopened.get()[{ 3, 2 }].green), 0x22);
+        reopened.get()[{ 0, 0 }] = 0x445566_rgb;
+    }
+
+    read_only_mapped_image read_only = read_only_mapped_image::open(path);
+    EXPECT_EQ((read_only.get()[{ 0, 0 }].blue), 0x66);
+
+    std::filesystem::remove(path);
+}
+
+TEST(image_io, rejects_other_files)
+{
+    using namespace base;
+    const std::string path = temp_path("image_io_test_bad.rtimg");
+    {
+        std::ofstream out{ path, std::ios::binary };
+        out << std::string(128, 'x');
+    }
+    EXPECT_THROW(read_only_mapped_image::open(path), std::runtime_error);
+    std::filesystem::remove(path);
+
+    EXPECT_THROW(read_only_mapped_image::open(path), std::system_error);
+}
+
+TEST(image_io, rejects_headers_pointing_outside_the_file)
+{
+    using namespace base;
+    const std::string path = temp_path("image_io_test_crafted.rtimg");
+    pixel buffer[4 * 4];
+    save_raw(image{ buffer, 4, 4, 4 }, path);
+
+    auto rewrite = [&](auto&& edit)
+    {
+        std::string data = read_file(path);
+        raw_image_header header;
+        std::memcpy(&header, data.data(), sizeof(header));
+        edit(header);
+        std::memcpy(data.data(), &header, sizeof(header));
+        std::ofstream{ path, std::ios::binary } << data;
+    };
+
+    EXPECT_NO_THROW(read_only_mapped_image::open(path));
+
+    // an offset a multiple of 64 so close to 2^64 that adding the pixels to it wraps around to a small size
+    rewrite([](raw_image_header& header) { header.data_offset = ~uint64_t{ 0 } - 63; });
+    EXPECT_THROW(read_only_mapped_image::open(path), std::runtime_error);
+
+    rewrite([](raw_image_header& header) { header.data_offset = 64; header.height = 5; });
+    EXPECT_THROW(read_only_mapped_image::open(path), std::runtime_error);
+
+    rewrite([](raw_image_header& header) { header.height = 4; header.stride = 0x7fffffff; });
+    EXPECT_THROW(read_only_mapped_image::open(path), std::runtime_error);
+
+    rewrite([](raw_image_header& header) { header.stride = 4; header.data_offset = 0; });
+    EXPECT_THROW(read_only_mapped_image::open(path), std::runtime_error);
+
+    std::filesystem::remove(path);
+}
+
+TEST(image_io, ppm_and_pfm)
+{
+    using namespace base;
+    image img{ 2, 1 };
+    img[{ 0, 0 }] = 0x010203_rgb;
+    img[{ 1, 0 }] = 0x040506_rgb;
+
+    const std::string ppm = temp_path("image_io_test.ppm");
+    save_ppm(img, ppm);
+    EXPECT_EQ(read_file(ppm), std::string("P6\n2 1\n255\n\x01\x02\x03\x04\x05\x06", 17));
+    std::filesystem::remove(ppm);
+
+    hdr_image hdr{ 1, 2 };
+    hdr.add_sample({ 0, 0 }, 2.0f, 0.0f, 0.0f);
+    hdr.add_sample({ 0, 0 }, 4.0f, 0.0f, 0.0f);
+
+    const std::string pfm = temp_path("image_io_test.pfm");
+    save_pfm(hdr, pfm);
+    const std::string data = read_file(pfm);
+    const std::string header = "PF\n1 2\n-1.0\n";
+    ASSERT_EQ(data.size(), header.size() + 6 * sizeof(float));
+    EXPECT_EQ(data.substr(0, header.size()), header);
+
+    float top_red; // the top row is stored last
+    std::memcpy(&top_red, data.data() + header.size() + 3 * sizeof(float), sizeof(float));
+    EXPECT_FLOAT_EQ(top_red, 3.0f);
+    std::filesystem::remove(pfm);
+}
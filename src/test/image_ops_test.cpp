@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "base/image_ops.hpp"
+
+namespace
+{
+    base::image pattern(int width, int height)
+    {
+        base::image img{ width, height };
+        for (int y = 0; y < height; ++y)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                img[{ x, y }] = base::pixel{ static_cast<uint8_t>(x * 7 + y), static_cast<uint8_t>(y * 13), static_cast<uint8_t>(x ^ y) };
+            }
+        }
+        return img;
+    }
+}
+
+TEST(image_ops, fill_leaves_padding)
+{
+    using namespace base;
+    constexpr int width = 19, height = 5, stride = 24;
+    pixel buffer[stride * height];
+    image view{ buffer, width, height, stride };
+
+    thread_pool pool{ 2 };
+    fill(view, 0x102030_rgb, pool);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x) EXPECT_EQ((view[{ x, y }].green), 0x20);
+        EXPECT_EQ(buffer[y * stride + width].green, 0);
+    }
+}
+
+TEST(image_ops, blit_copies_rectangle)
+{
+    using namespace base;
+    image src = pattern(16, 16);
+    image dst{ 8, 8 };
+    dst.fill(0x000000_rgb);
+
+    blit(src, { 3, 4, 5, 2 }, dst, 1, 6);
+    EXPECT_EQ((dst[{ 1, 6 }].red), (src[{ 3, 4 }].red));
+    EXPECT_EQ((dst[{ 5, 7 }].blue), (src[{ 7, 5 }].blue));
+    EXPECT_EQ((dst[{ 0, 6 }].red), 0);
+
+    EXPECT_THROW(blit(src, { 0, 0, 9, 1 }, dst, 0, 0), std::out_of_range);
+}
+
+TEST(image_ops, alpha_blend_matches_scalar)
+{
+    using namespace base;
+    constexpr int width = 37, height = 3; // leaves a scalar tail after the vector loops
+    image src = pattern(width, height);
+    image dst{ width, height };
+    dst.fill(0xC08040_rgb);
+    image expected = dst;
+
+    constexpr uint8_t alpha = 77;
+    alpha_blend(src, dst, alpha);
+
+    auto blend = [](int s, int d) { return (s * alpha + d * (255 - alpha) + 127) / 255; };
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            EXPECT_EQ((dst[{ x, y }].red), blend(src[{ x, y }].red, expected[{ x, y }].red));
+            EXPECT_EQ((dst[{ x, y }].blue), blend(src[{ x, y }].blue, expected[{ x, y }].blue));
+        }
+    }
+}
+
+TEST(image_ops, gamma_and_map)
+{
+    using namespace base;
+    image img{ 4, 2 };
+    img.fill(pixel{ 0, 128, 255 });
+
+    apply_gamma(img, 2.0f);
+    EXPECT_EQ((img[{ 3, 1 }].red), 0);
+    EXPECT_EQ((img[{ 3, 1 }].green), 64);
+    EXPECT_EQ((img[{ 3, 1 }].blue), 255);
+    EXPECT_THROW(apply_gamma(img, -1.0f), std::invalid_argument);
+    EXPECT_THROW(apply_gamma(img, 0.0f), std::invalid_argument);
+    EXPECT_THROW(apply_gamma(img, std::numeric_limits<float>::quiet_NaN()), std::invalid_argument);
+    EXPECT_EQ((img[{ 3, 1 }].green), 64);
+
+    map(img, [](pixel p) { return pixel{ p.blue, p.green, p.red }; });
+    EXPECT_EQ((img[{ 0, 0 }].red), 255);
+
+    generate(img, [](int x, int y) { return pixel{ static_cast<uint8_t>(x), static_cast<uint8_t>(y), 0 }; });
+    EXPECT_EQ((img[{ 3, 1 }].red), 3);
+    EXPECT_EQ((img[{ 3, 1 }].green), 1);
+}
+
+TEST(image_ops, downsample_averages_blocks)
+{
+    using namespace base;
+    constexpr int width = 23, height = 10; // odd column is dropped
+    image src = pattern(width, height);
+    image dst{ width / 2, height / 2 };
+    downsample(src, dst);
+
+    for (int y = 0; y < height / 2; ++y)
+    {
+        for (int x = 0; x < width / 2; ++x)
+        {
+            int sum = src[{ 2 * x, 2 * y }].red + src[{ 2 * x + 1, 2 * y }].red + src[{ 2 * x, 2 * y + 1 }].red + src[{ 2 * x + 1, 2 * y + 1 }].red;
+            EXPECT_EQ((dst[{ x, y }].red), (sum + 2) / 4);
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#include <gtest/gtest.h>
+
+#include "base/image.hpp"
+
+TEST(image, strided_view)
+{
+    using namespace base;
+    constexpr int width = 3, height = 2, stride = 5;
+    pixel buffer[stride * height];
+
+    image view{ buffer, width, height, stride };
+    EXPECT_FALSE(view.owns_buffer());
+    EXPECT_EQ(view.stride(), stride);
+
+    view.fill(0xFF0000_rgb);
+    view[{ 2, 1 }] = 0x00FF00_rgb;
+
+    EXPECT_EQ(buffer[0].red, 0xFF);
+    EXPECT_EQ(buffer[stride + 2].green, 0xFF);
+    EXPECT_EQ(buffer[stride + 2].red, 0);
+    EXPECT_EQ(buffer[width].red, 0); // padding is left untouched
+}
+
+TEST(image, copy_packs_rows)
+{
+    using namespace base;
+    constexpr int width = 2, height = 2, stride = 4;
+    pixel buffer[stride * height];
+
+    image view{ buffer, width, height, stride };
+    view[{ 0, 0 }] = 0x010203_rgb;
+    view[{ 1, 1 }] = 0x040506_rgb;
+
+    image copy{ view };
+    EXPECT_TRUE(copy.owns_buffer());
+    EXPECT_EQ(copy.stride(), width);
+    EXPECT_EQ((copy[{ 0, 0 }].blue), 3);
+    EXPECT_EQ((copy[{ 1, 1 }].red), 4);
+
+    image assigned{ 1, 1 };
+    assigned = copy;
+    EXPECT_NE(assigned.get_buffer(), copy.get_buffer());
+    EXPECT_EQ((assigned[{ 1, 1 }].green), 5);
+}
@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "accel/lbvh.hpp"
+#include "accel/triangle.hpp"
+#include "accel/wide_bvh.hpp"
+#include "accel_test_util.hpp"
+#include "math/geometry/morton.hpp"
+
+using namespace math;
+using namespace accel_test;
+using accel::bvh;
+
+// interleaves one bit at a time, the definition the bit tricks must match
+static std::uint64_t interleave(std::uint64_t x, std::uint64_t y, std::uint64_t z, int bits)
+{
+    std::uint64_t code = 0;
+    for (int b = 0; b < bits; ++b)
+    {
+        code |= ((x >> b) & 1) << (3 * b);
+        code |= ((y >> b) & 1) << (3 * b + 1);
+        code |= ((z >> b) & 1) << (3 * b + 2);
+    }
+    return code;
+}
+
+TEST(morton, encode)
+{
+    std::mt19937_64 rng{ 1 };
+    for (int i = 0; i < 1000; ++i)
+    {
+        std::uint64_t x = rng() & 0x1fffff, y = rng() & 0x1fffff, z = rng() & 0x1fffff;
+        ASSERT_EQ(morton_encode_63(x, y, z), interleave(x, y, z, 21));
+        ASSERT_EQ(morton_encode_30(static_cast<std::uint32_t>(x & 0x3ff), static_cast<std::uint32_t>(y & 0x3ff), static_cast<std::uint32_t>(z & 0x3ff)),
+                  interleave(x & 0x3ff, y & 0x3ff, z & 0x3ff, 10));
+    }
+    ASSERT_EQ(morton_encode_30(0x3ff, 0x3ff, 0x3ff), (1u << 30) - 1);
+    ASSERT_EQ(morton_encode_63(0x1fffff, 0x1fffff, 0x1fffff), (std::uint64_t{ 1 } << 63) - 1);
+
+    // bits past the width are dropped
+    ASSERT_EQ(spread_bits_10(0x400), 0u);
+    ASSERT_EQ(spread_bits_21(0x200000), 0u);
+}
+
+TEST(morton, quantize)
+{
+    bounds3f b{ point<float, 3>{ 0, 0, 0 }, point<float, 3>{ 1, 2, 4 } };
+    ASSERT_EQ(morton_code_30(point<float, 3>{ 0, 0, 0 }, b), 0u);
+    ASSERT_EQ(morton_code_30(point<float, 3>{ 1, 2, 4 }, b), (1u << 30) - 1);
+    ASSERT_EQ(morton_code_63(point<float, 3>{ 1, 2, 4 }, b), (std::uint64_t{ 1 } << 63) - 1);
+
+    // the middle of the box is the first cell of the upper half on every axis
+    ASSERT_EQ(morton_code_30(point<float, 3>{ 0.5f, 1, 2 }, b), 7u << 27);
+
+    // outside the box clamps, and a flat axis maps to cell 0
+    ASSERT_EQ(morton_code_30(point<float, 3>{ -5, 10, 2 }, b), morton_encode_30(0, 0x3ff, 512));
+    bounds3f flat{ point<float, 3>{ 0, 0, 3 }, point<float, 3>{ 1, 1, 3 } };
+    ASSERT_EQ(morton_code_30(point<float, 3>{ 1, 1, 3 }, flat), morton_encode_30(0x3ff, 0x3ff, 0));
+}
+
+TEST(lbvh, emit_nodes)
+{
+    // the example of Karras 2012, figure 3
+    std::vector<std::uint32_t> codes{ 0b00001, 0b00010, 0b00100, 0b00101, 0b10011, 0b11000, 0b11001, 0b11110 };
+    std::uint32_t n = 8;
+    std::vector<accel::lbvh_node> nodes(n - 1);
+    std::vector<std::uint32_t> parents(2 * n - 1);
+    for (std::uint32_t i = 0; i < n - 1; ++i) accel::lbvh_emit_node(codes.data(), n, 5, i, nodes.data(), parents.data());
+
+    auto leaf = [&](std::uint32_t i) { return n - 1 + i; };
+    ASSERT_EQ(nodes[0].children[0], 3u);
+    ASSERT_EQ(nodes[0].children[1], 4u);
+    ASSERT_EQ(nodes[3].children[0], 1u);
+    ASSERT_EQ(nodes[3].children[1], 2u);
+    ASSERT_EQ(nodes[1].children[0], leaf(0));
+    ASSERT_EQ(nodes[1].children[1], leaf(1));
+    ASSERT_EQ(nodes[2].children[0], leaf(2));
+    ASSERT_EQ(nodes[2].children[1], leaf(3));
+    ASSERT_EQ(nodes[4].children[0], leaf(4));
+    ASSERT_EQ(nodes[4].children[1], 5u);
+    ASSERT_EQ(nodes[5].children[0], 6u);
+    ASSERT_EQ(nodes[5].children[1], leaf(7));
+    ASSERT_EQ(nodes[6].children[0], leaf(5));
+    ASSERT_EQ(nodes[6].children[1], leaf(6));
+
+    ASSERT_EQ(nodes[0].first, 0u);
+    ASSERT_EQ(nodes[0].last, 7u);
+    ASSERT_EQ(nodes[4].first, 4u);
+    ASSERT_EQ(nodes[4].last, 7u);
+
+    // the root splits at bit 4, which belongs to y
+    ASSERT_EQ(nodes[0].axis, 1);
+
+    for (std::uint32_t i = 1; i < 2 * n - 1; ++i)
+    {
+        const auto& p = nodes[parents[i]];
+        ASSERT_TRUE(p.children[0] == i || p.children[1] == i);
+    }
+}
+
+TEST(lbvh, trivial_inputs)
+{
+    ASSERT_TRUE(accel::build_lbvh({}).empty());
+
+    std::vector<bounds3f> one{ bounds3f{ point<float, 3>{ 0, 0, 0 }, point<float, 3>{ 1, 1, 1 } } };
+    bvh tree = accel::build_lbvh(one);
+    ASSERT_EQ(tree.nodes().size(), 1u);
+    ASSERT_EQ(tree.nodes()[0].count, 1);
+
+    std::vector<bounds3f> empty_bounds(2);
+    ASSERT_THROW(accel::build_lbvh(empty_bounds), std::invalid_argument);
+
+    accel::lbvh_build_settings settings;
+    settings.max_leaf_size = 1 << 16;
+    ASSERT_THROW(accel::build_lbvh(one, settings), std::invalid_argument);
+}
+
+TEST(lbvh, matches_brute_force)
+{
+    auto tris = random_triangles(20000, 2);
+    auto prim_bounds = bounds_of(tris);
+
+    bvh tree = accel::build_lbvh(prim_bounds);
+    check_tree(tree, prim_bounds, 1);
+    auto rays = random_rays(1000, 3);
+    ASSERT_GT(check_against_brute_force(tree, tris, rays), rays.size() / 10);
+
+    accel::lbvh_build_settings settings;
+    settings.use_63_bit_codes = true;
+    settings.max_leaf_size = 4;
+    bvh tree63 = accel::build_lbvh(prim_bounds, settings);
+    check_tree(tree63, prim_bounds, 4);
+    ASSERT_LT(tree63.nodes().size(), tree.nodes().size());
+    check_against_brute_force(tree63, tris, rays);
+
+    // the result collapses into a wide bvh like any other
+    accel::bvh8 wide{ tree63 };
+    float t0 = std::numeric_limits<float>::infinity(), t1 = t0;
+    ray3f r{ point<float, 3>{ -12, -12, -12 }, vector<float, 3>{ 1, 1, 1 } };
+    auto intersect = [&](std::uint32_t prim, const ray3f& ray, float& tmax) { return tris[prim].intersect(ray, tmax); };
+    ASSERT_EQ(wide.closest_hit(r, t0, intersect), tree63.closest_hit(r, t1, intersect));
+    ASSERT_FLOAT_EQ(t0, t1);
+}
+
+TEST(lbvh, duplicate_codes)
+{
+    // every centroid falls in the same cell, so the primitive indices alone order the splits
+    std::vector<bounds3f> b;
+    for (int i = 0; i < 5000; ++i) b.push_back(bounds3f{ point<float, 3>{ 0, 0, 0 }, point<float, 3>{ 1, 1, 1 + i * 1e-7f } });
+    b.push_back(bounds3f{ point<float, 3>{ 5, 5, 5 }, point<float, 3>{ 6, 6, 6 } });
+
+    bvh tree = accel::build_lbvh(b);
+    std::size_t depth = check_tree(tree, b, 1);
+    ASSERT_LE(depth, bvh::max_depth);
+    ASSERT_LE(depth, 30u + 14u);
+}
+
+TEST(lbvh, parallel_build)
+{
+    auto tris = random_triangles(200000, 4);
+    auto prim_bounds = bounds_of(tris);
+
+    base::thread_pool pool{ 4 };
+    accel::lbvh_build_settings settings;
+    settings.max_leaf_size = 2;
+    bvh tree = accel::build_lbvh(prim_bounds, settings, pool);
+    check_tree(tree, prim_bounds, 2);
+
+    // the build is deterministic whatever the scheduling
+    base::thread_pool serial{ 0 };
+    bvh expected = accel::build_lbvh(prim_bounds, settings, serial);
+    ASSERT_EQ(tree.nodes().size(), expected.nodes().size());
+    for (std::size_t i = 0; i < tree.nodes().size(); ++i)
+    {
+        ASSERT_EQ(tree.nodes()[i].offset, expected.nodes()[i].offset);
+        ASSERT_EQ(tree.nodes()[i].count, expected.nodes()[i].count);
+        ASSERT_EQ(tree.nodes()[i].lower[0], expected.nodes()[i].lower[0]);
+        ASSERT_EQ(tree.nodes()[i].upper[2], expected.nodes()[i].upper[2]);
+    }
+    ASSERT_TRUE(std::equal(tree.primitive_indices().begin(), tree.primitive_indices().end(), expected.primitive_indices().begin()));
+}
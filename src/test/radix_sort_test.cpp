@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "base/radix_sort.hpp"
+
+using namespace base;
+
+template<typename K>
+static void check_sort(std::size_t n, int bits, thread_pool& pool)
+{
+    std::mt19937_64 rng{ n };
+    std::vector<K> keys(n);
+    for (auto& k : keys) k = static_cast<K>(bits >= 64 ? rng() : rng() & ((std::uint64_t{ 1 } << bits) - 1));
+    std::vector<std::uint32_t> values(n);
+    std::iota(values.begin(), values.end(), 0);
+
+    // the expected order, stable so that equal keys keep the order of their values
+    std::vector<std::uint32_t> expected = values;
+    std::stable_sort(expected.begin(), expected.end(), [&](std::uint32_t a, std::uint32_t b) { return keys[a] < keys[b]; });
+    std::vector<K> original = keys;
+
+    radix_sort(std::span<K>{ keys }, std::span<std::uint32_t>{ values }, bits, pool);
+    ASSERT_EQ(values, expected);
+    for (std::size_t i = 0; i < n; ++i) ASSERT_EQ(keys[i], original[values[i]]);
+}
+
+TEST(radix_sort, small_and_empty)
+{
+    thread_pool pool{ 2 };
+    std::vector<std::uint32_t> keys, values;
+    radix_sort(std::span<std::uint32_t>{ keys }, std::span<std::uint32_t>{ values }, 32, pool);
+
+    keys = { 5, 3, 9, 3, 0 };
+    values = { 0, 1, 2, 3, 4 };
+    radix_sort(std::span<std::uint32_t>{ keys }, std::span<std::uint32_t>{ values }, 32, pool);
+    ASSERT_EQ(keys, (std::vector<std::uint32_t>{ 0, 3, 3, 5, 9 }));
+    ASSERT_EQ(values, (std::vector<std::uint32_t>{ 4, 1, 3, 0, 2 }));
+}
+
+TEST(radix_sort, matches_stable_sort)
+{
+    thread_pool pool{ 3 };
+    check_sort<std::uint32_t>(1000, 32, pool);
+    check_sort<std::uint32_t>(200000, 30, pool);
+    check_sort<std::uint64_t>(200000, 63, pool);
+    check_sort<std::uint64_t>(100000, 64, pool);
+}
+
+TEST(radix_sort, few_distinct_keys)
+{
+    // most passes see one digit and are skipped
+    thread_pool pool{ 2 };
+    check_sort<std::uint32_t>(100000, 2, pool);
+    check_sort<std::uint64_t>(100000, 1, pool);
+}
+
+TEST(radix_sort, serial_pool)
+{
+    thread_pool pool{ 0 };
+    check_sort<std::uint64_t>(50000, 40, pool);
+}
+
+TEST(radix_sort, size_mismatch)
+{
+    std::vector<std::uint32_t> keys(4), values(3);
+    ASSERT_THROW(radix_sort(std::span<std::uint32_t>{ keys }, std::span<std::uint32_t>{ values }), std::invalid_argument);
+}
@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "math/geometry/ray_packet.hpp"
+#include "math/geometry/ray_stream.hpp"
+
+using namespace math;
+
+using ray3f = ray<float, 3>;
+
+static ray3f make_ray(float i)
+{
+    return { point<float, 3>{ i, 2 * i, -i }, vector<float, 3>{ 1 - i, i == 2 ? -0.0f : 0.5f, -2.0f } };
+}
+
+TEST(ray_packet, load_and_extract)
+{
+    std::vector<ray3f> rays;
+    for (int i = 0; i < 3; ++i) rays.push_back(make_ray(static_cast<float>(i)));
+
+    auto p = ray_packet<float, 4>::load(rays, 0.5f, 10.0f);
+    ASSERT_EQ(p.get_active().bits(), 0b0111u);
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        ray3f r = p.extract(i);
+        for (int c = 0; c < 3; ++c)
+        {
+            ASSERT_FLOAT_EQ(r.get_origin()[c], rays[i].get_origin()[c]);
+            ASSERT_FLOAT_EQ(r.get_direction()[c], rays[i].get_direction()[c]);
+            ASSERT_FLOAT_EQ(p.get_inv_direction()[c][i], 1 / rays[i].get_direction()[c]);
+        }
+        ASSERT_FLOAT_EQ(p.get_tmin()[i], 0.5f);
+        ASSERT_FLOAT_EQ(p.get_tmax()[i], 10.0f);
+    }
+
+    // a zero direction component becomes an infinity of the same sign
+    ASSERT_EQ(p.get_inv_direction()[0][1], std::numeric_limits<float>::infinity());
+    ASSERT_EQ(p.get_inv_direction()[1][2], -std::numeric_limits<float>::infinity());
+}
+
+TEST(ray_packet, insert_and_at)
+{
+    ray_packet<float, 8> p;
+    ASSERT_TRUE(p.get_active().none());
+
+    p.insert(5, make_ray(1), 0, 3);
+    ASSERT_EQ(p.get_active().bits(), 1u << 5);
+
+    auto points = p.at(2.0f);
+    ASSERT_FLOAT_EQ(points[0][5], 1);
+    ASSERT_FLOAT_EQ(points[1][5], 3);
+    ASSERT_FLOAT_EQ(points[2][5], -5);
+}
+
+TEST(ray_packet, common_octant)
+{
+    std::vector<ray3f> rays = {
+        { point<float, 3>{ 0, 0, 0 }, vector<float, 3>{ -1, 2, -3 } },
+        { point<float, 3>{ 0, 0, 0 }, vector<float, 3>{ -0.5f, 0.1f, -0.0f } }
+    };
+    auto p = ray_packet<float, 4>::load(rays);
+    ASSERT_EQ(p.common_octant(), 0b101);
+    ASSERT_EQ(direction_octant(rays[1].get_direction()), 0b101u);
+
+    p.insert(2, { point<float, 3>{ 0, 0, 0 }, vector<float, 3>{ 1, 1, -1 } });
+    ASSERT_EQ(p.common_octant(), -1);
+}
+
+static ray_stream<float> make_stream(std::size_t count, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    ray_stream<float> stream(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        stream.push_back({ point<float, 3>{ 10 * dist(rng), 10 * dist(rng), 10 * dist(rng) },
+                           vector<float, 3>{ dist(rng), dist(rng), dist(rng) } }, 0, static_cast<float>(i));
+    }
+    return stream;
+}
+
+TEST(ray_stream, packets)
+{
+    ray_stream<float> stream = make_stream(19, 1);
+    for (std::size_t first = 0; first < stream.size(); first += 8)
+    {
+        auto p = stream.packet<8>(first);
+        for (std::size_t r = 0; r < 8; ++r)
+        {
+            ASSERT_EQ(p.get_active()[r], first + r < stream.size());
+            if (first + r >= stream.size()) continue;
+
+            ray3f expected = stream.get_ray(first + r);
+            for (int c = 0; c < 3; ++c) ASSERT_EQ(p.get_origin()[c][r], expected.get_origin()[c]);
+            ASSERT_EQ(p.get_tmax()[r], stream.get_tmax(first + r));
+        }
+
+        p.get_tmax() = p.get_tmax() * 0.5f;
+        stream.store_tmax(first, p);
+    }
+    ASSERT_FLOAT_EQ(stream.get_tmax(18), 9);
+}
+
+TEST(ray_stream, compact_keeps_order)
+{
+    ray_stream<float> stream = make_stream(100, 2);
+    std::vector<ray3f> before;
+    for (std::size_t i = 0; i < stream.size(); ++i) before.push_back(stream.get_ray(i));
+
+    ASSERT_EQ(stream.compact([](std::size_t idx) { return idx % 3 == 0; }), 66u);
+    ASSERT_EQ(stream.size(), 34u);
+    for (std::size_t i = 0; i < stream.size(); ++i)
+    {
+        ASSERT_EQ(stream.get_id(i), 3 * i);
+        ASSERT_EQ(stream.get_ray(i).get_origin()[0], before[3 * i].get_origin()[0]);
+        ASSERT_FLOAT_EQ(stream.get_tmax(i), static_cast<float>(3 * i));
+    }
+}
+
+TEST(ray_stream, sort_by_octant)
+{
+    ray_stream<float> stream = make_stream(1000, 3);
+    stream.sort_by_octant();
+
+    std::set<std::uint32_t> ids;
+    std::uint32_t last = 0;
+    for (std::size_t i = 0; i < stream.size(); ++i)
+    {
+        std::uint32_t octant = direction_octant(stream.get_ray(i).get_direction());
+        ASSERT_GE(octant, last);
+        last = octant;
+        ids.insert(stream.get_id(i));
+
+        // the interval moves with its ray
+        ASSERT_FLOAT_EQ(stream.get_tmax(i), static_cast<float>(stream.get_id(i)));
+    }
+    ASSERT_EQ(ids.size(), 1000u);
+}
+
+TEST(ray_stream, sort_by_octant_and_origin)
+{
+    ray_stream<float> stream = make_stream(4096, 4);
+    auto mean_step = [&]
+    {
+        double total = 0;
+        for (std::size_t i = 1; i < stream.size(); ++i)
+        {
+            double d = 0;
+            for (int c = 0; c < 3; ++c)
+            {
+                double delta = stream.get_ray(i).get_origin()[c] - stream.get_ray(i - 1).get_origin()[c];
+                d += delta * delta;
+            }
+            total += std::sqrt(d);
+        }
+        return total / static_cast<double>(stream.size() - 1);
+    };
+
+    double shuffled = mean_step();
+    stream.sort_by_octant_and_origin();
+    ASSERT_LT(mean_step(), shuffled / 3);
+
+    std::uint32_t last = 0;
+    for (std::size_t i = 0; i < stream.size(); ++i)
+    {
+        std::uint32_t octant = direction_octant(stream.get_ray(i).get_direction());
+        ASSERT_GE(octant, last);
+        last = octant;
+    }
+}
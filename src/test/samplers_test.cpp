@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <set>
+
+#include "math/samplers.hpp"
+#include "math/sampling.hpp"
+
+using namespace math::samplers;
+
+static_assert(sampler<independent_sampler>);
+static_assert(sampler<sobol_sampler>);
+static_assert(sampler<halton_sampler>);
+static_assert(sampler<pmj02_sampler>);
+
+static_assert(reverse_bits(1u) == 0x80000000u);
+static_assert(reverse_bits(0x12345678u) == 0x1e6a2c48u);
+
+TEST(samplers, pcg32_reference_stream)
+{
+    // the output of pcg32_srandom_r(&rng, 42, 54) in the reference implementation
+    pcg32 rng(54, 42);
+    std::uint32_t expected[] = { 0xa15c02b7u, 0x7b47f409u, 0xba1d3330u, 0x83d2f293u, 0xbfa4784bu, 0xcbed606eu };
+    for (std::uint32_t value : expected) ASSERT_EQ(rng.next_uint(), value);
+}
+
+TEST(samplers, pcg32_advance)
+{
+    pcg32 stepped(7), skipped(7);
+    for (int i = 0; i < 1000; ++i) stepped.next_uint();
+    skipped.advance(1000);
+    ASSERT_EQ(stepped.next_uint(), skipped.next_uint());
+
+    skipped.advance(-1001);
+    pcg32 fresh(7);
+    ASSERT_EQ(skipped.next_uint(), fresh.next_uint());
+}
+
+TEST(samplers, owen_scramble_preserves_stratification)
+{
+    // a permutation of the 2^k intervals of width 2^-k for every k
+    for (std::uint32_t seed : { 0u, 1u, 0xdeadbeefu })
+    {
+        for (int k = 1; k <= 12; ++k)
+        {
+            std::set<std::uint32_t> intervals;
+            for (std::uint32_t i = 0; i < (1u << k); ++i) intervals.insert(owen_scramble(i << (32 - k), seed) >> (32 - k));
+            ASSERT_EQ(intervals.size(), 1u << k);
+        }
+    }
+}
+
+template<sampler S>
+void check_range_and_determinism(const S& s)
+{
+    for (int y = 0; y < 4; ++y)
+    {
+        for (int x = 0; x < 4; ++x)
+        {
+            for (std::uint32_t index = 0; index < 64; ++index)
+            {
+                for (std::uint32_t dim = 0; dim < 80; ++dim)
+                {
+                    float u = s.template get_1d<float>({ x, y }, index, dim);
+                    double v = s.template get_1d<double>({ x, y }, index, dim);
+                    ASSERT_GE(u, 0);
+                    ASSERT_LT(u, 1);
+                    ASSERT_GE(v, 0);
+                    ASSERT_LT(v, 1);
+                    ASSERT_EQ(u, (s.template get_1d<float>({ x, y }, index, dim)));
+                }
+            }
+        }
+    }
+    ASSERT_NE((s.template get_1d<float>({ 0, 0 }, 5, 3)), (s.template get_1d<float>({ 1, 0 }, 5, 3)));
+    ASSERT_NE((s.template get_1d<float>({ 0, 0 }, 5, 3)), (s.template get_1d<float>({ 0, 0 }, 5, 4)));
+}
+
+TEST(samplers, values_are_uniform_and_reproducible)
+{
+    check_range_and_determinism(independent_sampler(1));
+    check_range_and_determinism(sobol_sampler(1));
+    check_range_and_determinism(halton_sampler(1));
+    check_range_and_determinism(pmj02_sampler(1));
+}
+
+template<sampler S>
+bool is_02_net(const S& s, math::point<int, 2> pixel, std::uint32_t dimension, int m)
+{
+    // every elementary interval of area 2^-m holds exactly one of the first 2^m points
+    for (int a = 0; a <= m; ++a)
+    {
+        std::set<std::pair<int, int>> cells;
+        for (std::uint32_t i = 0; i < (1u << m); ++i)
+        {
+            math::point<double, 2> u = s.template get_2d<double>(pixel, i, dimension);
+            cells.emplace(static_cast<int>(std::ldexp(u[0], a)), static_cast<int>(std::ldexp(u[1], m - a)));
+        }
+        if (cells.size() != (1u << m)) return false;
+    }
+    return true;
+}
+
+TEST(samplers, pmj02_pairs_are_02_sequences)
+{
+    pmj02_sampler s(3);
+    for (std::uint32_t dim : { 0u, 2u, 7u, 40u })
+    {
+        for (int m = 1; m <= 8; ++m) ASSERT_TRUE(is_02_net(s, { 5, 9 }, dim, m)) << "dimension " << dim << ", 2^" << m;
+    }
+}
+
+TEST(samplers, sobol_first_pair_is_02_sequence)
+{
+    sobol_sampler s(3);
+    for (int m = 1; m <= 8; ++m) ASSERT_TRUE(is_02_net(s, { 5, 9 }, 0, m)) << "2^" << m;
+}
+
+TEST(samplers, sobol_dimensions_are_stratified)
+{
+    sobol_sampler s(11);
+    for (std::uint32_t dim = 0; dim < 40; ++dim)
+    {
+        std::set<int> intervals;
+        for (std::uint32_t i = 0; i < 256; ++i) intervals.insert(static_cast<int>(s.get_1d<double>({ 2, 3 }, i, dim) * 256));
+        ASSERT_EQ(intervals.size(), 256u) << "dimension " << dim;
+    }
+}
+
+TEST(samplers, halton_dimensions_are_stratified)
+{
+    // the first b^k points of the dimension in base b fall in distinct intervals of width b^-k
+    halton_sampler s(11);
+    std::uint32_t bases[] = { 2, 3, 5, 7, 11 };
+    for (std::uint32_t dim = 0; dim < 5; ++dim)
+    {
+        std::uint32_t count = 1;
+        while (count * bases[dim] <= 1024) count *= bases[dim];
+
+        std::set<int> intervals;
+        for (std::uint32_t i = 0; i < count; ++i) intervals.insert(static_cast<int>(s.get_1d<double>({ 2, 3 }, i, dim) * count));
+        ASSERT_EQ(intervals.size(), count) << "dimension " << dim;
+    }
+}
+
+template<sampler S>
+double disk_integration_error(const S& s, std::uint32_t count)
+{
+    // integrates x^2 over the unit disk through math::sampling. the exact mean is 1/4
+    double error = 0;
+    for (int pixel = 0; pixel < 16; ++pixel)
+    {
+        double sum = 0;
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            math::point<double, 2> polar = math::sampling::sample_disk(s.template get_2d<double>({ pixel, 0 }, i, 2));
+            double x = polar[0] * std::cos(polar[1]);
+            sum += x * x;
+        }
+        error += std::abs(sum / count - 0.25);
+    }
+    return error / 16;
+}
+
+TEST(samplers, low_discrepancy_converges_faster)
+{
+    double white = disk_integration_error(independent_sampler(), 1024);
+    ASSERT_LT(disk_integration_error(sobol_sampler(), 1024), white / 4);
+    ASSERT_LT(disk_integration_error(halton_sampler(), 1024), white / 4);
+    ASSERT_LT(disk_integration_error(pmj02_sampler(), 1024), white / 4);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "math/sampling_batch.hpp"
+
+using namespace math;
+
+template<typename T, std::size_t N>
+std::vector<point<T, N>> uniform_points(std::size_t count, unsigned seed)
+{
+    // a few values outside [0, 1) check that the batches reject them like the single-sample functions
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<T> dist(static_cast<T>(-0.05), static_cast<T>(1.05));
+    std::vector<point<T, N>> points(count);
+    for (auto& p : points)
+    {
+        for (std::size_t c = 0; c < N; ++c) p[static_cast<int>(c)] = dist(rng);
+    }
+    return points;
+}
+
+template<typename T, std::size_t N, std::size_t M, typename Batch, typename Single>
+void check_against_single(Batch batch, Single single, double tolerance)
+{
+    base::thread_pool pool(3);
+    for (std::size_t count : { std::size_t{ 0 }, std::size_t{ 1 }, std::size_t{ 17 }, std::size_t{ 100003 } })
+    {
+        std::vector<point<T, N>> u = uniform_points<T, N>(count, static_cast<unsigned>(count));
+        std::vector<point<T, M>> out(count);
+        batch(std::span<const point<T, N>>(u), std::span<point<T, M>>(out), pool);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            point<T, M> expected = single(u[i]);
+            for (int c = 0; c < static_cast<int>(M); ++c) ASSERT_NEAR(out[i][c], expected[c], tolerance) << "sample " << i << " of " << count;
+        }
+    }
+}
+
+template<typename T>
+void check_continuous_batches()
+{
+    using namespace math::sampling;
+    check_against_single<T, 2, 2>([](auto u, auto out, auto& pool) { sample_disk<T>(u, out, pool); },
+                                  [](point<T, 2> u) { return sample_disk(u); }, 1e-6);
+    check_against_single<T, 2, 3>([](auto u, auto out, auto& pool) { sample_sphere_surface<T>(u, out, pool); },
+                                  [](point<T, 2> u) { return sample_sphere_surface(u); }, 2e-6);
+    check_against_single<T, 2, 3>([](auto u, auto out, auto& pool) { sample_cosine_hemisphere<T>(u, out, pool); },
+                                  [](point<T, 2> u) { return sample_cosine_hemisphere(u); }, 2e-6);
+    check_against_single<T, 3, 3>([](auto u, auto out, auto& pool) { sample_sphere<T>(u, out, pool); },
+                                  [](point<T, 3> u) { return sample_sphere(u); }, 2e-6);
+}
+
+TEST(sampling_batch, continuous_float)
+{
+    check_continuous_batches<float>();
+}
+
+TEST(sampling_batch, continuous_double)
+{
+    check_continuous_batches<double>();
+}
+
+TEST(sampling_batch, linear)
+{
+    std::vector<float> u(10007);
+    for (std::size_t i = 0; i < u.size(); ++i) u[i] = static_cast<float>(i) / static_cast<float>(u.size());
+    std::vector<float> out(u.size());
+
+    for (auto [a, b] : { std::pair{ 1.0f, 3.0f }, std::pair{ 0.0f, 2.0f }, std::pair{ 5.0f, 0.5f } })
+    {
+        sampling::sample_linear<float>(u, a, b, out);
+        for (std::size_t i = 0; i < u.size(); ++i)
+        {
+            ASSERT_NEAR(out[i], sampling::sample_linear(u[i], a, b), 1e-6);
+            ASSERT_NEAR(sampling::invert_sample_linear(out[i], a, b), u[i], 1e-5);
+        }
+    }
+}
+
+TEST(sampling_batch, discrete_matches_single)
+{
+    std::vector<double> weights = { 0.5, 0, 2, 1, 0, 3.25, 0.25 };
+    std::vector<double> u(50001);
+    for (std::size_t i = 0; i < u.size(); ++i) u[i] = static_cast<double>(i) / static_cast<double>(u.size() - 1);
+    std::vector<int> out(u.size());
+
+    base::thread_pool pool(3);
+    sampling::sample_discrete<double>(weights, u, out, pool);
+    for (std::size_t i = 0; i < u.size(); ++i) ASSERT_EQ(out[i], sampling::sample_discrete<double>(weights, u[i])) << u[i];
+
+    sampling::sample_discrete<double>(std::span<const double>{}, u, out, pool);
+    ASSERT_EQ(out[0], -1);
+}
+
+TEST(sampling_batch, rejects_mismatched_spans)
+{
+    std::vector<point<float, 2>> u(4);
+    std::vector<point<float, 2>> out(3);
+    ASSERT_THROW(sampling::sample_disk<float>(u, out), std::invalid_argument);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <set>
+
+#include "math/tables.hpp"
+#include "math/sampling.hpp"
+
+// the tables are built and usable at compile time
+static_assert(math::tables::sobol_matrices.columns[0][0] == 0x80000000u);
+static_assert(math::tables::sobol(3, 1) == 0x40000000u);
+static_assert(math::tables::quarter_sine<double>[math::tables::SINE_TABLE_SIZE - 1] > 0.9999999);
+static_assert(math::tables::polar_angle(0.25) > math::pi<double> / 3 - 1e-9 && math::tables::polar_angle(0.25) < math::pi<double> / 3 + 1e-9);
+
+template<typename T>
+void check_polar_angle(double bound)
+{
+    double worst = 0;
+    for (int i = 0; i <= 100000; ++i)
+    {
+        T u = static_cast<T>(i) / 100000;
+        worst = std::max(worst, std::abs(static_cast<double>(math::tables::polar_angle(u)) - std::acos(1 - 2 * static_cast<double>(u))));
+    }
+    ASSERT_LT(worst, bound);
+}
+
+template<typename T>
+void check_sincos_turn()
+{
+    double worst = 0;
+    for (int i = 0; i <= 100000; ++i)
+    {
+        T u = static_cast<T>(i) / 100000, s, c;
+        math::tables::sincos_turn(u, s, c);
+        double angle = 2 * math::pi<double> * static_cast<double>(u);
+        worst = std::max(worst, std::abs(static_cast<double>(s) - std::sin(angle)));
+        worst = std::max(worst, std::abs(static_cast<double>(c) - std::cos(angle)));
+    }
+    ASSERT_LT(worst, 0x1p-21);
+}
+
+TEST(tables, polar_angle)
+{
+    check_polar_angle<float>(0x1p-21);
+    check_polar_angle<double>(0x1p-22);
+    ASSERT_EQ(math::tables::polar_angle(0.0f), 0);
+    ASSERT_FLOAT_EQ(math::tables::polar_angle(1.0f), math::pi<float>);
+}
+
+TEST(tables, sincos_turn)
+{
+    check_sincos_turn<float>();
+    check_sincos_turn<double>();
+}
+
+TEST(tables, lookup_table_lerp)
+{
+    constexpr auto ramp = math::tables::tabulate<float, 5>([](float u) { return u * u; });
+    ASSERT_FLOAT_EQ(ramp.lerp(0.25f), 0.0625f);
+    ASSERT_FLOAT_EQ(ramp.lerp(0.375f), (0.0625f + 0.25f) / 2);
+    ASSERT_FLOAT_EQ(ramp.lerp(-1.0f), 0);
+    ASSERT_FLOAT_EQ(ramp.lerp(2.0f), 1);
+}
+
+TEST(tables, sobol_stratifies_every_dimension)
+{
+    // the first 2^k points of each dimension fall in distinct intervals of width 2^-k
+    for (std::size_t dim = 0; dim < math::tables::SOBOL_DIMENSIONS; ++dim)
+    {
+        for (int k = 1; k <= 10; ++k)
+        {
+            std::set<std::uint32_t> intervals;
+            for (std::uint32_t i = 0; i < (1u << k); ++i) intervals.insert(math::tables::sobol(i, dim) >> (32 - k));
+            ASSERT_EQ(intervals.size(), 1u << k) << "dimension " << dim << ", 2^" << k << " points";
+        }
+    }
+}
+
+TEST(tables, sobol_first_dimensions_form_a_02_sequence)
+{
+    // every elementary interval of area 2^-m holds exactly one of the first 2^m points
+    constexpr int m = 8;
+    for (int a = 0; a <= m; ++a)
+    {
+        std::set<std::pair<std::uint32_t, std::uint32_t>> cells;
+        for (std::uint32_t i = 0; i < (1u << m); ++i)
+        {
+            std::uint32_t x = a == 0 ? 0 : math::tables::sobol(i, 0) >> (32 - a);
+            std::uint32_t y = a == m ? 0 : math::tables::sobol(i, 1) >> (32 - (m - a));
+            cells.emplace(x, y);
+        }
+        ASSERT_EQ(cells.size(), 1u << m) << a << " by " << m - a;
+    }
+}
+
+TEST(tables, sampling_uses_tables)
+{
+    using namespace math;
+
+    point<float, 3> sphere = sampling::sample_sphere_surface(point<float, 2>{ 0.25f, 0.8f });
+    ASSERT_FLOAT_EQ(sphere[0], 1);
+    ASSERT_FLOAT_EQ(sphere[1], pi<float> / 2);
+    ASSERT_NEAR(sphere[2], std::acos(1 - 2 * 0.8f), 1e-6);
+
+    point<float, 3> hemisphere = sampling::sample_cosine_hemisphere(point<float, 2>{ 0.5f, 0.3f });
+    ASSERT_FLOAT_EQ(hemisphere[1], pi<float>);
+    ASSERT_NEAR(hemisphere[2], std::asin(std::sqrt(0.3f)), 1e-6);
+}
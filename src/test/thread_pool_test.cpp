@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "base/thread_pool.hpp"
+
+TEST(thread_pool, parallel_for_covers_range)
+{
+    base::thread_pool pool{ 3 };
+    std::vector<int> hits(1000, 0);
+
+    pool.parallel_for(0, hits.size(), 16, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) ++hits[i];
+    });
+
+    for (int hit : hits) EXPECT_EQ(hit, 1);
+}
+
+TEST(thread_pool, nested_loops)
+{
+    base::thread_pool pool{ 2 };
+    std::vector<long> sums(8, 0);
+
+    pool.parallel_for(0, sums.size(), 1, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            std::vector<long> values(256);
+            pool.parallel_for(0, values.size(), 8, [&](std::size_t lo, std::size_t hi) {
+                for (std::size_t j = lo; j < hi; ++j) values[j] = static_cast<long>(i * j);
+            });
+            sums[i] = std::accumulate(values.begin(), values.end(), 0l);
+        }
+    });
+
+    for (std::size_t i = 0; i < sums.size(); ++i) EXPECT_EQ(sums[i], static_cast<long>(i * 255 * 256 / 2));
+}
+
+TEST(thread_pool, rethrows_exceptions)
+{
+    base::thread_pool pool{ 2 };
+    EXPECT_THROW(pool.parallel_for(0, 64, 1, [](std::size_t begin, std::size_t) {
+        if (begin == 0) throw std::runtime_error{ "chunk failed" };
+    }), std::runtime_error);
+}
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "base/tiled_image.hpp"
+
+TEST(tiled_image, indexing_matches_layout)
+{
+    using namespace base;
+    constexpr int ts = tiled_image::tile_size;
+    tiled_image img{ 3 * ts, 2 * ts };
+
+    img[{ ts + 2, ts + 3 }] = 0x0A0B0C_rgb;
+
+    const pixel& p = img.tile(1, 1)[3 * ts + 2];
+    EXPECT_EQ(p.red, 0x0A);
+    EXPECT_EQ(p.blue, 0x0C);
+    EXPECT_EQ(&p, (&img[{ ts + 2, ts + 3 }]));
+}
+
+TEST(tiled_image, untile_round_trip)
+{
+    using namespace base;
+    constexpr int width = 37, height = 21; // not multiples of the tile size
+    image src{ width, height };
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x) src[{ x, y }] = pixel{ static_cast<uint8_t>(x), static_cast<uint8_t>(y), static_cast<uint8_t>(x ^ y) };
+    }
+
+    tiled_image tiled{ src };
+
+    thread_pool pool{ 3 };
+    constexpr int stride = width + 5;
+    pixel buffer[stride * height];
+    image view{ buffer, width, height, stride };
+    tiled.untile(view, pool);
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            EXPECT_EQ((view[{ x, y }].red), x);
+            EXPECT_EQ((view[{ x, y }].green), y);
+            EXPECT_EQ((view[{ x, y }].blue), x ^ y);
+        }
+    }
+
+    image packed = tiled.to_image();
+    EXPECT_EQ((packed[{ width - 1, height - 1 }].blue), (width - 1) ^ (height - 1));
+
+    image wrong{ width + 1, height };
+    EXPECT_THROW(tiled.untile(wrong, pool), std::invalid_argument);
+}
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#include "math/geometry/transform.hpp"
+
+using namespace math;
+
+static void expect_near(const point<float, 3>& a, const point<float, 3>& b, float eps = 1e-5f)
+{
+    for (int i = 0; i < 3; ++i) EXPECT_NEAR(a[i], b[i], eps);
+}
+
+TEST(transform, identity_and_translate)
+{
+    transformf id;
+    expect_near(id(point<float, 3>{ 1, 2, 3 }), point<float, 3>{ 1, 2, 3 });
+    ASSERT_FALSE(id.swaps_handedness());
+
+    transformf t = translate(vector<float, 3>{ 1, -2, 0.5f });
+    expect_near(t(point<float, 3>{ 1, 2, 3 }), point<float, 3>{ 2, 0, 3.5f });
+
+    // vectors and normals ignore the translation
+    vector<float, 3> v = t(vector<float, 3>{ 1, 2, 3 });
+    ASSERT_FLOAT_EQ(v[0], 1);
+    ASSERT_FLOAT_EQ(v[2], 3);
+    normal<float, 3> n = t(normal<float, 3>{ 0, 1, 0 });
+    ASSERT_FLOAT_EQ(n[1], 1);
+
+    expect_near(t.inverse()(t(point<float, 3>{ 4, 5, 6 })), point<float, 3>{ 4, 5, 6 });
+}
+
+TEST(transform, rotate)
+{
+    transformf r = rotate(std::numbers::pi_v<float> / 2, vector<float, 3>{ 0, 0, 2 });
+    expect_near(r(point<float, 3>{ 1, 0, 0 }), point<float, 3>{ 0, 1, 0 });
+    expect_near(r(point<float, 3>{ 0, 1, 5 }), point<float, 3>{ -1, 0, 5 });
+    expect_near(r.inverse()(point<float, 3>{ 0, 1, 0 }), point<float, 3>{ 1, 0, 0 });
+
+    transformf about = rotate(0.7f, vector<float, 3>{ 1, 2, -1 });
+    point<float, 3> p{ 3, -1, 2 };
+    vector<float, 3> axis{ 1, 2, -1 };
+    point<float, 3> q = about(p);
+    ASSERT_NEAR(magnitude(q - point<float, 3>{ 0, 0, 0 }), magnitude(p - point<float, 3>{ 0, 0, 0 }), 1e-5f);
+    ASSERT_NEAR(dot(q - point<float, 3>{ 0, 0, 0 }, axis), dot(p - point<float, 3>{ 0, 0, 0 }, axis), 1e-5f);
+}
+
+TEST(transform, compose)
+{
+    transformf t = translate(vector<float, 3>{ 1, 0, 0 }) * scale(2.0f, 3.0f, 4.0f);
+    expect_near(t(point<float, 3>{ 1, 1, 1 }), point<float, 3>{ 3, 3, 4 });
+    expect_near(t.inverse()(point<float, 3>{ 3, 3, 4 }), point<float, 3>{ 1, 1, 1 });
+
+    // the general constructor inverts the same matrix
+    transformf general{ t.get_matrix() };
+    for (int i = 0; i < 3; ++i)
+    {
+        for (int j = 0; j < 4; ++j) ASSERT_NEAR(general.get_inverse_matrix()[i][j], t.get_inverse_matrix()[i][j], 1e-6f);
+    }
+
+    transformf m = rotate(0.3f, vector<float, 3>{ 1, 1, 0 }) * scale(1.0f, -2.0f, 0.5f) * translate(vector<float, 3>{ 0, 4, -1 });
+    transformf inverted{ m.get_matrix() };
+    expect_near(inverted.inverse()(m(point<float, 3>{ -2, 7, 1 })), point<float, 3>{ -2, 7, 1 }, 1e-4f);
+    ASSERT_TRUE(m.swaps_handedness());
+}
+
+TEST(transform, singular)
+{
+    float flat[3][4] = { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 1, 1, 0, 0 } };
+    ASSERT_THROW(transformf{ flat }, std::invalid_argument);
+    ASSERT_THROW(scale(1.0f, 0.0f, 1.0f), std::invalid_argument);
+}
+
+TEST(transform, normals_stay_perpendicular)
+{
+    // a plane tilted 45 degrees, squashed along x, tilts further and its normal must follow
+    transformf t = scale(0.25f, 1.0f, 1.0f) * rotate(0.4f, vector<float, 3>{ 0, 1, 1 });
+    vector<float, 3> tangent0{ 1, 1, 0 }, tangent1{ 0, 0, 1 };
+    normal<float, 3> n{ 1, -1, 0 };
+
+    normal<float, 3> tn = t(n);
+    ASSERT_NEAR(dot(tn, t(tangent0)), 0, 1e-5f);
+    ASSERT_NEAR(dot(tn, t(tangent1)), 0, 1e-5f);
+
+    // transforming the normal like a vector would not be perpendicular
+    vector<float, 3> wrong = t(vector<float, 3>{ 1, -1, 0 });
+    ASSERT_GT(std::abs(dot(wrong, t(tangent0))), 0.1f);
+}
+
+TEST(transform, rays_keep_distances)
+{
+    transformf t = translate(vector<float, 3>{ 2, 0, 0 }) * scale(3.0f, 3.0f, 3.0f);
+    ray<float, 3> r{ point<float, 3>{ 0, 1, 0 }, vector<float, 3>{ 1, 0, 0 } };
+    ray<float, 3> tr = t(r);
+    expect_near(tr.at(2.0f), t(r.at(2.0f)));
+}
+
+TEST(transform, bounds)
+{
+    bounds3f b{ point<float, 3>{ -1, -1, -1 }, point<float, 3>{ 1, 2, 3 } };
+    bounds3f moved = translate(vector<float, 3>{ 1, 1, 1 })(b);
+    expect_near(moved.get_min(), point<float, 3>{ 0, 0, 0 });
+    expect_near(moved.get_max(), point<float, 3>{ 2, 3, 4 });
+
+    transformf t = rotate(0.9f, vector<float, 3>{ 1, -2, 1 }) * scale(2.0f, 1.0f, -1.0f);
+    bounds3f tb = t(b);
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        point<float, 3> p{ b[corner & 1][0], b[(corner >> 1) & 1][1], b[(corner >> 2) & 1][2] };
+        point<float, 3> q = t(p);
+        for (int i = 0; i < 3; ++i)
+        {
+            EXPECT_LE(tb.get_min()[i], q[i] + 1e-5f);
+            EXPECT_GE(tb.get_max()[i], q[i] - 1e-5f);
+        }
+    }
+
+    ASSERT_TRUE(t(bounds3f{}).is_empty());
+}
@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "accel/triangle.hpp"
+#include "accel/two_level_bvh.hpp"
+#include "accel/wide_bvh.hpp"
+#include "accel_test_util.hpp"
+
+using namespace math;
+using namespace accel_test;
+using accel::bvh;
+using accel::bvh_instance;
+using accel::triangle;
+using accel::two_level_bvh;
+
+static transformf random_placement(std::mt19937& rng)
+{
+    std::uniform_real_distribution<float> position{ -20, 20 }, size{ 0.5f, 2 }, angle{ 0, 6.28f }, axis{ -1, 1 };
+    return translate(vector<float, 3>{ position(rng), position(rng), position(rng) })
+         * rotate(angle(rng), vector<float, 3>{ axis(rng), axis(rng), axis(rng) })
+         * scale(size(rng), size(rng), size(rng));
+}
+
+/**
+ * the scene of the test: a few meshes, each placed many times.
+ */
+struct scene
+{
+    std::vector<std::vector<triangle>> meshes;
+    std::vector<bvh> blases;
+    std::vector<bvh_instance> instances;
+
+    scene(std::size_t mesh_count, std::size_t instance_count)
+    {
+        std::mt19937 rng{ 1 };
+        for (std::size_t m = 0; m < mesh_count; ++m)
+        {
+            meshes.push_back(random_triangles(200, static_cast<unsigned>(m + 10), 1, 0.2f));
+            blases.emplace_back(bounds_of(meshes.back()));
+        }
+        for (std::size_t i = 0; i < instance_count; ++i)
+        {
+            instances.push_back({ static_cast<std::uint32_t>(i % mesh_count), random_placement(rng) });
+        }
+    }
+
+    // intersects the triangles of every instance moved into the scene one by one
+    float brute_force(const ray3f& r, std::span<const bvh_instance> placed, std::uint32_t* hit_instance) const
+    {
+        float tmax = std::numeric_limits<float>::infinity();
+        for (std::uint32_t i = 0; i < placed.size(); ++i)
+        {
+            const transformf& t = placed[i].object_to_world;
+            for (const auto& tri : meshes[placed[i].blas])
+            {
+                if (triangle{ t(tri.p0), t(tri.p1), t(tri.p2) }.intersect(r, tmax)) *hit_instance = i;
+            }
+        }
+        return tmax;
+    }
+};
+
+template<typename Blas>
+static void check_against_brute_force(const two_level_bvh<Blas>& tree, const scene& s, std::size_t ray_count)
+{
+    std::size_t hits = 0;
+    for (const auto& r : random_rays(ray_count, 2, 25))
+    {
+        std::uint32_t expected_instance = 0;
+        float expected = s.brute_force(r, tree.instances(), &expected_instance);
+
+        std::uint32_t hit_instance = 0;
+        auto intersect = [&](std::uint32_t instance, std::uint32_t primitive, const ray3f& object_ray, float& tmax)
+        {
+            if (!s.meshes[tree.instances()[instance].blas][primitive].intersect(object_ray, tmax)) return false;
+            hit_instance = instance;
+            return true;
+        };
+
+        float tmax = std::numeric_limits<float>::infinity();
+        bool hit = tree.closest_hit(r, tmax, intersect);
+        ASSERT_EQ(hit, std::isfinite(expected));
+        auto occluded = [&](std::uint32_t instance, std::uint32_t primitive, const ray3f& object_ray, float& t)
+        {
+            return s.meshes[tree.instances()[instance].blas][primitive].intersect(object_ray, t);
+        };
+        ASSERT_EQ(tree.any_hit(r, std::numeric_limits<float>::infinity(), occluded), hit);
+        if (!hit) continue;
+
+        ++hits;
+        ASSERT_NEAR(tmax, expected, 1e-4f * expected + 1e-5f);
+        ASSERT_EQ(hit_instance, expected_instance);
+
+        // the hit point found in object space lands on the ray in the scene
+        const transformf& t = tree.instances()[hit_instance].object_to_world;
+        point<float, 3> p = t(t.inverse()(r).at(tmax));
+        point<float, 3> q = r.at(tmax);
+        for (int i = 0; i < 3; ++i) ASSERT_NEAR(p[i], q[i], 1e-3f);
+    }
+    ASSERT_GT(hits, ray_count / 20);
+}
+
+TEST(two_level_bvh, matches_brute_force)
+{
+    scene s{ 3, 300 };
+    two_level_bvh<> tree{ s.blases, s.instances };
+    ASSERT_EQ(tree.top().primitive_indices().size(), 300u);
+    ASSERT_EQ(tree.blases().size(), 3u);
+    check_against_brute_force(tree, s, 300);
+}
+
+TEST(two_level_bvh, wide_blases)
+{
+    scene s{ 2, 100 };
+    std::vector<accel::bvh8> wide(s.blases.begin(), s.blases.end());
+    two_level_bvh<accel::bvh8> tree{ wide, s.instances };
+    check_against_brute_force(tree, s, 200);
+}
+
+TEST(two_level_bvh, moving_instances_rebuilds_the_top)
+{
+    scene s{ 2, 200 };
+    two_level_bvh<> tree{ s.blases, s.instances };
+    const accel::bvh_node* blas_nodes = s.blases[0].nodes().data();
+
+    std::mt19937 rng{ 3 };
+    for (std::uint32_t i = 0; i < 200; i += 7) tree.set_transform(i, random_placement(rng));
+    tree.rebuild();
+
+    // the bottom level is shared and untouched
+    ASSERT_EQ(s.blases[0].nodes().data(), blas_nodes);
+    check_against_brute_force(tree, s, 200);
+}
+
+TEST(two_level_bvh, normals)
+{
+    // a mesh squashed and mirrored: the normal computed in object space must come out perpendicular to the surface
+    std::vector<triangle> mesh{ { point<float, 3>{ 0, 0, 0 }, point<float, 3>{ 1, 0, 1 }, point<float, 3>{ 0, 1, 0 } } };
+    std::vector<bvh> blases;
+    blases.emplace_back(bounds_of(mesh));
+    transformf t = rotate(0.5f, vector<float, 3>{ 1, 1, 0 }) * scale(3.0f, -0.5f, 1.0f);
+    two_level_bvh<> tree{ blases, { bvh_instance{ 0, t } } };
+
+    triangle world{ t(mesh[0].p0), t(mesh[0].p1), t(mesh[0].p2) };
+    point<float, 3> target = t(point<float, 3>{ 0.25f, 0.25f, 0.25f });
+    ray3f r{ point<float, 3>{ 5, 5, 5 }, target - point<float, 3>{ 5, 5, 5 } };
+
+    normal<float, 3> object_normal{};
+    float tmax = std::numeric_limits<float>::infinity();
+    ASSERT_TRUE(tree.closest_hit(r, tmax, [&](std::uint32_t, std::uint32_t primitive, const ray3f& object_ray, float& t_hit)
+    {
+        const triangle& tri = mesh[primitive];
+        if (!tri.intersect(object_ray, t_hit)) return false;
+        vector<float, 3> n = cross(tri.p1 - tri.p0, tri.p2 - tri.p0);
+        object_normal = normal<float, 3>{ n[0], n[1], n[2] };
+        return true;
+    }));
+    ASSERT_NEAR(tmax, 1, 1e-5f);
+
+    normal<float, 3> n = t(object_normal);
+    ASSERT_NEAR(dot(n, world.p1 - world.p0), 0, 1e-4f);
+    ASSERT_NEAR(dot(n, world.p2 - world.p0), 0, 1e-4f);
+    ASSERT_TRUE(t.swaps_handedness());
+}
+
+TEST(two_level_bvh, invalid_instances)
+{
+    std::vector<bvh> blases(1);
+    ASSERT_THROW((two_level_bvh<>{ blases, { bvh_instance{ 0, transformf{} } } }), std::invalid_argument);
+    ASSERT_THROW((two_level_bvh<>{ blases, { bvh_instance{ 1, transformf{} } } }), std::invalid_argument);
+
+    two_level_bvh<> empty{ blases, {} };
+    ASSERT_TRUE(empty.empty());
+    float tmax = 1;
+    ASSERT_FALSE(empty.closest_hit(ray3f{}, tmax, [](std::uint32_t, std::uint32_t, const ray3f&, float&) { return true; }));
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+
+#include "math/geometry/vec_packet.hpp"
+
+template<typename T, std::size_t W>
+void check_lane_arithmetic()
+{
+    using namespace math;
+    using lane_t = lane<T, W>;
+
+    T a_values[W], b_values[W];
+    for (std::size_t i = 0; i < W; ++i)
+    {
+        a_values[i] = static_cast<T>(i) - 3;
+        b_values[i] = static_cast<T>(W - i) * 0.5f;
+    }
+    lane_t a = lane_t::load(a_values);
+    lane_t b = lane_t::load(b_values);
+
+    lane_t sum = a + b, diff = a - b, prod = a * b, quot = a / b, neg = -a;
+    lane_t lo = min(a, b), hi = max(a, b), fused = fma(a, b, lane_t{ 2 }), root = sqrt(b), absolute = abs(a);
+    lane_t signs = copysign(b, a);
+    for (std::size_t i = 0; i < W; ++i)
+    {
+        ASSERT_FLOAT_EQ(sum[i], a_values[i] + b_values[i]);
+        ASSERT_FLOAT_EQ(diff[i], a_values[i] - b_values[i]);
+        ASSERT_FLOAT_EQ(prod[i], a_values[i] * b_values[i]);
+        ASSERT_FLOAT_EQ(quot[i], a_values[i] / b_values[i]);
+        ASSERT_FLOAT_EQ(neg[i], -a_values[i]);
+        ASSERT_FLOAT_EQ(lo[i], std::min(a_values[i], b_values[i]));
+        ASSERT_FLOAT_EQ(hi[i], std::max(a_values[i], b_values[i]));
+        ASSERT_FLOAT_EQ(fused[i], a_values[i] * b_values[i] + 2);
+        ASSERT_FLOAT_EQ(root[i], std::sqrt(b_values[i]));
+        ASSERT_FLOAT_EQ(absolute[i], std::abs(a_values[i]));
+        ASSERT_FLOAT_EQ(signs[i], std::copysign(b_values[i], a_values[i]));
+    }
+
+    T total = 0, smallest = a_values[0], largest = a_values[0];
+    for (std::size_t i = 0; i < W; ++i)
+    {
+        total += a_values[i];
+        smallest = std::min(smallest, a_values[i]);
+        largest = std::max(largest, a_values[i]);
+    }
+    ASSERT_FLOAT_EQ(reduce_add(a), total);
+    ASSERT_FLOAT_EQ(reduce_min(a), smallest);
+    ASSERT_FLOAT_EQ(reduce_max(a), largest);
+
+    // scalars broadcast
+    lane_t shifted = a + 1;
+    ASSERT_FLOAT_EQ(shifted[W - 1], a_values[W - 1] + 1);
+
+    lane_t modified = a;
+    modified.set(W - 1, 42);
+    ASSERT_FLOAT_EQ(modified[W - 1], 42);
+    ASSERT_FLOAT_EQ(modified[0], a_values[0]);
+}
+
+template<typename T, std::size_t W>
+void check_lane_masks()
+{
+    using namespace math;
+    using lane_t = lane<T, W>;
+
+    T values[W];
+    for (std::size_t i = 0; i < W; ++i) values[i] = static_cast<T>(i);
+    lane_t a = lane_t::load(values);
+    lane_t half{ static_cast<T>(W / 2) };
+
+    auto below = a < half;
+    std::uint32_t expected = (1u << (W / 2)) - 1;
+    ASSERT_EQ(below.bits(), expected);
+    ASSERT_TRUE(below.any());
+    ASSERT_FALSE(below.all());
+    ASSERT_FALSE(below.none());
+    ASSERT_EQ((~below).bits(), (a >= half).bits());
+    ASSERT_EQ((below | (a >= half)).bits(), (lane_mask<T, W>::full));
+    ASSERT_TRUE((below & (a >= half)).none());
+    ASSERT_TRUE((a == a).all());
+    ASSERT_TRUE((a != a).none());
+    ASSERT_EQ((a <= half).bits(), (expected << 1) | 1);
+    ASSERT_EQ((a > half).bits(), (a >= half).bits() & ~(1u << (W / 2)));
+
+    ASSERT_EQ((decltype(below)::from_bits(0b101).bits()), 0b101u);
+    ASSERT_TRUE(decltype(below){ true }.all());
+    ASSERT_TRUE(decltype(below){ false }.none());
+    ASSERT_TRUE(decltype(below)::from_bits(0b10)[1]);
+
+    lane_t picked = select(below, a, -a);
+    for (std::size_t i = 0; i < W; ++i)
+    {
+        ASSERT_FLOAT_EQ(picked[i], i < W / 2 ? values[i] : -values[i]);
+    }
+}
+
+TEST(lane, arithmetic)
+{
+    check_lane_arithmetic<float, 4>();
+    check_lane_arithmetic<float, 8>();
+    check_lane_arithmetic<float, 16>();
+    check_lane_arithmetic<double, 4>();
+}
+
+TEST(lane, masks)
+{
+    check_lane_masks<float, 4>();
+    check_lane_masks<float, 8>();
+    check_lane_masks<float, 16>();
+    check_lane_masks<double, 4>();
+}
+
+template<std::size_t W>
+void check_packet_against_vectors()
+{
+    using namespace math;
+    using packet_t = vector_packet<float, 3, W>;
+
+    std::mt19937 gen{ 7 };
+    std::uniform_real_distribution<float> dist{ -4, 4 };
+
+    std::array<vec3f, W> as, bs;
+    for (std::size_t i = 0; i < W; ++i)
+    {
+        as[i] = vec3f{ dist(gen), dist(gen), dist(gen) };
+        bs[i] = vec3f{ dist(gen), dist(gen), dist(gen) };
+    }
+    packet_t a = packet_t::load(as);
+    packet_t b = packet_t::load(bs);
+
+    auto d = dot(a, b);
+    auto c = cross(a, b);
+    auto n = normalize(a);
+    auto sum = a + b;
+    auto diff = a - b;
+    auto scaled = a * 2.0f;
+    auto lo = min(a, b);
+    auto hi = max(a, b);
+    auto l = lerp(a, b, 0.25f);
+    auto f = fma(a, b, a);
+    auto [t, s] = coordinate_system(n);
+
+    for (std::size_t i = 0; i < W; ++i)
+    {
+        ASSERT_NEAR(d[i], dot(as[i], bs[i]), 1e-4);
+
+        vec3f expected_cross = cross(as[i], bs[i]);
+        vec3f expected_normal = normalize<float>(as[i]);
+        vec3f expected_lerp = lerp(as[i], bs[i], 0.25f);
+        vec3f expected_fma = fma(as[i], bs[i], as[i]);
+        auto [expected_t, expected_s] = coordinate_system(expected_normal);
+        for (int k = 0; k < 3; ++k)
+        {
+            ASSERT_NEAR(c[k][i], expected_cross[k], 1e-4);
+            ASSERT_NEAR(n[k][i], expected_normal[k], 1e-5);
+            ASSERT_FLOAT_EQ(sum[k][i], as[i][k] + bs[i][k]);
+            ASSERT_FLOAT_EQ(diff[k][i], as[i][k] - bs[i][k]);
+            ASSERT_FLOAT_EQ(scaled[k][i], as[i][k] * 2);
+            ASSERT_FLOAT_EQ(lo[k][i], std::min(as[i][k], bs[i][k]));
+            ASSERT_FLOAT_EQ(hi[k][i], std::max(as[i][k], bs[i][k]));
+            ASSERT_NEAR(l[k][i], expected_lerp[k], 1e-5);
+            ASSERT_NEAR(f[k][i], expected_fma[k], 1e-5);
+            ASSERT_NEAR(t[k][i], expected_t[k], 1e-4);
+            ASSERT_NEAR(s[k][i], expected_s[k], 1e-4);
+        }
+
+        // the frame is orthonormal
+        ASSERT_NEAR(dot(t, n)[i], 0, 1e-5);
+        ASSERT_NEAR(dot(s, n)[i], 0, 1e-5);
+        ASSERT_NEAR(dot(t, s)[i], 0, 1e-5);
+        ASSERT_NEAR(magnitude(t)[i], 1, 1e-5);
+    }
+
+    std::array<vec3f, W> round_trip;
+    a.store(round_trip);
+    for (std::size_t i = 0; i < W; ++i)
+    {
+        ASSERT_EQ(round_trip[i], as[i]);
+        ASSERT_EQ(a.extract(i), as[i]);
+    }
+}
+
+TEST(vector_packet, matches_vector_functions)
+{
+    check_packet_against_vectors<4>();
+    check_packet_against_vectors<8>();
+    check_packet_against_vectors<16>();
+}
+
+TEST(vector_packet, broadcast_insert_select)
+{
+    using namespace math;
+    vec3f_packet<4> p{ vec3f{ 1, 2, 3 } };
+    for (std::size_t i = 0; i < 4; ++i) ASSERT_EQ(p.extract(i), (vec3f{ 1, 2, 3 }));
+
+    p.insert(2, vec3f{ -1, -2, -3 });
+    ASSERT_EQ(p.extract(2), (vec3f{ -1, -2, -3 }));
+    ASSERT_EQ(p.extract(3), (vec3f{ 1, 2, 3 }));
+
+    auto negative = p[0] < 0.0f;
+    ASSERT_EQ(negative.bits(), 0b0100u);
+
+    vec3f_packet<4> zero;
+    auto picked = select(negative, zero, p);
+    ASSERT_EQ(picked.extract(2), (vec3f{ 0, 0, 0 }));
+    ASSERT_EQ(picked.extract(1), (vec3f{ 1, 2, 3 }));
+
+    // partial loads leave the remaining lanes zero
+    std::array<vec3f, 2> two{ vec3f{ 1, 1, 1 }, vec3f{ 2, 2, 2 } };
+    auto partial = vec3f_packet<4>::load(two);
+    ASSERT_EQ(partial.extract(1), (vec3f{ 2, 2, 2 }));
+    ASSERT_EQ(partial.extract(3), (vec3f{ 0, 0, 0 }));
+}
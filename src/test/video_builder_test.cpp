@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "media/video_builder.hpp"
+
+namespace
+{
+    constexpr int width = 16, height = 8;
+
+    std::string temp_path(const char* name)
+    {
+        return (std::filesystem::temp_directory_path() / name).string();
+    }
+
+    std::string read_file(const std::string& path)
+    {
+        std::ifstream in{ path, std::ios::binary };
+        return { std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+    }
+
+    media::video_settings raw_settings(media::output_mode mode, std::size_t queue_depth)
+    {
+        media::video_settings settings;
+        settings.width = width;
+        settings.height = height;
+        settings.fps = 30;
+        settings.mode = mode;
+        settings.queue_depth = queue_depth;
+        return settings;
+    }
+
+    /**
+     * color encoding the index of a frame, so that the order of the written frames can be read back.
+     */
+    base::pixel numbered_pixel(int i)
+    {
+        return base::pixel{ static_cast<uint8_t>(i), static_cast<uint8_t>(i * 3), static_cast<uint8_t>(255 - i) };
+    }
+
+    base::image numbered_frame(int i)
+    {
+        base::image img{ width, height };
+        img.fill(numbered_pixel(i));
+        return img;
+    }
+}
+
+TEST(video_builder, y4m_layout)
+{
+    constexpr int frames = 3;
+    constexpr std::size_t frame_size = width * height * 3 / 2; // YUV420P
+    const std::string path = temp_path("video_builder_test.y4m");
+    {
+        media::video_builder builder{ path, raw_settings(media::output_mode::y4m, 0) };
+        for (int i = 0; i < frames; ++i) builder.push_frame(numbered_frame(i));
+        builder.flush();
+
+        media::encoder_stats stats = builder.stats();
+        EXPECT_EQ(stats.frames_pushed, frames);
+        EXPECT_EQ(stats.frames_written, frames);
+        EXPECT_EQ(stats.bytes_written, std::filesystem::file_size(path));
+    }
+
+    const std::string data = read_file(path);
+    const std::string header = "YUV4MPEG2 W16 H8 F30:1 Ip A1:1 C420jpeg\n";
+    ASSERT_EQ(data.size(), header.size() + frames * (6 + frame_size));
+    EXPECT_EQ(data.substr(0, header.size()), header);
+    for (int i = 0; i < frames; ++i) EXPECT_EQ(data.substr(header.size() + i * (6 + frame_size), 6), "FRAME\n");
+}
+
+TEST(video_builder, raw_rgb0_layout)
+{
+    constexpr int frames = 4;
+    const std::string path = temp_path("video_builder_test.rgb0");
+    {
+        media::video_builder builder{ path, raw_settings(media::output_mode::raw_rgb0, 0) };
+        for (int i = 0; i < frames; ++i) builder.push_frame(numbered_frame(i));
+        builder.flush();
+        EXPECT_EQ(builder.stats().bytes_written, frames * width * height * 4);
+    }
+
+    const std::string data = read_file(path);
+    ASSERT_EQ(data.size(), frames * width * height * 4);
+    for (int i = 0; i < frames; ++i)
+    {
+        // rows are written without the padding of the frames
+        const char* frame = data.data() + i * width * height * 4;
+        for (int p = 0; p < width * height; ++p)
+        {
+            EXPECT_EQ(static_cast<uint8_t>(frame[4 * p + 0]), i);
+            EXPECT_EQ(static_cast<uint8_t>(frame[4 * p + 1]), i * 3);
+            EXPECT_EQ(static_cast<uint8_t>(frame[4 * p + 2]), 255 - i);
+        }
+    }
+}
+
+TEST(video_builder, asynchronous_mode_keeps_frame_order)
+{
+    constexpr int frames = 40;
+    const std::string path = temp_path("video_builder_test_async.rgb0");
+    {
+        media::video_builder builder{ path, raw_settings(media::output_mode::raw_rgb0, 3) };
+        for (int i = 0; i < frames; ++i)
+        {
+            if (i % 2 == 0)
+            {
+                builder.push_frame(numbered_frame(i));
+                continue;
+            }
+            media::video_builder::lent_frame frame = builder.lend_frame();
+            frame.get().fill(numbered_pixel(i));
+            builder.commit_frame(std::move(frame));
+        }
+        builder.flush();
+        EXPECT_EQ(builder.stats().frames_written, frames);
+        EXPECT_EQ(builder.stats().frames_queued(), 0u);
+    }
+
+    const std::string data = read_file(path);
+    ASSERT_EQ(data.size(), frames * width * height * 4);
+    for (int i = 0; i < frames; ++i)
+    {
+        const char* frame = data.data() + i * width * height * 4;
+        EXPECT_EQ(static_cast<uint8_t>(frame[0]), i);
+        EXPECT_EQ(static_cast<uint8_t>(frame[(width * height - 1) * 4 + 1]), i * 3);
+    }
+}
+
+TEST(video_builder, destroyed_lent_frame_returns_its_slot)
+{
+    constexpr std::size_t queue_depth = 2;
+    const std::string path = temp_path("video_builder_test_lend.rgb0");
+    {
+        media::video_builder builder{ path, raw_settings(media::output_mode::raw_rgb0, queue_depth) };
+
+        // every lend past the depth of the ring would block forever if a dropped frame kept its slot
+        for (std::size_t i = 0; i < queue_depth + 1; ++i)
+        {
+            media::video_builder::lent_frame frame = builder.lend_frame();
+            EXPECT_FALSE(frame.empty());
+        }
+        builder.push_frame(numbered_frame(7));
+        builder.flush();
+        EXPECT_EQ(builder.stats().frames_written, 1u);
+    }
+    EXPECT_EQ(std::filesystem::file_size(path), width * height * 4);
+}
+
+TEST(video_builder, synchronous_mode_lends_again_after_a_dropped_frame)
+{
+    const std::string path = temp_path("video_builder_test_lend_sync.rgb0");
+    media::video_builder builder{ path, raw_settings(media::output_mode::raw_rgb0, 0) };
+    {
+        media::video_builder::lent_frame frame = builder.lend_frame();
+        EXPECT_THROW(builder.lend_frame(), media::ffmpeg_error);
+    }
+    media::video_builder::lent_frame frame = builder.lend_frame();
+    builder.commit_frame(std::move(frame));
+    EXPECT_TRUE(frame.empty());
+}
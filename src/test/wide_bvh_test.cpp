@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <limits>
+#include <vector>
+
+#include "accel/bvh.hpp"
+#include "accel/triangle.hpp"
+#include "accel/wide_bvh.hpp"
+#include "accel_test_util.hpp"
+
+using namespace math;
+using namespace accel_test;
+using accel::bvh;
+using accel::triangle;
+using accel::wide_bvh;
+
+static std::vector<ray3f> traversal_rays(std::size_t count, unsigned seed)
+{
+    std::vector<ray3f> rays = random_rays(count, seed);
+    // axis-aligned directions exercise the infinite reciprocals
+    rays.push_back({ point<float, 3>{ 0, 0, -12 }, vector<float, 3>{ 0, 0, 1 } });
+    rays.push_back({ point<float, 3>{ 1, -12, 2 }, vector<float, 3>{ -0.0f, 1, 0 } });
+    return rays;
+}
+
+template<std::size_t W>
+static void check_structure()
+{
+    auto tris = random_triangles(3000, 1);
+    auto prim_bounds = bounds_of(tris);
+    bvh binary{ prim_bounds };
+    wide_bvh<W> wide{ binary };
+
+    auto nodes = wide.nodes();
+    ASSERT_EQ(reinterpret_cast<std::uintptr_t>(nodes.data()) % 64, 0u);
+    ASSERT_LT(nodes.size(), binary.nodes().size() / 2);
+    check_tree(wide, prim_bounds);
+}
+
+template<std::size_t W>
+static void check_against_binary()
+{
+    auto tris = random_triangles(20000, 2);
+    auto rays = traversal_rays(2000, 3);
+    bvh binary{ bounds_of(tris) };
+    wide_bvh<W> wide{ binary };
+
+    auto intersect = [&](std::uint32_t prim, const ray3f& r, float& tmax) { return tris[prim].intersect(r, tmax); };
+
+    std::size_t hits = 0;
+    for (const auto& r : rays)
+    {
+        float expected = std::numeric_limits<float>::infinity();
+        bool expected_hit = binary.closest_hit(r, expected, intersect);
+
+        float tmax = std::numeric_limits<float>::infinity();
+        ASSERT_EQ(wide.closest_hit(r, tmax, intersect), expected_hit);
+        ASSERT_EQ(wide.any_hit(r, std::numeric_limits<float>::infinity(), intersect), expected_hit);
+        if (expected_hit)
+        {
+            ++hits;
+            ASSERT_FLOAT_EQ(tmax, expected);
+            ASSERT_FALSE(wide.any_hit(r, expected * 0.999f, intersect));
+        }
+    }
+    ASSERT_GT(hits, rays.size() / 10);
+}
+
+TEST(wide_bvh, node_layout)
+{
+    ASSERT_EQ(sizeof(accel::wide_bvh_node<4>), 128u);
+    ASSERT_EQ(sizeof(accel::wide_bvh_node<8>), 256u);
+
+    accel::wide_bvh_node<4> node;
+    for (std::size_t s = 0; s < 4; ++s)
+    {
+        ASSERT_FALSE(node.is_used(s));
+        ASSERT_TRUE(node.get_bounds(s).is_empty());
+    }
+}
+
+TEST(wide_bvh, small_trees)
+{
+    ASSERT_TRUE(accel::bvh4{ bvh{} }.empty());
+
+    // a single primitive makes a root with one leaf slot
+    std::vector<triangle> tris{ triangle{ { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 } } };
+    accel::bvh8 wide{ bvh{ bounds_of(tris) } };
+    ASSERT_EQ(wide.nodes().size(), 1u);
+    ASSERT_TRUE(wide.nodes()[0].is_leaf(0));
+    ASSERT_FALSE(wide.nodes()[0].is_used(1));
+
+    float tmax = 10;
+    ASSERT_TRUE(wide.closest_hit(ray3f{ point<float, 3>{ 0.25f, 0.25f, -1 }, vector<float, 3>{ 0, 0, 1 } }, tmax,
+                                 [&](std::uint32_t prim, const ray3f& r, float& t) { return tris[prim].intersect(r, t); }));
+    ASSERT_FLOAT_EQ(tmax, 1);
+}
+
+TEST(wide_bvh, bvh4_structure)
+{
+    check_structure<4>();
+}
+
+TEST(wide_bvh, bvh8_structure)
+{
+    check_structure<8>();
+}
+
+TEST(wide_bvh, bvh4_matches_binary)
+{
+    check_against_binary<4>();
+}
+
+TEST(wide_bvh, bvh8_matches_binary)
+{
+    check_against_binary<8>();
+}